@@ -33,6 +33,7 @@
 #include "gfbgraph-album.h"
 #include "gfbgraph-user.h"
 #include "gfbgraph-connectable.h"
+#include "gfbgraph-private.h"
 
 enum {
         PROP_O,
@@ -55,6 +56,7 @@ static void gfbgraph_album_class_init   (GFBGraphAlbumClass *klass);
 static void gfbgraph_album_finalize     (GObject *obj);
 static void gfbgraph_album_set_property (GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec);
 static void gfbgraph_album_get_property (GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+static gboolean gfbgraph_album_deserialize_member (GFBGraphNode *node, const gchar *member_name, JsonNode *member_node);
 
 static void gfbgraph_album_connectable_iface_init (GFBGraphConnectableInterface *iface);
 GHashTable* gfbgraph_album_get_connection_post_params (GFBGraphConnectable *self, GType node_type);
@@ -83,6 +85,8 @@ gfbgraph_album_class_init (GFBGraphAlbumClass *klass)
         gobject_class->set_property = gfbgraph_album_set_property;
         gobject_class->get_property = gfbgraph_album_get_property;
 
+        GFBGRAPH_NODE_CLASS (klass)->deserialize_member = gfbgraph_album_deserialize_member;
+
         g_type_class_add_private (gobject_class, sizeof(GFBGraphAlbumPrivate));
 
         /**
@@ -205,6 +209,25 @@ gfbgraph_album_get_property (GObject *object, guint prop_id, GValue *value, GPar
         }
 }
 
+static gboolean
+gfbgraph_album_deserialize_member (GFBGraphNode *node, const gchar *member_name, JsonNode *member_node)
+{
+        GFBGraphAlbumPrivate *priv;
+
+        priv = GFBGRAPH_ALBUM (node)->priv;
+
+        if (gfbgraph_json_member_is (member_name, "name"))
+                return gfbgraph_json_set_string (member_node, &priv->name);
+        else if (gfbgraph_json_member_is (member_name, "description"))
+                return gfbgraph_json_set_string (member_node, &priv->description);
+        else if (gfbgraph_json_member_is (member_name, "cover_photo"))
+                return gfbgraph_json_set_string (member_node, &priv->cover_photo);
+        else if (gfbgraph_json_member_is (member_name, "count"))
+                return gfbgraph_json_set_uint (member_node, &priv->count);
+
+        return parent_class->deserialize_member (node, member_name, member_node);
+}
+
 static void
 gfbgraph_album_connectable_iface_init (GFBGraphConnectableInterface *iface)
 {
@@ -264,6 +287,24 @@ gfbgraph_album_new_from_id (GFBGraphAuthorizer *authorizer, const gchar *id, GEr
         return GFBGRAPH_ALBUM (gfbgraph_node_new_from_id (authorizer, id, GFBGRAPH_TYPE_ALBUM, error));
 }
 
+/**
+ * gfbgraph_album_new_from_id_with_fields:
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @id: a const #gchar with the album ID.
+ * @fields: (array zero-terminated=1) (allow-none): a %NULL-terminated array with the fields to retrieve, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Retrieves only the given @fields of the album node with the give ID, see
+ * gfbgraph_node_new_from_id_with_fields().
+ *
+ * Returns: (transfer full): a new #GFBGraphAlbum; unref with g_object_unref()
+ **/
+GFBGraphAlbum*
+gfbgraph_album_new_from_id_with_fields (GFBGraphAuthorizer *authorizer, const gchar *id, const gchar * const *fields, GError **error)
+{
+        return GFBGRAPH_ALBUM (gfbgraph_node_new_from_id_with_fields (authorizer, id, GFBGRAPH_TYPE_ALBUM, fields, error));
+}
+
 /**
  * gfbgraph_album_get_name:
  * @album: a #GFBGraphAlbum.
@@ -52,6 +52,7 @@ struct _GFBGraphAlbumClass {
 GType          gfbgraph_album_get_type    (void) G_GNUC_CONST;
 GFBGraphAlbum* gfbgraph_album_new         (void);
 GFBGraphAlbum* gfbgraph_album_new_from_id (GFBGraphAuthorizer *authorizer, const gchar *id, GError **error);
+GFBGraphAlbum* gfbgraph_album_new_from_id_with_fields (GFBGraphAuthorizer *authorizer, const gchar *id, const gchar * const *fields, GError **error);
 
 const gchar*   gfbgraph_album_get_name           (GFBGraphAlbum *album);
 const gchar*   gfbgraph_album_get_description    (GFBGraphAlbum *album);
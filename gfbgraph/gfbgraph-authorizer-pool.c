@@ -0,0 +1,796 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-authorizer-pool
+ * @title: GFBGraphAuthorizerPool
+ * @short_description: Spreads the requests over several authorizers.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphAuthorizerPool implements #GFBGraphAuthorizer with a set of
+ * authorizers, like one #GFBGraphSimpleAuthorizer per access token, so the
+ * requests of many users of one app don't exhaust the limits of one token.
+ * Every request is authorized by one of them, chosen in turn or by its load
+ * as set with gfbgraph_authorizer_pool_set_strategy().
+ *
+ * The pool counts the requests of every authorizer and keeps the usage
+ * reported by the Graph API in the X-App-Usage and X-Business-Use-Case-Usage
+ * headers of their responses. An authorizer whose token is throttled, or
+ * reaches a 100% usage, is quarantined until the time to regain access
+ * reported by the Graph API or during #GFBGraphAuthorizerPool:quarantine
+ * seconds, and its requests are retried with another one. An authorizer whose
+ * token is rejected is quarantined too, and refreshed if no other one is
+ * available.
+ **/
+
+#include "gfbgraph-authorizer-pool.h"
+#include "gfbgraph-common.h"
+#include "gfbgraph-private.h"
+#include "gfbgraph-simple-authorizer.h"
+
+#define DEFAULT_QUARANTINE 60
+
+typedef struct
+{
+  gint                ref_count;
+  GFBGraphAuthorizer *authorizer;
+  /* Processed calls without response yet, atomic */
+  gint                in_flight;
+
+  /* Protected by the mutex of the pool */
+  guint64             n_requests;
+  gdouble             usage;
+  gint64              quarantined_until;
+  gboolean            unauthorized;
+} Member;
+
+/* The member that authorized a call, until its response arrives */
+typedef struct
+{
+  Member   *member;
+  gboolean  pending;
+} CallData;
+
+typedef struct
+{
+  GFBGraphAuthorizerPoolStrategy strategy;
+  guint                          quarantine;
+
+  /* Protected by mutex */
+  GMutex                         mutex;
+  GPtrArray                     *members;
+  guint                          next;
+} GFBGraphAuthorizerPoolPrivate;
+
+static void gfbgraph_authorizer_pool_iface_init (GFBGraphAuthorizerInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GFBGraphAuthorizerPool, gfbgraph_authorizer_pool, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GFBGraphAuthorizerPool)
+                         G_IMPLEMENT_INTERFACE (GFBGRAPH_TYPE_AUTHORIZER, gfbgraph_authorizer_pool_iface_init))
+
+G_DEFINE_QUARK (gfbgraph-authorizer-pool-call-data, gfbgraph_authorizer_pool_call_data);
+
+enum
+{
+  PROP_0,
+  PROP_QUARANTINE,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE(_obj) gfbgraph_authorizer_pool_get_instance_private (GFBGRAPH_AUTHORIZER_POOL (_obj))
+
+static Member*
+member_new (GFBGraphAuthorizer *authorizer)
+{
+  Member *member;
+
+  member = g_slice_new0 (Member);
+  member->ref_count = 1;
+  member->authorizer = g_object_ref (authorizer);
+  member->usage = -1;
+
+  return member;
+}
+
+static Member*
+member_ref (Member *member)
+{
+  g_atomic_int_inc (&member->ref_count);
+
+  return member;
+}
+
+static void
+member_unref (Member *member)
+{
+  if (!g_atomic_int_dec_and_test (&member->ref_count))
+    return;
+
+  g_object_unref (member->authorizer);
+  g_slice_free (Member, member);
+}
+
+static void
+call_data_free (CallData *data)
+{
+  /* The call was processed again or dropped before its response */
+  if (data->pending)
+    g_atomic_int_add (&data->member->in_flight, -1);
+
+  member_unref (data->member);
+  g_slice_free (CallData, data);
+}
+
+/* Called with the mutex held */
+static Member*
+find_member (GFBGraphAuthorizerPoolPrivate *priv,
+             GFBGraphAuthorizer            *authorizer)
+{
+  guint i;
+
+  for (i = 0; i < priv->members->len; i++) {
+    Member *member = g_ptr_array_index (priv->members, i);
+
+    if (member->authorizer == authorizer)
+      return member;
+  }
+
+  return NULL;
+}
+
+/* The load of an available member for the least loaded strategy: a token
+ * near its limit counts up to twice as loaded */
+static gdouble
+member_get_load (Member *member)
+{
+  return (g_atomic_int_get (&member->in_flight) + 1) * (100.0 + CLAMP (member->usage, 0, 100));
+}
+
+/* Chooses the member to authorize a request. If all are quarantined, the one
+ * released first is used, the scheduler of the client holds the requests of a
+ * throttled token back. */
+static Member*
+select_member (GFBGraphAuthorizerPool *self)
+{
+  GFBGraphAuthorizerPoolPrivate *priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (self);
+  Member *selected = NULL;
+  gdouble selected_load = 0;
+  gint64 now;
+  guint i;
+
+  g_mutex_lock (&priv->mutex);
+
+  if (priv->members->len == 0) {
+    g_mutex_unlock (&priv->mutex);
+    return NULL;
+  }
+
+  now = g_get_monotonic_time ();
+
+  for (i = 0; i < priv->members->len; i++) {
+    guint index = (priv->next + i) % priv->members->len;
+    Member *member = g_ptr_array_index (priv->members, index);
+    gdouble load;
+
+    if (member->quarantined_until > now)
+      continue;
+
+    if (priv->strategy == GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN) {
+      selected = member;
+      priv->next = index + 1;
+      break;
+    }
+
+    load = member_get_load (member);
+    if (selected == NULL || load < selected_load) {
+      selected = member;
+      selected_load = load;
+    }
+  }
+
+  if (selected == NULL) {
+    for (i = 0; i < priv->members->len; i++) {
+      Member *member = g_ptr_array_index (priv->members, i);
+
+      if (selected == NULL || member->quarantined_until < selected->quarantined_until)
+        selected = member;
+    }
+  }
+
+  member_ref (selected);
+
+  g_mutex_unlock (&priv->mutex);
+
+  return selected;
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_authorizer_pool_finalize (GObject *object)
+{
+  GFBGraphAuthorizerPoolPrivate *priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (object);
+
+  g_ptr_array_unref (priv->members);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_authorizer_pool_parent_class)->finalize (object);
+}
+
+static void
+gfbgraph_authorizer_pool_set_property (GObject      *object,
+                                       guint         prop_id,
+                                       const GValue *value,
+                                       GParamSpec   *pspec)
+{
+  GFBGraphAuthorizerPoolPrivate *priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_QUARANTINE:
+      priv->quarantine = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_authorizer_pool_get_property (GObject    *object,
+                                       guint       prop_id,
+                                       GValue     *value,
+                                       GParamSpec *pspec)
+{
+  GFBGraphAuthorizerPoolPrivate *priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_QUARANTINE:
+      g_value_set_uint (value, priv->quarantine);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_authorizer_pool_init (GFBGraphAuthorizerPool *self)
+{
+  GFBGraphAuthorizerPoolPrivate *priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (self);
+
+  priv->strategy = GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN;
+  priv->quarantine = DEFAULT_QUARANTINE;
+  g_mutex_init (&priv->mutex);
+  priv->members = g_ptr_array_new_with_free_func ((GDestroyNotify) member_unref);
+}
+
+static void
+gfbgraph_authorizer_pool_class_init (GFBGraphAuthorizerPoolClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gfbgraph_authorizer_pool_finalize;
+  gobject_class->set_property = gfbgraph_authorizer_pool_set_property;
+  gobject_class->get_property = gfbgraph_authorizer_pool_get_property;
+
+  /**
+   * GFBGraphAuthorizerPool:quarantine:
+   *
+   * The seconds an authorizer isn't used after its token is throttled or
+   * rejected, when the Graph API doesn't tell when it regains access.
+   **/
+  properties [PROP_QUARANTINE] = g_param_spec_uint ("quarantine",
+                                                    "Quarantine",
+                                                    "The seconds a throttled or rejected authorizer isn't used.",
+                                                    0, G_MAXUINT, DEFAULT_QUARANTINE,
+                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+/* --- Internal methods --- */
+static void
+gfbgraph_authorizer_pool_process_call (GFBGraphAuthorizer *iface,
+                                       RestProxyCall      *call)
+{
+  Member *member;
+  CallData *data;
+
+  member = select_member (GFBGRAPH_AUTHORIZER_POOL (iface));
+  if (member == NULL)
+    return;
+
+  g_atomic_int_inc (&member->in_flight);
+
+  data = g_slice_new (CallData);
+  data->member = member;
+  data->pending = TRUE;
+  /* Replaces the member that processed the call before, if any */
+  g_object_set_qdata_full (G_OBJECT (call), gfbgraph_authorizer_pool_call_data_quark (),
+                           data, (GDestroyNotify) call_data_free);
+
+  gfbgraph_authorizer_process_call (member->authorizer, call);
+}
+
+static void
+gfbgraph_authorizer_pool_process_message (GFBGraphAuthorizer *iface,
+                                          SoupMessage        *message)
+{
+  Member *member;
+
+  member = select_member (GFBGRAPH_AUTHORIZER_POOL (iface));
+  if (member == NULL)
+    return;
+
+  gfbgraph_authorizer_process_message (member->authorizer, message);
+  member_unref (member);
+}
+
+static gboolean
+is_throttling_error (const GError *error)
+{
+  if (error == NULL || error->domain != GFBGRAPH_API_ERROR)
+    return FALSE;
+
+  switch (error->code)
+    {
+    case GFBGRAPH_API_ERROR_TOO_MANY_CALLS:
+    case GFBGRAPH_API_ERROR_USER_TOO_MANY_CALLS:
+    case GFBGRAPH_API_ERROR_PAGE_TOO_MANY_CALLS:
+    case GFBGRAPH_API_ERROR_RATE_LIMIT:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static void
+gfbgraph_authorizer_pool_process_response (GFBGraphAuthorizer *iface,
+                                           RestProxyCall      *call,
+                                           const GError       *error)
+{
+  GFBGraphAuthorizerPoolPrivate *priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (iface);
+  CallData *data;
+  Member *member;
+  gdouble app_usage;
+  gdouble token_usage;
+  gdouble usage;
+  gint64 regain_usec;
+  gint64 now;
+
+  data = g_object_get_qdata (G_OBJECT (call), gfbgraph_authorizer_pool_call_data_quark ());
+  if (data == NULL || !data->pending)
+    return;
+
+  member = data->member;
+  data->pending = FALSE;
+  g_atomic_int_add (&member->in_flight, -1);
+
+  gfbgraph_rest_call_get_usage (call, &app_usage, &token_usage, &regain_usec);
+  usage = MAX (app_usage, token_usage);
+  now = g_get_monotonic_time ();
+
+  g_mutex_lock (&priv->mutex);
+
+  member->n_requests++;
+  if (usage >= 0)
+    member->usage = usage;
+
+  if (g_error_matches (error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_OAUTH)) {
+    /* It's available again after the quarantine, the authorizer can refresh
+     * its token by itself meanwhile */
+    member->unauthorized = TRUE;
+    member->quarantined_until = MAX (member->quarantined_until, now + (gint64) priv->quarantine * G_USEC_PER_SEC);
+  } else if (is_throttling_error (error) || usage >= 100.0) {
+    if (regain_usec == 0)
+      regain_usec = (gint64) priv->quarantine * G_USEC_PER_SEC;
+    member->quarantined_until = MAX (member->quarantined_until, now + regain_usec);
+  } else if (error == NULL) {
+    member->unauthorized = FALSE;
+  }
+
+  g_mutex_unlock (&priv->mutex);
+}
+
+/* Returns %TRUE if there is an authorizer available. Otherwise the rejected
+ * ones are refreshed. */
+static gboolean
+gfbgraph_authorizer_pool_refresh_authorization (GFBGraphAuthorizer  *iface,
+                                                GCancellable        *cancellable,
+                                                GError             **error)
+{
+  GFBGraphAuthorizerPoolPrivate *priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (iface);
+  GPtrArray *unauthorized;
+  GError *refresh_error = NULL;
+  gboolean refreshed = FALSE;
+  gint64 now;
+  guint i;
+
+  unauthorized = g_ptr_array_new_with_free_func ((GDestroyNotify) member_unref);
+  now = g_get_monotonic_time ();
+
+  g_mutex_lock (&priv->mutex);
+  for (i = 0; i < priv->members->len; i++) {
+    Member *member = g_ptr_array_index (priv->members, i);
+
+    if (member->quarantined_until <= now)
+      refreshed = TRUE;
+    else if (member->unauthorized)
+      g_ptr_array_add (unauthorized, member_ref (member));
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  for (i = 0; i < unauthorized->len && !refreshed; i++) {
+    Member *member = g_ptr_array_index (unauthorized, i);
+
+    g_clear_error (&refresh_error);
+    if (!gfbgraph_authorizer_refresh_authorization (member->authorizer, cancellable, &refresh_error))
+      continue;
+
+    g_mutex_lock (&priv->mutex);
+    member->unauthorized = FALSE;
+    member->quarantined_until = 0;
+    g_mutex_unlock (&priv->mutex);
+    refreshed = TRUE;
+  }
+
+  g_ptr_array_unref (unauthorized);
+
+  if (refreshed) {
+    g_clear_error (&refresh_error);
+    return TRUE;
+  }
+
+  if (refresh_error != NULL)
+    g_propagate_error (error, refresh_error);
+  else
+    g_set_error_literal (error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_OAUTH,
+                         "None of the authorizers of the pool is available");
+
+  return FALSE;
+}
+
+/* The identity of the member that processed @call, as every member can be
+ * a different user */
+static gchar*
+gfbgraph_authorizer_pool_get_identity (GFBGraphAuthorizer *iface,
+                                       RestProxyCall      *call)
+{
+  CallData *data;
+
+  data = g_object_get_qdata (G_OBJECT (call), gfbgraph_authorizer_pool_call_data_quark ());
+  if (data == NULL)
+    return NULL;
+
+  return gfbgraph_authorizer_get_identity (data->member->authorizer, call);
+}
+
+static void
+gfbgraph_authorizer_pool_iface_init (GFBGraphAuthorizerInterface *iface)
+{
+  iface->process_call = gfbgraph_authorizer_pool_process_call;
+  iface->process_message = gfbgraph_authorizer_pool_process_message;
+  iface->refresh_authorization = gfbgraph_authorizer_pool_refresh_authorization;
+  iface->process_response = gfbgraph_authorizer_pool_process_response;
+  iface->get_identity = gfbgraph_authorizer_pool_get_identity;
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_authorizer_pool_new:
+ * @strategy: how the authorizer of every request is chosen.
+ *
+ * Creates a new #GFBGraphAuthorizerPool without authorizers, add them with
+ * gfbgraph_authorizer_pool_add() or gfbgraph_authorizer_pool_add_token().
+ *
+ * Returns: (transfer full): a new #GFBGraphAuthorizerPool.
+ **/
+GFBGraphAuthorizerPool*
+gfbgraph_authorizer_pool_new (GFBGraphAuthorizerPoolStrategy strategy)
+{
+  GFBGraphAuthorizerPool *pool;
+
+  pool = GFBGRAPH_AUTHORIZER_POOL (g_object_new (GFBGRAPH_TYPE_AUTHORIZER_POOL, NULL));
+  gfbgraph_authorizer_pool_set_strategy (pool, strategy);
+
+  return pool;
+}
+
+/**
+ * gfbgraph_authorizer_pool_get_strategy:
+ * @pool: a #GFBGraphAuthorizerPool.
+ *
+ * Returns: how @pool chooses the authorizer of every request.
+ **/
+GFBGraphAuthorizerPoolStrategy
+gfbgraph_authorizer_pool_get_strategy (GFBGraphAuthorizerPool *pool)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+  GFBGraphAuthorizerPoolStrategy strategy;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+
+  g_mutex_lock (&priv->mutex);
+  strategy = priv->strategy;
+  g_mutex_unlock (&priv->mutex);
+
+  return strategy;
+}
+
+/**
+ * gfbgraph_authorizer_pool_set_strategy:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @strategy: how the authorizer of every request is chosen.
+ *
+ * Sets how @pool chooses the authorizer of the next requests.
+ **/
+void
+gfbgraph_authorizer_pool_set_strategy (GFBGraphAuthorizerPool         *pool,
+                                       GFBGraphAuthorizerPoolStrategy  strategy)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool));
+  g_return_if_fail (strategy == GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN ||
+                    strategy == GFBGRAPH_AUTHORIZER_POOL_LEAST_LOADED);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+
+  g_mutex_lock (&priv->mutex);
+  priv->strategy = strategy;
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gfbgraph_authorizer_pool_get_quarantine:
+ * @pool: a #GFBGraphAuthorizerPool.
+ *
+ * Returns: the value of #GFBGraphAuthorizerPool:quarantine.
+ **/
+guint
+gfbgraph_authorizer_pool_get_quarantine (GFBGraphAuthorizerPool *pool)
+{
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), 0);
+
+  return GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool)->quarantine;
+}
+
+/**
+ * gfbgraph_authorizer_pool_set_quarantine:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @seconds: the seconds a throttled or rejected authorizer isn't used.
+ *
+ * Sets #GFBGraphAuthorizerPool:quarantine.
+ **/
+void
+gfbgraph_authorizer_pool_set_quarantine (GFBGraphAuthorizerPool *pool,
+                                         guint                   seconds)
+{
+  g_return_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool));
+
+  g_object_set (pool, "quarantine", seconds, NULL);
+}
+
+/**
+ * gfbgraph_authorizer_pool_add:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @authorizer: a #GFBGraphAuthorizer.
+ *
+ * Adds @authorizer to @pool, to authorize the next requests.
+ **/
+void
+gfbgraph_authorizer_pool_add (GFBGraphAuthorizerPool *pool,
+                              GFBGraphAuthorizer     *authorizer)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool));
+  g_return_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer));
+  g_return_if_fail ((gpointer) authorizer != (gpointer) pool);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+
+  g_mutex_lock (&priv->mutex);
+  if (find_member (priv, authorizer) == NULL)
+    g_ptr_array_add (priv->members, member_new (authorizer));
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gfbgraph_authorizer_pool_add_token:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @access_token: an access token.
+ *
+ * Adds a #GFBGraphSimpleAuthorizer with @access_token to @pool.
+ *
+ * Returns: (transfer none): the authorizer of @access_token, owned by @pool.
+ **/
+GFBGraphAuthorizer*
+gfbgraph_authorizer_pool_add_token (GFBGraphAuthorizerPool *pool,
+                                    const gchar            *access_token)
+{
+  GFBGraphSimpleAuthorizer *authorizer;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), NULL);
+  g_return_val_if_fail (access_token != NULL, NULL);
+
+  authorizer = gfbgraph_simple_authorizer_new (access_token);
+  gfbgraph_authorizer_pool_add (pool, GFBGRAPH_AUTHORIZER (authorizer));
+  g_object_unref (authorizer);
+
+  return GFBGRAPH_AUTHORIZER (authorizer);
+}
+
+/**
+ * gfbgraph_authorizer_pool_remove:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @authorizer: a #GFBGraphAuthorizer added to @pool.
+ *
+ * Removes @authorizer from @pool. The requests already authorized by it
+ * aren't affected.
+ *
+ * Returns: %TRUE if @authorizer was in @pool.
+ **/
+gboolean
+gfbgraph_authorizer_pool_remove (GFBGraphAuthorizerPool *pool,
+                                 GFBGraphAuthorizer     *authorizer)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+  Member *member;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), FALSE);
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), FALSE);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+
+  g_mutex_lock (&priv->mutex);
+  member = find_member (priv, authorizer);
+  if (member != NULL)
+    g_ptr_array_remove (priv->members, member);
+  g_mutex_unlock (&priv->mutex);
+
+  return member != NULL;
+}
+
+/**
+ * gfbgraph_authorizer_pool_get_n_available:
+ * @pool: a #GFBGraphAuthorizerPool.
+ *
+ * Returns: the number of authorizers of @pool that aren't quarantined.
+ **/
+guint
+gfbgraph_authorizer_pool_get_n_available (GFBGraphAuthorizerPool *pool)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+  guint n_available = 0;
+  gint64 now;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), 0);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+  now = g_get_monotonic_time ();
+
+  g_mutex_lock (&priv->mutex);
+  for (i = 0; i < priv->members->len; i++) {
+    Member *member = g_ptr_array_index (priv->members, i);
+
+    if (member->quarantined_until <= now)
+      n_available++;
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  return n_available;
+}
+
+/**
+ * gfbgraph_authorizer_pool_is_quarantined:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @authorizer: a #GFBGraphAuthorizer added to @pool.
+ *
+ * Returns: %TRUE if @authorizer isn't used for now because its token was
+ * throttled or rejected.
+ **/
+gboolean
+gfbgraph_authorizer_pool_is_quarantined (GFBGraphAuthorizerPool *pool,
+                                         GFBGraphAuthorizer     *authorizer)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+  Member *member;
+  gboolean quarantined = FALSE;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), FALSE);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+
+  g_mutex_lock (&priv->mutex);
+  member = find_member (priv, authorizer);
+  if (member != NULL)
+    quarantined = member->quarantined_until > g_get_monotonic_time ();
+  g_mutex_unlock (&priv->mutex);
+
+  return quarantined;
+}
+
+/**
+ * gfbgraph_authorizer_pool_get_n_requests:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @authorizer: a #GFBGraphAuthorizer added to @pool.
+ *
+ * Returns: the number of responses received to the requests authorized by
+ * @authorizer.
+ **/
+guint64
+gfbgraph_authorizer_pool_get_n_requests (GFBGraphAuthorizerPool *pool,
+                                         GFBGraphAuthorizer     *authorizer)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+  Member *member;
+  guint64 n_requests = 0;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), 0);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+
+  g_mutex_lock (&priv->mutex);
+  member = find_member (priv, authorizer);
+  if (member != NULL)
+    n_requests = member->n_requests;
+  g_mutex_unlock (&priv->mutex);
+
+  return n_requests;
+}
+
+/**
+ * gfbgraph_authorizer_pool_get_usage:
+ * @pool: a #GFBGraphAuthorizerPool.
+ * @authorizer: a #GFBGraphAuthorizer added to @pool.
+ *
+ * Gets the highest usage percentage reported by the Graph API in the last
+ * response to a request authorized by @authorizer.
+ *
+ * Returns: the usage percentage, or -1 if unknown.
+ **/
+gdouble
+gfbgraph_authorizer_pool_get_usage (GFBGraphAuthorizerPool *pool,
+                                    GFBGraphAuthorizer     *authorizer)
+{
+  GFBGraphAuthorizerPoolPrivate *priv;
+  Member *member;
+  gdouble usage = -1;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER_POOL (pool), -1);
+
+  priv = GFBGRAPH_AUTHORIZER_POOL_GET_PRIVATE (pool);
+
+  g_mutex_lock (&priv->mutex);
+  member = find_member (priv, authorizer);
+  if (member != NULL)
+    usage = member->usage;
+  g_mutex_unlock (&priv->mutex);
+
+  return usage;
+}
@@ -0,0 +1,83 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_AUTHORIZER_POOL_H__
+#define __GFBGRAPH_AUTHORIZER_POOL_H__
+
+#include <glib-object.h>
+#include <gfbgraph/gfbgraph-authorizer.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GFBGraphAuthorizerPoolStrategy:
+ * @GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN: The authorizers are used in turn.
+ * @GFBGRAPH_AUTHORIZER_POOL_LEAST_LOADED: The authorizer with less requests in
+ *  flight and usage reported by the Graph API is used.
+ *
+ * How a #GFBGraphAuthorizerPool chooses the authorizer of every request.
+ **/
+typedef enum
+{
+  GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN,
+  GFBGRAPH_AUTHORIZER_POOL_LEAST_LOADED
+} GFBGraphAuthorizerPoolStrategy;
+
+#define GFBGRAPH_TYPE_AUTHORIZER_POOL (gfbgraph_authorizer_pool_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphAuthorizerPool, gfbgraph_authorizer_pool, GFBGRAPH, AUTHORIZER_POOL, GObject)
+
+struct _GFBGraphAuthorizerPoolClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+GFBGraphAuthorizerPool*        gfbgraph_authorizer_pool_new             (GFBGraphAuthorizerPoolStrategy  strategy);
+
+GFBGraphAuthorizerPoolStrategy gfbgraph_authorizer_pool_get_strategy    (GFBGraphAuthorizerPool         *pool);
+void                           gfbgraph_authorizer_pool_set_strategy    (GFBGraphAuthorizerPool         *pool,
+                                                                         GFBGraphAuthorizerPoolStrategy  strategy);
+guint                          gfbgraph_authorizer_pool_get_quarantine  (GFBGraphAuthorizerPool         *pool);
+void                           gfbgraph_authorizer_pool_set_quarantine  (GFBGraphAuthorizerPool         *pool,
+                                                                         guint                           seconds);
+
+void                           gfbgraph_authorizer_pool_add             (GFBGraphAuthorizerPool         *pool,
+                                                                         GFBGraphAuthorizer             *authorizer);
+GFBGraphAuthorizer*            gfbgraph_authorizer_pool_add_token       (GFBGraphAuthorizerPool         *pool,
+                                                                         const gchar                    *access_token);
+gboolean                       gfbgraph_authorizer_pool_remove          (GFBGraphAuthorizerPool         *pool,
+                                                                         GFBGraphAuthorizer             *authorizer);
+guint                          gfbgraph_authorizer_pool_get_n_available (GFBGraphAuthorizerPool         *pool);
+
+gboolean                       gfbgraph_authorizer_pool_is_quarantined  (GFBGraphAuthorizerPool         *pool,
+                                                                         GFBGraphAuthorizer             *authorizer);
+guint64                        gfbgraph_authorizer_pool_get_n_requests  (GFBGraphAuthorizerPool         *pool,
+                                                                         GFBGraphAuthorizer             *authorizer);
+gdouble                        gfbgraph_authorizer_pool_get_usage       (GFBGraphAuthorizerPool         *pool,
+                                                                         GFBGraphAuthorizer             *authorizer);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_AUTHORIZER_POOL_H__ */
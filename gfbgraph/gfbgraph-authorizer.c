@@ -95,3 +95,59 @@ gfbgraph_authorizer_refresh_authorization (GFBGraphAuthorizer  *iface,
 
   return GFBGRAPH_AUTHORIZER_GET_IFACE (iface)->refresh_authorization (iface, cancellable, error);
 }
+
+/**
+ * gfbgraph_authorizer_process_response:
+ * @iface: A #GFBGraphAuthorizer.
+ * @call: A #RestProxyCall processed by @iface, after its response arrived.
+ * @error: (allow-none): The error of @call, or %NULL if it succeeded.
+ *
+ * Lets @iface know the result of @call, so it can track the usage of its
+ * tokens. Does nothing if @iface doesn't implement it.
+ *
+ * This method is thread safe.
+ */
+void
+gfbgraph_authorizer_process_response (GFBGraphAuthorizer *iface,
+                                      RestProxyCall      *call,
+                                      const GError       *error)
+{
+  GFBGraphAuthorizerInterface *authorizer_iface;
+
+  g_return_if_fail (GFBGRAPH_IS_AUTHORIZER (iface));
+  g_return_if_fail (REST_IS_PROXY_CALL (call));
+
+  authorizer_iface = GFBGRAPH_AUTHORIZER_GET_IFACE (iface);
+  if (authorizer_iface->process_response != NULL)
+    authorizer_iface->process_response (iface, call, error);
+}
+
+/**
+ * gfbgraph_authorizer_get_identity:
+ * @iface: A #GFBGraphAuthorizer.
+ * @call: A #RestProxyCall processed by @iface.
+ *
+ * Gets the user or app that @call is authorized as, like the ID of an
+ * account. Unlike the access token, it doesn't change when the token is
+ * refreshed, so the response cache uses it to tell the users apart.
+ *
+ * This method is thread safe.
+ *
+ * Returns: (transfer full) (nullable): the identity, or %NULL if @iface
+ * doesn't implement it. Free with g_free().
+ */
+gchar*
+gfbgraph_authorizer_get_identity (GFBGraphAuthorizer *iface,
+                                  RestProxyCall      *call)
+{
+  GFBGraphAuthorizerInterface *authorizer_iface;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (iface), NULL);
+  g_return_val_if_fail (REST_IS_PROXY_CALL (call), NULL);
+
+  authorizer_iface = GFBGRAPH_AUTHORIZER_GET_IFACE (iface);
+  if (authorizer_iface->get_identity == NULL)
+    return NULL;
+
+  return authorizer_iface->get_identity (iface, call);
+}
@@ -37,6 +37,10 @@ G_DECLARE_INTERFACE (GFBGraphAuthorizer, gfbgraph_authorizer, GFBGRAPH, AUTHORIZ
  * @process_message: A method to append authorization headers to a #SoupMessage.
  * @refresh_authorization: A synchronous method to force a refresh of any authorization
  *  tokes held by the authorizer. It should return %TRUE on succes.
+ * @process_response: An optional method to learn from the response to a #RestProxyCall
+ *  processed by the authorizer, like the usage reported by the Graph API.
+ * @get_identity: An optional method to get the user or app a #RestProxyCall processed
+ *  by the authorizer is authorized as, which doesn't change when its token is refreshed.
  *
  * Interface structure for #GFBGraphAuthorizer. All methos should be thread safe.
  **/
@@ -51,6 +55,11 @@ struct _GFBGraphAuthorizerInterface
   gboolean  (*refresh_authorization)  (GFBGraphAuthorizer  *iface,
                                        GCancellable        *cancellable,
                                        GError             **error);
+  void      (*process_response)       (GFBGraphAuthorizer *iface,
+                                       RestProxyCall      *call,
+                                       const GError       *error);
+  gchar*    (*get_identity)           (GFBGraphAuthorizer *iface,
+                                       RestProxyCall      *call);
 };
 
 void     gfbgraph_authorizer_process_call          (GFBGraphAuthorizer *iface,
@@ -60,6 +69,11 @@ void     gfbgraph_authorizer_process_message       (GFBGraphAuthorizer *iface,
 gboolean gfbgraph_authorizer_refresh_authorization (GFBGraphAuthorizer  *iface,
                                                     GCancellable        *cancellable,
                                                     GError             **error);
+void     gfbgraph_authorizer_process_response      (GFBGraphAuthorizer *iface,
+                                                    RestProxyCall      *call,
+                                                    const GError       *error);
+gchar*   gfbgraph_authorizer_get_identity          (GFBGraphAuthorizer *iface,
+                                                    RestProxyCall      *call);
 
 G_END_DECLS
 
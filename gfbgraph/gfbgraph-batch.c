@@ -0,0 +1,712 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-batch
+ * @short_description: Several Graph API requests in a single round trip
+ * @stability: Unstable
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphBatch queues node fetches, connection fetches and connection appends,
+ * and sends them using <ulink url="https://developers.facebook.com/docs/graph-api/making-multiple-requests">
+ * Graph API batch requests</ulink>, up to #GFBGRAPH_BATCH_MAX_REQUESTS per HTTP request.
+ *
+ * Every queued request gets an index, used after gfbgraph_batch_execute() to get its
+ * result. Each request succeeds or fails on its own, see gfbgraph_batch_check_request().
+ **/
+
+#include <json-glib/json-glib.h>
+#include <libsoup/soup.h>
+#include <string.h>
+
+#include "gfbgraph-batch.h"
+#include "gfbgraph-common.h"
+#include "gfbgraph-connectable.h"
+#include "gfbgraph-private.h"
+
+typedef enum
+{
+  GFBGRAPH_BATCH_REQUEST_NODE,
+  GFBGRAPH_BATCH_REQUEST_CONNECTION,
+  GFBGRAPH_BATCH_REQUEST_APPEND
+} GFBGraphBatchRequestKind;
+
+typedef struct
+{
+  GFBGraphBatchRequestKind  kind;
+  GType                     node_type;
+  gchar                    *relative_url;
+  gchar                    *body;
+
+  /* The connection to parse and the node to update for appends */
+  const GFBGraphConnection *connection;
+  GFBGraphNode             *connect_node;
+
+  gboolean                  done;
+  GFBGraphNode             *node;
+  GPtrArray                *nodes;
+  GError                   *error;
+} GFBGraphBatchRequest;
+
+typedef struct
+{
+  GFBGraphAuthorizer *authorizer;
+  GPtrArray          *requests;
+} GFBGraphBatchPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphBatch, gfbgraph_batch, G_TYPE_OBJECT)
+
+enum {
+  PROP_0,
+  PROP_AUTHORIZER,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_BATCH_GET_PRIVATE(_obj) gfbgraph_batch_get_instance_private (GFBGRAPH_BATCH (_obj))
+
+
+static void
+gfbgraph_batch_request_free (GFBGraphBatchRequest *request)
+{
+  g_free (request->relative_url);
+  g_free (request->body);
+  g_clear_object (&request->connect_node);
+  g_clear_object (&request->node);
+  g_clear_pointer (&request->nodes, g_ptr_array_unref);
+  g_clear_error (&request->error);
+
+  g_slice_free (GFBGraphBatchRequest, request);
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_batch_dispose (GObject *object)
+{
+  GFBGraphBatchPrivate *priv = GFBGRAPH_BATCH_GET_PRIVATE (object);
+
+  g_clear_object (&priv->authorizer);
+  g_clear_pointer (&priv->requests, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (gfbgraph_batch_parent_class)->dispose (object);
+}
+
+static void
+gfbgraph_batch_set_property (GObject      *object,
+                             guint         prop_id,
+                             const GValue *value,
+                             GParamSpec   *pspec)
+{
+  GFBGraphBatchPrivate *priv = GFBGRAPH_BATCH_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_AUTHORIZER:
+      priv->authorizer = g_value_dup_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_batch_get_property (GObject    *object,
+                             guint       prop_id,
+                             GValue     *value,
+                             GParamSpec *pspec)
+{
+  GFBGraphBatchPrivate *priv = GFBGRAPH_BATCH_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_AUTHORIZER:
+      g_value_set_object (value, priv->authorizer);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_batch_class_init (GFBGraphBatchClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->dispose = gfbgraph_batch_dispose;
+  gobject_class->set_property = gfbgraph_batch_set_property;
+  gobject_class->get_property = gfbgraph_batch_get_property;
+
+  /**
+   * GFBGraphBatch:authorizer:
+   *
+   * The #GFBGraphAuthorizer used to send the batch requests.
+   **/
+  properties [PROP_AUTHORIZER] =
+    g_param_spec_object ("authorizer",
+                         "The authorizer",
+                         "The authorizer used to send the batch requests",
+                         GFBGRAPH_TYPE_AUTHORIZER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+static void
+gfbgraph_batch_init (GFBGraphBatch *batch)
+{
+  GFBGraphBatchPrivate *priv = GFBGRAPH_BATCH_GET_PRIVATE (batch);
+
+  priv->requests = g_ptr_array_new_with_free_func ((GDestroyNotify) gfbgraph_batch_request_free);
+}
+
+/* --- Internal methods --- */
+static guint
+gfbgraph_batch_add_request (GFBGraphBatch            *batch,
+                            GFBGraphBatchRequestKind  kind,
+                            GType                     node_type)
+{
+  GFBGraphBatchPrivate *priv = GFBGRAPH_BATCH_GET_PRIVATE (batch);
+  GFBGraphBatchRequest *request;
+
+  request = g_slice_new0 (GFBGraphBatchRequest);
+  request->kind = kind;
+  request->node_type = node_type;
+  g_ptr_array_add (priv->requests, request);
+
+  return priv->requests->len - 1;
+}
+
+static GFBGraphBatchRequest*
+gfbgraph_batch_get_request (GFBGraphBatch *batch,
+                            guint          index)
+{
+  GFBGraphBatchPrivate *priv = GFBGRAPH_BATCH_GET_PRIVATE (batch);
+
+  return g_ptr_array_index (priv->requests, index);
+}
+
+/* Looks up the connection of nodes of type connected_type with a node of type
+ * node_type, setting the error of the request if they can't be connected */
+static const GFBGraphConnection*
+gfbgraph_batch_request_lookup_connection (GFBGraphBatchRequest *request,
+                                          GType                 connected_type,
+                                          GType                 node_type)
+{
+  request->connection = gfbgraph_connectable_lookup_connection (connected_type, node_type, &request->error);
+  if (request->connection == NULL)
+    request->done = TRUE;
+
+  return request->connection;
+}
+
+static gchar*
+gfbgraph_batch_build_json (GPtrArray *chunk)
+{
+  JsonBuilder *builder;
+  JsonGenerator *generator;
+  JsonNode *root;
+  gchar *json;
+  guint i;
+
+  builder = json_builder_new ();
+  json_builder_begin_array (builder);
+  for (i = 0; i < chunk->len; i++) {
+    GFBGraphBatchRequest *request = g_ptr_array_index (chunk, i);
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "method");
+    json_builder_add_string_value (builder, request->kind == GFBGRAPH_BATCH_REQUEST_APPEND ? "POST" : "GET");
+    json_builder_set_member_name (builder, "relative_url");
+    json_builder_add_string_value (builder, request->relative_url);
+    if (request->body != NULL) {
+      json_builder_set_member_name (builder, "body");
+      json_builder_add_string_value (builder, request->body);
+    }
+    json_builder_end_object (builder);
+  }
+  json_builder_end_array (builder);
+
+  root = json_builder_get_root (builder);
+  generator = json_generator_new ();
+  json_generator_set_root (generator, root);
+  json = json_generator_to_data (generator, NULL);
+
+  json_node_free (root);
+  g_object_unref (generator);
+  g_object_unref (builder);
+
+  return json;
+}
+
+static void
+gfbgraph_batch_request_parse_body (GFBGraphBatchRequest *request,
+                                   const gchar          *body)
+{
+  JsonParser *jparser;
+  JsonNode *root;
+
+  if (request->kind == GFBGRAPH_BATCH_REQUEST_CONNECTION) {
+    request->nodes = gfbgraph_connectable_parse_connection_page (request->connection, NULL, body, NULL, NULL, &request->error);
+    return;
+  }
+
+  jparser = json_parser_new ();
+  if (json_parser_load_from_data (jparser, body, -1, &request->error)) {
+    root = json_parser_get_root (jparser);
+
+    if (request->kind == GFBGRAPH_BATCH_REQUEST_NODE) {
+      request->node = gfbgraph_node_deserialize (request->node_type, root);
+      if (request->node == NULL)
+        g_set_error_literal (&request->error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_UNKNOWN,
+                             "Couldn't deserialize the node returned by the Graph API");
+    } else if (JSON_NODE_HOLDS_OBJECT (root) && json_object_has_member (json_node_get_object (root), "id")) {
+      gfbgraph_node_set_id (request->connect_node,
+                            json_object_get_string_member (json_node_get_object (root), "id"));
+    } else {
+      g_set_error_literal (&request->error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_UNKNOWN,
+                           "The Graph API didn't return the ID of the new node");
+    }
+  }
+
+  g_object_unref (jparser);
+}
+
+/* Gives each request of the chunk its part of the batch response */
+static void
+gfbgraph_batch_demultiplex (GPtrArray   *chunk,
+                            JsonArray   *responses)
+{
+  guint i;
+
+  for (i = 0; i < chunk->len; i++) {
+    GFBGraphBatchRequest *request = g_ptr_array_index (chunk, i);
+    JsonNode *response_jnode = NULL;
+    JsonObject *response;
+    const gchar *body = NULL;
+    gint64 code;
+
+    request->done = TRUE;
+
+    if (i < json_array_get_length (responses))
+      response_jnode = json_array_get_element (responses, i);
+
+    /* The Graph API returns null for the requests it couldn't complete in time */
+    if (response_jnode == NULL || !JSON_NODE_HOLDS_OBJECT (response_jnode)) {
+      g_set_error_literal (&request->error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_SERVICE,
+                           "The Graph API didn't complete the request");
+      continue;
+    }
+
+    response = json_node_get_object (response_jnode);
+    code = json_object_has_member (response, "code") ? json_object_get_int_member (response, "code") : 0;
+    if (json_object_has_member (response, "body"))
+      body = json_object_get_string_member (response, "body");
+
+    if (code >= 200 && code < 300 && body != NULL) {
+      gfbgraph_batch_request_parse_body (request, body);
+    } else if (!gfbgraph_api_error_from_payload (body, -1, &request->error)) {
+      g_set_error (&request->error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_UNKNOWN,
+                   "The Graph API request failed with HTTP status %" G_GINT64_FORMAT, code);
+    }
+  }
+}
+
+static gboolean
+gfbgraph_batch_execute_chunk (GFBGraphBatch  *batch,
+                              GPtrArray      *chunk,
+                              GError        **error)
+{
+  GFBGraphBatchPrivate *priv = GFBGRAPH_BATCH_GET_PRIVATE (batch);
+  RestProxyCall *rest_call;
+  gchar *batch_json;
+  gboolean success = FALSE;
+  gboolean idempotent = TRUE;
+  guint i;
+
+  batch_json = gfbgraph_batch_build_json (chunk);
+
+  rest_call = gfbgraph_new_rest_call (priv->authorizer);
+  rest_proxy_call_set_method (rest_call, "POST");
+  rest_proxy_call_add_param (rest_call, "batch", batch_json);
+  rest_proxy_call_add_param (rest_call, "include_headers", "false");
+  g_free (batch_json);
+
+  /* Sent with POST, but a batch without appends is retried like a GET */
+  for (i = 0; i < chunk->len && idempotent; i++)
+    idempotent = ((GFBGraphBatchRequest *) g_ptr_array_index (chunk, i))->kind != GFBGRAPH_BATCH_REQUEST_APPEND;
+  if (idempotent)
+    gfbgraph_rest_call_set_idempotent (rest_call);
+
+  if (gfbgraph_rest_call_invoke (rest_call, NULL, error)) {
+    JsonParser *jparser;
+    JsonNode *root;
+    const gchar *payload;
+    gint64 timer;
+
+    timer = gfbgraph_rest_call_start_timer (rest_call);
+
+    payload = gfbgraph_rest_call_get_payload (rest_call);
+    jparser = json_parser_new ();
+    if (json_parser_load_from_data (jparser, payload, -1, error)) {
+      root = json_parser_get_root (jparser);
+      gfbgraph_rest_call_stop_parse_timer (rest_call, &timer);
+      if (JSON_NODE_HOLDS_ARRAY (root)) {
+        /* The bodies of the requests are parsed and deserialized here */
+        gfbgraph_batch_demultiplex (chunk, json_node_get_array (root));
+        gfbgraph_rest_call_stop_deserialize_timer (rest_call, &timer);
+        success = TRUE;
+      } else if (!gfbgraph_api_error_from_json (root, error)) {
+        g_set_error_literal (error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_UNKNOWN,
+                             "Unexpected response to a batch request");
+      }
+    }
+    g_object_unref (jparser);
+  }
+
+  g_object_unref (rest_call);
+
+  return success;
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_batch_new:
+ * @authorizer: a #GFBGraphAuthorizer.
+ *
+ * Creates a new empty #GFBGraphBatch.
+ *
+ * Returns: (transfer full): a new #GFBGraphBatch; unref with g_object_unref()
+ **/
+GFBGraphBatch*
+gfbgraph_batch_new (GFBGraphAuthorizer *authorizer)
+{
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
+
+  return GFBGRAPH_BATCH (g_object_new (GFBGRAPH_TYPE_BATCH,
+                                       "authorizer", authorizer,
+                                       NULL));
+}
+
+/**
+ * gfbgraph_batch_add_node:
+ * @batch: a #GFBGraphBatch.
+ * @id: a const #gchar with the node ID.
+ * @node_type: a #GFBGraphNode type #GType.
+ *
+ * Queues the retrieval of the node with the given @id, like gfbgraph_node_new_from_id().
+ * The node can be taken with gfbgraph_batch_get_node() after the execution.
+ *
+ * Returns: the index of the request in @batch.
+ **/
+guint
+gfbgraph_batch_add_node (GFBGraphBatch *batch,
+                         const gchar   *id,
+                         GType          node_type)
+{
+  GFBGraphBatchRequest *request;
+  guint index;
+
+  g_return_val_if_fail (GFBGRAPH_IS_BATCH (batch), G_MAXUINT);
+  g_return_val_if_fail (id != NULL && strlen (id) > 0, G_MAXUINT);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), G_MAXUINT);
+
+  index = gfbgraph_batch_add_request (batch, GFBGRAPH_BATCH_REQUEST_NODE, node_type);
+  request = gfbgraph_batch_get_request (batch, index);
+  request->relative_url = g_strdup (id);
+
+  return index;
+}
+
+/**
+ * gfbgraph_batch_add_connection:
+ * @batch: a #GFBGraphBatch.
+ * @node: a #GFBGraphNode object which retrieve the connected nodes.
+ * @node_type: a #GFBGraphNode type #GType that determines the kind of nodes to retrieve.
+ *
+ * Queues the retrieval of the nodes of type @node_type connected to @node, like
+ * gfbgraph_node_get_connection_nodes(). The nodes can be taken with
+ * gfbgraph_batch_get_connection_nodes() after the execution.
+ *
+ * Returns: the index of the request in @batch.
+ **/
+guint
+gfbgraph_batch_add_connection (GFBGraphBatch *batch,
+                               GFBGraphNode  *node,
+                               GType          node_type)
+{
+  GFBGraphBatchRequest *request;
+  guint index;
+
+  g_return_val_if_fail (GFBGRAPH_IS_BATCH (batch), G_MAXUINT);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), G_MAXUINT);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), G_MAXUINT);
+
+  index = gfbgraph_batch_add_request (batch, GFBGRAPH_BATCH_REQUEST_CONNECTION, node_type);
+  request = gfbgraph_batch_get_request (batch, index);
+
+  if (gfbgraph_batch_request_lookup_connection (request, node_type, G_OBJECT_TYPE (node)) != NULL)
+    request->relative_url = g_strdup_printf ("%s/%s", gfbgraph_node_get_id (node), request->connection->path);
+
+  return index;
+}
+
+/**
+ * gfbgraph_batch_add_append_connection:
+ * @batch: a #GFBGraphBatch.
+ * @node: a #GFBGraphNode.
+ * @connect_node: a #GFBGraphNode.
+ *
+ * Queues the append of @connect_node to @node, like gfbgraph_node_append_connection().
+ * After the execution, the ID of @connect_node is set with the one of the new node.
+ *
+ * Returns: the index of the request in @batch.
+ **/
+guint
+gfbgraph_batch_add_append_connection (GFBGraphBatch *batch,
+                                      GFBGraphNode  *node,
+                                      GFBGraphNode  *connect_node)
+{
+  GFBGraphBatchRequest *request;
+  GHashTable *params;
+  GHashTable *form;
+  GHashTableIter iter;
+  const gchar *key;
+  const gchar *value;
+  guint index;
+
+  g_return_val_if_fail (GFBGRAPH_IS_BATCH (batch), G_MAXUINT);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), G_MAXUINT);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (connect_node), G_MAXUINT);
+
+  index = gfbgraph_batch_add_request (batch, GFBGRAPH_BATCH_REQUEST_APPEND, G_OBJECT_TYPE (connect_node));
+  request = gfbgraph_batch_get_request (batch, index);
+
+  if (gfbgraph_batch_request_lookup_connection (request, G_OBJECT_TYPE (connect_node), G_OBJECT_TYPE (node)) == NULL)
+    return index;
+
+  request->connect_node = g_object_ref (connect_node);
+  request->relative_url = g_strdup_printf ("%s/%s", gfbgraph_node_get_id (node), request->connection->path);
+
+  /* The body of a batched POST is the url-encoded form of its params */
+  params = gfbgraph_connectable_get_connection_post_params (GFBGRAPH_CONNECTABLE (connect_node), G_OBJECT_TYPE (node));
+  form = g_hash_table_new (g_str_hash, g_str_equal);
+  g_hash_table_iter_init (&iter, params);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value)) {
+    if (value != NULL)
+      g_hash_table_insert (form, (gpointer) key, (gpointer) value);
+  }
+  request->body = soup_form_encode_hash (form);
+
+  g_hash_table_unref (form);
+  g_hash_table_unref (params);
+
+  return index;
+}
+
+/**
+ * gfbgraph_batch_get_n_requests:
+ * @batch: a #GFBGraphBatch.
+ *
+ * Returns: the number of requests queued in @batch.
+ **/
+guint
+gfbgraph_batch_get_n_requests (GFBGraphBatch *batch)
+{
+  GFBGraphBatchPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_BATCH (batch), 0);
+
+  priv = GFBGRAPH_BATCH_GET_PRIVATE (batch);
+
+  return priv->requests->len;
+}
+
+/**
+ * gfbgraph_batch_execute:
+ * @batch: a #GFBGraphBatch.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Sends the requests of @batch not executed yet, in groups of up to
+ * #GFBGRAPH_BATCH_MAX_REQUESTS requests per HTTP request.
+ *
+ * The result of this function only tells if the batch requests could be sent. Each
+ * request can fail on its own, use gfbgraph_batch_check_request() to know it.
+ *
+ * Returns: %TRUE if all the batch requests were sent, %FALSE otherwise. The requests
+ * of a failed batch request get @error as its own error.
+ **/
+gboolean
+gfbgraph_batch_execute (GFBGraphBatch  *batch,
+                        GCancellable   *cancellable,
+                        GError        **error)
+{
+  GFBGraphBatchPrivate *priv;
+  GPtrArray *chunk;
+  gboolean success = TRUE;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_BATCH (batch), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  priv = GFBGRAPH_BATCH_GET_PRIVATE (batch);
+
+  chunk = g_ptr_array_sized_new (GFBGRAPH_BATCH_MAX_REQUESTS);
+  for (i = 0; i <= priv->requests->len && success; i++) {
+    GError *chunk_error = NULL;
+    guint j;
+
+    if (i < priv->requests->len) {
+      GFBGraphBatchRequest *request = g_ptr_array_index (priv->requests, i);
+
+      if (!request->done)
+        g_ptr_array_add (chunk, request);
+
+      if (chunk->len < GFBGRAPH_BATCH_MAX_REQUESTS)
+        continue;
+    }
+
+    if (chunk->len == 0)
+      continue;
+
+    if (g_cancellable_set_error_if_cancelled (cancellable, &chunk_error) ||
+        !gfbgraph_batch_execute_chunk (batch, chunk, &chunk_error)) {
+      for (j = 0; j < chunk->len; j++) {
+        GFBGraphBatchRequest *request = g_ptr_array_index (chunk, j);
+
+        request->done = TRUE;
+        request->error = g_error_copy (chunk_error);
+      }
+      g_propagate_error (error, chunk_error);
+      success = FALSE;
+    }
+
+    g_ptr_array_set_size (chunk, 0);
+  }
+
+  g_ptr_array_unref (chunk);
+
+  return success;
+}
+
+/**
+ * gfbgraph_batch_check_request:
+ * @batch: a #GFBGraphBatch.
+ * @index: the index of a request in @batch.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Checks if the request at @index has been executed successfully.
+ *
+ * Returns: %TRUE if the request succeeded, %FALSE otherwise.
+ **/
+gboolean
+gfbgraph_batch_check_request (GFBGraphBatch  *batch,
+                              guint           index,
+                              GError        **error)
+{
+  GFBGraphBatchPrivate *priv;
+  GFBGraphBatchRequest *request;
+
+  g_return_val_if_fail (GFBGRAPH_IS_BATCH (batch), FALSE);
+
+  priv = GFBGRAPH_BATCH_GET_PRIVATE (batch);
+  g_return_val_if_fail (index < priv->requests->len, FALSE);
+
+  request = gfbgraph_batch_get_request (batch, index);
+  if (request->error != NULL) {
+    g_propagate_error (error, g_error_copy (request->error));
+    return FALSE;
+  }
+
+  if (!request->done) {
+    g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PENDING,
+                         "The request has not been executed yet");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gfbgraph_batch_get_node:
+ * @batch: a #GFBGraphBatch.
+ * @index: the index of a request added with gfbgraph_batch_add_node().
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Gets the node retrieved by the request at @index.
+ *
+ * Returns: (transfer full): a #GFBGraphNode or %NULL if the request failed.
+ **/
+GFBGraphNode*
+gfbgraph_batch_get_node (GFBGraphBatch  *batch,
+                         guint           index,
+                         GError        **error)
+{
+  GFBGraphBatchRequest *request;
+
+  if (!gfbgraph_batch_check_request (batch, index, error))
+    return NULL;
+
+  request = gfbgraph_batch_get_request (batch, index);
+  g_return_val_if_fail (request->kind == GFBGRAPH_BATCH_REQUEST_NODE, NULL);
+
+  if (request->node == NULL) {
+    g_set_error_literal (error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_UNKNOWN,
+                         "The request didn't return a node");
+    return NULL;
+  }
+
+  return g_object_ref (request->node);
+}
+
+/**
+ * gfbgraph_batch_get_connection_nodes:
+ * @batch: a #GFBGraphBatch.
+ * @index: the index of a request added with gfbgraph_batch_add_connection().
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Gets the connected nodes retrieved by the request at @index.
+ *
+ * Returns: (element-type GFBGraphNode) (transfer full): a newly-allocated #GList with the
+ * found nodes or %NULL.
+ **/
+GList*
+gfbgraph_batch_get_connection_nodes (GFBGraphBatch  *batch,
+                                     guint           index,
+                                     GError        **error)
+{
+  GFBGraphBatchRequest *request;
+  GList *nodes_list = NULL;
+  guint i;
+
+  if (!gfbgraph_batch_check_request (batch, index, error))
+    return NULL;
+
+  request = gfbgraph_batch_get_request (batch, index);
+  g_return_val_if_fail (request->kind == GFBGRAPH_BATCH_REQUEST_CONNECTION, NULL);
+
+  for (i = request->nodes->len; i > 0; i--)
+    nodes_list = g_list_prepend (nodes_list, g_object_ref (g_ptr_array_index (request->nodes, i - 1)));
+
+  return nodes_list;
+}
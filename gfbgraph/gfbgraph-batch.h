@@ -0,0 +1,81 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_BATCH_H__
+#define __GFBGRAPH_BATCH_H__
+
+#include <gio/gio.h>
+#include <gfbgraph/gfbgraph-authorizer.h>
+#include <gfbgraph/gfbgraph-node.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GFBGRAPH_BATCH_MAX_REQUESTS:
+ *
+ * The maximum number of requests sent in a single Graph API batch request.
+ **/
+#define GFBGRAPH_BATCH_MAX_REQUESTS 50
+
+#define GFBGRAPH_TYPE_BATCH (gfbgraph_batch_get_type())
+
+G_DECLARE_DERIVABLE_TYPE (GFBGraphBatch, gfbgraph_batch, GFBGRAPH, BATCH, GObject)
+
+struct _GFBGraphBatchClass
+{
+  GObjectClass parent_class;
+
+  gpointer  _reserved1;
+  gpointer  _reserved2;
+  gpointer  _reserved3;
+  gpointer  _reserved4;
+  gpointer  _reserved5;
+  gpointer  _reserved6;
+};
+
+GFBGraphBatch* gfbgraph_batch_new                   (GFBGraphAuthorizer *authorizer);
+
+guint          gfbgraph_batch_add_node              (GFBGraphBatch *batch,
+                                                     const gchar   *id,
+                                                     GType          node_type);
+guint          gfbgraph_batch_add_connection        (GFBGraphBatch *batch,
+                                                     GFBGraphNode  *node,
+                                                     GType          node_type);
+guint          gfbgraph_batch_add_append_connection (GFBGraphBatch *batch,
+                                                     GFBGraphNode  *node,
+                                                     GFBGraphNode  *connect_node);
+guint          gfbgraph_batch_get_n_requests        (GFBGraphBatch *batch);
+
+gboolean       gfbgraph_batch_execute               (GFBGraphBatch  *batch,
+                                                     GCancellable   *cancellable,
+                                                     GError        **error);
+
+gboolean       gfbgraph_batch_check_request         (GFBGraphBatch  *batch,
+                                                     guint           index,
+                                                     GError        **error);
+GFBGraphNode*  gfbgraph_batch_get_node              (GFBGraphBatch  *batch,
+                                                     guint           index,
+                                                     GError        **error);
+GList*         gfbgraph_batch_get_connection_nodes  (GFBGraphBatch  *batch,
+                                                     guint           index,
+                                                     GError        **error);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_BATCH_H__ */
@@ -0,0 +1,142 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-cache
+ * @title: GFBGraphCache
+ * @short_description: Graph API response cache interface.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphCache is the storage of the Graph API responses cached by a
+ * #GFBGraphClient, set with gfbgraph_client_set_cache(). The client keys the
+ * responses by the path and params of the request and the user it's made for,
+ * from gfbgraph_authorizer_get_identity() or else the access token used, and
+ * decides when they expire with gfbgraph_client_set_cache_ttl().
+ *
+ * Expired responses with an ETag aren't discarded: the request is sent with
+ * If-None-Match, and the cached payload is used again when the Graph API
+ * answers that it's not modified.
+ *
+ * #GFBGraphMemoryCache and #GFBGraphDiskCache are the implementations provided
+ * by the library.
+ **/
+
+#include "gfbgraph-cache.h"
+
+G_DEFINE_INTERFACE (GFBGraphCache, gfbgraph_cache, G_TYPE_OBJECT);
+
+static void
+gfbgraph_cache_default_init (GFBGraphCacheInterface *iface)
+{
+}
+
+/**
+ * gfbgraph_cache_lookup:
+ * @cache: A #GFBGraphCache.
+ * @key: The key of the response.
+ * @payload: (out) (transfer full): return location for the payload of the response.
+ * @etag: (out) (transfer full) (allow-none): return location for the ETag of the response, or %NULL.
+ * @expiration: (out) (allow-none): return location for the time when the response expires, as
+ *  returned by g_get_real_time(), or %NULL.
+ *
+ * Looks for the response stored with @key, expired or not.
+ *
+ * Returns: %TRUE if the response was found.
+ */
+gboolean
+gfbgraph_cache_lookup (GFBGraphCache  *cache,
+                       const gchar    *key,
+                       GBytes        **payload,
+                       gchar         **etag,
+                       gint64         *expiration)
+{
+  gchar *local_etag = NULL;
+  gint64 local_expiration = 0;
+  gboolean found;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CACHE (cache), FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+  g_return_val_if_fail (payload != NULL, FALSE);
+
+  found = GFBGRAPH_CACHE_GET_IFACE (cache)->lookup (cache, key, payload, &local_etag, &local_expiration);
+
+  if (etag != NULL)
+    *etag = local_etag;
+  else
+    g_free (local_etag);
+  if (expiration != NULL)
+    *expiration = local_expiration;
+
+  return found;
+}
+
+/**
+ * gfbgraph_cache_store:
+ * @cache: A #GFBGraphCache.
+ * @key: The key of the response.
+ * @payload: The payload of the response.
+ * @etag: (allow-none): The ETag of the response, or %NULL.
+ * @expiration: The time when the response expires, as returned by g_get_real_time().
+ *
+ * Adds the response, or replaces the one already stored with @key.
+ */
+void
+gfbgraph_cache_store (GFBGraphCache *cache,
+                      const gchar   *key,
+                      GBytes        *payload,
+                      const gchar   *etag,
+                      gint64         expiration)
+{
+  g_return_if_fail (GFBGRAPH_IS_CACHE (cache));
+  g_return_if_fail (key != NULL);
+  g_return_if_fail (payload != NULL);
+
+  GFBGRAPH_CACHE_GET_IFACE (cache)->store (cache, key, payload, etag, expiration);
+}
+
+/**
+ * gfbgraph_cache_remove:
+ * @cache: A #GFBGraphCache.
+ * @key: The key of the response.
+ *
+ * Removes the response stored with @key, if any.
+ */
+void
+gfbgraph_cache_remove (GFBGraphCache *cache,
+                       const gchar   *key)
+{
+  g_return_if_fail (GFBGRAPH_IS_CACHE (cache));
+  g_return_if_fail (key != NULL);
+
+  GFBGRAPH_CACHE_GET_IFACE (cache)->remove (cache, key);
+}
+
+/**
+ * gfbgraph_cache_clear:
+ * @cache: A #GFBGraphCache.
+ *
+ * Removes all the responses of @cache.
+ */
+void
+gfbgraph_cache_clear (GFBGraphCache *cache)
+{
+  g_return_if_fail (GFBGRAPH_IS_CACHE (cache));
+
+  GFBGRAPH_CACHE_GET_IFACE (cache)->clear (cache);
+}
@@ -0,0 +1,75 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_CACHE_H__
+#define __GFBGRAPH_CACHE_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_CACHE (gfbgraph_cache_get_type ())
+G_DECLARE_INTERFACE (GFBGraphCache, gfbgraph_cache, GFBGRAPH, CACHE, GObject)
+
+/**
+ * GFBGraphCacheInterface:
+ * @parent: The parent interface.
+ * @lookup: A method to get the payload, ETag and expiration time of a cached response.
+ * @store: A method to add or replace a response.
+ * @remove: A method to remove a response.
+ * @clear: A method to remove all the responses.
+ *
+ * Interface structure for #GFBGraphCache. All methods should be thread safe.
+ **/
+struct _GFBGraphCacheInterface
+{
+  GTypeInterface parent;
+
+  gboolean  (*lookup)  (GFBGraphCache  *cache,
+                        const gchar    *key,
+                        GBytes        **payload,
+                        gchar         **etag,
+                        gint64         *expiration);
+  void      (*store)   (GFBGraphCache  *cache,
+                        const gchar    *key,
+                        GBytes         *payload,
+                        const gchar    *etag,
+                        gint64          expiration);
+  void      (*remove)  (GFBGraphCache  *cache,
+                        const gchar    *key);
+  void      (*clear)   (GFBGraphCache  *cache);
+};
+
+gboolean gfbgraph_cache_lookup (GFBGraphCache  *cache,
+                                const gchar    *key,
+                                GBytes        **payload,
+                                gchar         **etag,
+                                gint64         *expiration);
+void     gfbgraph_cache_store  (GFBGraphCache  *cache,
+                                const gchar    *key,
+                                GBytes         *payload,
+                                const gchar    *etag,
+                                gint64          expiration);
+void     gfbgraph_cache_remove (GFBGraphCache  *cache,
+                                const gchar    *key);
+void     gfbgraph_cache_clear  (GFBGraphCache  *cache);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_CACHE_H__ */
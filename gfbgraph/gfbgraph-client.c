@@ -0,0 +1,1408 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-client
+ * @short_description: GFBGraph connection to the Graph API
+ * @stability: Unstable
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphClient owns the long-lived HTTP state used to talk with the Facebook
+ * Graph API: a #RestProxy pointing to the Graph API endpoint and a #SoupSession
+ * used to download media. Reusing them across requests allows the underlying
+ * connections to be kept alive instead of doing a new TCP and TLS handshake for
+ * every node fetched.
+ *
+ * The client also schedules the Graph API requests sent through it: at most
+ * #GFBGraphClient:max-requests-in-flight requests are sent at the same time,
+ * and every access token is limited to #GFBGraphClient:requests-per-second.
+ * Both limits are disabled by default, applications opt in by setting them
+ * on the client they make the default one. The rate of a token is lowered as the usage reported by the Graph API in the
+ * X-App-Usage and X-Business-Use-Case-Usage response headers grows, and the
+ * requests are held back while it's throttled, instead of making the
+ * throttling last longer.
+ *
+ * Failed requests are retried by the client when the error is transient, like
+ * a 5xx HTTP status or a throttling error, up to #GFBGraphClient:max-retries
+ * times with a jittered exponential backoff and within
+ * #GFBGraphClient:request-timeout. A 5xx HTTP status is only retried for
+ * requests without side effects, GET requests and the batches of them. When
+ * the access token of a request has expired, the authorizer of the request is
+ * refreshed with gfbgraph_authorizer_refresh_authorization() and the request
+ * is sent again once with the new token.
+ *
+ * All the node functions of the library use the client returned by
+ * gfbgraph_client_get_default().
+ *
+ * A #GFBGraphCache set with gfbgraph_client_set_cache() keeps the responses
+ * of the GET requests. They are reused without a request for the time set
+ * with gfbgraph_client_set_cache_ttl() for their node type, and afterwards
+ * revalidated with the ETag sent by the Graph API, so an unchanged node
+ * doesn't need to be downloaded again.
+ *
+ * A #GFBGraphPhotoCache set with gfbgraph_client_set_photo_cache() keeps the
+ * photos downloaded with gfbgraph_photo_download_default_size() and
+ * #GFBGraphPhotoDownloader.
+ *
+ * A #GFBGraphMetrics set with gfbgraph_client_set_metrics() records the
+ * requests sent through the client, and the #GFBGraphClient::request-started
+ * and #GFBGraphClient::request-finished signals are emitted for every one of
+ * them. Without metrics the requests aren't instrumented at all.
+ *
+ * A #GFBGraphTracer set with gfbgraph_client_set_tracer() records a span for
+ * every stage of the requests, from the wait for the scheduler to the
+ * deserialization of the nodes.
+ *
+ * The GFBGRAPH_ENDPOINT environment variable overrides the default endpoint of
+ * the clients created with gfbgraph_client_new(), including the default one.
+ * It's used to run the tests against a local mock of the Graph API.
+ **/
+
+#include "gfbgraph-cache.h"
+#include "gfbgraph-client.h"
+#include "gfbgraph-metrics.h"
+#include "gfbgraph-tracer.h"
+#include "gfbgraph-node.h"
+#include "gfbgraph-photo-cache.h"
+#include "gfbgraph-private.h"
+
+#define FACEBOOK_ENDPOINT       "https://graph.facebook.com"
+#define DEFAULT_MAX_CONNECTIONS 8
+#define DEFAULT_MAX_REQUESTS_IN_FLIGHT  0
+#define DEFAULT_REQUESTS_PER_SECOND     0.0
+#define DEFAULT_MAX_RETRIES             3
+#define DEFAULT_REQUEST_TIMEOUT         300
+
+typedef struct
+{
+  gchar       *endpoint;
+  guint        max_connections;
+  guint        max_requests_in_flight;
+  gdouble      requests_per_second;
+  guint        max_retries;
+  guint        request_timeout;
+
+  RestProxy   *proxy;
+  SoupSession *session;
+  GFBGraphScheduler *scheduler;
+
+  /* Protects the caches, the TTLs, the metrics and the tracer, that can change
+   * at any time. The metrics and the tracer are also written atomically, so
+   * the calls can check for them without the mutex */
+  GMutex              mutex;
+  GFBGraphCache      *cache;
+  GHashTable         *cache_ttls;
+  GFBGraphPhotoCache *photo_cache;
+  GFBGraphMetrics    *metrics;
+  GFBGraphTracer     *tracer;
+} GFBGraphClientPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphClient, gfbgraph_client, G_TYPE_OBJECT)
+
+enum {
+  PROP_0,
+  PROP_ENDPOINT,
+  PROP_MAX_CONNECTIONS,
+  PROP_MAX_REQUESTS_IN_FLIGHT,
+  PROP_REQUESTS_PER_SECOND,
+  PROP_MAX_RETRIES,
+  PROP_REQUEST_TIMEOUT,
+  PROP_CACHE,
+  PROP_PHOTO_CACHE,
+  PROP_METRICS,
+  PROP_TRACER,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+enum
+{
+  SIGNAL_REQUEST_STARTED,
+  SIGNAL_REQUEST_FINISHED,
+  N_SIGNALS
+};
+
+static guint signals [N_SIGNALS];
+
+#define GFBGRAPH_CLIENT_GET_PRIVATE(_obj) gfbgraph_client_get_instance_private (GFBGRAPH_CLIENT (_obj))
+
+/* Only written with the lock held, and never changes once set, so it's read
+ * without the lock */
+static GFBGraphClient *default_client = NULL;
+G_LOCK_DEFINE_STATIC (default_client);
+
+static GQuark client_quark;
+static GQuark authorizer_quark;
+static GQuark node_type_quark;
+static GQuark idempotent_quark;
+static GQuark metrics_quark;
+static GQuark trace_quark;
+
+/* The tracer of a call and the ID of its spans */
+typedef struct
+{
+  GFBGraphTracer *tracer;
+  guint           request_id;
+} TraceData;
+
+static void
+trace_data_free (TraceData *data)
+{
+  g_object_unref (data->tracer);
+  g_slice_free (TraceData, data);
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_client_constructed (GObject *object)
+{
+  GFBGraphClientPrivate *priv = GFBGRAPH_CLIENT_GET_PRIVATE (object);
+
+  G_OBJECT_CLASS (gfbgraph_client_parent_class)->constructed (object);
+
+  priv->proxy = rest_proxy_new (priv->endpoint, FALSE);
+  priv->session = soup_session_new_with_options (SOUP_SESSION_MAX_CONNS, priv->max_connections,
+                                                 SOUP_SESSION_MAX_CONNS_PER_HOST, priv->max_connections,
+                                                 NULL);
+  priv->scheduler = gfbgraph_scheduler_new (priv->max_requests_in_flight, priv->requests_per_second);
+}
+
+static void
+gfbgraph_client_dispose (GObject *object)
+{
+  GFBGraphClientPrivate *priv = GFBGRAPH_CLIENT_GET_PRIVATE (object);
+
+  g_clear_object (&priv->proxy);
+  g_clear_object (&priv->session);
+  g_clear_object (&priv->cache);
+  g_clear_object (&priv->photo_cache);
+  g_clear_object (&priv->metrics);
+  g_clear_object (&priv->tracer);
+
+  G_OBJECT_CLASS (gfbgraph_client_parent_class)->dispose (object);
+}
+
+static void
+gfbgraph_client_finalize (GObject *object)
+{
+  GFBGraphClientPrivate *priv = GFBGRAPH_CLIENT_GET_PRIVATE (object);
+
+  g_free (priv->endpoint);
+  gfbgraph_scheduler_free (priv->scheduler);
+  g_hash_table_unref (priv->cache_ttls);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_client_parent_class)->finalize (object);
+}
+
+static void
+gfbgraph_client_set_property (GObject      *object,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  GFBGraphClientPrivate *priv = GFBGRAPH_CLIENT_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_ENDPOINT:
+      g_free (priv->endpoint);
+      priv->endpoint = g_value_dup_string (value);
+      if (priv->endpoint == NULL)
+        priv->endpoint = g_strdup (FACEBOOK_ENDPOINT);
+      break;
+
+    case PROP_MAX_CONNECTIONS:
+      priv->max_connections = g_value_get_uint (value);
+      break;
+
+    case PROP_MAX_REQUESTS_IN_FLIGHT:
+      priv->max_requests_in_flight = g_value_get_uint (value);
+      break;
+
+    case PROP_REQUESTS_PER_SECOND:
+      priv->requests_per_second = g_value_get_double (value);
+      break;
+
+    case PROP_MAX_RETRIES:
+      priv->max_retries = g_value_get_uint (value);
+      break;
+
+    case PROP_REQUEST_TIMEOUT:
+      priv->request_timeout = g_value_get_uint (value);
+      break;
+
+    case PROP_CACHE:
+      gfbgraph_client_set_cache (GFBGRAPH_CLIENT (object), g_value_get_object (value));
+      break;
+
+    case PROP_PHOTO_CACHE:
+      gfbgraph_client_set_photo_cache (GFBGRAPH_CLIENT (object), g_value_get_object (value));
+      break;
+
+    case PROP_METRICS:
+      gfbgraph_client_set_metrics (GFBGRAPH_CLIENT (object), g_value_get_object (value));
+      break;
+
+    case PROP_TRACER:
+      gfbgraph_client_set_tracer (GFBGRAPH_CLIENT (object), g_value_get_object (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_client_get_property (GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  GFBGraphClientPrivate *priv = GFBGRAPH_CLIENT_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_ENDPOINT:
+      g_value_set_string (value, priv->endpoint);
+      break;
+
+    case PROP_MAX_CONNECTIONS:
+      g_value_set_uint (value, priv->max_connections);
+      break;
+
+    case PROP_MAX_REQUESTS_IN_FLIGHT:
+      g_value_set_uint (value, priv->max_requests_in_flight);
+      break;
+
+    case PROP_REQUESTS_PER_SECOND:
+      g_value_set_double (value, priv->requests_per_second);
+      break;
+
+    case PROP_MAX_RETRIES:
+      g_value_set_uint (value, priv->max_retries);
+      break;
+
+    case PROP_REQUEST_TIMEOUT:
+      g_value_set_uint (value, priv->request_timeout);
+      break;
+
+    case PROP_CACHE:
+      g_mutex_lock (&priv->mutex);
+      g_value_set_object (value, priv->cache);
+      g_mutex_unlock (&priv->mutex);
+      break;
+
+    case PROP_PHOTO_CACHE:
+      g_mutex_lock (&priv->mutex);
+      g_value_set_object (value, priv->photo_cache);
+      g_mutex_unlock (&priv->mutex);
+      break;
+
+    case PROP_METRICS:
+      g_mutex_lock (&priv->mutex);
+      g_value_set_object (value, priv->metrics);
+      g_mutex_unlock (&priv->mutex);
+      break;
+
+    case PROP_TRACER:
+      g_mutex_lock (&priv->mutex);
+      g_value_set_object (value, priv->tracer);
+      g_mutex_unlock (&priv->mutex);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_client_class_init (GFBGraphClientClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gfbgraph_client_constructed;
+  gobject_class->dispose = gfbgraph_client_dispose;
+  gobject_class->finalize = gfbgraph_client_finalize;
+  gobject_class->set_property = gfbgraph_client_set_property;
+  gobject_class->get_property = gfbgraph_client_get_property;
+
+  /**
+   * GFBGraphClient:endpoint:
+   *
+   * The base URL of the Graph API used by the client.
+   **/
+  properties [PROP_ENDPOINT] =
+    g_param_spec_string ("endpoint",
+                         "The Graph API endpoint",
+                         "The base URL used for the Graph API requests",
+                         FACEBOOK_ENDPOINT,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphClient:max-connections:
+   *
+   * The maximum number of keep-alive connections held by the media download session.
+   **/
+  properties [PROP_MAX_CONNECTIONS] =
+    g_param_spec_uint ("max-connections",
+                       "Maximum connections",
+                       "The maximum number of connections kept open to a host",
+                       1, G_MAXUINT, DEFAULT_MAX_CONNECTIONS,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphClient:max-requests-in-flight:
+   *
+   * The maximum number of Graph API requests sent through the client at the
+   * same time, by all the functions and threads. The other requests wait for
+   * one of them to finish. 0, the default, disables the limit.
+   **/
+  properties [PROP_MAX_REQUESTS_IN_FLIGHT] =
+    g_param_spec_uint ("max-requests-in-flight",
+                       "Maximum requests in flight",
+                       "The maximum number of requests sent at the same time",
+                       0, G_MAXUINT, DEFAULT_MAX_REQUESTS_IN_FLIGHT,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphClient:requests-per-second:
+   *
+   * The maximum rate of Graph API requests per access token, bursts of up to
+   * two seconds of requests are allowed. It's lowered while the usage reported
+   * by the Graph API is high. 0, the default, disables the limit, but not the
+   * pauses when the API throttles a token.
+   **/
+  properties [PROP_REQUESTS_PER_SECOND] =
+    g_param_spec_double ("requests-per-second",
+                         "Requests per second",
+                         "The maximum number of requests per second and access token",
+                         0, G_MAXDOUBLE, DEFAULT_REQUESTS_PER_SECOND,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphClient:max-retries:
+   *
+   * The maximum number of times a Graph API request is sent again after a
+   * transient error. Requests that aren't idempotent are only retried when the
+   * Graph API throttled them.
+   **/
+  properties [PROP_MAX_RETRIES] =
+    g_param_spec_uint ("max-retries",
+                       "Maximum retries",
+                       "The maximum number of retries of a request after a transient error",
+                       0, G_MAXUINT, DEFAULT_MAX_RETRIES,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphClient:request-timeout:
+   *
+   * The time in seconds after which a failed Graph API request isn't retried
+   * anymore, counting from the first attempt. 0 means no limit.
+   **/
+  properties [PROP_REQUEST_TIMEOUT] =
+    g_param_spec_uint ("request-timeout",
+                       "Request timeout",
+                       "The time in seconds to keep retrying a request, or 0 for no limit",
+                       0, G_MAXUINT, DEFAULT_REQUEST_TIMEOUT,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphClient:cache:
+   *
+   * The #GFBGraphCache keeping the responses of the GET requests, or %NULL
+   * to disable the cache.
+   **/
+  properties [PROP_CACHE] =
+    g_param_spec_object ("cache",
+                         "Response cache",
+                         "The cache of the Graph API responses",
+                         GFBGRAPH_TYPE_CACHE,
+                         G_PARAM_READWRITE);
+
+  /**
+   * GFBGraphClient:photo-cache:
+   *
+   * The #GFBGraphPhotoCache keeping the downloaded photos, or %NULL to
+   * disable it.
+   **/
+  properties [PROP_PHOTO_CACHE] =
+    g_param_spec_object ("photo-cache",
+                         "Photo cache",
+                         "The cache of the downloaded photos",
+                         GFBGRAPH_TYPE_PHOTO_CACHE,
+                         G_PARAM_READWRITE);
+
+  /**
+   * GFBGraphClient:metrics:
+   *
+   * The #GFBGraphMetrics recording the requests sent through the client, or
+   * %NULL to not instrument them.
+   **/
+  properties [PROP_METRICS] =
+    g_param_spec_object ("metrics",
+                         "Metrics",
+                         "The metrics of the requests",
+                         GFBGRAPH_TYPE_METRICS,
+                         G_PARAM_READWRITE);
+
+  /**
+   * GFBGraphClient:tracer:
+   *
+   * The #GFBGraphTracer recording the stages of the requests sent through the
+   * client, or %NULL to not trace them.
+   **/
+  properties [PROP_TRACER] =
+    g_param_spec_object ("tracer",
+                         "Tracer",
+                         "The tracer of the requests",
+                         GFBGRAPH_TYPE_TRACER,
+                         G_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+
+  /**
+   * GFBGraphClient::request-started:
+   * @client: the #GFBGraphClient.
+   * @call: the #RestProxyCall being sent.
+   *
+   * Emitted every time a request is sent to the Graph API, retries included,
+   * while #GFBGraphClient:metrics is set. It's emitted in the thread sending
+   * the request.
+   **/
+  signals [SIGNAL_REQUEST_STARTED] =
+    g_signal_new ("request-started",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 1,
+                  REST_TYPE_PROXY_CALL);
+
+  /**
+   * GFBGraphClient::request-finished:
+   * @client: the #GFBGraphClient.
+   * @call: the #RestProxyCall sent.
+   * @latency: the time until the response arrived, in microseconds.
+   * @error: (allow-none): the #GError of a failed request, or %NULL.
+   *
+   * Emitted every time the response to a request arrives, while
+   * #GFBGraphClient:metrics is set. It's emitted in the thread that sent the
+   * request.
+   **/
+  signals [SIGNAL_REQUEST_FINISHED] =
+    g_signal_new ("request-finished",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 3,
+                  REST_TYPE_PROXY_CALL, G_TYPE_INT64, G_TYPE_ERROR);
+
+  client_quark = g_quark_from_static_string ("gfbgraph-client");
+  authorizer_quark = g_quark_from_static_string ("gfbgraph-authorizer");
+  node_type_quark = g_quark_from_static_string ("gfbgraph-node-type");
+  idempotent_quark = g_quark_from_static_string ("gfbgraph-idempotent");
+  metrics_quark = g_quark_from_static_string ("gfbgraph-metrics");
+  trace_quark = g_quark_from_static_string ("gfbgraph-trace");
+}
+
+static void
+gfbgraph_client_init (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_init (&priv->mutex);
+  priv->cache_ttls = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_client_new:
+ *
+ * Creates a new #GFBGraphClient pointing to the Facebook Graph API, or to the
+ * endpoint in the GFBGRAPH_ENDPOINT environment variable if it's set.
+ *
+ * Returns: (transfer full): a new #GFBGraphClient; unref with g_object_unref()
+ **/
+GFBGraphClient*
+gfbgraph_client_new (void)
+{
+  return GFBGRAPH_CLIENT (g_object_new (GFBGRAPH_TYPE_CLIENT,
+                                        "endpoint", g_getenv ("GFBGRAPH_ENDPOINT"),
+                                        NULL));
+}
+
+/**
+ * gfbgraph_client_get_default:
+ *
+ * Gets the process wide #GFBGraphClient used by the node functions of the library.
+ * It's created the first time this function is called, unless one was set
+ * with gfbgraph_client_set_default(), and never destroyed.
+ *
+ * Returns: (transfer none): the default #GFBGraphClient.
+ **/
+GFBGraphClient*
+gfbgraph_client_get_default (void)
+{
+  GFBGraphClient *client;
+
+  client = g_atomic_pointer_get (&default_client);
+  if (G_LIKELY (client != NULL))
+    return client;
+
+  G_LOCK (default_client);
+  client = default_client;
+  if (client == NULL) {
+    client = gfbgraph_client_new ();
+    g_atomic_pointer_set (&default_client, client);
+  }
+  G_UNLOCK (default_client);
+
+  return client;
+}
+
+/**
+ * gfbgraph_client_set_default:
+ * @client: a #GFBGraphClient.
+ *
+ * Sets the #GFBGraphClient used by the node functions of the library, to
+ * change its limits or its endpoint. It must be called before any request is
+ * made, once the default client exists it can't be replaced.
+ **/
+void
+gfbgraph_client_set_default (GFBGraphClient *client)
+{
+  g_return_if_fail (GFBGRAPH_IS_CLIENT (client));
+
+  G_LOCK (default_client);
+  if (default_client != NULL) {
+    G_UNLOCK (default_client);
+    g_warning ("The default GFBGraphClient is already in use and can't be replaced");
+    return;
+  }
+  g_atomic_pointer_set (&default_client, g_object_ref (client));
+  G_UNLOCK (default_client);
+}
+
+/**
+ * gfbgraph_client_new_rest_call:
+ * @client: a #GFBGraphClient.
+ * @authorizer: a #GFBGraphAuthorizer.
+ *
+ * Creates a new #RestProxyCall using the shared proxy of @client, processed by
+ * @authorizer to allow queries.
+ *
+ * Returns: (transfer full): a new #RestProxyCall.
+ **/
+RestProxyCall*
+gfbgraph_client_new_rest_call (GFBGraphClient     *client,
+                               GFBGraphAuthorizer *authorizer)
+{
+  GFBGraphClientPrivate *priv;
+  RestProxyCall *rest_call;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  rest_call = rest_proxy_new_call (priv->proxy);
+  gfbgraph_authorizer_process_call (authorizer, rest_call);
+  g_object_set_qdata_full (G_OBJECT (rest_call), client_quark, g_object_ref (client), g_object_unref);
+  g_object_set_qdata_full (G_OBJECT (rest_call), authorizer_quark, g_object_ref (authorizer), g_object_unref);
+
+  /* Only the calls with metrics or a tracer are instrumented, the others
+   * don't take the mutex */
+  if (g_atomic_pointer_get (&priv->metrics) == NULL && g_atomic_pointer_get (&priv->tracer) == NULL)
+    return rest_call;
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->metrics != NULL)
+    g_object_set_qdata_full (G_OBJECT (rest_call), metrics_quark, g_object_ref (priv->metrics), g_object_unref);
+  if (priv->tracer != NULL) {
+    TraceData *data;
+
+    data = g_slice_new (TraceData);
+    data->tracer = g_object_ref (priv->tracer);
+    data->request_id = gfbgraph_tracer_new_request_id ();
+    g_object_set_qdata_full (G_OBJECT (rest_call), trace_quark, data, (GDestroyNotify) trace_data_free);
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  return rest_call;
+}
+
+/**
+ * gfbgraph_client_get_endpoint:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: (transfer none): the base URL of the Graph API used by @client.
+ **/
+const gchar*
+gfbgraph_client_get_endpoint (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->endpoint;
+}
+
+/**
+ * gfbgraph_client_get_max_connections:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: the maximum number of connections kept open to a host by the media session.
+ **/
+guint
+gfbgraph_client_get_max_connections (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), 0);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->max_connections;
+}
+
+/**
+ * gfbgraph_client_get_max_requests_in_flight:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: the maximum number of Graph API requests sent through @client at the same time,
+ * or 0 if it's not limited.
+ **/
+guint
+gfbgraph_client_get_max_requests_in_flight (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), 0);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->max_requests_in_flight;
+}
+
+/**
+ * gfbgraph_client_get_requests_per_second:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: the maximum rate of Graph API requests per access token, or 0 if it's not limited.
+ **/
+gdouble
+gfbgraph_client_get_requests_per_second (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), 0);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->requests_per_second;
+}
+
+/**
+ * gfbgraph_client_get_max_retries:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: the maximum number of retries of a Graph API request after a transient error.
+ **/
+guint
+gfbgraph_client_get_max_retries (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), 0);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->max_retries;
+}
+
+/**
+ * gfbgraph_client_get_request_timeout:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: the time in seconds to keep retrying a Graph API request, or 0 if it's not limited.
+ **/
+guint
+gfbgraph_client_get_request_timeout (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), 0);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->request_timeout;
+}
+
+/**
+ * gfbgraph_client_get_proxy:
+ * @client: a #GFBGraphClient.
+ *
+ * Gets the #RestProxy shared by all the Graph API calls created by @client.
+ *
+ * Returns: (transfer none): a #RestProxy.
+ **/
+RestProxy*
+gfbgraph_client_get_proxy (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->proxy;
+}
+
+/**
+ * gfbgraph_client_get_session:
+ * @client: a #GFBGraphClient.
+ *
+ * Gets the #SoupSession used to download photos and other media. It can be used
+ * from any thread, both for synchronous and asynchronous requests.
+ *
+ * Returns: (transfer none): a #SoupSession.
+ **/
+SoupSession*
+gfbgraph_client_get_session (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  return priv->session;
+}
+
+/**
+ * gfbgraph_client_get_cache:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: (transfer full) (nullable): the #GFBGraphCache of @client, or %NULL if
+ * the responses aren't cached. Unref it with g_object_unref(), it stays valid
+ * if another thread replaces it.
+ **/
+GFBGraphCache*
+gfbgraph_client_get_cache (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+  GFBGraphCache *cache = NULL;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->cache != NULL)
+    cache = g_object_ref (priv->cache);
+  g_mutex_unlock (&priv->mutex);
+
+  return cache;
+}
+
+/**
+ * gfbgraph_client_set_cache:
+ * @client: a #GFBGraphClient.
+ * @cache: (allow-none): a #GFBGraphCache, or %NULL.
+ *
+ * Sets the #GFBGraphCache keeping the responses of the GET requests sent
+ * through @client. %NULL disables the cache. The requests already running
+ * keep using the previous cache.
+ **/
+void
+gfbgraph_client_set_cache (GFBGraphClient *client,
+                           GFBGraphCache  *cache)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_CLIENT (client));
+  g_return_if_fail (cache == NULL || GFBGRAPH_IS_CACHE (cache));
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->cache == cache) {
+    g_mutex_unlock (&priv->mutex);
+    return;
+  }
+  g_clear_object (&priv->cache);
+  if (cache != NULL)
+    priv->cache = g_object_ref (cache);
+  g_mutex_unlock (&priv->mutex);
+
+  g_object_notify_by_pspec (G_OBJECT (client), properties [PROP_CACHE]);
+}
+
+/**
+ * gfbgraph_client_get_photo_cache:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: (transfer full) (nullable): the #GFBGraphPhotoCache of @client, or
+ * %NULL if the photos aren't cached. Unref it with g_object_unref().
+ **/
+GFBGraphPhotoCache*
+gfbgraph_client_get_photo_cache (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+  GFBGraphPhotoCache *photo_cache = NULL;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->photo_cache != NULL)
+    photo_cache = g_object_ref (priv->photo_cache);
+  g_mutex_unlock (&priv->mutex);
+
+  return photo_cache;
+}
+
+/**
+ * gfbgraph_client_set_photo_cache:
+ * @client: a #GFBGraphClient.
+ * @photo_cache: (allow-none): a #GFBGraphPhotoCache, or %NULL.
+ *
+ * Sets the #GFBGraphPhotoCache keeping the photos downloaded with @client.
+ * %NULL disables the cache.
+ **/
+void
+gfbgraph_client_set_photo_cache (GFBGraphClient     *client,
+                                 GFBGraphPhotoCache *photo_cache)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_CLIENT (client));
+  g_return_if_fail (photo_cache == NULL || GFBGRAPH_IS_PHOTO_CACHE (photo_cache));
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->photo_cache == photo_cache) {
+    g_mutex_unlock (&priv->mutex);
+    return;
+  }
+  g_clear_object (&priv->photo_cache);
+  if (photo_cache != NULL)
+    priv->photo_cache = g_object_ref (photo_cache);
+  g_mutex_unlock (&priv->mutex);
+
+  g_object_notify_by_pspec (G_OBJECT (client), properties [PROP_PHOTO_CACHE]);
+}
+
+/**
+ * gfbgraph_client_get_metrics:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: (transfer full) (nullable): the #GFBGraphMetrics of @client, or
+ * %NULL if the requests aren't instrumented. Unref it with g_object_unref().
+ **/
+GFBGraphMetrics*
+gfbgraph_client_get_metrics (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+  GFBGraphMetrics *metrics = NULL;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->metrics != NULL)
+    metrics = g_object_ref (priv->metrics);
+  g_mutex_unlock (&priv->mutex);
+
+  return metrics;
+}
+
+/**
+ * gfbgraph_client_set_metrics:
+ * @client: a #GFBGraphClient.
+ * @metrics: (allow-none): a #GFBGraphMetrics, or %NULL.
+ *
+ * Sets the #GFBGraphMetrics recording the requests created from now on with
+ * @client. %NULL disables the instrumentation of the requests.
+ **/
+void
+gfbgraph_client_set_metrics (GFBGraphClient  *client,
+                             GFBGraphMetrics *metrics)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_CLIENT (client));
+  g_return_if_fail (metrics == NULL || GFBGRAPH_IS_METRICS (metrics));
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->metrics == metrics) {
+    g_mutex_unlock (&priv->mutex);
+    return;
+  }
+  g_clear_object (&priv->metrics);
+  if (metrics != NULL)
+    g_atomic_pointer_set (&priv->metrics, g_object_ref (metrics));
+  g_mutex_unlock (&priv->mutex);
+
+  g_object_notify_by_pspec (G_OBJECT (client), properties [PROP_METRICS]);
+}
+
+/**
+ * gfbgraph_client_get_tracer:
+ * @client: a #GFBGraphClient.
+ *
+ * Returns: (transfer full) (nullable): the #GFBGraphTracer of @client, or
+ * %NULL if the requests aren't traced. Unref it with g_object_unref().
+ **/
+GFBGraphTracer*
+gfbgraph_client_get_tracer (GFBGraphClient *client)
+{
+  GFBGraphClientPrivate *priv;
+  GFBGraphTracer *tracer = NULL;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), NULL);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->tracer != NULL)
+    tracer = g_object_ref (priv->tracer);
+  g_mutex_unlock (&priv->mutex);
+
+  return tracer;
+}
+
+/**
+ * gfbgraph_client_set_tracer:
+ * @client: a #GFBGraphClient.
+ * @tracer: (allow-none): a #GFBGraphTracer, or %NULL.
+ *
+ * Sets the #GFBGraphTracer recording the stages of the requests created from
+ * now on with @client. %NULL disables the tracing of the requests.
+ **/
+void
+gfbgraph_client_set_tracer (GFBGraphClient *client,
+                            GFBGraphTracer *tracer)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_CLIENT (client));
+  g_return_if_fail (tracer == NULL || GFBGRAPH_IS_TRACER (tracer));
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->tracer == tracer) {
+    g_mutex_unlock (&priv->mutex);
+    return;
+  }
+  g_clear_object (&priv->tracer);
+  if (tracer != NULL)
+    g_atomic_pointer_set (&priv->tracer, g_object_ref (tracer));
+  g_mutex_unlock (&priv->mutex);
+
+  g_object_notify_by_pspec (G_OBJECT (client), properties [PROP_TRACER]);
+}
+
+/**
+ * gfbgraph_client_set_cache_ttl:
+ * @client: a #GFBGraphClient.
+ * @node_type: a #GFBGraphNode type #GType.
+ * @ttl: the time in seconds.
+ *
+ * Sets the time the cached responses with nodes of type @node_type, or of a
+ * type derived from it without its own TTL, are used without asking the Graph
+ * API. Once expired, they are revalidated with their ETag. The default TTL is
+ * 0, so every cached response is revalidated.
+ **/
+void
+gfbgraph_client_set_cache_ttl (GFBGraphClient *client,
+                               GType           node_type,
+                               guint           ttl)
+{
+  GFBGraphClientPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_CLIENT (client));
+  g_return_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE));
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  g_hash_table_insert (priv->cache_ttls, GSIZE_TO_POINTER (node_type), GUINT_TO_POINTER (ttl));
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gfbgraph_client_get_cache_ttl:
+ * @client: a #GFBGraphClient.
+ * @node_type: a #GFBGraphNode type #GType.
+ *
+ * Gets the time the cached responses with nodes of type @node_type are used
+ * without asking the Graph API, see gfbgraph_client_set_cache_ttl().
+ *
+ * Returns: the TTL in seconds.
+ **/
+guint
+gfbgraph_client_get_cache_ttl (GFBGraphClient *client,
+                               GType           node_type)
+{
+  GFBGraphClientPrivate *priv;
+  gpointer ttl = NULL;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CLIENT (client), 0);
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  for (; node_type != G_TYPE_INVALID; node_type = g_type_parent (node_type)) {
+    if (g_hash_table_lookup_extended (priv->cache_ttls, GSIZE_TO_POINTER (node_type), NULL, &ttl))
+      break;
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  return GPOINTER_TO_UINT (ttl);
+}
+
+/* --- Private API --- */
+
+/*
+ * gfbgraph_rest_call_get_client:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: (transfer none): the #GFBGraphClient that created @call, or %NULL
+ * if it wasn't created by gfbgraph_client_new_rest_call().
+ */
+GFBGraphClient*
+gfbgraph_rest_call_get_client (RestProxyCall *call)
+{
+  return g_object_get_qdata (G_OBJECT (call), client_quark);
+}
+
+/*
+ * gfbgraph_rest_call_get_authorizer:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: (transfer none): the #GFBGraphAuthorizer that processed @call, or
+ * %NULL if it wasn't created by gfbgraph_client_new_rest_call().
+ */
+GFBGraphAuthorizer*
+gfbgraph_rest_call_get_authorizer (RestProxyCall *call)
+{
+  return g_object_get_qdata (G_OBJECT (call), authorizer_quark);
+}
+
+/*
+ * gfbgraph_rest_call_get_scheduler:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: (transfer none): the #GFBGraphScheduler of the client that created
+ * @call, or %NULL if it wasn't created by gfbgraph_client_new_rest_call().
+ */
+GFBGraphScheduler*
+gfbgraph_rest_call_get_scheduler (RestProxyCall *call)
+{
+  GFBGraphClient *client;
+
+  client = g_object_get_qdata (G_OBJECT (call), client_quark);
+  if (client == NULL)
+    return NULL;
+
+  return GFBGRAPH_CLIENT_GET_PRIVATE (client)->scheduler;
+}
+
+/*
+ * gfbgraph_rest_call_ref_cache:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: (transfer full): the #GFBGraphCache of the client that created
+ * @call, or %NULL if the client doesn't have one.
+ */
+GFBGraphCache*
+gfbgraph_rest_call_ref_cache (RestProxyCall *call)
+{
+  GFBGraphClient *client;
+  GFBGraphClientPrivate *priv;
+  GFBGraphCache *cache = NULL;
+
+  client = g_object_get_qdata (G_OBJECT (call), client_quark);
+  if (client == NULL)
+    return NULL;
+
+  priv = GFBGRAPH_CLIENT_GET_PRIVATE (client);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->cache != NULL)
+    cache = g_object_ref (priv->cache);
+  g_mutex_unlock (&priv->mutex);
+
+  return cache;
+}
+
+/*
+ * gfbgraph_rest_call_get_metrics:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: (transfer none): the #GFBGraphMetrics of the client when @call was
+ * created, or %NULL if @call isn't instrumented.
+ */
+GFBGraphMetrics*
+gfbgraph_rest_call_get_metrics (RestProxyCall *call)
+{
+  return g_object_get_qdata (G_OBJECT (call), metrics_quark);
+}
+
+/*
+ * gfbgraph_client_emit_request_started:
+ * @client: a #GFBGraphClient.
+ * @call: the #RestProxyCall being sent.
+ *
+ * Emits #GFBGraphClient::request-started.
+ */
+void
+gfbgraph_client_emit_request_started (GFBGraphClient *client,
+                                      RestProxyCall  *call)
+{
+  g_signal_emit (client, signals [SIGNAL_REQUEST_STARTED], 0, call);
+}
+
+/*
+ * gfbgraph_client_emit_request_finished:
+ * @client: a #GFBGraphClient.
+ * @call: the #RestProxyCall sent.
+ * @latency: the time until the response arrived, in microseconds.
+ * @error: (allow-none): the error of @call, or %NULL.
+ *
+ * Emits #GFBGraphClient::request-finished.
+ */
+void
+gfbgraph_client_emit_request_finished (GFBGraphClient *client,
+                                       RestProxyCall  *call,
+                                       gint64          latency,
+                                       const GError   *error)
+{
+  g_signal_emit (client, signals [SIGNAL_REQUEST_FINISHED], 0, call, latency, error);
+}
+
+/*
+ * gfbgraph_rest_call_is_traced:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: %TRUE if the client of @call had a tracer when @call was created.
+ */
+gboolean
+gfbgraph_rest_call_is_traced (RestProxyCall *call)
+{
+  return g_object_get_qdata (G_OBJECT (call), trace_quark) != NULL;
+}
+
+/*
+ * gfbgraph_rest_call_trace:
+ * @call: a #RestProxyCall.
+ * @name: the name of the span.
+ * @start: when the span started, in the g_get_monotonic_time() clock.
+ * @end: when the span ended.
+ * @error: (allow-none): the error the span ended with, or %NULL.
+ *
+ * Records a span of @call, if it's traced.
+ */
+void
+gfbgraph_rest_call_trace (RestProxyCall *call,
+                          const gchar   *name,
+                          gint64         start,
+                          gint64         end,
+                          const GError  *error)
+{
+  gfbgraph_rest_call_trace_items (call, name, start, end, 0, error);
+}
+
+/*
+ * gfbgraph_rest_call_trace_items:
+ * @call: a #RestProxyCall.
+ * @name: the name of the span.
+ * @start: when the span started, in the g_get_monotonic_time() clock.
+ * @end: when the span ended.
+ * @n_items: the number of items handled in the span.
+ * @error: (allow-none): the error the span ended with, or %NULL.
+ *
+ * Like gfbgraph_rest_call_trace(), for a span handling several items.
+ */
+void
+gfbgraph_rest_call_trace_items (RestProxyCall *call,
+                                const gchar   *name,
+                                gint64         start,
+                                gint64         end,
+                                guint          n_items,
+                                const GError  *error)
+{
+  TraceData *data;
+  const gchar *method;
+  gchar *endpoint;
+
+  data = g_object_get_qdata (G_OBJECT (call), trace_quark);
+  if (data == NULL)
+    return;
+
+  method = rest_proxy_call_get_method (call);
+  endpoint = g_strdup_printf ("%s %s", method != NULL ? method : "GET", rest_proxy_call_get_function (call));
+  gfbgraph_tracer_add_span (data->tracer, name, data->request_id, start, end, n_items, endpoint,
+                            error != NULL ? error->message : NULL);
+  g_free (endpoint);
+}
+
+/*
+ * gfbgraph_rest_call_start_timer:
+ * @call: (allow-none): a #RestProxyCall, or %NULL.
+ *
+ * Starts timing a stage of @call.
+ *
+ * Returns: the current monotonic time, or 0 if @call isn't instrumented so
+ * the timers cost nothing when the instrumentation is disabled.
+ */
+gint64
+gfbgraph_rest_call_start_timer (RestProxyCall *call)
+{
+  if (call == NULL ||
+      (gfbgraph_rest_call_get_metrics (call) == NULL && !gfbgraph_rest_call_is_traced (call)))
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+/*
+ * gfbgraph_rest_call_stop_parse_timer:
+ * @call: (allow-none): a #RestProxyCall, or %NULL.
+ * @timer: a timer started with gfbgraph_rest_call_start_timer().
+ *
+ * Records the time since @timer as parse time of @call, and restarts @timer.
+ */
+void
+gfbgraph_rest_call_stop_parse_timer (RestProxyCall *call,
+                                     gint64        *timer)
+{
+  GFBGraphMetrics *metrics;
+  gint64 now;
+
+  if (*timer == 0)
+    return;
+
+  now = g_get_monotonic_time ();
+  metrics = gfbgraph_rest_call_get_metrics (call);
+  if (metrics != NULL)
+    gfbgraph_metrics_record_parse (metrics, rest_proxy_call_get_method (call), rest_proxy_call_get_function (call),
+                                   now - *timer);
+  gfbgraph_rest_call_trace (call, "parse", *timer, now, NULL);
+  *timer = now;
+}
+
+/*
+ * gfbgraph_rest_call_stop_deserialize_timer:
+ * @call: (allow-none): a #RestProxyCall, or %NULL.
+ * @timer: a timer started with gfbgraph_rest_call_start_timer().
+ *
+ * Records the time since @timer as deserialization time of @call, and
+ * restarts @timer.
+ */
+void
+gfbgraph_rest_call_stop_deserialize_timer (RestProxyCall *call,
+                                           gint64        *timer)
+{
+  GFBGraphMetrics *metrics;
+  gint64 now;
+
+  if (*timer == 0)
+    return;
+
+  now = g_get_monotonic_time ();
+  metrics = gfbgraph_rest_call_get_metrics (call);
+  if (metrics != NULL)
+    gfbgraph_metrics_record_deserialize (metrics, rest_proxy_call_get_method (call), rest_proxy_call_get_function (call),
+                                         now - *timer);
+  gfbgraph_rest_call_trace (call, "deserialize", *timer, now, NULL);
+  *timer = now;
+}
+
+/*
+ * gfbgraph_rest_call_set_node_type:
+ * @call: a #RestProxyCall.
+ * @node_type: the #GType of the nodes in the response of @call.
+ *
+ * Sets the type of the nodes requested by @call, used to choose the TTL of
+ * its response in the cache.
+ */
+void
+gfbgraph_rest_call_set_node_type (RestProxyCall *call,
+                                  GType          node_type)
+{
+  g_object_set_qdata (G_OBJECT (call), node_type_quark, GSIZE_TO_POINTER (node_type));
+}
+
+/*
+ * gfbgraph_rest_call_get_node_type:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: the type set with gfbgraph_rest_call_set_node_type(), or
+ * %G_TYPE_INVALID.
+ */
+GType
+gfbgraph_rest_call_get_node_type (RestProxyCall *call)
+{
+  return GPOINTER_TO_SIZE (g_object_get_qdata (G_OBJECT (call), node_type_quark));
+}
+
+/*
+ * gfbgraph_rest_call_set_idempotent:
+ * @call: a #RestProxyCall.
+ *
+ * Marks @call as safe to send again after a server error even if its
+ * method isn't GET, like a batch request made only of GET requests.
+ */
+void
+gfbgraph_rest_call_set_idempotent (RestProxyCall *call)
+{
+  g_object_set_qdata (G_OBJECT (call), idempotent_quark, GINT_TO_POINTER (TRUE));
+}
+
+/*
+ * gfbgraph_rest_call_is_idempotent:
+ * @call: a #RestProxyCall.
+ *
+ * Returns: %TRUE if @call is a GET request or was marked with
+ * gfbgraph_rest_call_set_idempotent().
+ */
+gboolean
+gfbgraph_rest_call_is_idempotent (RestProxyCall *call)
+{
+  const gchar *method;
+
+  if (g_object_get_qdata (G_OBJECT (call), idempotent_quark) != NULL)
+    return TRUE;
+
+  method = rest_proxy_call_get_method (call);
+
+  return method == NULL || g_strcmp0 (method, "GET") == 0;
+}
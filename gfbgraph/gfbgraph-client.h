@@ -0,0 +1,88 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_CLIENT_H__
+#define __GFBGRAPH_CLIENT_H__
+
+#include <glib-object.h>
+#include <libsoup/soup.h>
+#include <rest/rest-proxy.h>
+#include <gfbgraph/gfbgraph-authorizer.h>
+#include <gfbgraph/gfbgraph-cache.h>
+#include <gfbgraph/gfbgraph-metrics.h>
+#include <gfbgraph/gfbgraph-tracer.h>
+#include <gfbgraph/gfbgraph-photo-cache.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_CLIENT (gfbgraph_client_get_type())
+
+G_DECLARE_DERIVABLE_TYPE (GFBGraphClient, gfbgraph_client, GFBGRAPH, CLIENT, GObject)
+
+struct _GFBGraphClientClass
+{
+  GObjectClass parent_class;
+
+  gpointer  _reserved1;
+  gpointer  _reserved2;
+  gpointer  _reserved3;
+  gpointer  _reserved4;
+  gpointer  _reserved5;
+  gpointer  _reserved6;
+};
+
+GFBGraphClient* gfbgraph_client_new                 (void);
+GFBGraphClient* gfbgraph_client_get_default         (void);
+void            gfbgraph_client_set_default         (GFBGraphClient     *client);
+
+RestProxyCall*  gfbgraph_client_new_rest_call       (GFBGraphClient     *client,
+                                                     GFBGraphAuthorizer *authorizer);
+
+const gchar*    gfbgraph_client_get_endpoint                (GFBGraphClient *client);
+guint           gfbgraph_client_get_max_connections         (GFBGraphClient *client);
+guint           gfbgraph_client_get_max_requests_in_flight  (GFBGraphClient *client);
+gdouble         gfbgraph_client_get_requests_per_second     (GFBGraphClient *client);
+guint           gfbgraph_client_get_max_retries             (GFBGraphClient *client);
+guint           gfbgraph_client_get_request_timeout         (GFBGraphClient *client);
+RestProxy*      gfbgraph_client_get_proxy                   (GFBGraphClient *client);
+SoupSession*    gfbgraph_client_get_session                 (GFBGraphClient *client);
+
+GFBGraphCache*  gfbgraph_client_get_cache                   (GFBGraphClient *client);
+void            gfbgraph_client_set_cache                   (GFBGraphClient *client,
+                                                             GFBGraphCache  *cache);
+guint           gfbgraph_client_get_cache_ttl               (GFBGraphClient *client,
+                                                             GType           node_type);
+void            gfbgraph_client_set_cache_ttl               (GFBGraphClient *client,
+                                                             GType           node_type,
+                                                             guint           ttl);
+
+GFBGraphPhotoCache* gfbgraph_client_get_photo_cache         (GFBGraphClient     *client);
+void                gfbgraph_client_set_photo_cache         (GFBGraphClient     *client,
+                                                             GFBGraphPhotoCache *photo_cache);
+
+GFBGraphMetrics*    gfbgraph_client_get_metrics             (GFBGraphClient     *client);
+void                gfbgraph_client_set_metrics             (GFBGraphClient     *client,
+                                                             GFBGraphMetrics    *metrics);
+GFBGraphTracer*     gfbgraph_client_get_tracer              (GFBGraphClient     *client);
+void                gfbgraph_client_set_tracer              (GFBGraphClient     *client,
+                                                             GFBGraphTracer     *tracer);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_CLIENT_H__ */
@@ -17,35 +17,1072 @@
  * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
+#include "gfbgraph-cache.h"
 #include "gfbgraph-common.h"
+#include "gfbgraph-client.h"
+#include "gfbgraph-metrics.h"
+#include "gfbgraph-private.h"
 
-#include <rest/rest-proxy.h>
+#define RETRY_BASE_DELAY_USEC (500 * 1000)
+#define RETRY_MAX_DELAY_USEC  (30 * G_USEC_PER_SEC)
 
-#define FACEBOOK_ENDPOINT "https://graph.facebook.com"
+GQuark
+gfbgraph_api_error_quark (void)
+{
+  return g_quark_from_static_string ("gfbgraph-api-error-quark");
+}
 
 /**
  * gfbgraph_new_rest_call:
  * @authorizer: a #GFBGraphAuthorizer.
  *
  * Create a new #RestProxyCall pointing to the Facebook Graph API url (https://graph.facebook.com)
- * and processed by the authorizer to allow queries.
+ * and processed by the authorizer to allow queries. The call uses the shared proxy of the
+ * default #GFBGraphClient, so the connections to the Graph API are reused between calls.
  *
  * Returns: (transfer full): a new #RestProxyCall or %NULL in case of error.
  **/
 RestProxyCall*
 gfbgraph_new_rest_call (GFBGraphAuthorizer *authorizer)
 {
-  RestProxy *proxy;
-  RestProxyCall *rest_call;
-
   g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER(authorizer), NULL);
 
-  proxy = rest_proxy_new (FACEBOOK_ENDPOINT, FALSE);
-  rest_call = rest_proxy_new_call (proxy);
+  return gfbgraph_client_new_rest_call (gfbgraph_client_get_default (), authorizer);
+}
+
+/* --- Private API --- */
+
+static const gchar*
+gfbgraph_rest_call_get_token (RestProxyCall *call)
+{
+  RestParam *param;
+
+  param = rest_proxy_call_lookup_param (call, "access_token");
+  if (param == NULL)
+    return NULL;
+
+  return (const gchar *) rest_param_get_content (param);
+}
+
+/* The response cache state of a call, from the lookup before sending it until
+ * its response is stored */
+typedef struct
+{
+  GFBGraphCache *cache;
+  gchar         *key;
+  /* The cached response, served as is if @hit or revalidated with @etag */
+  GBytes        *payload;
+  gchar         *etag;
+  gboolean       hit;
+} CacheData;
+
+G_DEFINE_QUARK (gfbgraph-cache-data, gfbgraph_cache_data);
+
+static void
+cache_data_free (CacheData *data)
+{
+  g_object_unref (data->cache);
+  g_free (data->key);
+  g_clear_pointer (&data->payload, g_bytes_unref);
+  g_free (data->etag);
+
+  g_slice_free (CacheData, data);
+}
+
+static gint
+compare_strings (gconstpointer a,
+                 gconstpointer b)
+{
+  return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* The key of the response of @call: the path and the sorted params, but
+ * the access token, and a hash of the identity of the user, or of the token
+ * if the authorizer doesn't know it, so the responses of different users
+ * aren't mixed. With the identity the responses are still found after the
+ * token is refreshed. */
+static gchar*
+gfbgraph_rest_call_get_cache_key (RestProxyCall *call)
+{
+  RestParams *params;
+  RestParamsIter iter;
+  const gchar *name;
+  RestParam *param;
+  GPtrArray *names;
+  GString *key;
+  GFBGraphAuthorizer *authorizer;
+  gchar *identity = NULL;
+  guint i;
+
+  key = g_string_new (rest_proxy_call_get_function (call));
+
+  names = g_ptr_array_new ();
+  params = rest_proxy_call_get_params (call);
+  rest_params_iter_init (&iter, params);
+  while (rest_params_iter_next (&iter, &name, &param)) {
+    if (rest_param_is_string (param) && g_strcmp0 (name, "access_token") != 0)
+      g_ptr_array_add (names, (gpointer) name);
+  }
+  g_ptr_array_sort (names, compare_strings);
+
+  for (i = 0; i < names->len; i++) {
+    name = g_ptr_array_index (names, i);
+    g_string_append_c (key, i == 0 ? '?' : '&');
+    g_string_append_printf (key, "%s=%s", name,
+                            (const gchar *) rest_param_get_content (rest_params_get (params, name)));
+  }
+  g_ptr_array_free (names, TRUE);
+
+  authorizer = gfbgraph_rest_call_get_authorizer (call);
+  if (authorizer != NULL)
+    identity = gfbgraph_authorizer_get_identity (authorizer, call);
+  if (identity == NULL)
+    identity = g_strdup (gfbgraph_rest_call_get_token (call));
+
+  if (identity != NULL) {
+    gchar *hash;
+
+    hash = g_compute_checksum_for_string (G_CHECKSUM_SHA256, identity, -1);
+    g_string_append_printf (key, "#%.16s", hash);
+    g_free (hash);
+    g_free (identity);
+  }
+
+  return g_string_free (key, FALSE);
+}
+
+/* The payload of a response served from the cache must be NUL terminated, as
+ * the one of a #RestProxyCall */
+static void
+cache_data_set_hit (CacheData *data)
+{
+  gconstpointer payload;
+  gsize size;
+  gchar *copy;
+
+  payload = g_bytes_get_data (data->payload, &size);
+  copy = g_malloc (size + 1);
+  memcpy (copy, payload, size);
+  copy[size] = '\0';
+
+  g_bytes_unref (data->payload);
+  data->payload = g_bytes_new_take (copy, size + 1);
+  data->hit = TRUE;
+}
+
+/* Looks for the response of @call in the cache of its client. Returns %TRUE
+ * if it's fresh, so @call doesn't need to be sent. A stale response with an
+ * ETag is revalidated by the request instead. Only GET requests are cached. */
+static gboolean
+gfbgraph_rest_call_cache_lookup (RestProxyCall *call)
+{
+  GFBGraphCache *cache;
+  CacheData *data;
+  const gchar *method;
+  gint64 expiration;
+
+  g_object_set_qdata (G_OBJECT (call), gfbgraph_cache_data_quark (), NULL);
+  rest_proxy_call_remove_header (call, "If-None-Match");
+
+  method = rest_proxy_call_get_method (call);
+  if (method != NULL && g_strcmp0 (method, "GET") != 0)
+    return FALSE;
+
+  cache = gfbgraph_rest_call_ref_cache (call);
+  if (cache == NULL)
+    return FALSE;
+
+  data = g_slice_new0 (CacheData);
+  data->cache = cache;
+  data->key = gfbgraph_rest_call_get_cache_key (call);
+  g_object_set_qdata_full (G_OBJECT (call), gfbgraph_cache_data_quark (), data, (GDestroyNotify) cache_data_free);
+
+  if (!gfbgraph_cache_lookup (cache, data->key, &data->payload, &data->etag, &expiration))
+    return FALSE;
+
+  if (expiration > g_get_real_time ()) {
+    cache_data_set_hit (data);
+    return TRUE;
+  }
+
+  if (data->etag == NULL) {
+    g_clear_pointer (&data->payload, g_bytes_unref);
+    return FALSE;
+  }
+
+  rest_proxy_call_add_header (call, "If-None-Match", data->etag);
+
+  return FALSE;
+}
+
+/* Stores the response of @call in the cache, or turns a 304 Not Modified
+ * error into the cached response */
+static void
+gfbgraph_rest_call_cache_update (RestProxyCall  *call,
+                                 GError        **error)
+{
+  CacheData *data;
+  GBytes *payload;
+  const gchar *etag;
+  guint ttl;
+  gint64 expiration;
+
+  data = g_object_get_qdata (G_OBJECT (call), gfbgraph_cache_data_quark ());
+  if (data == NULL)
+    return;
+
+  if (*error != NULL && (!g_error_matches (*error, REST_PROXY_ERROR, SOUP_STATUS_NOT_MODIFIED) ||
+                         data->payload == NULL))
+    return;
+
+  ttl = gfbgraph_client_get_cache_ttl (gfbgraph_rest_call_get_client (call),
+                                       gfbgraph_rest_call_get_node_type (call));
+  expiration = g_get_real_time () + ttl * G_USEC_PER_SEC;
+
+  etag = rest_proxy_call_lookup_response_header (call, "ETag");
+
+  if (*error != NULL) {
+    g_clear_error (error);
+    gfbgraph_cache_store (data->cache, data->key, data->payload, etag != NULL ? etag : data->etag, expiration);
+    cache_data_set_hit (data);
+    return;
+  }
+
+  /* Without a TTL nor an ETag it would never be used */
+  if (etag == NULL && ttl == 0)
+    return;
+
+  payload = g_bytes_new (rest_proxy_call_get_payload (call), rest_proxy_call_get_payload_length (call));
+  gfbgraph_cache_store (data->cache, data->key, payload, etag, expiration);
+  g_bytes_unref (payload);
+}
+
+/* Replaces the HTTP error of a failed call by the Graph API error in its
+ * payload, so the callers and the scheduler can tell throttling and
+ * authorization errors apart. */
+static void
+gfbgraph_rest_call_check_error (RestProxyCall  *call,
+                                GError        **error)
+{
+  GError *api_error = NULL;
+
+  if (*error == NULL || (*error)->domain != REST_PROXY_ERROR)
+    return;
+
+  if (gfbgraph_api_error_from_payload (rest_proxy_call_get_payload (call),
+                                       rest_proxy_call_get_payload_length (call),
+                                       &api_error)) {
+    g_clear_error (error);
+    *error = api_error;
+  }
+}
+
+/* Lets the authorizer of @call know the result of the request */
+static void
+gfbgraph_rest_call_process_response (RestProxyCall *call,
+                                     const GError  *error)
+{
+  GFBGraphAuthorizer *authorizer;
+
+  authorizer = gfbgraph_rest_call_get_authorizer (call);
+  if (authorizer != NULL)
+    gfbgraph_authorizer_process_response (authorizer, call, error);
+}
+
+/* Authorizes @call again before a retry, so an authorizer with several
+ * tokens can send it with another one */
+static void
+gfbgraph_rest_call_reauthorize (RestProxyCall *call)
+{
+  GFBGraphAuthorizer *authorizer;
+
+  authorizer = gfbgraph_rest_call_get_authorizer (call);
+  if (authorizer != NULL)
+    gfbgraph_authorizer_process_call (authorizer, call);
+}
+
+/* An estimation of the size of the request, the params of @call without the
+ * headers */
+static gsize
+gfbgraph_rest_call_get_request_size (RestProxyCall *call)
+{
+  RestParamsIter iter;
+  const gchar *name;
+  RestParam *param;
+  gsize size = 0;
+
+  rest_params_iter_init (&iter, rest_proxy_call_get_params (call));
+  while (rest_params_iter_next (&iter, &name, &param))
+    size += strlen (name) + rest_param_get_content_length (param) + 2;
+
+  return size;
+}
+
+/* Records the span @name of @call, from @start to now. Nothing is done if
+ * the timer of @start wasn't started. */
+static void
+gfbgraph_rest_call_trace_since (RestProxyCall *call,
+                                const gchar   *name,
+                                gint64         start,
+                                const GError  *error)
+{
+  if (start != 0)
+    gfbgraph_rest_call_trace (call, name, start, g_get_monotonic_time (), error);
+}
+
+/* Emits the client request-started signal if @call has metrics. Returns the
+ * time @call is sent, or 0 if it isn't instrumented. */
+static gint64
+gfbgraph_rest_call_instrument_start (RestProxyCall *call)
+{
+  if (gfbgraph_rest_call_get_metrics (call) != NULL)
+    gfbgraph_client_emit_request_started (gfbgraph_rest_call_get_client (call), call);
+
+  return gfbgraph_rest_call_start_timer (call);
+}
+
+/* Records the response of an instrumented @call, sent at @started */
+static void
+gfbgraph_rest_call_instrument_finish (RestProxyCall *call,
+                                      gint64         started,
+                                      const GError  *error)
+{
+  GFBGraphMetrics *metrics;
+  CacheData *data;
+  gint64 latency;
+
+  if (started == 0)
+    return;
+
+  gfbgraph_rest_call_trace_since (call, "http", started, error);
+
+  metrics = gfbgraph_rest_call_get_metrics (call);
+  if (metrics == NULL)
+    return;
+
+  latency = g_get_monotonic_time () - started;
+  gfbgraph_metrics_record_request (metrics,
+                                   rest_proxy_call_get_method (call),
+                                   rest_proxy_call_get_function (call),
+                                   latency,
+                                   gfbgraph_rest_call_get_request_size (call),
+                                   rest_proxy_call_get_payload_length (call),
+                                   error);
+
+  /* Revalidated with a 304 Not Modified */
+  data = g_object_get_qdata (G_OBJECT (call), gfbgraph_cache_data_quark ());
+  if (data != NULL && data->hit)
+    gfbgraph_metrics_record_cache_hit (metrics, rest_proxy_call_get_method (call), rest_proxy_call_get_function (call));
+
+  gfbgraph_client_emit_request_finished (gfbgraph_rest_call_get_client (call), call, latency, error);
+}
+
+/* Looks for @call in the cache like gfbgraph_rest_call_cache_lookup(), also
+ * recording the fresh responses in the metrics */
+static gboolean
+gfbgraph_rest_call_cache_lookup_fresh (RestProxyCall *call)
+{
+  GFBGraphMetrics *metrics;
+
+  if (!gfbgraph_rest_call_cache_lookup (call))
+    return FALSE;
+
+  metrics = gfbgraph_rest_call_get_metrics (call);
+  if (metrics != NULL)
+    gfbgraph_metrics_record_cache_hit (metrics, rest_proxy_call_get_method (call), rest_proxy_call_get_function (call));
+
+  return TRUE;
+}
+
+/* Records a new attempt to send @call */
+static void
+gfbgraph_rest_call_metrics_retry (RestProxyCall *call)
+{
+  GFBGraphMetrics *metrics;
+
+  metrics = gfbgraph_rest_call_get_metrics (call);
+  if (metrics != NULL)
+    gfbgraph_metrics_record_retry (metrics, rest_proxy_call_get_method (call), rest_proxy_call_get_function (call));
+}
+
+/* Sends @call once, waiting for the scheduler of its client */
+static gboolean
+gfbgraph_rest_call_invoke_once (RestProxyCall  *call,
+                                GCancellable   *cancellable,
+                                GError        **error)
+{
+  GFBGraphScheduler *scheduler;
+  const gchar *token;
+  GError *call_error = NULL;
+  gint64 started;
+
+  scheduler = gfbgraph_rest_call_get_scheduler (call);
+  token = gfbgraph_rest_call_get_token (call);
+
+  if (scheduler != NULL) {
+    gint64 queued;
+
+    queued = gfbgraph_rest_call_start_timer (call);
+    if (!gfbgraph_scheduler_acquire (scheduler, token, cancellable, &call_error)) {
+      gfbgraph_rest_call_trace_since (call, "queue", queued, call_error);
+      g_propagate_error (error, call_error);
+      return FALSE;
+    }
+    gfbgraph_rest_call_trace_since (call, "queue", queued, NULL);
+  }
+
+  started = gfbgraph_rest_call_instrument_start (call);
+  rest_proxy_call_sync (call, &call_error);
+  gfbgraph_rest_call_check_error (call, &call_error);
+  gfbgraph_rest_call_cache_update (call, &call_error);
+  gfbgraph_rest_call_instrument_finish (call, started, call_error);
+
+  if (scheduler != NULL)
+    gfbgraph_scheduler_release (scheduler, token, call, call_error);
+  gfbgraph_rest_call_process_response (call, call_error);
+
+  if (call_error != NULL) {
+    g_propagate_error (error, call_error);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gfbgraph_rest_call_is_oauth_error (const GError *error)
+{
+  return g_error_matches (error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_OAUTH);
+}
+
+/* Whether @call may succeed if it's sent again after @error. Requests that
+ * aren't idempotent, like POST, are only sent again when the Graph API
+ * refused them. */
+static gboolean
+gfbgraph_rest_call_is_retryable (RestProxyCall *call,
+                                 const GError  *error)
+{
+  gboolean idempotent;
+
+  idempotent = gfbgraph_rest_call_is_idempotent (call);
+
+  if (error->domain == GFBGRAPH_API_ERROR) {
+    switch (error->code)
+      {
+      case GFBGRAPH_API_ERROR_TOO_MANY_CALLS:
+      case GFBGRAPH_API_ERROR_USER_TOO_MANY_CALLS:
+      case GFBGRAPH_API_ERROR_PAGE_TOO_MANY_CALLS:
+      case GFBGRAPH_API_ERROR_RATE_LIMIT:
+        return TRUE;
+
+      case GFBGRAPH_API_ERROR_UNKNOWN:
+      case GFBGRAPH_API_ERROR_SERVICE:
+        return idempotent;
+
+      default:
+        return FALSE;
+      }
+  }
+
+  if (error->domain == REST_PROXY_ERROR) {
+    return idempotent &&
+      (error->code == REST_PROXY_ERROR_CONNECTION ||
+       error->code == REST_PROXY_ERROR_IO ||
+       error->code >= REST_PROXY_ERROR_HTTP_INTERNAL_SERVER_ERROR);
+  }
+
+  return FALSE;
+}
+
+/* Gets the time to wait before the retry number @attempt, or -1 if @call
+ * shouldn't be retried anymore */
+static gint64
+gfbgraph_rest_call_get_retry_delay (RestProxyCall *call,
+                                    guint          attempt,
+                                    gint64         deadline)
+{
+  GFBGraphClient *client;
+  gint64 delay;
+
+  client = gfbgraph_rest_call_get_client (call);
+  if (client == NULL || attempt >= gfbgraph_client_get_max_retries (client))
+    return -1;
+
+  /* Full jitter: a random time between 0 and the exponential backoff, so
+   * the requests throttled at the same time don't come back together */
+  delay = MIN (RETRY_MAX_DELAY_USEC, (gint64) RETRY_BASE_DELAY_USEC << MIN (attempt, 16));
+  delay = g_random_int_range (0, delay / 1000 + 1) * (gint64) 1000;
+
+  if (deadline > 0 && g_get_monotonic_time () + delay > deadline)
+    return -1;
+
+  return delay;
+}
+
+static gint64
+gfbgraph_rest_call_get_deadline (RestProxyCall *call)
+{
+  GFBGraphClient *client;
+  guint timeout;
+
+  client = gfbgraph_rest_call_get_client (call);
+  if (client == NULL || (timeout = gfbgraph_client_get_request_timeout (client)) == 0)
+    return 0;
+
+  return g_get_monotonic_time () + timeout * G_USEC_PER_SEC;
+}
+
+static gboolean
+gfbgraph_rest_call_refresh (RestProxyCall  *call,
+                            GCancellable   *cancellable,
+                            GError        **error)
+{
+  GFBGraphAuthorizer *authorizer;
+  gchar *rejected_token;
+  gboolean refreshed;
+
+  authorizer = gfbgraph_rest_call_get_authorizer (call);
+  if (authorizer == NULL)
+    return FALSE;
+
+  /* Replaces the access_token param with the current token. If another
+   * request already refreshed the one rejected, that's enough. */
+  rejected_token = g_strdup (gfbgraph_rest_call_get_token (call));
+  gfbgraph_authorizer_process_call (authorizer, call);
+  refreshed = g_strcmp0 (rejected_token, gfbgraph_rest_call_get_token (call)) != 0;
+  g_free (rejected_token);
+  if (refreshed)
+    return TRUE;
+
+  if (!gfbgraph_authorizer_refresh_authorization (authorizer, cancellable, error))
+    return FALSE;
+
+  gfbgraph_authorizer_process_call (authorizer, call);
+
+  return TRUE;
+}
+
+/* Sleeps @delay microseconds, returning early if @cancellable is cancelled */
+static gboolean
+gfbgraph_sleep (gint64         delay,
+                GCancellable  *cancellable,
+                GError       **error)
+{
+  GPollFD pollfd;
+
+  if (g_cancellable_make_pollfd (cancellable, &pollfd)) {
+    g_poll (&pollfd, 1, delay / 1000);
+    g_cancellable_release_fd (cancellable);
+  } else {
+    g_usleep (delay);
+  }
+
+  return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+/* The cache lookup and the retries of gfbgraph_rest_call_invoke() */
+static gboolean
+gfbgraph_rest_call_invoke_real (RestProxyCall  *call,
+                                GCancellable   *cancellable,
+                                GError        **error)
+{
+  GError *call_error = NULL;
+  gboolean refreshed = FALSE;
+  guint attempt = 0;
+  gint64 deadline;
+
+  if (gfbgraph_rest_call_cache_lookup_fresh (call))
+    return TRUE;
+
+  deadline = gfbgraph_rest_call_get_deadline (call);
+
+  while (!gfbgraph_rest_call_invoke_once (call, cancellable, &call_error)) {
+    gint64 delay;
+    gint64 timer;
+
+    if (!refreshed && gfbgraph_rest_call_is_oauth_error (call_error)) {
+      gboolean success;
+
+      /* Only once, a new token rejected again is a hard error */
+      refreshed = TRUE;
+      timer = gfbgraph_rest_call_start_timer (call);
+      success = gfbgraph_rest_call_refresh (call, cancellable, NULL);
+      gfbgraph_rest_call_trace_since (call, "refresh", timer, NULL);
+      if (success) {
+        g_clear_error (&call_error);
+        gfbgraph_rest_call_metrics_retry (call);
+        continue;
+      }
+    }
+
+    if (!gfbgraph_rest_call_is_retryable (call, call_error) ||
+        (delay = gfbgraph_rest_call_get_retry_delay (call, attempt++, deadline)) < 0) {
+      g_propagate_error (error, call_error);
+      return FALSE;
+    }
+
+    g_clear_error (&call_error);
+    timer = gfbgraph_rest_call_start_timer (call);
+    if (!gfbgraph_sleep (delay, cancellable, error))
+      return FALSE;
+    gfbgraph_rest_call_trace_since (call, "backoff", timer, NULL);
+
+    gfbgraph_rest_call_reauthorize (call);
+    gfbgraph_rest_call_metrics_retry (call);
+  }
+
+  return TRUE;
+}
+
+/*
+ * gfbgraph_rest_call_invoke:
+ * @call: a #RestProxyCall created with gfbgraph_new_rest_call().
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Runs @call synchronously. Every Graph API request of the library goes
+ * through this function or gfbgraph_rest_call_invoke_async(), that wait for
+ * the scheduler of the #GFBGraphClient of @call before sending it, refresh
+ * the authorizer of @call if its token has expired and retry the transient
+ * errors as configured in the client. The Graph API errors are reported in
+ * the %GFBGRAPH_API_ERROR domain.
+ *
+ * Returns: %TRUE if the request succeeded, the payload is in @call.
+ */
+gboolean
+gfbgraph_rest_call_invoke (RestProxyCall  *call,
+                           GCancellable   *cancellable,
+                           GError        **error)
+{
+  GError *call_error = NULL;
+  gboolean success;
+  gint64 timer;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  timer = gfbgraph_rest_call_start_timer (call);
+  success = gfbgraph_rest_call_invoke_real (call, cancellable, &call_error);
+  gfbgraph_rest_call_trace_since (call, "request", timer, call_error);
+
+  if (call_error != NULL)
+    g_propagate_error (error, call_error);
+
+  return success;
+}
+
+typedef struct
+{
+  gchar    *token;
+  gboolean  refreshed;
+  guint     attempt;
+  gint64    deadline;
+  /* When the request started, when the current attempt was sent and when the
+   * current wait for the scheduler, a refresh or a retry started, for the
+   * instrumentation */
+  gint64    requested;
+  gint64    started;
+  gint64    waiting;
+  /* The error that made the authorization to be refreshed */
+  GError   *error;
+} InvokeData;
+
+static void
+invoke_data_free (InvokeData *data)
+{
+  g_free (data->token);
+  g_clear_error (&data->error);
+
+  g_slice_free (InvokeData, data);
+}
+
+static void gfbgraph_rest_call_invoke_attempt (GTask *task);
+
+/* Returns the result of @task, with its reference */
+static void
+gfbgraph_rest_call_invoke_return (GTask  *task,
+                                  GError *error)
+{
+  RestProxyCall *call = REST_PROXY_CALL (g_task_get_source_object (task));
+  InvokeData *data = g_task_get_task_data (task);
+
+  gfbgraph_rest_call_trace_since (call, "request", data->requested, error);
+
+  if (error != NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+/* Dispatched when the backoff is over, or as soon as the task is cancelled */
+static gboolean
+gfbgraph_rest_call_retry_cb (gpointer user_data)
+{
+  RestProxyCall *call = REST_PROXY_CALL (g_task_get_source_object (G_TASK (user_data)));
+  InvokeData *data = g_task_get_task_data (G_TASK (user_data));
+  GError *error = NULL;
+
+  if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (G_TASK (user_data)), &error)) {
+    gfbgraph_rest_call_trace_since (call, "backoff", data->waiting, error);
+    gfbgraph_rest_call_invoke_return (G_TASK (user_data), error);
+    return G_SOURCE_REMOVE;
+  }
+
+  gfbgraph_rest_call_trace_since (call, "backoff", data->waiting, NULL);
+  gfbgraph_rest_call_reauthorize (call);
+  gfbgraph_rest_call_metrics_retry (call);
+  gfbgraph_rest_call_invoke_attempt (G_TASK (user_data));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gfbgraph_rest_call_refresh_thread (GTask        *task,
+                                   gpointer      source_object,
+                                   gpointer      task_data,
+                                   GCancellable *cancellable)
+{
+  GError *error = NULL;
+
+  if (gfbgraph_rest_call_refresh (REST_PROXY_CALL (source_object), cancellable, &error))
+    g_task_return_boolean (task, TRUE);
+  else if (error != NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, FALSE);
+}
+
+static void
+gfbgraph_rest_call_refreshed_cb (GObject      *source_object,
+                                 GAsyncResult *result,
+                                 gpointer      user_data)
+{
+  GTask *task = G_TASK (user_data);
+  RestProxyCall *call = REST_PROXY_CALL (source_object);
+  InvokeData *data = g_task_get_task_data (task);
+  GError *error;
+
+  gfbgraph_rest_call_trace_since (call, "refresh", data->waiting, NULL);
+
+  if (g_task_propagate_boolean (G_TASK (result), NULL)) {
+    g_clear_error (&data->error);
+    gfbgraph_rest_call_metrics_retry (call);
+    gfbgraph_rest_call_invoke_attempt (task);
+    return;
+  }
+
+  error = data->error;
+  data->error = NULL;
+  gfbgraph_rest_call_invoke_return (task, error);
+}
+
+static void
+gfbgraph_rest_call_invoked_cb (GObject      *source_object,
+                               GAsyncResult *result,
+                               gpointer      user_data)
+{
+  GTask *task = G_TASK (user_data);
+  RestProxyCall *call = REST_PROXY_CALL (source_object);
+  InvokeData *data = g_task_get_task_data (task);
+  GFBGraphScheduler *scheduler;
+  GSource *source;
+  GError *error = NULL;
+  gint64 delay;
+
+  rest_proxy_call_invoke_finish (call, result, &error);
+  gfbgraph_rest_call_check_error (call, &error);
+  gfbgraph_rest_call_cache_update (call, &error);
+  gfbgraph_rest_call_instrument_finish (call, data->started, error);
+
+  scheduler = gfbgraph_rest_call_get_scheduler (call);
+  if (scheduler != NULL)
+    gfbgraph_scheduler_release (scheduler, data->token, call, error);
+  gfbgraph_rest_call_process_response (call, error);
+
+  if (error == NULL) {
+    gfbgraph_rest_call_invoke_return (task, NULL);
+    return;
+  }
+
+  if (!data->refreshed && gfbgraph_rest_call_is_oauth_error (error) &&
+      gfbgraph_rest_call_get_authorizer (call) != NULL) {
+    GTask *refresh_task;
+
+    /* Refreshing the authorization can block, it's done in a thread */
+    data->refreshed = TRUE;
+    data->error = error;
+    data->waiting = gfbgraph_rest_call_start_timer (call);
+    refresh_task = g_task_new (call, g_task_get_cancellable (task), gfbgraph_rest_call_refreshed_cb, task);
+    g_task_run_in_thread (refresh_task, gfbgraph_rest_call_refresh_thread);
+    g_object_unref (refresh_task);
+    return;
+  }
+
+  if (!gfbgraph_rest_call_is_retryable (call, error) ||
+      (delay = gfbgraph_rest_call_get_retry_delay (call, data->attempt++, data->deadline)) < 0) {
+    gfbgraph_rest_call_invoke_return (task, error);
+    return;
+  }
+
+  g_error_free (error);
+
+  data->waiting = gfbgraph_rest_call_start_timer (call);
+  source = g_timeout_source_new (delay / 1000);
+  if (g_task_get_cancellable (task) != NULL) {
+    GSource *cancellable_source;
+
+    /* Cancelling the task dispatches the timeout without waiting for it */
+    cancellable_source = g_cancellable_source_new (g_task_get_cancellable (task));
+    g_source_set_dummy_callback (cancellable_source);
+    g_source_add_child_source (source, cancellable_source);
+    g_source_unref (cancellable_source);
+  }
+  g_source_set_callback (source, gfbgraph_rest_call_retry_cb, task, NULL);
+  g_source_attach (source, g_task_get_context (task));
+  g_source_unref (source);
+}
+
+/* Sends the call of @task, that already went through the scheduler */
+static void
+gfbgraph_rest_call_send (GTask *task)
+{
+  RestProxyCall *call = REST_PROXY_CALL (g_task_get_source_object (task));
+  InvokeData *data = g_task_get_task_data (task);
+
+  data->started = gfbgraph_rest_call_instrument_start (call);
+  rest_proxy_call_invoke_async (call, g_task_get_cancellable (task), gfbgraph_rest_call_invoked_cb, task);
+}
+
+static void
+gfbgraph_rest_call_acquired_cb (GObject      *source_object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  GTask *task = G_TASK (user_data);
+  RestProxyCall *call = REST_PROXY_CALL (g_task_get_source_object (task));
+  InvokeData *data = g_task_get_task_data (task);
+  GError *error = NULL;
+
+  gfbgraph_scheduler_acquire_finish (gfbgraph_rest_call_get_scheduler (call), result, &error);
+  gfbgraph_rest_call_trace_since (call, "queue", data->waiting, error);
+  if (error != NULL) {
+    gfbgraph_rest_call_invoke_return (task, error);
+    return;
+  }
+
+  gfbgraph_rest_call_send (task);
+}
+
+/* Sends the call of @task once, the task reference is passed along */
+static void
+gfbgraph_rest_call_invoke_attempt (GTask *task)
+{
+  RestProxyCall *call = REST_PROXY_CALL (g_task_get_source_object (task));
+  InvokeData *data = g_task_get_task_data (task);
+  GFBGraphScheduler *scheduler;
+  GError *error = NULL;
+
+  if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), &error)) {
+    gfbgraph_rest_call_invoke_return (task, error);
+    return;
+  }
+
+  /* The token changes when the authorization is refreshed */
+  g_free (data->token);
+  data->token = g_strdup (gfbgraph_rest_call_get_token (call));
+
+  scheduler = gfbgraph_rest_call_get_scheduler (call);
+  if (scheduler == NULL) {
+    gfbgraph_rest_call_send (task);
+    return;
+  }
+
+  data->waiting = gfbgraph_rest_call_start_timer (call);
+  gfbgraph_scheduler_acquire_async (scheduler, data->token, g_task_get_cancellable (task),
+                                    gfbgraph_rest_call_acquired_cb, task);
+}
+
+/*
+ * gfbgraph_rest_call_invoke_async:
+ * @call: a #RestProxyCall created with gfbgraph_new_rest_call().
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @callback: (scope async): A #GAsyncReadyCallback to call when the request is completed.
+ * @user_data: (closure): The data to pass to @callback.
+ *
+ * Runs @call in the thread-default main context without blocking any thread,
+ * neither while it waits for the scheduler or to be retried. Cancelling
+ * @cancellable aborts the HTTP exchange.
+ */
+void
+gfbgraph_rest_call_invoke_async (RestProxyCall       *call,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  GTask *task;
+  InvokeData *data;
+
+  task = g_task_new (call, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gfbgraph_rest_call_invoke_async);
+
+  data = g_slice_new0 (InvokeData);
+  data->deadline = gfbgraph_rest_call_get_deadline (call);
+  data->requested = gfbgraph_rest_call_start_timer (call);
+  g_task_set_task_data (task, data, (GDestroyNotify) invoke_data_free);
+
+  if (gfbgraph_rest_call_cache_lookup_fresh (call)) {
+    gfbgraph_rest_call_invoke_return (task, NULL);
+    return;
+  }
+
+  gfbgraph_rest_call_invoke_attempt (task);
+}
+
+gboolean
+gfbgraph_rest_call_invoke_finish (RestProxyCall  *call,
+                                  GAsyncResult   *result,
+                                  GError        **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, call), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/*
+ * gfbgraph_rest_call_get_payload:
+ * @call: a #RestProxyCall run with gfbgraph_rest_call_invoke().
+ *
+ * Gets the payload of the response to @call, that can come from the cache of
+ * its client instead of the Graph API. Use it instead of
+ * rest_proxy_call_get_payload().
+ *
+ * Returns: the NUL terminated payload.
+ */
+const gchar*
+gfbgraph_rest_call_get_payload (RestProxyCall *call)
+{
+  CacheData *data;
+
+  data = g_object_get_qdata (G_OBJECT (call), gfbgraph_cache_data_quark ());
+  if (data != NULL && data->hit)
+    return g_bytes_get_data (data->payload, NULL);
+
+  return rest_proxy_call_get_payload (call);
+}
+
+/*
+ * gfbgraph_rest_call_get_payload_length:
+ * @call: a #RestProxyCall run with gfbgraph_rest_call_invoke().
+ *
+ * Returns: the length of the payload returned by gfbgraph_rest_call_get_payload().
+ */
+goffset
+gfbgraph_rest_call_get_payload_length (RestProxyCall *call)
+{
+  CacheData *data;
+
+  data = g_object_get_qdata (G_OBJECT (call), gfbgraph_cache_data_quark ());
+  if (data != NULL && data->hit)
+    return g_bytes_get_size (data->payload) - 1;
+
+  return rest_proxy_call_get_payload_length (call);
+}
+
+/*
+ * gfbgraph_api_error_from_json:
+ * @root: the root #JsonNode of a Graph API response.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Checks if @root is a Graph API error object, like
+ * {"error": {"message": "...", "type": "OAuthException", "code": 190}},
+ * and sets @error from it.
+ *
+ * Returns: %TRUE if @root holds an error.
+ */
+gboolean
+gfbgraph_api_error_from_json (JsonNode  *root,
+                              GError   **error)
+{
+  JsonObject *error_jobject;
+  const gchar *message = NULL;
+  gint code = GFBGRAPH_API_ERROR_UNKNOWN;
+
+  if (root == NULL || !JSON_NODE_HOLDS_OBJECT (root))
+    return FALSE;
+
+  if (!json_object_has_member (json_node_get_object (root), "error"))
+    return FALSE;
+
+  error_jobject = json_object_get_object_member (json_node_get_object (root), "error");
+  if (error_jobject != NULL) {
+    if (json_object_has_member (error_jobject, "code"))
+      code = json_object_get_int_member (error_jobject, "code");
+    if (json_object_has_member (error_jobject, "message"))
+      message = json_object_get_string_member (error_jobject, "message");
+  }
+
+  g_set_error (error, GFBGRAPH_API_ERROR, code,
+               "%s", message != NULL ? message : "Unknown Graph API error");
+
+  return TRUE;
+}
+
+/*
+ * gfbgraph_node_array_to_list:
+ * @nodes: (transfer full) (allow-none): a #GPtrArray of #GFBGraphNode, or %NULL.
+ *
+ * Moves the nodes of @nodes to a #GList, keeping their order, and frees @nodes.
+ * Used to keep the #GList based APIs on top of the array based ones.
+ *
+ * Returns: (transfer full): a newly-allocated #GList with the nodes.
+ */
+GList*
+gfbgraph_node_array_to_list (GPtrArray *nodes)
+{
+  GList *nodes_list = NULL;
+  guint i;
+
+  if (nodes == NULL)
+    return NULL;
+
+  for (i = nodes->len; i > 0; i--)
+    nodes_list = g_list_prepend (nodes_list, g_ptr_array_index (nodes, i - 1));
+
+  /* The references are now owned by the list */
+  g_ptr_array_set_free_func (nodes, NULL);
+  g_ptr_array_unref (nodes);
+
+  return nodes_list;
+}
+
+/*
+ * gfbgraph_api_error_from_payload:
+ * @payload: a Graph API response.
+ * @length: the length of @payload, or -1 if it's nul-terminated.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_api_error_from_json() but taking the unparsed response.
+ *
+ * Returns: %TRUE if @payload holds an error.
+ */
+gboolean
+gfbgraph_api_error_from_payload (const gchar  *payload,
+                                 gssize        length,
+                                 GError      **error)
+{
+  JsonParser *jparser;
+  gboolean is_error = FALSE;
 
-  gfbgraph_authorizer_process_call (authorizer, rest_call);
+  if (payload == NULL)
+    return FALSE;
 
-  g_object_unref (proxy);
+  jparser = json_parser_new ();
+  if (json_parser_load_from_data (jparser, payload, length, NULL))
+    is_error = gfbgraph_api_error_from_json (json_parser_get_root (jparser), error);
+  g_object_unref (jparser);
 
-  return rest_call;
+  return is_error;
 }
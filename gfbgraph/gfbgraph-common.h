@@ -23,6 +23,42 @@
 #include <rest/rest-proxy-call.h>
 #include <gfbgraph/gfbgraph-authorizer.h>
 
-RestProxyCall* gfbgraph_new_rest_call (GFBGraphAuthorizer *authorizer);
+G_BEGIN_DECLS
+
+#define GFBGRAPH_API_ERROR (gfbgraph_api_error_quark ())
+
+/**
+ * GFBGraphApiError:
+ * @GFBGRAPH_API_ERROR_UNKNOWN: Unknown error, or an error without a Graph API error object.
+ * @GFBGRAPH_API_ERROR_SERVICE: Temporary issue in the Graph API service.
+ * @GFBGRAPH_API_ERROR_TOO_MANY_CALLS: Application request limit reached.
+ * @GFBGRAPH_API_ERROR_PERMISSION_DENIED: The permission is not granted or has been removed.
+ * @GFBGRAPH_API_ERROR_USER_TOO_MANY_CALLS: User request limit reached.
+ * @GFBGRAPH_API_ERROR_PAGE_TOO_MANY_CALLS: Page request limit reached.
+ * @GFBGRAPH_API_ERROR_INVALID_PARAMETER: Invalid parameter in the request.
+ * @GFBGRAPH_API_ERROR_OAUTH: The access token is invalid or has expired.
+ * @GFBGRAPH_API_ERROR_RATE_LIMIT: The rate limit of the called API has been exceeded.
+ *
+ * Errors in the #GFBGRAPH_API_ERROR domain. The error code is the "code" member of
+ * the error object returned by the Graph API, so codes not listed here can be found too.
+ **/
+typedef enum
+{
+  GFBGRAPH_API_ERROR_UNKNOWN              = 1,
+  GFBGRAPH_API_ERROR_SERVICE              = 2,
+  GFBGRAPH_API_ERROR_TOO_MANY_CALLS       = 4,
+  GFBGRAPH_API_ERROR_PERMISSION_DENIED    = 10,
+  GFBGRAPH_API_ERROR_USER_TOO_MANY_CALLS  = 17,
+  GFBGRAPH_API_ERROR_PAGE_TOO_MANY_CALLS  = 32,
+  GFBGRAPH_API_ERROR_INVALID_PARAMETER    = 100,
+  GFBGRAPH_API_ERROR_OAUTH                = 190,
+  GFBGRAPH_API_ERROR_RATE_LIMIT           = 613
+} GFBGraphApiError;
+
+GQuark         gfbgraph_api_error_quark (void);
+
+RestProxyCall* gfbgraph_new_rest_call   (GFBGraphAuthorizer *authorizer);
+
+G_END_DECLS
 
 #endif /* __GFBGRAPH_COMMON_H__ */
@@ -27,15 +27,26 @@
  * You can see the posible (not necesary implemented) connections in
  * the section "Connections" in any node object in the
  * <ulink url="https://developers.facebook.com/docs/reference/api/">Facebook Graph API documentation</ulink>
+ *
+ * The connections of every connectable type are read from its interface the
+ * first time the type is used, and kept in a registry indexed by the pair of
+ * types, so checking and resolving a connection doesn't need an instance.
  **/
 
 #include "gfbgraph-connectable.h"
 #include "gfbgraph-node.h"
+#include "gfbgraph-private.h"
 
 #include <json-glib/json-glib.h>
 
 G_DEFINE_INTERFACE (GFBGraphConnectable, gfbgraph_connectable, G_TYPE_OBJECT)
 
+/* The GFBGraphConnection of every pair of types, and the connectable types
+ * already added. The entries are never changed nor removed. */
+static GRWLock     registry_lock;
+static GHashTable *registry = NULL;
+static GHashTable *registered_types = NULL;
+
 static void
 gfbgraph_connectable_default_init (GFBGraphConnectableInterface *iface)
 {
@@ -45,21 +56,61 @@ gfbgraph_connectable_default_init (GFBGraphConnectableInterface *iface)
   iface->parse_connected_data = NULL;
 }
 
-static GHashTable*
-get_connections (GFBGraphConnectableInterface *iface)
+static guint
+connection_hash (gconstpointer key)
 {
-  /* The GHashTable contains the connections for a node.
-   * The key must be the g_type_name() of a GFBGRAPH_TYPE_NODE, and the value
-   * must be the function name to call in order to retrieve the nodes connected
-   * to the GFBGraphNode indicated by GFBGRAPH_TYPE_NODE.
-   */
-  GHashTable *connections;
-
-  connections = iface->connections;
-  /* If no connections... Why you implement this iface? */
-  g_assert (g_hash_table_size (connections) > 0);
-
-  return connections;
+  const GFBGraphConnection *connection = key;
+
+  return g_direct_hash (GSIZE_TO_POINTER (connection->node_type)) * 31 +
+    g_direct_hash (GSIZE_TO_POINTER (connection->parent_type));
+}
+
+static gboolean
+connection_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const GFBGraphConnection *connection_a = a;
+  const GFBGraphConnection *connection_b = b;
+
+  return connection_a->node_type == connection_b->node_type &&
+    connection_a->parent_type == connection_b->parent_type;
+}
+
+/* Adds the connections of node_type to the registry, with the writer lock held */
+static void
+register_type (GType node_type)
+{
+  GFBGraphConnectableInterface *iface;
+  GHashTableIter iter;
+  const gchar *type_name;
+  const gchar *path;
+  gpointer klass;
+
+  if (registry == NULL) {
+    registry = g_hash_table_new (connection_hash, connection_equal);
+    registered_types = g_hash_table_new (g_direct_hash, g_direct_equal);
+  }
+
+  /* The class is kept, like the iface pointed by the entries */
+  klass = g_type_class_ref (node_type);
+  iface = g_type_interface_peek (klass, GFBGRAPH_TYPE_CONNECTABLE);
+
+  /* The keys of iface->connections are the g_type_name() of the nodes where
+   * node_type can be connected, and the values the function paths */
+  g_assert (iface->connections != NULL && g_hash_table_size (iface->connections) > 0);
+  g_hash_table_iter_init (&iter, iface->connections);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &type_name, (gpointer *) &path)) {
+    GFBGraphConnection *connection;
+
+    connection = g_new0 (GFBGraphConnection, 1);
+    connection->node_type = node_type;
+    connection->parent_type = g_type_from_name (type_name);
+    connection->path = path;
+    connection->iface = iface;
+    g_hash_table_add (registry, connection);
+  }
+
+  g_hash_table_add (registered_types, GSIZE_TO_POINTER (node_type));
 }
 
 /**
@@ -130,16 +181,10 @@ gboolean
 gfbgraph_connectable_is_connectable_to (GFBGraphConnectable *self,
                                         GType                node_type)
 {
-  GFBGraphConnectableInterface *iface;
-  GHashTable *connections;
-
   g_return_val_if_fail (GFBGRAPH_IS_CONNECTABLE (self), FALSE);
   g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), FALSE);
 
-  iface = GFBGRAPH_CONNECTABLE_GET_IFACE (self);
-
-  connections = get_connections (iface);
-  return g_hash_table_contains (connections, g_type_name (node_type));
+  return gfbgraph_connectable_lookup_connection (G_OBJECT_TYPE (self), node_type, NULL) != NULL;
 }
 
 /**
@@ -156,17 +201,102 @@ const gchar*
 gfbgraph_connectable_get_connection_path (GFBGraphConnectable *self,
                                           GType                node_type)
 {
-  GFBGraphConnectableInterface *iface;
-  GHashTable *connections;
+  const GFBGraphConnection *connection;
 
   g_return_val_if_fail (GFBGRAPH_IS_CONNECTABLE (self), NULL);
   g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
-  g_return_val_if_fail (gfbgraph_connectable_is_connectable_to (self, node_type), NULL);
 
-  iface = GFBGRAPH_CONNECTABLE_GET_IFACE (self);
+  connection = gfbgraph_connectable_lookup_connection (G_OBJECT_TYPE (self), node_type, NULL);
+  g_return_val_if_fail (connection != NULL, NULL);
 
-  connections = get_connections (iface);
-  return (const gchar *) g_hash_table_lookup (connections, g_type_name (node_type));
+  return connection->path;
+}
+
+typedef struct
+{
+  GType          node_type;
+  GPtrArray     *nodes;
+  RestProxyCall *call;
+  gint64         deserialize_start;
+  gint64         deserialize_time;
+} ParseConnectedData;
+
+static void
+parse_connected_element (JsonNode           *element,
+                         ParseConnectedData *data)
+{
+  GFBGraphNode *node;
+  gint64 timer;
+
+  timer = gfbgraph_rest_call_start_timer (data->call);
+  node = gfbgraph_node_deserialize (data->node_type, element);
+  g_ptr_array_add (data->nodes, node);
+  if (timer != 0) {
+    if (data->deserialize_start == 0)
+      data->deserialize_start = timer;
+    data->deserialize_time += g_get_monotonic_time () - timer;
+  }
+}
+
+/* The page is scanned incrementally, so only one element is held as a JsonNode
+ * tree at a time. With G_TYPE_INVALID as node_type, only the paging is parsed.
+ * The time spent in the elements is recorded in the metrics of call as
+ * deserialization time, the rest as parse time. The trace has one
+ * "deserialize" span for all the elements, with their number, inside the
+ * "parse" span of the page, a span per element would cost more than most of
+ * them. */
+static GPtrArray*
+parse_connected_data (GType            node_type,
+                      RestProxyCall   *call,
+                      const gchar     *payload,
+                      gchar          **after,
+                      gchar          **next,
+                      GError         **error)
+{
+  GFBGraphPageParser *parser;
+  ParseConnectedData data;
+  gint64 timer;
+
+  if (after != NULL)
+    *after = NULL;
+  if (next != NULL)
+    *next = NULL;
+
+  data.node_type = node_type;
+  data.nodes = g_ptr_array_new_with_free_func (g_object_unref);
+  data.call = call;
+  data.deserialize_start = 0;
+  data.deserialize_time = 0;
+
+  timer = gfbgraph_rest_call_start_timer (call);
+
+  parser = gfbgraph_page_parser_new (node_type != G_TYPE_INVALID ? (GFBGraphPageParserElementFunc) parse_connected_element : NULL,
+                                     &data);
+  if (!gfbgraph_page_parser_feed (parser, payload, -1, error) ||
+      !gfbgraph_page_parser_end (parser, after, next, error))
+    g_clear_pointer (&data.nodes, g_ptr_array_unref);
+  gfbgraph_page_parser_free (parser);
+
+  if (timer != 0) {
+    GFBGraphMetrics *metrics;
+    gint64 now = g_get_monotonic_time ();
+
+    metrics = gfbgraph_rest_call_get_metrics (call);
+    if (metrics != NULL) {
+      const gchar *method = rest_proxy_call_get_method (call);
+      const gchar *function = rest_proxy_call_get_function (call);
+
+      gfbgraph_metrics_record_parse (metrics, method, function, now - timer - data.deserialize_time);
+      gfbgraph_metrics_record_deserialize (metrics, method, function, data.deserialize_time);
+    }
+    if (data.deserialize_start != 0)
+      gfbgraph_rest_call_trace_items (call, "deserialize", data.deserialize_start,
+                                      data.deserialize_start + data.deserialize_time,
+                                      data.nodes != NULL ? data.nodes->len : 0, NULL);
+    gfbgraph_rest_call_trace (call, "parse", timer, now, error != NULL ? *error : NULL);
+  }
+
+  return data.nodes;
 }
 
 /**
@@ -189,33 +319,157 @@ gfbgraph_connectable_default_parse_connected_data (GFBGraphConnectable  *self,
                                                    const gchar          *payload,
                                                    GError              **error)
 {
-  GList *nodes_list = NULL;
-  JsonParser *jparser;
-  GType node_type;
-
-  node_type = G_OBJECT_TYPE (self);
-
-  jparser = json_parser_new ();
-  if (json_parser_load_from_data (jparser, payload, -1, error)) {
-    JsonNode *root_jnode;
-    JsonObject *main_jobject;
-    JsonArray *nodes_jarray;
-    int i = 0;
-
-    root_jnode = json_parser_get_root (jparser);
-    main_jobject = json_node_get_object (root_jnode);
-    nodes_jarray = json_object_get_array_member (main_jobject, "data");
-    for (i = 0; i < json_array_get_length (nodes_jarray); i++) {
-      JsonNode *jnode;
-      GFBGraphNode *node;
-
-      jnode = json_array_get_element (nodes_jarray, i);
-      node = GFBGRAPH_NODE (json_gobject_deserialize (node_type, jnode));
-      nodes_list = g_list_append (nodes_list, node);
-    }
+  return gfbgraph_node_array_to_list (parse_connected_data (G_OBJECT_TYPE (self), NULL, payload, NULL, NULL, error));
+}
+
+/* --- Private API --- */
+
+/*
+ * gfbgraph_connectable_parse_connected_page:
+ * @self: a #GFBGraphConnectable.
+ * @payload: a const #gchar with the response string from the Facebook Graph API.
+ * @after: (out) (allow-none): return location for the "after" cursor of the next page, or %NULL.
+ * @next: (out) (allow-none): return location for the URL of the next page, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_connectable_parse_connected_data(), but also returns the "paging"
+ * information of the response. When there isn't a next page, @next is set to %NULL.
+ *
+ * Returns: (element-type GFBGraphNode) (transfer full): a newly-allocated #GPtrArray of #GFBGraphNode,
+ * or %NULL in case of error.
+ */
+GPtrArray*
+gfbgraph_connectable_parse_connected_page (GFBGraphConnectable  *self,
+                                           const gchar          *payload,
+                                           gchar               **after,
+                                           gchar               **next,
+                                           GError              **error)
+{
+  GFBGraphConnectableInterface *iface;
+  GPtrArray *nodes;
+  GPtrArray *paging;
+  GList *nodes_list;
+  GList *l;
+  GError *local_error = NULL;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CONNECTABLE (self), NULL);
+
+  iface = GFBGRAPH_CONNECTABLE_GET_IFACE (self);
+  if (iface->parse_connected_data == gfbgraph_connectable_default_parse_connected_data)
+    return parse_connected_data (G_OBJECT_TYPE (self), NULL, payload, after, next, error);
+
+  /* Custom parsers don't know about the paging, so we parse it on our own */
+  nodes_list = gfbgraph_connectable_parse_connected_data (self, payload, &local_error);
+  if (local_error != NULL) {
+    g_propagate_error (error, local_error);
+    return NULL;
+  }
+
+  nodes = g_ptr_array_new_full (g_list_length (nodes_list), g_object_unref);
+  for (l = nodes_list; l != NULL; l = l->next)
+    g_ptr_array_add (nodes, l->data);
+  g_list_free (nodes_list);
+
+  /* Only the paging is parsed, so the returned array is always empty */
+  paging = parse_connected_data (G_TYPE_INVALID, NULL, payload, after, next, NULL);
+  if (paging != NULL)
+    g_ptr_array_unref (paging);
+
+  return nodes;
+}
+
+/*
+ * gfbgraph_connectable_lookup_connection:
+ * @node_type: the #GType of the connected nodes.
+ * @parent_type: the #GType of the node they're connected to.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Looks up the connection between nodes of @parent_type and nodes of
+ * @node_type. Besides the first time @node_type is used, it doesn't allocate.
+ *
+ * Returns: (transfer none): the #GFBGraphConnection, valid forever, or %NULL
+ * if @node_type isn't connectable to @parent_type.
+ */
+const GFBGraphConnection*
+gfbgraph_connectable_lookup_connection (GType    node_type,
+                                        GType    parent_type,
+                                        GError **error)
+{
+  GFBGraphConnection key;
+  const GFBGraphConnection *connection = NULL;
+  gboolean registered = FALSE;
+
+  if (g_type_is_a (node_type, GFBGRAPH_TYPE_CONNECTABLE) == FALSE) {
+    g_set_error (error, GFBGRAPH_NODE_ERROR,
+                 GFBGRAPH_NODE_ERROR_NO_CONNECTABLE,
+                 "The given node type (%s) doesn't implement connectable interface", g_type_name (node_type));
+    return NULL;
   }
 
-  g_clear_object (&jparser);
+  key.node_type = node_type;
+  key.parent_type = parent_type;
+
+  g_rw_lock_reader_lock (&registry_lock);
+  if (registry != NULL) {
+    connection = g_hash_table_lookup (registry, &key);
+    registered = g_hash_table_contains (registered_types, GSIZE_TO_POINTER (node_type));
+  }
+  g_rw_lock_reader_unlock (&registry_lock);
+
+  if (!registered) {
+    g_rw_lock_writer_lock (&registry_lock);
+    if (registry == NULL || !g_hash_table_contains (registered_types, GSIZE_TO_POINTER (node_type)))
+      register_type (node_type);
+    connection = g_hash_table_lookup (registry, &key);
+    g_rw_lock_writer_unlock (&registry_lock);
+  }
+
+  if (connection == NULL) {
+    g_set_error (error, GFBGRAPH_NODE_ERROR,
+                 GFBGRAPH_NODE_ERROR_NO_CONNECTABLE,
+                 "The given node type (%s) can't connect with a %s node", g_type_name (node_type), g_type_name (parent_type));
+  }
+
+  return connection;
+}
+
+/*
+ * gfbgraph_connectable_parse_connection_page:
+ * @connection: a #GFBGraphConnection.
+ * @call: (allow-none): the #RestProxyCall of the page, to record the time spent, or %NULL.
+ * @payload: a const #gchar with the response string from the Facebook Graph API.
+ * @after: (out) (allow-none): return location for the "after" cursor of the next page, or %NULL.
+ * @next: (out) (allow-none): return location for the URL of the next page, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_connectable_parse_connected_page(), without an instance of
+ * the connected type. Only the types with their own parser need one, which
+ * is created for the call.
+ *
+ * Returns: (element-type GFBGraphNode) (transfer full): a newly-allocated #GPtrArray of #GFBGraphNode,
+ * or %NULL in case of error.
+ */
+GPtrArray*
+gfbgraph_connectable_parse_connection_page (const GFBGraphConnection  *connection,
+                                            RestProxyCall             *call,
+                                            const gchar               *payload,
+                                            gchar                    **after,
+                                            gchar                    **next,
+                                            GError                   **error)
+{
+  GFBGraphConnectable *connectable;
+  GPtrArray *nodes;
+  gint64 timer;
+
+  if (connection->iface->parse_connected_data == gfbgraph_connectable_default_parse_connected_data)
+    return parse_connected_data (connection->node_type, call, payload, after, next, error);
+
+  /* A custom parser does both, it's all deserialization time */
+  timer = gfbgraph_rest_call_start_timer (call);
+  connectable = g_object_new (connection->node_type, NULL);
+  nodes = gfbgraph_connectable_parse_connected_page (connectable, payload, after, next, error);
+  g_object_unref (connectable);
+  gfbgraph_rest_call_stop_deserialize_timer (call, &timer);
 
-  return nodes_list;
+  return nodes;
 }
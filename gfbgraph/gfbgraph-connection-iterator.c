@@ -0,0 +1,715 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-connection-iterator
+ * @short_description: Page by page retrieval of connected nodes
+ * @stability: Unstable
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * The Facebook Graph API splits big connections, like the albums of a user or
+ * the photos of an album, in pages. gfbgraph_node_get_connection_nodes() only
+ * returns the first one, #GFBGraphConnectionIterator follows the "paging"
+ * information of the responses to retrieve all of them.
+ *
+ * Each call to gfbgraph_connection_iterator_next_page() returns the nodes of the
+ * next page. While the caller processes them, the following page is prefetched
+ * in a thread of the #GTask pool.
+ *
+ * |[
+ * iter = gfbgraph_connection_iterator_new (GFBGRAPH_NODE (album), GFBGRAPH_TYPE_PHOTO, authorizer, 100);
+ * while ((photos = gfbgraph_connection_iterator_next_page (iter, NULL, &error)) != NULL) {
+ *   ...
+ *   g_list_free_full (photos, g_object_unref);
+ * }
+ * ]|
+ **/
+
+#include <libsoup/soup.h>
+
+#include "gfbgraph-common.h"
+#include "gfbgraph-connectable.h"
+#include "gfbgraph-connection-iterator.h"
+#include "gfbgraph-private.h"
+
+typedef struct
+{
+  GFBGraphNode        *node;
+  GType                node_type;
+  GFBGraphAuthorizer  *authorizer;
+  guint                limit;
+  gboolean             prefetch;
+
+  /* The connection used to parse the pages */
+  const GFBGraphConnection *connection;
+  gchar               *function_path;
+  gchar               *fields;
+  gint64               since;
+  gint64               until;
+
+  /* Protected by mutex */
+  GMutex               mutex;
+  GCond                cond;
+  gchar               *after;
+  gchar               *next;
+  gboolean             started;
+  gboolean             done;
+  gboolean             prefetching;
+  gboolean             prefetched;
+  GList               *prefetch_nodes;
+  GError              *prefetch_error;
+} GFBGraphConnectionIteratorPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphConnectionIterator, gfbgraph_connection_iterator, G_TYPE_OBJECT)
+
+enum {
+  PROP_0,
+  PROP_NODE,
+  PROP_NODE_TYPE,
+  PROP_AUTHORIZER,
+  PROP_LIMIT,
+  PROP_PREFETCH,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE(_obj) gfbgraph_connection_iterator_get_instance_private (GFBGRAPH_CONNECTION_ITERATOR (_obj))
+
+
+/* --- GObject --- */
+static void
+gfbgraph_connection_iterator_dispose (GObject *object)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (object);
+
+  g_clear_object (&priv->node);
+  g_clear_object (&priv->authorizer);
+
+  G_OBJECT_CLASS (gfbgraph_connection_iterator_parent_class)->dispose (object);
+}
+
+static void
+gfbgraph_connection_iterator_finalize (GObject *object)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (object);
+
+  g_free (priv->function_path);
+  g_free (priv->fields);
+  g_free (priv->after);
+  g_free (priv->next);
+  g_list_free_full (priv->prefetch_nodes, g_object_unref);
+  g_clear_error (&priv->prefetch_error);
+
+  g_mutex_clear (&priv->mutex);
+  g_cond_clear (&priv->cond);
+
+  G_OBJECT_CLASS (gfbgraph_connection_iterator_parent_class)->finalize (object);
+}
+
+static void
+gfbgraph_connection_iterator_set_property (GObject      *object,
+                                           guint         prop_id,
+                                           const GValue *value,
+                                           GParamSpec   *pspec)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_NODE:
+      priv->node = g_value_dup_object (value);
+      break;
+
+    case PROP_NODE_TYPE:
+      priv->node_type = g_value_get_gtype (value);
+      break;
+
+    case PROP_AUTHORIZER:
+      priv->authorizer = g_value_dup_object (value);
+      break;
+
+    case PROP_LIMIT:
+      priv->limit = g_value_get_uint (value);
+      break;
+
+    case PROP_PREFETCH:
+      priv->prefetch = g_value_get_boolean (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_connection_iterator_get_property (GObject    *object,
+                                           guint       prop_id,
+                                           GValue     *value,
+                                           GParamSpec *pspec)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_NODE:
+      g_value_set_object (value, priv->node);
+      break;
+
+    case PROP_NODE_TYPE:
+      g_value_set_gtype (value, priv->node_type);
+      break;
+
+    case PROP_AUTHORIZER:
+      g_value_set_object (value, priv->authorizer);
+      break;
+
+    case PROP_LIMIT:
+      g_value_set_uint (value, priv->limit);
+      break;
+
+    case PROP_PREFETCH:
+      g_value_set_boolean (value, priv->prefetch);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_connection_iterator_class_init (GFBGraphConnectionIteratorClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->dispose = gfbgraph_connection_iterator_dispose;
+  gobject_class->finalize = gfbgraph_connection_iterator_finalize;
+  gobject_class->set_property = gfbgraph_connection_iterator_set_property;
+  gobject_class->get_property = gfbgraph_connection_iterator_get_property;
+
+  /**
+   * GFBGraphConnectionIterator:node:
+   *
+   * The node which connections are retrieved.
+   **/
+  properties [PROP_NODE] =
+    g_param_spec_object ("node",
+                         "The node",
+                         "The node which connections are retrieved",
+                         GFBGRAPH_TYPE_NODE,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphConnectionIterator:node-type:
+   *
+   * The #GType of the connected nodes, it must implement the #GFBGraphConnectable interface.
+   **/
+  properties [PROP_NODE_TYPE] =
+    g_param_spec_gtype ("node-type",
+                        "The connected nodes type",
+                        "The type of the nodes connected to the node",
+                        GFBGRAPH_TYPE_NODE,
+                        G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphConnectionIterator:authorizer:
+   *
+   * The #GFBGraphAuthorizer used to request the pages.
+   **/
+  properties [PROP_AUTHORIZER] =
+    g_param_spec_object ("authorizer",
+                         "The authorizer",
+                         "The authorizer used to request the pages",
+                         GFBGRAPH_TYPE_AUTHORIZER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphConnectionIterator:limit:
+   *
+   * The number of nodes requested per page, 0 to use the Graph API default.
+   **/
+  properties [PROP_LIMIT] =
+    g_param_spec_uint ("limit",
+                       "Page size",
+                       "The number of nodes requested per page",
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  /**
+   * GFBGraphConnectionIterator:prefetch:
+   *
+   * Whether the next page is requested while the current one is processed.
+   **/
+  properties [PROP_PREFETCH] =
+    g_param_spec_boolean ("prefetch",
+                          "Prefetch",
+                          "Whether the next page is requested in advance",
+                          TRUE,
+                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+static void
+gfbgraph_connection_iterator_init (GFBGraphConnectionIterator *iterator)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+
+  g_mutex_init (&priv->mutex);
+  g_cond_init (&priv->cond);
+}
+
+/* --- Internal methods --- */
+static gboolean
+gfbgraph_connection_iterator_resolve (GFBGraphConnectionIterator  *iterator,
+                                      GError                     **error)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+  if (priv->connection != NULL)
+    return TRUE;
+
+  priv->connection = gfbgraph_connectable_lookup_connection (priv->node_type, G_OBJECT_TYPE (priv->node), error);
+  if (priv->connection == NULL)
+    return FALSE;
+
+  priv->function_path = g_strdup_printf ("%s/%s", gfbgraph_node_get_id (priv->node), priv->connection->path);
+
+  return TRUE;
+}
+
+static void
+add_next_page_params (RestProxyCall *rest_call,
+                      const gchar   *after,
+                      const gchar   *next)
+{
+  SoupURI *uri;
+  GHashTable *params;
+  GHashTableIter iter;
+  const gchar *key;
+  const gchar *value;
+
+  if (after != NULL) {
+    rest_proxy_call_add_param (rest_call, "after", after);
+    return;
+  }
+
+  /* Time or offset based paging, reuse the params of the "next" URL */
+  uri = soup_uri_new (next);
+  if (uri == NULL || soup_uri_get_query (uri) == NULL) {
+    g_clear_pointer (&uri, soup_uri_free);
+    return;
+  }
+
+  params = soup_form_decode (soup_uri_get_query (uri));
+  g_hash_table_iter_init (&iter, params);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &key, (gpointer *) &value)) {
+    if (g_strcmp0 (key, "access_token") != 0)
+      rest_proxy_call_add_param (rest_call, key, value);
+  }
+
+  g_hash_table_unref (params);
+  soup_uri_free (uri);
+}
+
+/* Requests the page pointed by the current cursor and moves the cursor to the
+ * following one. It can be called from any thread. */
+static GList*
+gfbgraph_connection_iterator_load_page (GFBGraphConnectionIterator  *iterator,
+                                        GCancellable                *cancellable,
+                                        GError                     **error)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+  RestProxyCall *rest_call;
+  GList *nodes = NULL;
+  gchar *after;
+  gchar *next;
+  gchar *fields;
+  gint64 since;
+  gint64 until;
+  gboolean started;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return NULL;
+
+  g_mutex_lock (&priv->mutex);
+  started = priv->started;
+  fields = g_strdup (priv->fields);
+  since = priv->since;
+  until = priv->until;
+  after = g_strdup (priv->after);
+  next = g_strdup (priv->next);
+  g_mutex_unlock (&priv->mutex);
+
+  rest_call = gfbgraph_new_rest_call (priv->authorizer);
+  rest_proxy_call_set_method (rest_call, "GET");
+  rest_proxy_call_set_function (rest_call, priv->function_path);
+  gfbgraph_rest_call_set_node_type (rest_call, priv->node_type);
+  if (priv->limit > 0) {
+    gchar *limit;
+
+    limit = g_strdup_printf ("%u", priv->limit);
+    rest_proxy_call_add_param (rest_call, "limit", limit);
+    g_free (limit);
+  }
+  if (fields != NULL)
+    rest_proxy_call_add_param (rest_call, "fields", fields);
+  if (since > 0) {
+    gchar *param;
+
+    param = g_strdup_printf ("%" G_GINT64_FORMAT, since);
+    rest_proxy_call_add_param (rest_call, "since", param);
+    g_free (param);
+  }
+  if (until > 0) {
+    gchar *param;
+
+    param = g_strdup_printf ("%" G_GINT64_FORMAT, until);
+    rest_proxy_call_add_param (rest_call, "until", param);
+    g_free (param);
+  }
+  if (started)
+    add_next_page_params (rest_call, after, next);
+
+  g_free (after);
+  g_free (next);
+  g_free (fields);
+
+  if (gfbgraph_rest_call_invoke (rest_call, cancellable, error)) {
+    const gchar *payload;
+    GError *local_error = NULL;
+
+    payload = gfbgraph_rest_call_get_payload (rest_call);
+    nodes = gfbgraph_node_array_to_list (gfbgraph_connectable_parse_connection_page (priv->connection, rest_call,
+                                                                                     payload, &after, &next,
+                                                                                     &local_error));
+    if (local_error == NULL) {
+      g_mutex_lock (&priv->mutex);
+      g_free (priv->after);
+      g_free (priv->next);
+      priv->after = after;
+      priv->next = next;
+      priv->started = TRUE;
+      priv->done = (next == NULL);
+      g_mutex_unlock (&priv->mutex);
+    } else {
+      g_propagate_error (error, local_error);
+    }
+  }
+
+  g_object_unref (rest_call);
+
+  return nodes;
+}
+
+static void
+gfbgraph_connection_iterator_prefetch_thread (GTask        *task,
+                                              gpointer      source_object,
+                                              gpointer      task_data,
+                                              GCancellable *cancellable)
+{
+  GFBGraphConnectionIterator *iterator = GFBGRAPH_CONNECTION_ITERATOR (task_data);
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+  GList *nodes;
+  GError *error = NULL;
+
+  nodes = gfbgraph_connection_iterator_load_page (iterator, cancellable, &error);
+
+  g_mutex_lock (&priv->mutex);
+  priv->prefetch_nodes = nodes;
+  priv->prefetch_error = error;
+  priv->prefetched = TRUE;
+  priv->prefetching = FALSE;
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->mutex);
+
+  g_object_unref (iterator);
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+gfbgraph_connection_iterator_start_prefetch (GFBGraphConnectionIterator *iterator,
+                                             GCancellable               *cancellable)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+  GTask *task;
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->done || priv->prefetching || priv->prefetched) {
+    g_mutex_unlock (&priv->mutex);
+    return;
+  }
+  priv->prefetching = TRUE;
+  g_mutex_unlock (&priv->mutex);
+
+  /* The thread keeps the iterator alive until the page is loaded. The task
+   * doesn't, it lives until its context dispatches its completion, that may
+   * never happen in a synchronous application */
+  task = g_task_new (NULL, cancellable, NULL, NULL);
+  g_task_set_source_tag (task, gfbgraph_connection_iterator_start_prefetch);
+  g_task_set_task_data (task, g_object_ref (iterator), NULL);
+  g_task_run_in_thread (task, gfbgraph_connection_iterator_prefetch_thread);
+  g_object_unref (task);
+}
+
+/* Wakes up the next_page() waiting for a prefetch when it's cancelled */
+static void
+gfbgraph_connection_iterator_cancelled_cb (GCancellable               *cancellable,
+                                           GFBGraphConnectionIterator *iterator)
+{
+  GFBGraphConnectionIteratorPrivate *priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+
+  g_mutex_lock (&priv->mutex);
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->mutex);
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_connection_iterator_new:
+ * @node: a #GFBGraphNode which connected nodes will be retrieved.
+ * @node_type: a #GFBGraphNode type #GType, implementing the #GFBGraphConnectable interface.
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @limit: the number of nodes per page, or 0 to use the Graph API default.
+ *
+ * Creates a new #GFBGraphConnectionIterator to retrieve all the nodes of type @node_type
+ * connected to @node. No request is done until gfbgraph_connection_iterator_next_page()
+ * is called.
+ *
+ * Returns: (transfer full): a new #GFBGraphConnectionIterator; unref with g_object_unref()
+ **/
+GFBGraphConnectionIterator*
+gfbgraph_connection_iterator_new (GFBGraphNode        *node,
+                                  GType                node_type,
+                                  GFBGraphAuthorizer  *authorizer,
+                                  guint                limit)
+{
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), NULL);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
+
+  return GFBGRAPH_CONNECTION_ITERATOR (g_object_new (GFBGRAPH_TYPE_CONNECTION_ITERATOR,
+                                                     "node", node,
+                                                     "node-type", node_type,
+                                                     "authorizer", authorizer,
+                                                     "limit", limit,
+                                                     NULL));
+}
+
+/**
+ * gfbgraph_connection_iterator_next_page:
+ * @iterator: a #GFBGraphConnectionIterator.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Retrieves the nodes of the next page of the connection. If the page was prefetched
+ * it returns without doing any request, otherwise it blocks until the page is loaded.
+ * Empty pages are skipped.
+ *
+ * The following page is prefetched with @cancellable, cancelling it also aborts
+ * the prefetch. A cancelled call returns at once, even while a prefetched page is
+ * in flight.
+ *
+ * Returns: (element-type GFBGraphNode) (transfer full): a newly-allocated #GList with
+ * the nodes of the page, or %NULL when there aren't more pages or in case of error.
+ **/
+GList*
+gfbgraph_connection_iterator_next_page (GFBGraphConnectionIterator  *iterator,
+                                        GCancellable                *cancellable,
+                                        GError                     **error)
+{
+  GFBGraphConnectionIteratorPrivate *priv;
+  GList *nodes = NULL;
+  GError *local_error = NULL;
+  gboolean done = FALSE;
+  gulong cancelled_id = 0;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CONNECTION_ITERATOR (iterator), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return NULL;
+
+  if (!gfbgraph_connection_iterator_resolve (iterator, error))
+    return NULL;
+
+  if (cancellable != NULL)
+    cancelled_id = g_cancellable_connect (cancellable,
+                                          G_CALLBACK (gfbgraph_connection_iterator_cancelled_cb),
+                                          iterator, NULL);
+
+  while (nodes == NULL && !done) {
+    g_mutex_lock (&priv->mutex);
+    while (priv->prefetching && !g_cancellable_is_cancelled (cancellable))
+      g_cond_wait (&priv->cond, &priv->mutex);
+
+    if (priv->prefetching) {
+      /* The prefetch sees the cancellation too, and keeps the cursor */
+      g_mutex_unlock (&priv->mutex);
+      g_cancellable_set_error_if_cancelled (cancellable, &local_error);
+    } else if (priv->prefetched) {
+      nodes = priv->prefetch_nodes;
+      local_error = priv->prefetch_error;
+      priv->prefetch_nodes = NULL;
+      priv->prefetch_error = NULL;
+      priv->prefetched = FALSE;
+      g_mutex_unlock (&priv->mutex);
+
+      /* A prefetch cancelled by a previous call is requested again */
+      if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED) &&
+          !g_cancellable_is_cancelled (cancellable))
+        g_clear_error (&local_error);
+    } else if (priv->done) {
+      g_mutex_unlock (&priv->mutex);
+      break;
+    } else {
+      g_mutex_unlock (&priv->mutex);
+      nodes = gfbgraph_connection_iterator_load_page (iterator, cancellable, &local_error);
+    }
+
+    if (local_error != NULL)
+      break;
+
+    done = gfbgraph_connection_iterator_is_done (iterator);
+  }
+
+  g_cancellable_disconnect (cancellable, cancelled_id);
+
+  if (local_error != NULL) {
+    g_list_free_full (nodes, g_object_unref);
+    g_propagate_error (error, local_error);
+    return NULL;
+  }
+
+  if (priv->prefetch && !done)
+    gfbgraph_connection_iterator_start_prefetch (iterator, cancellable);
+
+  return nodes;
+}
+
+/**
+ * gfbgraph_connection_iterator_is_done:
+ * @iterator: a #GFBGraphConnectionIterator.
+ *
+ * Returns: %TRUE if the last page of the connection has been loaded.
+ **/
+gboolean
+gfbgraph_connection_iterator_is_done (GFBGraphConnectionIterator *iterator)
+{
+  GFBGraphConnectionIteratorPrivate *priv;
+  gboolean done;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CONNECTION_ITERATOR (iterator), TRUE);
+
+  priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+
+  g_mutex_lock (&priv->mutex);
+  done = priv->done;
+  g_mutex_unlock (&priv->mutex);
+
+  return done;
+}
+
+/**
+ * gfbgraph_connection_iterator_set_fields:
+ * @iterator: a #GFBGraphConnectionIterator.
+ * @fields: (array zero-terminated=1) (allow-none): a %NULL-terminated array with the
+ * Graph API fields to retrieve, or %NULL.
+ *
+ * Restricts the fields retrieved for each connected node to @fields. If @fields is
+ * %NULL, the fields are the properties of the #GFBGraphConnectionIterator:node-type
+ * type. It must be called before requesting the first page.
+ **/
+void
+gfbgraph_connection_iterator_set_fields (GFBGraphConnectionIterator *iterator,
+                                         const gchar * const        *fields)
+{
+  GFBGraphConnectionIteratorPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_CONNECTION_ITERATOR (iterator));
+
+  priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->started || priv->prefetching) {
+    g_mutex_unlock (&priv->mutex);
+    g_warning ("The fields of a GFBGraphConnectionIterator can't be changed once started");
+    return;
+  }
+
+  g_free (priv->fields);
+  priv->fields = gfbgraph_node_fields_to_param (priv->node_type, fields);
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gfbgraph_connection_iterator_set_time_range:
+ * @iterator: a #GFBGraphConnectionIterator.
+ * @since: a UNIX time, or 0.
+ * @until: a UNIX time, or 0.
+ *
+ * Restricts the connected nodes to the ones in the time range given by the
+ * "since" and "until" Graph API parameters. For albums and photos, the range
+ * applies to their "created_time", the nodes edited inside it aren't listed.
+ * A 0 value leaves that end of the range unbounded. It must be called before
+ * requesting the first page.
+ **/
+void
+gfbgraph_connection_iterator_set_time_range (GFBGraphConnectionIterator *iterator,
+                                             gint64                      since,
+                                             gint64                      until)
+{
+  GFBGraphConnectionIteratorPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_CONNECTION_ITERATOR (iterator));
+  g_return_if_fail (since >= 0 && until >= 0);
+
+  priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+
+  g_mutex_lock (&priv->mutex);
+  if (priv->started || priv->prefetching) {
+    g_mutex_unlock (&priv->mutex);
+    g_warning ("The time range of a GFBGraphConnectionIterator can't be changed once started");
+    return;
+  }
+
+  priv->since = since;
+  priv->until = until;
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gfbgraph_connection_iterator_get_limit:
+ * @iterator: a #GFBGraphConnectionIterator.
+ *
+ * Returns: the number of nodes requested per page, 0 if the Graph API default is used.
+ **/
+guint
+gfbgraph_connection_iterator_get_limit (GFBGraphConnectionIterator *iterator)
+{
+  GFBGraphConnectionIteratorPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_CONNECTION_ITERATOR (iterator), 0);
+
+  priv = GFBGRAPH_CONNECTION_ITERATOR_GET_PRIVATE (iterator);
+
+  return priv->limit;
+}
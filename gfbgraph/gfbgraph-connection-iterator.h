@@ -0,0 +1,63 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_CONNECTION_ITERATOR_H__
+#define __GFBGRAPH_CONNECTION_ITERATOR_H__
+
+#include <gio/gio.h>
+#include <gfbgraph/gfbgraph-authorizer.h>
+#include <gfbgraph/gfbgraph-node.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_CONNECTION_ITERATOR (gfbgraph_connection_iterator_get_type())
+
+G_DECLARE_DERIVABLE_TYPE (GFBGraphConnectionIterator, gfbgraph_connection_iterator, GFBGRAPH, CONNECTION_ITERATOR, GObject)
+
+struct _GFBGraphConnectionIteratorClass
+{
+  GObjectClass parent_class;
+
+  gpointer  _reserved1;
+  gpointer  _reserved2;
+  gpointer  _reserved3;
+  gpointer  _reserved4;
+  gpointer  _reserved5;
+  gpointer  _reserved6;
+};
+
+GFBGraphConnectionIterator* gfbgraph_connection_iterator_new       (GFBGraphNode        *node,
+                                                                    GType                node_type,
+                                                                    GFBGraphAuthorizer  *authorizer,
+                                                                    guint                limit);
+
+GList*                      gfbgraph_connection_iterator_next_page (GFBGraphConnectionIterator  *iterator,
+                                                                    GCancellable                *cancellable,
+                                                                    GError                     **error);
+gboolean                    gfbgraph_connection_iterator_is_done   (GFBGraphConnectionIterator  *iterator);
+guint                       gfbgraph_connection_iterator_get_limit (GFBGraphConnectionIterator  *iterator);
+void                        gfbgraph_connection_iterator_set_fields (GFBGraphConnectionIterator *iterator,
+                                                                     const gchar * const        *fields);
+void                        gfbgraph_connection_iterator_set_time_range (GFBGraphConnectionIterator *iterator,
+                                                                         gint64                      since,
+                                                                         gint64                      until);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_CONNECTION_ITERATOR_H__ */
@@ -0,0 +1,583 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-disk-cache
+ * @title: GFBGraphDiskCache
+ * @short_description: On-disk response cache.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphDiskCache is a #GFBGraphCache keeping every response in its own
+ * file inside #GFBGraphDiskCache:directory, so they survive the process. The
+ * files are named by the SHA-256 of the key and replaced atomically, so many
+ * processes can share the same directory.
+ *
+ * When the files take more than #GFBGraphDiskCache:max-size bytes, the least
+ * recently used ones are removed. The modification time of the files is
+ * updated when they're used, so the order is kept between processes.
+ **/
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "gfbgraph-cache.h"
+#include "gfbgraph-disk-cache.h"
+
+/* The file starts with the expiration time and the ETag, one per line,
+ * followed by the payload. */
+#define ENTRY_MAGIC "GFBGraphCache1\n"
+
+#define DEFAULT_MAX_SIZE (64 * 1024 * 1024)
+#define HASH_LENGTH      64
+
+typedef struct
+{
+  gchar   *name;
+  guint64  size;
+  gint64   mtime;
+  /* In the LRU queue, the data is the entry */
+  GList    link;
+} Entry;
+
+typedef struct
+{
+  gchar      *directory;
+  guint64     max_size;
+
+  /* Protected by mutex */
+  GMutex      mutex;
+  GHashTable *entries;
+  GQueue      lru;
+  guint64     size;
+} GFBGraphDiskCachePrivate;
+
+static void gfbgraph_disk_cache_iface_init (GFBGraphCacheInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GFBGraphDiskCache, gfbgraph_disk_cache, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GFBGraphDiskCache)
+                         G_IMPLEMENT_INTERFACE (GFBGRAPH_TYPE_CACHE, gfbgraph_disk_cache_iface_init));
+
+enum
+{
+  PROP_0,
+  PROP_DIRECTORY,
+  PROP_MAX_SIZE,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_DISK_CACHE_GET_PRIVATE(_obj) gfbgraph_disk_cache_get_instance_private (GFBGRAPH_DISK_CACHE (_obj))
+
+static Entry*
+entry_new (const gchar *name,
+           guint64      size,
+           gint64       mtime)
+{
+  Entry *entry;
+
+  entry = g_slice_new0 (Entry);
+  entry->name = g_strdup (name);
+  entry->size = size;
+  entry->mtime = mtime;
+  entry->link.data = entry;
+
+  return entry;
+}
+
+static void
+entry_free (Entry *entry)
+{
+  g_free (entry->name);
+  g_slice_free (Entry, entry);
+}
+
+/* Must be called with the mutex held. */
+static void
+remove_entry_unlocked (GFBGraphDiskCachePrivate *priv,
+                       Entry                    *entry)
+{
+  g_queue_unlink (&priv->lru, &entry->link);
+  priv->size -= entry->size;
+  g_hash_table_remove (priv->entries, entry->name);
+}
+
+/* Removes the least recently used files until they fit in the maximum size,
+ * except @keep */
+static void
+evict_unlocked (GFBGraphDiskCachePrivate *priv,
+                Entry                    *keep)
+{
+  while (priv->size > priv->max_size && priv->lru.head != NULL) {
+    Entry *entry = priv->lru.head->data;
+    gchar *path;
+
+    if (entry == keep)
+      break;
+
+    path = g_build_filename (priv->directory, entry->name, NULL);
+    g_unlink (path);
+    g_free (path);
+
+    remove_entry_unlocked (priv, entry);
+  }
+}
+
+static gint
+compare_entries_by_mtime (gconstpointer a,
+                          gconstpointer b)
+{
+  const Entry *entry_a = *(Entry * const *) a;
+  const Entry *entry_b = *(Entry * const *) b;
+
+  return entry_a->mtime < entry_b->mtime ? -1 : entry_a->mtime > entry_b->mtime;
+}
+
+/* Loads the entries stored by previous processes, oldest first */
+static void
+load_entries (GFBGraphDiskCachePrivate *priv)
+{
+  GPtrArray *entries;
+  GDir *dir;
+  const gchar *name;
+  guint i;
+
+  dir = g_dir_open (priv->directory, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  entries = g_ptr_array_new ();
+  while ((name = g_dir_read_name (dir)) != NULL) {
+    GStatBuf buf;
+    gchar *path;
+
+    /* Only our own entries, named by a SHA-256. Leftovers of
+     * g_file_set_contents() have a suffix */
+    if (strlen (name) != HASH_LENGTH)
+      continue;
+
+    path = g_build_filename (priv->directory, name, NULL);
+    if (g_stat (path, &buf) == 0)
+      g_ptr_array_add (entries, entry_new (name, buf.st_size, buf.st_mtime));
+    g_free (path);
+  }
+  g_dir_close (dir);
+
+  g_ptr_array_sort (entries, compare_entries_by_mtime);
+  for (i = 0; i < entries->len; i++) {
+    Entry *entry = g_ptr_array_index (entries, i);
+
+    g_hash_table_insert (priv->entries, entry->name, entry);
+    g_queue_push_tail_link (&priv->lru, &entry->link);
+    priv->size += entry->size;
+  }
+  g_ptr_array_unref (entries);
+
+  evict_unlocked (priv, NULL);
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_disk_cache_finalize (GObject *obj)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (obj);
+
+  g_hash_table_unref (priv->entries);
+  g_free (priv->directory);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_disk_cache_parent_class)->finalize (obj);
+}
+
+static void
+gfbgraph_disk_cache_constructed (GObject *obj)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (obj);
+
+  G_OBJECT_CLASS (gfbgraph_disk_cache_parent_class)->constructed (obj);
+
+  if (priv->directory == NULL)
+    priv->directory = g_build_filename (g_get_user_cache_dir (), "gfbgraph", NULL);
+
+  if (g_mkdir_with_parents (priv->directory, 0700) != 0)
+    g_warning ("Couldn't create the cache directory %s: %s", priv->directory, g_strerror (errno));
+
+  load_entries (priv);
+}
+
+static void
+gfbgraph_disk_cache_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_DIRECTORY:
+      g_free (priv->directory);
+      priv->directory = g_value_dup_string (value);
+      break;
+
+    case PROP_MAX_SIZE:
+      priv->max_size = g_value_get_uint64 (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_disk_cache_get_property (GObject    *object,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_DIRECTORY:
+      g_value_set_string (value, priv->directory);
+      break;
+
+    case PROP_MAX_SIZE:
+      g_value_set_uint64 (value, priv->max_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_disk_cache_init (GFBGraphDiskCache *obj)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (obj);
+
+  g_mutex_init (&priv->mutex);
+  priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) entry_free);
+  g_queue_init (&priv->lru);
+}
+
+static void
+gfbgraph_disk_cache_class_init (GFBGraphDiskCacheClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gfbgraph_disk_cache_finalize;
+  gobject_class->constructed = gfbgraph_disk_cache_constructed;
+  gobject_class->set_property = gfbgraph_disk_cache_set_property;
+  gobject_class->get_property = gfbgraph_disk_cache_get_property;
+
+  /**
+   * GFBGraphDiskCache:directory:
+   *
+   * The directory where the responses are stored. If %NULL, the "gfbgraph"
+   * directory inside g_get_user_cache_dir() is used.
+   **/
+  properties [PROP_DIRECTORY] =
+    g_param_spec_string ("directory", "Directory",
+                         "The directory where the responses are stored.",
+                         NULL,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GFBGraphDiskCache:max-size:
+   *
+   * The maximum size in bytes of the stored responses.
+   **/
+  properties [PROP_MAX_SIZE] =
+    g_param_spec_uint64 ("max-size", "Max size",
+                         "The maximum size in bytes of the stored responses.",
+                         1, G_MAXUINT64, DEFAULT_MAX_SIZE,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+/* --- Internal methods --- */
+static gboolean
+gfbgraph_disk_cache_lookup (GFBGraphCache  *iface,
+                            const gchar    *key,
+                            GBytes        **payload,
+                            gchar         **etag,
+                            gint64         *expiration)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (iface);
+  Entry *entry;
+  gchar *name;
+  gchar *path;
+  gchar *contents = NULL;
+  gsize length;
+  gchar *expiration_line;
+  gchar *etag_line;
+  gchar *data;
+  gboolean found = FALSE;
+
+  name = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  path = g_build_filename (priv->directory, name, NULL);
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    goto out;
+
+  g_mutex_lock (&priv->mutex);
+  entry = g_hash_table_lookup (priv->entries, name);
+  if (entry != NULL) {
+    g_queue_unlink (&priv->lru, &entry->link);
+    g_queue_push_tail_link (&priv->lru, &entry->link);
+  }
+  g_mutex_unlock (&priv->mutex);
+  g_utime (path, NULL);
+
+  if (!g_str_has_prefix (contents, ENTRY_MAGIC))
+    goto out;
+
+  expiration_line = contents + strlen (ENTRY_MAGIC);
+  etag_line = memchr (expiration_line, '\n', length - (expiration_line - contents));
+  if (etag_line == NULL)
+    goto out;
+  *etag_line++ = '\0';
+
+  data = memchr (etag_line, '\n', length - (etag_line - contents));
+  if (data == NULL)
+    goto out;
+  *data++ = '\0';
+
+  *expiration = g_ascii_strtoll (expiration_line, NULL, 10);
+  *etag = *etag_line != '\0' ? g_strdup (etag_line) : NULL;
+  *payload = g_bytes_new (data, length - (data - contents));
+  found = TRUE;
+
+ out:
+  g_free (contents);
+  g_free (path);
+  g_free (name);
+
+  return found;
+}
+
+static void
+gfbgraph_disk_cache_store (GFBGraphCache *iface,
+                           const gchar   *key,
+                           GBytes        *payload,
+                           const gchar   *etag,
+                           gint64         expiration)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (iface);
+  GString *contents;
+  gconstpointer data;
+  gsize size;
+  Entry *entry;
+  gchar *name;
+  gchar *path;
+  GError *error = NULL;
+
+  /* An ETag with a newline would break the file format */
+  if (etag != NULL && strchr (etag, '\n') != NULL)
+    etag = NULL;
+
+  data = g_bytes_get_data (payload, &size);
+
+  contents = g_string_sized_new (size + 64);
+  g_string_append (contents, ENTRY_MAGIC);
+  g_string_append_printf (contents, "%" G_GINT64_FORMAT "\n%s\n", expiration, etag != NULL ? etag : "");
+  g_string_append_len (contents, data, size);
+
+  name = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  path = g_build_filename (priv->directory, name, NULL);
+
+  /* Written with the lock held, so the file isn't evicted before it's
+   * accounted */
+  g_mutex_lock (&priv->mutex);
+  if (g_file_set_contents (path, contents->str, contents->len, &error)) {
+    entry = g_hash_table_lookup (priv->entries, name);
+    if (entry != NULL)
+      remove_entry_unlocked (priv, entry);
+
+    entry = entry_new (name, contents->len, g_get_real_time () / G_USEC_PER_SEC);
+    g_hash_table_insert (priv->entries, entry->name, entry);
+    g_queue_push_tail_link (&priv->lru, &entry->link);
+    priv->size += entry->size;
+    evict_unlocked (priv, entry);
+  } else {
+    g_warning ("Couldn't store the cached response %s: %s", path, error->message);
+    g_error_free (error);
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  g_free (path);
+  g_free (name);
+  g_string_free (contents, TRUE);
+}
+
+static void
+gfbgraph_disk_cache_remove (GFBGraphCache *iface,
+                            const gchar   *key)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (iface);
+  Entry *entry;
+  gchar *name;
+  gchar *path;
+
+  name = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  path = g_build_filename (priv->directory, name, NULL);
+
+  g_mutex_lock (&priv->mutex);
+  g_unlink (path);
+  entry = g_hash_table_lookup (priv->entries, name);
+  if (entry != NULL)
+    remove_entry_unlocked (priv, entry);
+  g_mutex_unlock (&priv->mutex);
+
+  g_free (path);
+  g_free (name);
+}
+
+static void
+gfbgraph_disk_cache_clear (GFBGraphCache *iface)
+{
+  GFBGraphDiskCachePrivate *priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (iface);
+  GDir *dir;
+  const gchar *name;
+
+  g_mutex_lock (&priv->mutex);
+
+  g_queue_init (&priv->lru);
+  g_hash_table_remove_all (priv->entries);
+  priv->size = 0;
+
+  /* Also the entries stored by other processes since this one started */
+  dir = g_dir_open (priv->directory, 0, NULL);
+  if (dir != NULL) {
+    while ((name = g_dir_read_name (dir)) != NULL) {
+      gchar *path;
+
+      /* Only remove our own entries, named by a SHA-256 */
+      if (strlen (name) != HASH_LENGTH)
+        continue;
+
+      path = g_build_filename (priv->directory, name, NULL);
+      g_unlink (path);
+      g_free (path);
+    }
+
+    g_dir_close (dir);
+  }
+
+  g_mutex_unlock (&priv->mutex);
+}
+
+static void
+gfbgraph_disk_cache_iface_init (GFBGraphCacheInterface *iface)
+{
+  iface->lookup = gfbgraph_disk_cache_lookup;
+  iface->store = gfbgraph_disk_cache_store;
+  iface->remove = gfbgraph_disk_cache_remove;
+  iface->clear = gfbgraph_disk_cache_clear;
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_disk_cache_new:
+ * @directory: (allow-none): The directory where the responses are stored, or %NULL
+ *  to use the default one.
+ * @max_size: The maximum size in bytes of the stored responses, or 0 for the default.
+ *
+ * Creates a new #GFBGraphDiskCache, with the responses already in @directory.
+ *
+ * Returns: (transfer full): a new #GFBGraphDiskCache.
+ **/
+GFBGraphDiskCache*
+gfbgraph_disk_cache_new (const gchar *directory,
+                         guint64      max_size)
+{
+  return GFBGRAPH_DISK_CACHE (g_object_new (GFBGRAPH_TYPE_DISK_CACHE,
+                                            "directory", directory,
+                                            "max-size", max_size > 0 ? max_size : (guint64) DEFAULT_MAX_SIZE,
+                                            NULL));
+}
+
+/**
+ * gfbgraph_disk_cache_get_directory:
+ * @cache: a #GFBGraphDiskCache.
+ *
+ * Gets the directory where the responses are stored.
+ *
+ * Returns: the #GFBGraphDiskCache:directory of @cache.
+ **/
+const gchar*
+gfbgraph_disk_cache_get_directory (GFBGraphDiskCache *cache)
+{
+  GFBGraphDiskCachePrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_DISK_CACHE (cache), NULL);
+
+  priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (cache);
+
+  return priv->directory;
+}
+
+/**
+ * gfbgraph_disk_cache_get_max_size:
+ * @cache: a #GFBGraphDiskCache.
+ *
+ * Gets the maximum size in bytes of the stored responses.
+ *
+ * Returns: the #GFBGraphDiskCache:max-size of @cache.
+ **/
+guint64
+gfbgraph_disk_cache_get_max_size (GFBGraphDiskCache *cache)
+{
+  GFBGraphDiskCachePrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_DISK_CACHE (cache), 0);
+
+  priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (cache);
+
+  return priv->max_size;
+}
+
+/**
+ * gfbgraph_disk_cache_get_size:
+ * @cache: a #GFBGraphDiskCache.
+ *
+ * Gets the size in bytes of the responses stored by @cache.
+ *
+ * Returns: the size of @cache in bytes.
+ **/
+guint64
+gfbgraph_disk_cache_get_size (GFBGraphDiskCache *cache)
+{
+  GFBGraphDiskCachePrivate *priv;
+  guint64 size;
+
+  g_return_val_if_fail (GFBGRAPH_IS_DISK_CACHE (cache), 0);
+
+  priv = GFBGRAPH_DISK_CACHE_GET_PRIVATE (cache);
+
+  g_mutex_lock (&priv->mutex);
+  size = priv->size;
+  g_mutex_unlock (&priv->mutex);
+
+  return size;
+}
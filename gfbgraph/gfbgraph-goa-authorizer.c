@@ -25,10 +25,25 @@
  *
  * #GFBGraphGoaAuthorizer provides an implementation of the #GFBGraphAuthorizer interface
  * for authorization using GNOME Online Accounts (GOA).
+ *
+ * The access token is read from GOA when the authorizer is created, and
+ * again shortly before it expires, in a thread started from the main context
+ * of the thread that created the authorizer, so the requests don't wait for
+ * GOA while that context runs. A request finding no token or an expired one,
+ * like in applications that don't run that context, reads it before being
+ * sent. It's also read when the Graph API rejects the current one. The
+ * requests keep being sent with a valid token while it's refreshed, and the
+ * requests refreshing it at the same time share one refresh.
  **/
 
 #include "gfbgraph-authorizer.h"
 #include "gfbgraph-goa-authorizer.h"
+#include "gfbgraph-private.h"
+
+/* Seconds before the expiration of the token when it's refreshed, at least */
+#define PRE_REFRESH_MARGIN 60
+/* Seconds before trying again a failed background refresh */
+#define REFRESH_RETRY_DELAY 60
 
 enum {
         PROP_O,
@@ -37,9 +52,20 @@ enum {
 };
 
 struct _GFBGraphGoaAuthorizerPrivate {
-        GMutex mutex;
         GoaObject *goa_object;
-        gchar *access_token;
+        GFBGraphTokenSlot slot;
+
+        /* The background refreshes run from this context */
+        GMainContext *context;
+        GCancellable *cancellable;
+
+        /* Protected by mutex */
+        GMutex mutex;
+        GSource *refresh_source;
+        /* The wall-clock time of the scheduled refresh, or 0 */
+        gint64 refresh_time;
+        gboolean refresh_due;
+        gboolean refreshing;
 };
 
 static void gfbgraph_goa_authorizer_class_init            (GFBGraphGoaAuthorizerClass *klass);
@@ -53,8 +79,11 @@ static void gfbgraph_goa_authorizer_iface_init            (GFBGraphAuthorizerInt
 void        gfbgraph_goa_authorizer_process_call          (GFBGraphAuthorizer *iface, RestProxyCall *call);
 void        gfbgraph_goa_authorizer_process_message       (GFBGraphAuthorizer *iface, SoupMessage *message);
 gboolean    gfbgraph_goa_authorizer_refresh_authorization (GFBGraphAuthorizer *iface, GCancellable *cancellable, GError **error);
+static gchar* gfbgraph_goa_authorizer_get_identity        (GFBGraphAuthorizer *iface, RestProxyCall *call);
 
 static void gfbgraph_goa_authorizer_set_goa_object        (GFBGraphGoaAuthorizer *self, GoaObject *goa_object);
+static GFBGraphToken* gfbgraph_goa_authorizer_get_token (GFBGraphGoaAuthorizer *self, GCancellable *cancellable, GError **error);
+static void gfbgraph_goa_authorizer_schedule_refresh      (GFBGraphGoaAuthorizer *self, guint delay);
 
 #define GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE((o), GFBGRAPH_TYPE_GOA_AUTHORIZER, GFBGraphGoaAuthorizerPrivate))
 
@@ -96,7 +125,10 @@ static void
 gfbgraph_goa_authorizer_init (GFBGraphGoaAuthorizer *object)
 {
         object->priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE(object);
+        gfbgraph_token_slot_init (&object->priv->slot);
         g_mutex_init (&object->priv->mutex);
+        object->priv->context = g_main_context_ref_thread_default ();
+        object->priv->cancellable = g_cancellable_new ();
 }
 
 static void
@@ -104,7 +136,10 @@ gfbgraph_goa_authorizer_finalize (GObject *object)
 {
         GFBGraphGoaAuthorizerPrivate *priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (object);
 
-        g_free (priv->access_token);
+        gfbgraph_token_slot_clear (&priv->slot);
+        g_main_context_unref (priv->context);
+        g_object_unref (priv->cancellable);
+        g_mutex_clear (&priv->mutex);
 
         G_OBJECT_CLASS(parent_class)->finalize (object);
 }
@@ -116,6 +151,14 @@ gfbgraph_goa_authorizer_dispose (GObject *object)
 
         priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (object);
 
+        g_cancellable_cancel (priv->cancellable);
+        g_mutex_lock (&priv->mutex);
+        if (priv->refresh_source != NULL) {
+                g_source_destroy (priv->refresh_source);
+                g_clear_pointer (&priv->refresh_source, g_source_unref);
+        }
+        g_mutex_unlock (&priv->mutex);
+
         g_clear_object (&priv->goa_object);
 
         G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -157,19 +200,55 @@ gfbgraph_goa_authorizer_iface_init (GFBGraphAuthorizerInterface *iface)
         iface->process_call = gfbgraph_goa_authorizer_process_call;
         iface->process_message = gfbgraph_goa_authorizer_process_message;
         iface->refresh_authorization = gfbgraph_goa_authorizer_refresh_authorization;
+        iface->get_identity = gfbgraph_goa_authorizer_get_identity;
 }
 
 void
 gfbgraph_goa_authorizer_process_call (GFBGraphAuthorizer *iface, RestProxyCall *call)
 {
         GFBGraphGoaAuthorizerPrivate *priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (GFBGRAPH_GOA_AUTHORIZER (iface));
+        GFBGraphToken *token;
+
+        token = gfbgraph_token_slot_get (&priv->slot);
+
+        /* Sending the request with it would only get it rejected, the token
+         * is read now, once for all the requests finding it expired */
+        if (token == NULL || gfbgraph_token_is_expired (token)) {
+                GError *error = NULL;
+
+                if (gfbgraph_token_slot_refresh (&priv->slot,
+                                                 (GFBGraphTokenRefreshFunc) gfbgraph_goa_authorizer_get_token, iface,
+                                                 priv->cancellable, &error)) {
+                        if (token != NULL)
+                                gfbgraph_token_unref (token);
+                        token = gfbgraph_token_slot_get (&priv->slot);
+                } else {
+                        g_debug ("Couldn't refresh the GOA access token: %s", error->message);
+                        g_error_free (error);
+                }
+        } else if (token->expiration != 0 &&
+                   token->expiration - PRE_REFRESH_MARGIN * G_USEC_PER_SEC <= g_get_real_time ()) {
+                gboolean start;
+
+                /* About to expire, it's refreshed in the background and the
+                 * request is sent with the current one, not before the retry
+                 * of a failed refresh */
+                g_mutex_lock (&priv->mutex);
+                start = !priv->refreshing && !priv->refresh_due &&
+                        priv->refresh_time <= g_get_real_time ();
+                g_mutex_unlock (&priv->mutex);
+
+                if (start)
+                        gfbgraph_goa_authorizer_schedule_refresh (GFBGRAPH_GOA_AUTHORIZER (iface), 0);
+        }
 
-        g_mutex_lock (&priv->mutex);
+        if (token == NULL)
+                return;
 
-        if (priv->access_token != NULL)
-                rest_proxy_call_add_param (call, "access_token", priv->access_token);
+        if (token->access_token != NULL)
+                rest_proxy_call_add_param (call, "access_token", token->access_token);
 
-        g_mutex_unlock (&priv->mutex);
+        gfbgraph_token_unref (token);
 }
 
 void
@@ -178,45 +257,197 @@ gfbgraph_goa_authorizer_process_message (GFBGraphAuthorizer *iface, SoupMessage
         gchar *auth_value;
         SoupURI *uri;
         GFBGraphGoaAuthorizerPrivate *priv;
+        GFBGraphToken *token;
 
         priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (GFBGRAPH_GOA_AUTHORIZER (iface));
 
-        g_mutex_lock (&priv->mutex);
+        token = gfbgraph_token_slot_get (&priv->slot);
 
         uri = soup_message_get_uri (message);
-        auth_value = g_strconcat ("access_token=", priv->access_token, NULL);
+        auth_value = g_strconcat ("access_token=", token != NULL ? token->access_token : NULL, NULL);
         soup_uri_set_query (uri, auth_value);
 
         g_free (auth_value);
-
-        g_mutex_unlock (&priv->mutex);
+        if (token != NULL)
+                gfbgraph_token_unref (token);
 }
 
-gboolean
-gfbgraph_goa_authorizer_refresh_authorization (GFBGraphAuthorizer *iface, GCancellable *cancellable, GError **error)
+/* Runs without any lock held, the D-Bus calls to GOA can take a while */
+static GFBGraphToken*
+gfbgraph_goa_authorizer_get_token (GFBGraphGoaAuthorizer *self, GCancellable *cancellable, GError **error)
 {
         GFBGraphGoaAuthorizerPrivate *priv;
+        GFBGraphToken *token;
         GoaAccount *account;
         GoaOAuth2Based *oauth2_based;
-        gboolean ret_val;
+        gchar *access_token;
+        gint expires_in;
 
-        priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (GFBGRAPH_GOA_AUTHORIZER (iface));
-        ret_val = FALSE;
+        priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (self);
+
+        account = goa_object_peek_account (priv->goa_object);
+        oauth2_based = goa_object_peek_oauth2_based (priv->goa_object);
+
+        if (!goa_account_call_ensure_credentials_sync (account, NULL, cancellable, error))
+                return NULL;
+        if (!goa_oauth2_based_call_get_access_token_sync (oauth2_based, &access_token, &expires_in, cancellable, error))
+                return NULL;
+
+        token = gfbgraph_token_new (access_token);
+        g_free (access_token);
+
+        /* 0 when GOA doesn't know it, then it's only refreshed when rejected */
+        if (expires_in > 0) {
+                guint margin;
+
+                token->expiration = g_get_real_time () + (gint64) expires_in * G_USEC_PER_SEC;
+                margin = MAX (expires_in / 10, PRE_REFRESH_MARGIN);
+                gfbgraph_goa_authorizer_schedule_refresh (self, expires_in > (gint) margin ? expires_in - margin : 0);
+        }
+
+        return token;
+}
+
+static void
+gfbgraph_goa_authorizer_refresh_thread (GTask        *task,
+                                        gpointer      source_object,
+                                        gpointer      task_data,
+                                        GCancellable *cancellable)
+{
+        GFBGraphGoaAuthorizerPrivate *priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (source_object);
+        GError *error = NULL;
+
+        if (gfbgraph_token_slot_refresh (&priv->slot,
+                                         (GFBGraphTokenRefreshFunc) gfbgraph_goa_authorizer_get_token, source_object,
+                                         cancellable, &error))
+                g_task_return_boolean (task, TRUE);
+        else
+                g_task_return_error (task, error);
+}
+
+static void
+gfbgraph_goa_authorizer_refreshed_cb (GObject      *source_object,
+                                      GAsyncResult *result,
+                                      gpointer      user_data)
+{
+        GFBGraphGoaAuthorizer *self = GFBGRAPH_GOA_AUTHORIZER (source_object);
+        GFBGraphGoaAuthorizerPrivate *priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (self);
+        GError *error = NULL;
+
+        g_mutex_lock (&priv->mutex);
+        priv->refreshing = FALSE;
+        g_mutex_unlock (&priv->mutex);
+
+        if (!g_task_propagate_boolean (G_TASK (result), &error)) {
+                if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+                        g_debug ("Couldn't refresh the GOA access token: %s", error->message);
+                        gfbgraph_goa_authorizer_schedule_refresh (self, REFRESH_RETRY_DELAY);
+                }
+                g_error_free (error);
+        }
+}
+
+/* Runs in priv->context, the refresh itself runs in a thread */
+static gboolean
+gfbgraph_goa_authorizer_refresh_cb (gpointer user_data)
+{
+        GFBGraphGoaAuthorizer *self;
+        GFBGraphGoaAuthorizerPrivate *priv;
+        GTask *task;
+        gint64 remaining;
+
+        self = g_weak_ref_get (user_data);
+        if (self == NULL)
+                return G_SOURCE_REMOVE;
+
+        priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (self);
 
         g_mutex_lock (&priv->mutex);
+        if (priv->refresh_source == g_main_current_source ())
+                g_clear_pointer (&priv->refresh_source, g_source_unref);
+
+        /* The timer runs on the monotonic clock, the wall clock could have
+         * been set back since it was scheduled */
+        remaining = (priv->refresh_time - g_get_real_time ()) / G_USEC_PER_SEC;
+        if (!priv->refresh_due && remaining > 0) {
+                g_mutex_unlock (&priv->mutex);
+                gfbgraph_goa_authorizer_schedule_refresh (self, remaining);
+                g_object_unref (self);
+                return G_SOURCE_REMOVE;
+        }
 
-        g_free (priv->access_token);
-        priv->access_token = NULL;
+        priv->refresh_due = FALSE;
+        priv->refresh_time = 0;
+        if (priv->refreshing) {
+                g_mutex_unlock (&priv->mutex);
+                g_object_unref (self);
+                return G_SOURCE_REMOVE;
+        }
+        priv->refreshing = TRUE;
+        g_mutex_unlock (&priv->mutex);
 
-        account = goa_object_peek_account (priv->goa_object);
-        oauth2_based = goa_object_peek_oauth2_based (priv->goa_object);
+        task = g_task_new (self, priv->cancellable, gfbgraph_goa_authorizer_refreshed_cb, NULL);
+        g_task_run_in_thread (task, gfbgraph_goa_authorizer_refresh_thread);
+        g_object_unref (task);
+        g_object_unref (self);
+
+        return G_SOURCE_REMOVE;
+}
+
+static void
+weak_ref_free (GWeakRef *weak_ref)
+{
+        g_weak_ref_clear (weak_ref);
+        g_slice_free (GWeakRef, weak_ref);
+}
+
+/* Refreshes the token in the background after delay seconds, replacing the
+ * previous scheduled refresh. Can be called from any thread. */
+static void
+gfbgraph_goa_authorizer_schedule_refresh (GFBGraphGoaAuthorizer *self, guint delay)
+{
+        GFBGraphGoaAuthorizerPrivate *priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (self);
+        GWeakRef *weak_ref;
 
-        if (goa_account_call_ensure_credentials_sync (account, NULL, cancellable, error))
-                if (goa_oauth2_based_call_get_access_token_sync (oauth2_based, &priv->access_token, NULL, cancellable, error))
-                        ret_val = TRUE;
+        /* The source doesn't keep the authorizer alive, the token can last days */
+        weak_ref = g_slice_new (GWeakRef);
+        g_weak_ref_init (weak_ref, self);
 
+        g_mutex_lock (&priv->mutex);
+        if (priv->refresh_source != NULL) {
+                g_source_destroy (priv->refresh_source);
+                g_source_unref (priv->refresh_source);
+        }
+        priv->refresh_source = delay > 0 ? g_timeout_source_new_seconds (delay) : g_idle_source_new ();
+        priv->refresh_time = g_get_real_time () + (gint64) delay * G_USEC_PER_SEC;
+        priv->refresh_due = (delay == 0);
+        g_source_set_callback (priv->refresh_source, gfbgraph_goa_authorizer_refresh_cb,
+                               weak_ref, (GDestroyNotify) weak_ref_free);
+        g_source_attach (priv->refresh_source, priv->context);
         g_mutex_unlock (&priv->mutex);
-        return ret_val;
+}
+
+gboolean
+gfbgraph_goa_authorizer_refresh_authorization (GFBGraphAuthorizer *iface, GCancellable *cancellable, GError **error)
+{
+        GFBGraphGoaAuthorizerPrivate *priv;
+
+        priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (GFBGRAPH_GOA_AUTHORIZER (iface));
+
+        return gfbgraph_token_slot_refresh (&priv->slot,
+                                            (GFBGraphTokenRefreshFunc) gfbgraph_goa_authorizer_get_token, iface,
+                                            cancellable, error);
+}
+
+/* The account stays the same when its token is refreshed */
+static gchar*
+gfbgraph_goa_authorizer_get_identity (GFBGraphAuthorizer *iface, RestProxyCall *call)
+{
+        GFBGraphGoaAuthorizerPrivate *priv;
+
+        priv = GFBGRAPH_GOA_AUTHORIZER_GET_PRIVATE (GFBGRAPH_GOA_AUTHORIZER (iface));
+
+        return g_strconcat ("goa:", goa_account_get_id (goa_object_peek_account (priv->goa_object)), NULL);
 }
 
 static void
@@ -238,6 +469,9 @@ gfbgraph_goa_authorizer_set_goa_object (GFBGraphGoaAuthorizer *self, GoaObject *
 
         g_object_ref (goa_object);
         priv->goa_object = goa_object;
+
+        /* Before the first request */
+        gfbgraph_goa_authorizer_schedule_refresh (self, 0);
 }
 
 /**
@@ -0,0 +1,350 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-memory-cache
+ * @title: GFBGraphMemoryCache
+ * @short_description: In-memory LRU response cache.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphMemoryCache is a #GFBGraphCache keeping the responses in memory,
+ * up to #GFBGraphMemoryCache:max-size bytes. When the limit is reached the
+ * least recently used responses are evicted.
+ **/
+
+#include <string.h>
+
+#include "gfbgraph-cache.h"
+#include "gfbgraph-memory-cache.h"
+
+#define DEFAULT_MAX_SIZE (8 * 1024 * 1024)
+
+typedef struct
+{
+  gchar  *key;
+  GBytes *payload;
+  gchar  *etag;
+  gint64  expiration;
+  GList  *link;
+} Entry;
+
+typedef struct
+{
+  GMutex      mutex;
+  GHashTable *entries;
+  GQueue      lru;
+  gsize       max_size;
+  gsize       size;
+} GFBGraphMemoryCachePrivate;
+
+static void gfbgraph_memory_cache_iface_init (GFBGraphCacheInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GFBGraphMemoryCache, gfbgraph_memory_cache, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GFBGraphMemoryCache)
+                         G_IMPLEMENT_INTERFACE (GFBGRAPH_TYPE_CACHE, gfbgraph_memory_cache_iface_init));
+
+enum
+{
+  PROP_0,
+  PROP_MAX_SIZE,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_MEMORY_CACHE_GET_PRIVATE(_obj) gfbgraph_memory_cache_get_instance_private (GFBGRAPH_MEMORY_CACHE (_obj))
+
+/* The bytes accounted to an entry, so the size doesn't ignore the small ones. */
+static gsize
+entry_get_size (Entry *entry)
+{
+  return sizeof (Entry) + strlen (entry->key) + g_bytes_get_size (entry->payload)
+    + (entry->etag != NULL ? strlen (entry->etag) : 0);
+}
+
+static void
+entry_free (Entry *entry)
+{
+  g_free (entry->key);
+  g_bytes_unref (entry->payload);
+  g_free (entry->etag);
+  g_slice_free (Entry, entry);
+}
+
+/* Must be called with the mutex held. */
+static void
+remove_entry (GFBGraphMemoryCachePrivate *priv,
+              Entry                      *entry)
+{
+  g_queue_delete_link (&priv->lru, entry->link);
+  priv->size -= entry_get_size (entry);
+  g_hash_table_remove (priv->entries, entry->key);
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_memory_cache_finalize (GObject *obj)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (obj);
+
+  g_queue_clear (&priv->lru);
+  g_hash_table_unref (priv->entries);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_memory_cache_parent_class)->finalize (obj);
+}
+
+static void
+gfbgraph_memory_cache_set_property (GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_SIZE:
+      priv->max_size = g_value_get_uint64 (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_memory_cache_get_property (GObject    *object,
+                                    guint       prop_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_SIZE:
+      g_value_set_uint64 (value, priv->max_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_memory_cache_init (GFBGraphMemoryCache *obj)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (obj);
+
+  g_mutex_init (&priv->mutex);
+  priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) entry_free);
+  g_queue_init (&priv->lru);
+}
+
+static void
+gfbgraph_memory_cache_class_init (GFBGraphMemoryCacheClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gfbgraph_memory_cache_finalize;
+  gobject_class->set_property = gfbgraph_memory_cache_set_property;
+  gobject_class->get_property = gfbgraph_memory_cache_get_property;
+
+  /**
+   * GFBGraphMemoryCache:max-size:
+   *
+   * The maximum number of bytes used by the cached responses.
+   **/
+  properties [PROP_MAX_SIZE] =
+    g_param_spec_uint64 ("max-size", "Maximum size",
+                         "The maximum number of bytes used by the cached responses.",
+                         0, G_MAXUINT64, DEFAULT_MAX_SIZE,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+/* --- Internal methods --- */
+static gboolean
+gfbgraph_memory_cache_lookup (GFBGraphCache  *iface,
+                              const gchar    *key,
+                              GBytes        **payload,
+                              gchar         **etag,
+                              gint64         *expiration)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (iface);
+  Entry *entry;
+
+  g_mutex_lock (&priv->mutex);
+
+  entry = g_hash_table_lookup (priv->entries, key);
+  if (entry != NULL) {
+    g_queue_unlink (&priv->lru, entry->link);
+    g_queue_push_head_link (&priv->lru, entry->link);
+
+    *payload = g_bytes_ref (entry->payload);
+    *etag = g_strdup (entry->etag);
+    *expiration = entry->expiration;
+  }
+
+  g_mutex_unlock (&priv->mutex);
+
+  return entry != NULL;
+}
+
+static void
+gfbgraph_memory_cache_store (GFBGraphCache *iface,
+                             const gchar   *key,
+                             GBytes        *payload,
+                             const gchar   *etag,
+                             gint64         expiration)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (iface);
+  Entry *entry;
+
+  entry = g_slice_new0 (Entry);
+  entry->key = g_strdup (key);
+  entry->payload = g_bytes_ref (payload);
+  entry->etag = g_strdup (etag);
+  entry->expiration = expiration;
+
+  g_mutex_lock (&priv->mutex);
+
+  if (g_hash_table_contains (priv->entries, key))
+    remove_entry (priv, g_hash_table_lookup (priv->entries, key));
+
+  if (entry_get_size (entry) > priv->max_size) {
+    g_mutex_unlock (&priv->mutex);
+    entry_free (entry);
+    return;
+  }
+
+  while (priv->size + entry_get_size (entry) > priv->max_size)
+    remove_entry (priv, g_queue_peek_tail (&priv->lru));
+
+  g_queue_push_head (&priv->lru, entry);
+  entry->link = priv->lru.head;
+  priv->size += entry_get_size (entry);
+  g_hash_table_insert (priv->entries, entry->key, entry);
+
+  g_mutex_unlock (&priv->mutex);
+}
+
+static void
+gfbgraph_memory_cache_remove (GFBGraphCache *iface,
+                              const gchar   *key)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (iface);
+  Entry *entry;
+
+  g_mutex_lock (&priv->mutex);
+
+  entry = g_hash_table_lookup (priv->entries, key);
+  if (entry != NULL)
+    remove_entry (priv, entry);
+
+  g_mutex_unlock (&priv->mutex);
+}
+
+static void
+gfbgraph_memory_cache_clear (GFBGraphCache *iface)
+{
+  GFBGraphMemoryCachePrivate *priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (iface);
+
+  g_mutex_lock (&priv->mutex);
+
+  g_queue_clear (&priv->lru);
+  g_hash_table_remove_all (priv->entries);
+  priv->size = 0;
+
+  g_mutex_unlock (&priv->mutex);
+}
+
+static void
+gfbgraph_memory_cache_iface_init (GFBGraphCacheInterface *iface)
+{
+  iface->lookup = gfbgraph_memory_cache_lookup;
+  iface->store = gfbgraph_memory_cache_store;
+  iface->remove = gfbgraph_memory_cache_remove;
+  iface->clear = gfbgraph_memory_cache_clear;
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_memory_cache_new:
+ * @max_size: The maximum number of bytes used by the cached responses.
+ *
+ * Creates a new #GFBGraphMemoryCache.
+ *
+ * Returns: (transfer full): a new #GFBGraphMemoryCache.
+ **/
+GFBGraphMemoryCache*
+gfbgraph_memory_cache_new (gsize max_size)
+{
+  return GFBGRAPH_MEMORY_CACHE (g_object_new (GFBGRAPH_TYPE_MEMORY_CACHE,
+                                              "max-size", (guint64) max_size,
+                                              NULL));
+}
+
+/**
+ * gfbgraph_memory_cache_get_max_size:
+ * @cache: a #GFBGraphMemoryCache.
+ *
+ * Gets the maximum number of bytes used by the cached responses.
+ *
+ * Returns: the #GFBGraphMemoryCache:max-size of @cache.
+ **/
+gsize
+gfbgraph_memory_cache_get_max_size (GFBGraphMemoryCache *cache)
+{
+  GFBGraphMemoryCachePrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_MEMORY_CACHE (cache), 0);
+
+  priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (cache);
+
+  return priv->max_size;
+}
+
+/**
+ * gfbgraph_memory_cache_get_size:
+ * @cache: a #GFBGraphMemoryCache.
+ *
+ * Gets the number of bytes currently used by the cached responses.
+ *
+ * Returns: the size of @cache in bytes.
+ **/
+gsize
+gfbgraph_memory_cache_get_size (GFBGraphMemoryCache *cache)
+{
+  GFBGraphMemoryCachePrivate *priv;
+  gsize size;
+
+  g_return_val_if_fail (GFBGRAPH_IS_MEMORY_CACHE (cache), 0);
+
+  priv = GFBGRAPH_MEMORY_CACHE_GET_PRIVATE (cache);
+
+  g_mutex_lock (&priv->mutex);
+  size = priv->size;
+  g_mutex_unlock (&priv->mutex);
+
+  return size;
+}
@@ -0,0 +1,49 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_MEMORY_CACHE_H__
+#define __GFBGRAPH_MEMORY_CACHE_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_MEMORY_CACHE (gfbgraph_memory_cache_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphMemoryCache, gfbgraph_memory_cache, GFBGRAPH, MEMORY_CACHE, GObject)
+
+struct _GFBGraphMemoryCacheClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+GFBGraphMemoryCache* gfbgraph_memory_cache_new          (gsize                max_size);
+
+gsize                gfbgraph_memory_cache_get_max_size (GFBGraphMemoryCache *cache);
+gsize                gfbgraph_memory_cache_get_size     (GFBGraphMemoryCache *cache);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_MEMORY_CACHE_H__ */
@@ -0,0 +1,790 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-metrics
+ * @title: GFBGraphMetrics
+ * @short_description: Counters of the requests to the Graph API.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphMetrics counts what the library does on the wire: the requests to
+ * every endpoint, with their errors, retries, bytes and a histogram of their
+ * latencies, the responses served by the response cache, and the time spent
+ * parsing their JSON responses and deserializing the nodes.
+ *
+ * The requests of a #GFBGraphClient are recorded once a #GFBGraphMetrics is
+ * set with gfbgraph_client_set_metrics(). Without it the requests aren't
+ * instrumented at all, so there is no cost when the metrics aren't wanted.
+ * The endpoints are grouped replacing the IDs in their path by "{id}", like
+ * "{id}/albums".
+ *
+ * The counters can be read with gfbgraph_metrics_get_counters(), exported to
+ * any monitoring system with gfbgraph_metrics_foreach(), or dumped in the
+ * Prometheus text format with gfbgraph_metrics_dump_prometheus().
+ **/
+
+#include <string.h>
+
+#include "gfbgraph-metrics.h"
+
+typedef struct
+{
+  gchar                   *key;
+  gchar                   *method;
+  gchar                   *endpoint;
+  GFBGraphMetricsCounters  counters;
+} Endpoint;
+
+/* The key of the counters of a request, built before taking the mutex */
+typedef struct
+{
+  const gchar *method;
+  gchar       *endpoint;
+  gchar       *key;
+} EndpointKey;
+
+typedef struct
+{
+  /* Protected by mutex */
+  GMutex      mutex;
+  GHashTable *endpoints;
+} GFBGraphMetricsPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphMetrics, gfbgraph_metrics, G_TYPE_OBJECT)
+
+#define GFBGRAPH_METRICS_GET_PRIVATE(_obj) gfbgraph_metrics_get_instance_private (GFBGRAPH_METRICS (_obj))
+
+/* Upper bounds of the latency buckets in microseconds, the last one is +Inf */
+static const gint64 latency_bounds[GFBGRAPH_METRICS_N_LATENCY_BUCKETS - 1] = {
+  5000, 10000, 25000, 50000, 100000, 250000, 500000,
+  1000000, 2500000, 5000000, 10000000
+};
+
+static Endpoint*
+endpoint_new (const gchar *key,
+              const gchar *method,
+              const gchar *path)
+{
+  Endpoint *endpoint;
+
+  endpoint = g_slice_new0 (Endpoint);
+  endpoint->key = g_strdup (key);
+  endpoint->method = g_strdup (method);
+  endpoint->endpoint = g_strdup (path);
+
+  return endpoint;
+}
+
+static void
+endpoint_free (Endpoint *endpoint)
+{
+  g_free (endpoint->key);
+  g_free (endpoint->method);
+  g_free (endpoint->endpoint);
+  g_slice_free (Endpoint, endpoint);
+}
+
+static gboolean
+is_id (const gchar *segment)
+{
+  gboolean has_digit = FALSE;
+
+  /* Like "10150146071791729" or "10150146071791729_10150146072071729" */
+  for (; *segment != '\0'; segment++) {
+    if (g_ascii_isdigit (*segment))
+      has_digit = TRUE;
+    else if (*segment != '_')
+      return FALSE;
+  }
+
+  return has_digit;
+}
+
+/* "https://graph.facebook.com/v2.0/1234/albums?after=x" is "v2.0/{id}/albums" */
+static gchar*
+normalize_endpoint (const gchar *endpoint)
+{
+  const gchar *scheme;
+  gchar *path;
+  gchar **segments;
+  gchar *normalized;
+  guint i;
+
+  if (endpoint == NULL)
+    return g_strdup ("/");
+
+  scheme = strstr (endpoint, "://");
+  if (scheme != NULL) {
+    endpoint = strchr (scheme + 3, '/');
+    if (endpoint == NULL)
+      return g_strdup ("/");
+  }
+  while (*endpoint == '/')
+    endpoint++;
+
+  path = g_strndup (endpoint, strcspn (endpoint, "?#"));
+  if (*path == '\0') {
+    g_free (path);
+    return g_strdup ("/");
+  }
+
+  segments = g_strsplit (path, "/", -1);
+  for (i = 0; segments[i] != NULL; i++) {
+    if (is_id (segments[i])) {
+      g_free (segments[i]);
+      segments[i] = g_strdup ("{id}");
+    }
+  }
+  normalized = g_strjoinv ("/", segments);
+
+  g_strfreev (segments);
+  g_free (path);
+
+  return normalized;
+}
+
+static void
+endpoint_key_init (EndpointKey *key,
+                   const gchar *method,
+                   const gchar *path)
+{
+  key->method = method != NULL ? method : "GET";
+  key->endpoint = normalize_endpoint (path);
+  key->key = g_strconcat (key->method, " ", key->endpoint, NULL);
+}
+
+static void
+endpoint_key_clear (EndpointKey *key)
+{
+  g_free (key->endpoint);
+  g_free (key->key);
+}
+
+/* Called with the mutex held */
+static Endpoint*
+get_endpoint_unlocked (GFBGraphMetricsPrivate *priv,
+                       const EndpointKey      *key)
+{
+  Endpoint *endpoint;
+
+  endpoint = g_hash_table_lookup (priv->endpoints, key->key);
+  if (endpoint == NULL) {
+    endpoint = endpoint_new (key->key, key->method, key->endpoint);
+    g_hash_table_insert (priv->endpoints, endpoint->key, endpoint);
+  }
+
+  return endpoint;
+}
+
+static void
+counters_add (GFBGraphMetricsCounters       *sum,
+              const GFBGraphMetricsCounters *counters)
+{
+  guint i;
+
+  sum->n_requests += counters->n_requests;
+  sum->n_errors += counters->n_errors;
+  sum->n_retries += counters->n_retries;
+  sum->n_cache_hits += counters->n_cache_hits;
+  sum->bytes_sent += counters->bytes_sent;
+  sum->bytes_received += counters->bytes_received;
+  sum->latency_sum += counters->latency_sum;
+  for (i = 0; i < GFBGRAPH_METRICS_N_LATENCY_BUCKETS; i++)
+    sum->latency_buckets[i] += counters->latency_buckets[i];
+  sum->n_parses += counters->n_parses;
+  sum->parse_time += counters->parse_time;
+  sum->n_deserializations += counters->n_deserializations;
+  sum->deserialize_time += counters->deserialize_time;
+}
+
+static gint
+compare_endpoints (gconstpointer a,
+                   gconstpointer b)
+{
+  return strcmp ((*(Endpoint **) a)->key, (*(Endpoint **) b)->key);
+}
+
+/* Copies the endpoints, sorted, so they can be read without the mutex */
+static GPtrArray*
+snapshot_endpoints (GFBGraphMetricsPrivate *priv)
+{
+  GPtrArray *snapshot;
+  GHashTableIter iter;
+  Endpoint *endpoint;
+
+  snapshot = g_ptr_array_new_with_free_func ((GDestroyNotify) endpoint_free);
+
+  g_mutex_lock (&priv->mutex);
+  g_hash_table_iter_init (&iter, priv->endpoints);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &endpoint)) {
+    Endpoint *copy;
+
+    copy = endpoint_new (endpoint->key, endpoint->method, endpoint->endpoint);
+    copy->counters = endpoint->counters;
+    g_ptr_array_add (snapshot, copy);
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  g_ptr_array_sort (snapshot, compare_endpoints);
+
+  return snapshot;
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_metrics_finalize (GObject *object)
+{
+  GFBGraphMetricsPrivate *priv = GFBGRAPH_METRICS_GET_PRIVATE (object);
+
+  g_hash_table_unref (priv->endpoints);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_metrics_parent_class)->finalize (object);
+}
+
+static void
+gfbgraph_metrics_init (GFBGraphMetrics *self)
+{
+  GFBGraphMetricsPrivate *priv = GFBGRAPH_METRICS_GET_PRIVATE (self);
+
+  g_mutex_init (&priv->mutex);
+  priv->endpoints = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) endpoint_free);
+}
+
+static void
+gfbgraph_metrics_class_init (GFBGraphMetricsClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gfbgraph_metrics_finalize;
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_metrics_new:
+ *
+ * Creates a new #GFBGraphMetrics, set it in a #GFBGraphClient with
+ * gfbgraph_client_set_metrics() to record its requests.
+ *
+ * Returns: (transfer full): a new #GFBGraphMetrics.
+ **/
+GFBGraphMetrics*
+gfbgraph_metrics_new (void)
+{
+  return GFBGRAPH_METRICS (g_object_new (GFBGRAPH_TYPE_METRICS, NULL));
+}
+
+/**
+ * gfbgraph_metrics_record_request:
+ * @metrics: a #GFBGraphMetrics.
+ * @method: (allow-none): the HTTP method of the request, or %NULL for GET.
+ * @endpoint: (allow-none): the path or the URL of the request.
+ * @latency: the time until the response arrived, in microseconds.
+ * @bytes_sent: the bytes of the parameters of the request.
+ * @bytes_received: the bytes of the payload of the response.
+ * @error: (allow-none): the error of the request, or %NULL.
+ *
+ * Records a request sent to the Graph API. The #GFBGraphClient does it for
+ * every request sent through it.
+ **/
+void
+gfbgraph_metrics_record_request (GFBGraphMetrics *metrics,
+                                 const gchar     *method,
+                                 const gchar     *endpoint,
+                                 gint64           latency,
+                                 gsize            bytes_sent,
+                                 gsize            bytes_received,
+                                 const GError    *error)
+{
+  GFBGraphMetricsPrivate *priv;
+  GFBGraphMetricsCounters *counters;
+  EndpointKey key;
+  guint bucket;
+
+  g_return_if_fail (GFBGRAPH_IS_METRICS (metrics));
+
+  priv = GFBGRAPH_METRICS_GET_PRIVATE (metrics);
+
+  for (bucket = 0; bucket < G_N_ELEMENTS (latency_bounds); bucket++) {
+    if (latency <= latency_bounds[bucket])
+      break;
+  }
+
+  endpoint_key_init (&key, method, endpoint);
+
+  g_mutex_lock (&priv->mutex);
+  counters = &get_endpoint_unlocked (priv, &key)->counters;
+  counters->n_requests++;
+  if (error != NULL)
+    counters->n_errors++;
+  counters->bytes_sent += bytes_sent;
+  counters->bytes_received += bytes_received;
+  counters->latency_sum += latency;
+  counters->latency_buckets[bucket]++;
+  g_mutex_unlock (&priv->mutex);
+
+  endpoint_key_clear (&key);
+}
+
+/**
+ * gfbgraph_metrics_record_retry:
+ * @metrics: a #GFBGraphMetrics.
+ * @method: (allow-none): the HTTP method of the request, or %NULL for GET.
+ * @endpoint: (allow-none): the path or the URL of the request.
+ *
+ * Records that a failed request is going to be sent again.
+ **/
+void
+gfbgraph_metrics_record_retry (GFBGraphMetrics *metrics,
+                               const gchar     *method,
+                               const gchar     *endpoint)
+{
+  GFBGraphMetricsPrivate *priv;
+  EndpointKey key;
+
+  g_return_if_fail (GFBGRAPH_IS_METRICS (metrics));
+
+  priv = GFBGRAPH_METRICS_GET_PRIVATE (metrics);
+
+  endpoint_key_init (&key, method, endpoint);
+
+  g_mutex_lock (&priv->mutex);
+  get_endpoint_unlocked (priv, &key)->counters.n_retries++;
+  g_mutex_unlock (&priv->mutex);
+
+  endpoint_key_clear (&key);
+}
+
+/**
+ * gfbgraph_metrics_record_cache_hit:
+ * @metrics: a #GFBGraphMetrics.
+ * @method: (allow-none): the HTTP method of the request, or %NULL for GET.
+ * @endpoint: (allow-none): the path or the URL of the request.
+ *
+ * Records a response served by the response cache.
+ **/
+void
+gfbgraph_metrics_record_cache_hit (GFBGraphMetrics *metrics,
+                                   const gchar     *method,
+                                   const gchar     *endpoint)
+{
+  GFBGraphMetricsPrivate *priv;
+  EndpointKey key;
+
+  g_return_if_fail (GFBGRAPH_IS_METRICS (metrics));
+
+  priv = GFBGRAPH_METRICS_GET_PRIVATE (metrics);
+
+  endpoint_key_init (&key, method, endpoint);
+
+  g_mutex_lock (&priv->mutex);
+  get_endpoint_unlocked (priv, &key)->counters.n_cache_hits++;
+  g_mutex_unlock (&priv->mutex);
+
+  endpoint_key_clear (&key);
+}
+
+/**
+ * gfbgraph_metrics_record_parse:
+ * @metrics: a #GFBGraphMetrics.
+ * @method: (allow-none): the HTTP method of the request, or %NULL for GET.
+ * @endpoint: (allow-none): the path or the URL of the request.
+ * @duration: the time spent, in microseconds.
+ *
+ * Records the time spent parsing the JSON of a response.
+ **/
+void
+gfbgraph_metrics_record_parse (GFBGraphMetrics *metrics,
+                               const gchar     *method,
+                               const gchar     *endpoint,
+                               gint64           duration)
+{
+  GFBGraphMetricsPrivate *priv;
+  GFBGraphMetricsCounters *counters;
+  EndpointKey key;
+
+  g_return_if_fail (GFBGRAPH_IS_METRICS (metrics));
+
+  priv = GFBGRAPH_METRICS_GET_PRIVATE (metrics);
+
+  endpoint_key_init (&key, method, endpoint);
+
+  g_mutex_lock (&priv->mutex);
+  counters = &get_endpoint_unlocked (priv, &key)->counters;
+  counters->n_parses++;
+  counters->parse_time += duration;
+  g_mutex_unlock (&priv->mutex);
+
+  endpoint_key_clear (&key);
+}
+
+/**
+ * gfbgraph_metrics_record_deserialize:
+ * @metrics: a #GFBGraphMetrics.
+ * @method: (allow-none): the HTTP method of the request, or %NULL for GET.
+ * @endpoint: (allow-none): the path or the URL of the request.
+ * @duration: the time spent, in microseconds.
+ *
+ * Records the time spent building the nodes of a response from its JSON.
+ **/
+void
+gfbgraph_metrics_record_deserialize (GFBGraphMetrics *metrics,
+                                     const gchar     *method,
+                                     const gchar     *endpoint,
+                                     gint64           duration)
+{
+  GFBGraphMetricsPrivate *priv;
+  GFBGraphMetricsCounters *counters;
+  EndpointKey key;
+
+  g_return_if_fail (GFBGRAPH_IS_METRICS (metrics));
+
+  priv = GFBGRAPH_METRICS_GET_PRIVATE (metrics);
+
+  endpoint_key_init (&key, method, endpoint);
+
+  g_mutex_lock (&priv->mutex);
+  counters = &get_endpoint_unlocked (priv, &key)->counters;
+  counters->n_deserializations++;
+  counters->deserialize_time += duration;
+  g_mutex_unlock (&priv->mutex);
+
+  endpoint_key_clear (&key);
+}
+
+/**
+ * gfbgraph_metrics_get_counters:
+ * @metrics: a #GFBGraphMetrics.
+ * @method: (allow-none): an HTTP method, or %NULL for all of them.
+ * @endpoint: (allow-none): an endpoint, like "me" or "{id}/albums", or %NULL
+ *  for all of them.
+ * @counters: (out caller-allocates): return location for the counters.
+ *
+ * Gets the counters of the requests to @endpoint with @method, added up if
+ * several endpoints match.
+ *
+ * Returns: %TRUE if there are requests recorded for @endpoint.
+ **/
+gboolean
+gfbgraph_metrics_get_counters (GFBGraphMetrics         *metrics,
+                               const gchar             *method,
+                               const gchar             *endpoint,
+                               GFBGraphMetricsCounters *counters)
+{
+  GFBGraphMetricsPrivate *priv;
+  GHashTableIter iter;
+  Endpoint *entry;
+  gchar *normalized = NULL;
+  gboolean found = FALSE;
+
+  g_return_val_if_fail (GFBGRAPH_IS_METRICS (metrics), FALSE);
+  g_return_val_if_fail (counters != NULL, FALSE);
+
+  priv = GFBGRAPH_METRICS_GET_PRIVATE (metrics);
+
+  memset (counters, 0, sizeof (GFBGraphMetricsCounters));
+  if (endpoint != NULL)
+    normalized = normalize_endpoint (endpoint);
+
+  g_mutex_lock (&priv->mutex);
+  g_hash_table_iter_init (&iter, priv->endpoints);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry)) {
+    if ((method == NULL || g_strcmp0 (method, entry->method) == 0) &&
+        (normalized == NULL || g_strcmp0 (normalized, entry->endpoint) == 0)) {
+      counters_add (counters, &entry->counters);
+      found = TRUE;
+    }
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  g_free (normalized);
+
+  return found;
+}
+
+/**
+ * gfbgraph_metrics_get_parse_time:
+ * @metrics: a #GFBGraphMetrics.
+ * @n_parses: (out) (allow-none): return location for the number of responses
+ *  parsed, or %NULL.
+ *
+ * Gets the time spent parsing the responses of all the endpoints, see
+ * #GFBGraphMetricsCounters.parse_time for the time of every endpoint.
+ *
+ * Returns: the time spent parsing the JSON of the responses, in microseconds.
+ **/
+gint64
+gfbgraph_metrics_get_parse_time (GFBGraphMetrics *metrics,
+                                 guint64         *n_parses)
+{
+  GFBGraphMetricsCounters counters;
+
+  g_return_val_if_fail (GFBGRAPH_IS_METRICS (metrics), 0);
+
+  gfbgraph_metrics_get_counters (metrics, NULL, NULL, &counters);
+  if (n_parses != NULL)
+    *n_parses = counters.n_parses;
+
+  return counters.parse_time;
+}
+
+/**
+ * gfbgraph_metrics_get_deserialize_time:
+ * @metrics: a #GFBGraphMetrics.
+ * @n_deserializations: (out) (allow-none): return location for the number of
+ *  responses deserialized, or %NULL.
+ *
+ * Gets the time spent deserializing the responses of all the endpoints, see
+ * #GFBGraphMetricsCounters.deserialize_time for the time of every endpoint.
+ *
+ * Returns: the time spent building the nodes of the responses, in microseconds.
+ **/
+gint64
+gfbgraph_metrics_get_deserialize_time (GFBGraphMetrics *metrics,
+                                       guint64         *n_deserializations)
+{
+  GFBGraphMetricsCounters counters;
+
+  g_return_val_if_fail (GFBGRAPH_IS_METRICS (metrics), 0);
+
+  gfbgraph_metrics_get_counters (metrics, NULL, NULL, &counters);
+  if (n_deserializations != NULL)
+    *n_deserializations = counters.n_deserializations;
+
+  return counters.deserialize_time;
+}
+
+/**
+ * gfbgraph_metrics_get_latency_bound:
+ * @bucket: the index of a bucket of #GFBGraphMetricsCounters.latency_buckets.
+ *
+ * Gets the upper bound of the latencies counted in @bucket. The buckets go
+ * from 5 milliseconds to 10 seconds, and the last one has no bound.
+ *
+ * Returns: the bound in microseconds, or %G_MAXINT64 for the last bucket.
+ **/
+gint64
+gfbgraph_metrics_get_latency_bound (guint bucket)
+{
+  g_return_val_if_fail (bucket < GFBGRAPH_METRICS_N_LATENCY_BUCKETS, G_MAXINT64);
+
+  if (bucket < G_N_ELEMENTS (latency_bounds))
+    return latency_bounds[bucket];
+
+  return G_MAXINT64;
+}
+
+/**
+ * gfbgraph_metrics_foreach:
+ * @metrics: a #GFBGraphMetrics.
+ * @func: (scope call): the function to call for every endpoint.
+ * @user_data: the data to pass to @func.
+ *
+ * Calls @func with the counters of every endpoint with recorded requests,
+ * sorted by method and endpoint, to export them to a monitoring system. The
+ * counters are copied before, so @func can use @metrics.
+ **/
+void
+gfbgraph_metrics_foreach (GFBGraphMetrics            *metrics,
+                          GFBGraphMetricsForeachFunc  func,
+                          gpointer                    user_data)
+{
+  GPtrArray *snapshot;
+  guint i;
+
+  g_return_if_fail (GFBGRAPH_IS_METRICS (metrics));
+  g_return_if_fail (func != NULL);
+
+  snapshot = snapshot_endpoints (GFBGRAPH_METRICS_GET_PRIVATE (metrics));
+  for (i = 0; i < snapshot->len; i++) {
+    Endpoint *endpoint = g_ptr_array_index (snapshot, i);
+
+    func (endpoint->method, endpoint->endpoint, &endpoint->counters, user_data);
+  }
+  g_ptr_array_unref (snapshot);
+}
+
+static void
+append_labels (GString     *dump,
+               const gchar *name,
+               Endpoint    *endpoint)
+{
+  const gchar *c;
+
+  g_string_append_printf (dump, "%s{method=\"%s\",endpoint=\"", name, endpoint->method);
+  for (c = endpoint->endpoint; *c != '\0'; c++) {
+    if (*c == '\\' || *c == '"')
+      g_string_append_c (dump, '\\');
+    if (*c == '\n')
+      g_string_append (dump, "\\n");
+    else
+      g_string_append_c (dump, *c);
+  }
+  g_string_append_c (dump, '"');
+}
+
+static void
+append_seconds (GString *dump,
+                gint64   usec)
+{
+  gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append (dump, g_ascii_dtostr (buffer, sizeof (buffer), (gdouble) usec / G_USEC_PER_SEC));
+}
+
+/* A counter of every endpoint, offset is the one of the counter in
+ * #GFBGraphMetricsCounters */
+static void
+append_counter (GString     *dump,
+                GPtrArray   *snapshot,
+                const gchar *name,
+                const gchar *help,
+                gsize        offset)
+{
+  guint i;
+
+  g_string_append_printf (dump, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+  for (i = 0; i < snapshot->len; i++) {
+    Endpoint *endpoint = g_ptr_array_index (snapshot, i);
+
+    append_labels (dump, name, endpoint);
+    g_string_append_printf (dump, "} %" G_GUINT64_FORMAT "\n",
+                            G_STRUCT_MEMBER (guint64, &endpoint->counters, offset));
+  }
+}
+
+/* A time in seconds of every endpoint, offset is the one of the time in
+ * microseconds in #GFBGraphMetricsCounters */
+static void
+append_seconds_counter (GString     *dump,
+                        GPtrArray   *snapshot,
+                        const gchar *name,
+                        const gchar *help,
+                        gsize        offset)
+{
+  guint i;
+
+  g_string_append_printf (dump, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+  for (i = 0; i < snapshot->len; i++) {
+    Endpoint *endpoint = g_ptr_array_index (snapshot, i);
+
+    append_labels (dump, name, endpoint);
+    g_string_append (dump, "} ");
+    append_seconds (dump, G_STRUCT_MEMBER (gint64, &endpoint->counters, offset));
+    g_string_append_c (dump, '\n');
+  }
+}
+
+/**
+ * gfbgraph_metrics_dump_prometheus:
+ * @metrics: a #GFBGraphMetrics.
+ *
+ * Dumps the metrics in the Prometheus text exposition format, to be served
+ * to a Prometheus server or written to a file for its node exporter.
+ *
+ * Returns: (transfer full): a newly-allocated string, free it with g_free().
+ **/
+gchar*
+gfbgraph_metrics_dump_prometheus (GFBGraphMetrics *metrics)
+{
+  GPtrArray *snapshot;
+  GString *dump;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_METRICS (metrics), NULL);
+
+  snapshot = snapshot_endpoints (GFBGRAPH_METRICS_GET_PRIVATE (metrics));
+
+  dump = g_string_new (NULL);
+
+  append_counter (dump, snapshot, "gfbgraph_requests_total", "Requests sent to the Graph API.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, n_requests));
+  append_counter (dump, snapshot, "gfbgraph_request_errors_total", "Requests to the Graph API that failed.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, n_errors));
+  append_counter (dump, snapshot, "gfbgraph_request_retries_total", "Failed requests sent again.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, n_retries));
+  append_counter (dump, snapshot, "gfbgraph_cache_hits_total", "Responses served by the response cache.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, n_cache_hits));
+  append_counter (dump, snapshot, "gfbgraph_sent_bytes_total", "Bytes of the parameters of the requests.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, bytes_sent));
+  append_counter (dump, snapshot, "gfbgraph_received_bytes_total", "Bytes of the payloads of the responses.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, bytes_received));
+
+  g_string_append (dump,
+                   "# HELP gfbgraph_request_duration_seconds Latency of the requests to the Graph API.\n"
+                   "# TYPE gfbgraph_request_duration_seconds histogram\n");
+  for (i = 0; i < snapshot->len; i++) {
+    Endpoint *endpoint = g_ptr_array_index (snapshot, i);
+    guint64 count = 0;
+    guint bucket;
+
+    for (bucket = 0; bucket < GFBGRAPH_METRICS_N_LATENCY_BUCKETS; bucket++) {
+      count += endpoint->counters.latency_buckets[bucket];
+      append_labels (dump, "gfbgraph_request_duration_seconds_bucket", endpoint);
+      g_string_append (dump, ",le=\"");
+      if (bucket < G_N_ELEMENTS (latency_bounds))
+        append_seconds (dump, latency_bounds[bucket]);
+      else
+        g_string_append (dump, "+Inf");
+      g_string_append_printf (dump, "\"} %" G_GUINT64_FORMAT "\n", count);
+    }
+
+    append_labels (dump, "gfbgraph_request_duration_seconds_sum", endpoint);
+    g_string_append (dump, "} ");
+    append_seconds (dump, endpoint->counters.latency_sum);
+    g_string_append_c (dump, '\n');
+
+    append_labels (dump, "gfbgraph_request_duration_seconds_count", endpoint);
+    g_string_append_printf (dump, "} %" G_GUINT64_FORMAT "\n", count);
+  }
+
+  append_counter (dump, snapshot, "gfbgraph_json_parses_total", "Responses parsed.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, n_parses));
+  append_seconds_counter (dump, snapshot, "gfbgraph_json_parse_seconds_total", "Time spent parsing the responses.",
+                          G_STRUCT_OFFSET (GFBGraphMetricsCounters, parse_time));
+  append_counter (dump, snapshot, "gfbgraph_deserializations_total", "Responses deserialized into nodes.",
+                  G_STRUCT_OFFSET (GFBGraphMetricsCounters, n_deserializations));
+  append_seconds_counter (dump, snapshot, "gfbgraph_deserialize_seconds_total", "Time spent deserializing the nodes.",
+                          G_STRUCT_OFFSET (GFBGraphMetricsCounters, deserialize_time));
+
+  g_ptr_array_unref (snapshot);
+
+  return g_string_free (dump, FALSE);
+}
+
+/**
+ * gfbgraph_metrics_reset:
+ * @metrics: a #GFBGraphMetrics.
+ *
+ * Sets all the counters of @metrics to zero.
+ **/
+void
+gfbgraph_metrics_reset (GFBGraphMetrics *metrics)
+{
+  GFBGraphMetricsPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_METRICS (metrics));
+
+  priv = GFBGRAPH_METRICS_GET_PRIVATE (metrics);
+
+  g_mutex_lock (&priv->mutex);
+  g_hash_table_remove_all (priv->endpoints);
+  g_mutex_unlock (&priv->mutex);
+}
@@ -0,0 +1,142 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_METRICS_H__
+#define __GFBGRAPH_METRICS_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GFBGRAPH_METRICS_N_LATENCY_BUCKETS:
+ *
+ * The number of buckets of the latency histograms, see
+ * gfbgraph_metrics_get_latency_bound().
+ **/
+#define GFBGRAPH_METRICS_N_LATENCY_BUCKETS 12
+
+/**
+ * GFBGraphMetricsCounters:
+ * @n_requests: the requests sent to the Graph API, retries included.
+ * @n_errors: the requests that failed.
+ * @n_retries: the requests sent again after a failure.
+ * @n_cache_hits: the responses served by the response cache, without a
+ *  request or after revalidating them.
+ * @bytes_sent: the bytes of the parameters of the requests.
+ * @bytes_received: the bytes of the payloads of the responses.
+ * @latency_sum: the sum of the latencies of the requests, in microseconds.
+ * @latency_buckets: the number of requests in every latency bucket.
+ * @n_parses: the responses parsed.
+ * @parse_time: the time spent parsing the JSON of the responses, in
+ *  microseconds.
+ * @n_deserializations: the responses deserialized.
+ * @deserialize_time: the time spent building the nodes of the responses, in
+ *  microseconds.
+ *
+ * The counters of the requests to an endpoint of the Graph API.
+ **/
+typedef struct
+{
+  guint64 n_requests;
+  guint64 n_errors;
+  guint64 n_retries;
+  guint64 n_cache_hits;
+  guint64 bytes_sent;
+  guint64 bytes_received;
+  gint64  latency_sum;
+  guint64 latency_buckets[GFBGRAPH_METRICS_N_LATENCY_BUCKETS];
+  guint64 n_parses;
+  gint64  parse_time;
+  guint64 n_deserializations;
+  gint64  deserialize_time;
+} GFBGraphMetricsCounters;
+
+/**
+ * GFBGraphMetricsForeachFunc:
+ * @method: the HTTP method of the requests.
+ * @endpoint: the endpoint of the requests, with the IDs replaced by "{id}".
+ * @counters: the counters of the requests.
+ * @user_data: the data passed to gfbgraph_metrics_foreach().
+ *
+ * The function called by gfbgraph_metrics_foreach() for every endpoint.
+ **/
+typedef void (*GFBGraphMetricsForeachFunc) (const gchar                   *method,
+                                            const gchar                   *endpoint,
+                                            const GFBGraphMetricsCounters *counters,
+                                            gpointer                       user_data);
+
+#define GFBGRAPH_TYPE_METRICS (gfbgraph_metrics_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphMetrics, gfbgraph_metrics, GFBGRAPH, METRICS, GObject)
+
+struct _GFBGraphMetricsClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+GFBGraphMetrics* gfbgraph_metrics_new                   (void);
+
+void             gfbgraph_metrics_record_request        (GFBGraphMetrics            *metrics,
+                                                         const gchar                *method,
+                                                         const gchar                *endpoint,
+                                                         gint64                      latency,
+                                                         gsize                       bytes_sent,
+                                                         gsize                       bytes_received,
+                                                         const GError               *error);
+void             gfbgraph_metrics_record_retry          (GFBGraphMetrics            *metrics,
+                                                         const gchar                *method,
+                                                         const gchar                *endpoint);
+void             gfbgraph_metrics_record_cache_hit      (GFBGraphMetrics            *metrics,
+                                                         const gchar                *method,
+                                                         const gchar                *endpoint);
+void             gfbgraph_metrics_record_parse          (GFBGraphMetrics            *metrics,
+                                                         const gchar                *method,
+                                                         const gchar                *endpoint,
+                                                         gint64                      duration);
+void             gfbgraph_metrics_record_deserialize    (GFBGraphMetrics            *metrics,
+                                                         const gchar                *method,
+                                                         const gchar                *endpoint,
+                                                         gint64                      duration);
+
+gboolean         gfbgraph_metrics_get_counters          (GFBGraphMetrics            *metrics,
+                                                         const gchar                *method,
+                                                         const gchar                *endpoint,
+                                                         GFBGraphMetricsCounters    *counters);
+gint64           gfbgraph_metrics_get_parse_time        (GFBGraphMetrics            *metrics,
+                                                         guint64                    *n_parses);
+gint64           gfbgraph_metrics_get_deserialize_time  (GFBGraphMetrics            *metrics,
+                                                         guint64                    *n_deserializations);
+gint64           gfbgraph_metrics_get_latency_bound     (guint                       bucket);
+
+void             gfbgraph_metrics_foreach               (GFBGraphMetrics            *metrics,
+                                                         GFBGraphMetricsForeachFunc  func,
+                                                         gpointer                    user_data);
+gchar*           gfbgraph_metrics_dump_prometheus       (GFBGraphMetrics            *metrics);
+void             gfbgraph_metrics_reset                 (GFBGraphMetrics            *metrics);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_METRICS_H__ */
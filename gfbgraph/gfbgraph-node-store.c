@@ -0,0 +1,1436 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-node-store
+ * @title: GFBGraphNodeStore
+ * @short_description: Persistent store of nodes and their connections.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphNodeStore keeps an offline snapshot of a part of the graph: nodes,
+ * like albums, photos and users, and the connections between them.
+ *
+ * The store is an append-only log of binary records, the #GVariant
+ * serialization of the nodes, and an index sorted by node ID written next to
+ * it by gfbgraph_node_store_flush(). Both files are memory-mapped, so opening
+ * a store doesn't read the records, and the nodes are only rehydrated when
+ * they are requested with gfbgraph_node_store_get_node(), directly from the
+ * mapped log.
+ *
+ * Adding a node that is already in the store replaces it, the old record is
+ * kept in the log but isn't reachable anymore. If the process dies before the
+ * index is written, the records appended after the last flush are recovered
+ * from the log when the store is opened again.
+ **/
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <json-glib/json-glib.h>
+#include <json-glib/json-gobject.h>
+
+#include "gfbgraph-album.h"
+#include "gfbgraph-node-store.h"
+#include "gfbgraph-photo.h"
+#include "gfbgraph-private.h"
+#include "gfbgraph-user.h"
+
+#define LOG_MAGIC          "GFBGNS1\n"
+#define INDEX_MAGIC        "GFBGNI1\n"
+#define MAGIC_SIZE         8
+#define RECORD_HEADER_SIZE 8
+#define ALIGN8(_n)         (((_n) + 7) & ~(guint64) 7)
+
+/* Every record starts with a header of its size, as a little endian guint32,
+ * and its kind, then the serialized #GVariant. Records are 8 bytes aligned, so
+ * the variants can be used in place. */
+enum
+{
+  RECORD_NODE = 1,
+  RECORD_EDGE,
+  RECORD_EDGE_REMOVED
+};
+
+/* Type name, ID and properties, as serialized by json_gobject_serialize() */
+#define NODE_RECORD_TYPE   G_VARIANT_TYPE ("(ssv)")
+/* ID, type name and ID of the connected node. The type name is empty in the
+ * records removing a connection. */
+#define EDGE_RECORD_TYPE   G_VARIANT_TYPE ("(sss)")
+
+/* The index has a header followed by the node entries and the edge entries,
+ * both sorted by the hash of the ID. All the fields are little endian. The
+ * node entries also have the hash of the updated_time of the node, or 0 if
+ * it has none, to find the outdated nodes without rehydrating them. */
+typedef struct
+{
+  gchar   magic[MAGIC_SIZE];
+  guint64 log_size;
+  guint64 n_nodes;
+  guint64 n_edges;
+} IndexHeader;
+
+typedef struct
+{
+  guint32 hash;
+  guint32 updated_hash;
+  guint64 offset;
+} IndexEntry;
+
+/* The latest record of a node appended since the index was written */
+typedef struct
+{
+  guint64 offset;
+  guint32 updated_hash;
+} TailNode;
+
+typedef struct
+{
+  GMutex            mutex;
+  gchar            *path;
+  gchar            *index_path;
+
+  FILE             *log;
+  guint64           log_size;
+  GMappedFile      *log_map;
+  GBytes           *log_bytes;
+
+  GMappedFile      *index_map;
+  const IndexEntry *index_nodes;
+  guint64           n_index_nodes;
+  const IndexEntry *index_edges;
+  guint64           n_index_edges;
+
+  /* The records appended since the index was written */
+  GHashTable       *nodes;
+  GHashTable       *edges;
+  /* The offsets of the index entries replaced by a newer record */
+  GHashTable       *superseded;
+  /* The sets of the IDs connected to a node, read once from the log and
+   * updated by the edge records appended afterwards */
+  GHashTable       *live_edges;
+  guint             n_nodes;
+} GFBGraphNodeStorePrivate;
+
+static void gfbgraph_node_store_initable_iface_init (GInitableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GFBGraphNodeStore, gfbgraph_node_store, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GFBGraphNodeStore)
+                         G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE, gfbgraph_node_store_initable_iface_init));
+
+enum
+{
+  PROP_0,
+  PROP_PATH,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_NODE_STORE_GET_PRIVATE(_obj) gfbgraph_node_store_get_instance_private (GFBGRAPH_NODE_STORE (_obj))
+
+static gboolean gfbgraph_node_store_flush_unlocked (GFBGraphNodeStorePrivate  *priv,
+                                                    GError                   **error);
+
+/* FNV-1a, g_str_hash() isn't guaranteed to be stable between versions */
+static guint32
+hash_id (const gchar *id)
+{
+  guint32 hash = 2166136261u;
+
+  for (; *id != '\0'; id++) {
+    hash ^= (guchar) *id;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+/* Never 0, which is for the nodes without updated_time */
+static guint32
+hash_updated_time (const gchar *updated_time)
+{
+  if (updated_time == NULL)
+    return 0;
+
+  return MAX (hash_id (updated_time), 1);
+}
+
+static gint
+compare_entries (gconstpointer a,
+                 gconstpointer b)
+{
+  const IndexEntry *entry_a = a;
+  const IndexEntry *entry_b = b;
+
+  if (entry_a->hash != entry_b->hash)
+    return entry_a->hash < entry_b->hash ? -1 : 1;
+  if (entry_a->offset != entry_b->offset)
+    return entry_a->offset < entry_b->offset ? -1 : 1;
+
+  return 0;
+}
+
+static void
+set_io_error (GError      **error,
+              const gchar  *path)
+{
+  int errsv = errno;
+
+  g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+               "Error writing %s: %s", path, g_strerror (errsv));
+}
+
+static gboolean
+map_log (GFBGraphNodeStorePrivate  *priv,
+         GError                   **error)
+{
+  GMappedFile *map;
+
+  if (fflush (priv->log) != 0) {
+    set_io_error (error, priv->path);
+    return FALSE;
+  }
+
+  map = g_mapped_file_new (priv->path, FALSE, error);
+  if (map == NULL)
+    return FALSE;
+
+  /* The nodes already rehydrated keep the previous mapping alive */
+  g_clear_pointer (&priv->log_bytes, g_bytes_unref);
+  g_clear_pointer (&priv->log_map, g_mapped_file_unref);
+  priv->log_map = map;
+  priv->log_bytes = g_mapped_file_get_bytes (map);
+
+  return TRUE;
+}
+
+/* Gets the record at @offset, mapping again the log if it was appended after
+ * the current mapping. Returns %NULL if the record is truncated. */
+static GVariant*
+get_record (GFBGraphNodeStorePrivate  *priv,
+            guint64                    offset,
+            guint8                    *kind,
+            GError                   **error)
+{
+  const guint8 *data;
+  gsize length;
+  guint32 size;
+  GBytes *bytes;
+  GVariant *record;
+
+  length = g_bytes_get_size (priv->log_bytes);
+  if (offset + RECORD_HEADER_SIZE > length) {
+    if (priv->log_size <= length || !map_log (priv, error))
+      goto corrupt;
+    length = g_bytes_get_size (priv->log_bytes);
+    if (offset + RECORD_HEADER_SIZE > length)
+      goto corrupt;
+  }
+
+  data = (const guint8 *) g_bytes_get_data (priv->log_bytes, NULL) + offset;
+  size = GUINT32_FROM_LE (*(const guint32 *) data);
+  *kind = data[4];
+
+  if (offset + RECORD_HEADER_SIZE + size > length) {
+    if (priv->log_size <= length || !map_log (priv, error))
+      goto corrupt;
+    length = g_bytes_get_size (priv->log_bytes);
+    data = (const guint8 *) g_bytes_get_data (priv->log_bytes, NULL) + offset;
+  }
+
+  if ((*kind != RECORD_NODE && *kind != RECORD_EDGE && *kind != RECORD_EDGE_REMOVED) ||
+      offset + RECORD_HEADER_SIZE + size > length)
+    goto corrupt;
+
+  bytes = g_bytes_new_from_bytes (priv->log_bytes, offset + RECORD_HEADER_SIZE, size);
+  record = g_variant_new_from_bytes (*kind == RECORD_NODE ? NODE_RECORD_TYPE : EDGE_RECORD_TYPE, bytes, FALSE);
+  g_bytes_unref (bytes);
+
+  return g_variant_ref_sink (record);
+
+ corrupt:
+  if (error != NULL && *error != NULL)
+    return NULL;
+  g_set_error (error, GFBGRAPH_NODE_STORE_ERROR, GFBGRAPH_NODE_STORE_ERROR_CORRUPT,
+               "Truncated or invalid record at offset %" G_GUINT64_FORMAT " of %s", offset, priv->path);
+  return NULL;
+}
+
+/* Gets the ID of the node record at @offset, or the source ID of an edge */
+static gboolean
+record_has_id (GFBGraphNodeStorePrivate *priv,
+               guint64                   offset,
+               const gchar              *id)
+{
+  GVariant *record;
+  const gchar *record_id;
+  guint8 kind;
+  gboolean found;
+
+  record = get_record (priv, offset, &kind, NULL);
+  if (record == NULL)
+    return FALSE;
+
+  g_variant_get_child (record, kind == RECORD_NODE ? 1 : 0, "&s", &record_id);
+  found = g_strcmp0 (record_id, id) == 0;
+  g_variant_unref (record);
+
+  return found;
+}
+
+/* The first entry of @entries with @hash */
+static guint64
+find_first_entry (const IndexEntry *entries,
+                  guint64           n_entries,
+                  guint32           hash)
+{
+  guint64 low = 0;
+  guint64 high = n_entries;
+
+  while (low < high) {
+    guint64 mid = low + (high - low) / 2;
+
+    if (GUINT32_FROM_LE (entries[mid].hash) < hash)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return low;
+}
+
+static const IndexEntry*
+index_lookup_node_entry (GFBGraphNodeStorePrivate *priv,
+                         const gchar              *id)
+{
+  guint32 hash;
+  guint64 i;
+
+  hash = hash_id (id);
+  for (i = find_first_entry (priv->index_nodes, priv->n_index_nodes, hash);
+       i < priv->n_index_nodes && GUINT32_FROM_LE (priv->index_nodes[i].hash) == hash;
+       i++) {
+    if (record_has_id (priv, GUINT64_FROM_LE (priv->index_nodes[i].offset), id))
+      return &priv->index_nodes[i];
+  }
+
+  return NULL;
+}
+
+static guint64
+index_lookup_node (GFBGraphNodeStorePrivate *priv,
+                   const gchar              *id)
+{
+  const IndexEntry *entry;
+
+  entry = index_lookup_node_entry (priv, id);
+
+  return entry != NULL ? GUINT64_FROM_LE (entry->offset) : 0;
+}
+
+/* The offset of the latest record of the node @id, or 0, and the hash of its
+ * updated_time */
+static guint64
+lookup_node_full (GFBGraphNodeStorePrivate *priv,
+                  const gchar              *id,
+                  guint32                  *updated_hash)
+{
+  const IndexEntry *entry;
+  TailNode *tail_node;
+
+  tail_node = g_hash_table_lookup (priv->nodes, id);
+  if (tail_node != NULL) {
+    *updated_hash = tail_node->updated_hash;
+    return tail_node->offset;
+  }
+
+  entry = index_lookup_node_entry (priv, id);
+  if (entry == NULL)
+    return 0;
+
+  *updated_hash = GUINT32_FROM_LE (entry->updated_hash);
+  return GUINT64_FROM_LE (entry->offset);
+}
+
+/* The offset of the latest record of the node @id, or 0 */
+static guint64
+lookup_node (GFBGraphNodeStorePrivate *priv,
+             const gchar              *id)
+{
+  guint32 updated_hash;
+
+  return lookup_node_full (priv, id, &updated_hash);
+}
+
+/* The offsets of the edge records of the node @id */
+static GArray*
+lookup_edges (GFBGraphNodeStorePrivate *priv,
+              const gchar              *id)
+{
+  GArray *offsets;
+  GArray *tail;
+  guint32 hash;
+  guint64 i;
+
+  offsets = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  hash = hash_id (id);
+  for (i = find_first_entry (priv->index_edges, priv->n_index_edges, hash);
+       i < priv->n_index_edges && GUINT32_FROM_LE (priv->index_edges[i].hash) == hash;
+       i++) {
+    guint64 offset = GUINT64_FROM_LE (priv->index_edges[i].offset);
+
+    if (record_has_id (priv, offset, id))
+      g_array_append_val (offsets, offset);
+  }
+
+  tail = g_hash_table_lookup (priv->edges, id);
+  if (tail != NULL)
+    g_array_append_vals (offsets, tail->data, tail->len);
+
+  return offsets;
+}
+
+/* The edge records of the node @id not removed afterwards, in the order they
+ * were added. The offsets of the index and the tail are both sorted. */
+static GPtrArray*
+get_live_edges (GFBGraphNodeStorePrivate *priv,
+                const gchar              *id)
+{
+  GArray *offsets;
+  GPtrArray *edges;
+  GHashTable *positions;
+  guint n_edges = 0;
+  guint i;
+
+  offsets = lookup_edges (priv, id);
+  edges = g_ptr_array_new ();
+  positions = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (i = 0; i < offsets->len; i++) {
+    GVariant *record;
+    const gchar *connected_id;
+    gpointer position;
+    guint8 kind;
+
+    record = get_record (priv, g_array_index (offsets, guint64, i), &kind, NULL);
+    if (record == NULL)
+      continue;
+
+    g_variant_get_child (record, 2, "&s", &connected_id);
+    if (g_hash_table_lookup_extended (positions, connected_id, NULL, &position)) {
+      if (kind == RECORD_EDGE_REMOVED) {
+        g_hash_table_remove (positions, connected_id);
+        g_clear_pointer (&g_ptr_array_index (edges, GPOINTER_TO_UINT (position)), g_variant_unref);
+      }
+      g_variant_unref (record);
+    } else if (kind == RECORD_EDGE) {
+      /* The key is owned by the record */
+      g_hash_table_insert (positions, (gpointer) connected_id, GUINT_TO_POINTER (edges->len));
+      g_ptr_array_add (edges, record);
+    } else {
+      g_variant_unref (record);
+    }
+  }
+
+  g_hash_table_unref (positions);
+  g_array_unref (offsets);
+
+  /* Drops the removed ones */
+  for (i = 0; i < edges->len; i++) {
+    if (g_ptr_array_index (edges, i) != NULL)
+      g_ptr_array_index (edges, n_edges++) = g_ptr_array_index (edges, i);
+  }
+  g_ptr_array_set_size (edges, n_edges);
+  g_ptr_array_set_free_func (edges, (GDestroyNotify) g_variant_unref);
+
+  return edges;
+}
+
+/* The set of the IDs connected to the node @id */
+static GHashTable*
+ensure_live_edges (GFBGraphNodeStorePrivate *priv,
+                   const gchar              *id)
+{
+  GHashTable *connected_ids;
+  GPtrArray *edges;
+  guint i;
+
+  connected_ids = g_hash_table_lookup (priv->live_edges, id);
+  if (connected_ids != NULL)
+    return connected_ids;
+
+  connected_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  edges = get_live_edges (priv, id);
+  for (i = 0; i < edges->len; i++) {
+    gchar *connected_id;
+
+    g_variant_get_child (g_ptr_array_index (edges, i), 2, "s", &connected_id);
+    g_hash_table_add (connected_ids, connected_id);
+  }
+  g_ptr_array_unref (edges);
+
+  g_hash_table_insert (priv->live_edges, g_strdup (id), connected_ids);
+
+  return connected_ids;
+}
+
+static void
+add_tail_record (GFBGraphNodeStorePrivate *priv,
+                 guint64                   offset,
+                 guint8                    kind,
+                 GVariant                 *record)
+{
+  const gchar *id;
+
+  if (kind == RECORD_NODE) {
+    GVariant *properties;
+    const gchar *updated_time = NULL;
+    TailNode *tail_node;
+
+    g_variant_get_child (record, 1, "&s", &id);
+    if (!g_hash_table_contains (priv->nodes, id)) {
+      guint64 index_offset;
+
+      index_offset = index_lookup_node (priv, id);
+      if (index_offset != 0) {
+        guint64 *superseded;
+
+        superseded = g_new (guint64, 1);
+        *superseded = index_offset;
+        g_hash_table_add (priv->superseded, superseded);
+      } else
+        priv->n_nodes++;
+    }
+
+    /* The properties as written by json_gobject_serialize() */
+    g_variant_get_child (record, 2, "v", &properties);
+    if (g_variant_is_of_type (properties, G_VARIANT_TYPE_VARDICT))
+      g_variant_lookup (properties, "updated-time", "&s", &updated_time);
+
+    tail_node = g_new (TailNode, 1);
+    tail_node->offset = offset;
+    tail_node->updated_hash = hash_updated_time (updated_time);
+    g_hash_table_insert (priv->nodes, g_strdup (id), tail_node);
+    g_variant_unref (properties);
+  } else {
+    GHashTable *connected_ids;
+    GArray *offsets;
+
+    g_variant_get_child (record, 0, "&s", &id);
+    offsets = g_hash_table_lookup (priv->edges, id);
+    if (offsets == NULL) {
+      offsets = g_array_new (FALSE, FALSE, sizeof (guint64));
+      g_hash_table_insert (priv->edges, g_strdup (id), offsets);
+    }
+    g_array_append_val (offsets, offset);
+
+    connected_ids = g_hash_table_lookup (priv->live_edges, id);
+    if (connected_ids != NULL) {
+      gchar *connected_id;
+
+      g_variant_get_child (record, 2, "s", &connected_id);
+      if (kind == RECORD_EDGE) {
+        g_hash_table_add (connected_ids, connected_id);
+      } else {
+        g_hash_table_remove (connected_ids, connected_id);
+        g_free (connected_id);
+      }
+    }
+  }
+}
+
+/* Adds the records appended after the index to the tail tables. A truncated
+ * record, from a write interrupted by a crash, is dropped from the log. */
+static gboolean
+scan_log (GFBGraphNodeStorePrivate  *priv,
+          guint64                    offset,
+          GError                   **error)
+{
+  gsize length;
+
+  length = g_bytes_get_size (priv->log_bytes);
+  priv->log_size = length;
+
+  while (offset < length) {
+    GVariant *record;
+    guint8 kind;
+
+    record = get_record (priv, offset, &kind, NULL);
+    if (record == NULL || !g_variant_is_normal_form (record)) {
+      g_clear_pointer (&record, g_variant_unref);
+      g_warning ("Dropping %" G_GUINT64_FORMAT " invalid bytes at the end of %s",
+                 (guint64) (length - offset), priv->path);
+      if (ftruncate (fileno (priv->log), offset) != 0) {
+        set_io_error (error, priv->path);
+        return FALSE;
+      }
+
+      /* The records appended from now on must be read through a mapping of
+       * the truncated file, not past the end of the previous one */
+      if (!map_log (priv, error))
+        return FALSE;
+      length = g_bytes_get_size (priv->log_bytes);
+      break;
+    }
+
+    add_tail_record (priv, offset, kind, record);
+    offset += RECORD_HEADER_SIZE + ALIGN8 (g_variant_get_size (record));
+    g_variant_unref (record);
+  }
+
+  priv->log_size = MIN (offset, length);
+
+  return TRUE;
+}
+
+static void
+clear_index (GFBGraphNodeStorePrivate *priv)
+{
+  g_clear_pointer (&priv->index_map, g_mapped_file_unref);
+  priv->index_nodes = NULL;
+  priv->n_index_nodes = 0;
+  priv->index_edges = NULL;
+  priv->n_index_edges = 0;
+}
+
+/* Maps the index, returns the size of the log covered by it, or 0 if the
+ * index doesn't exist or doesn't match the log */
+static guint64
+load_index (GFBGraphNodeStorePrivate *priv)
+{
+  const IndexHeader *header;
+  const gchar *contents;
+  guint64 log_size;
+  guint64 n_nodes;
+  guint64 n_edges;
+  gsize length;
+
+  clear_index (priv);
+
+  priv->index_map = g_mapped_file_new (priv->index_path, FALSE, NULL);
+  if (priv->index_map == NULL)
+    return 0;
+
+  contents = g_mapped_file_get_contents (priv->index_map);
+  length = g_mapped_file_get_length (priv->index_map);
+  if (length < sizeof (IndexHeader))
+    goto invalid;
+
+  header = (const IndexHeader *) contents;
+  log_size = GUINT64_FROM_LE (header->log_size);
+  n_nodes = GUINT64_FROM_LE (header->n_nodes);
+  n_edges = GUINT64_FROM_LE (header->n_edges);
+
+  if (memcmp (header->magic, INDEX_MAGIC, MAGIC_SIZE) != 0 ||
+      log_size > g_bytes_get_size (priv->log_bytes) ||
+      n_nodes > G_MAXSIZE / sizeof (IndexEntry) ||
+      n_edges > G_MAXSIZE / sizeof (IndexEntry) ||
+      length != sizeof (IndexHeader) + (n_nodes + n_edges) * sizeof (IndexEntry))
+    goto invalid;
+
+  priv->index_nodes = (const IndexEntry *) (contents + sizeof (IndexHeader));
+  priv->n_index_nodes = n_nodes;
+  priv->index_edges = priv->index_nodes + n_nodes;
+  priv->n_index_edges = n_edges;
+  priv->n_nodes = n_nodes;
+
+  return log_size;
+
+ invalid:
+  g_warning ("Ignoring the invalid index %s", priv->index_path);
+  clear_index (priv);
+  return 0;
+}
+
+static gboolean
+append_record (GFBGraphNodeStorePrivate  *priv,
+               guint8                     kind,
+               GVariant                  *record,
+               GError                   **error)
+{
+  static const guint8 padding[8] = { 0 };
+  guint8 header[RECORD_HEADER_SIZE] = { 0 };
+  guint32 size;
+  guint64 offset;
+
+  g_variant_ref_sink (record);
+
+  size = g_variant_get_size (record);
+  *(guint32 *) header = GUINT32_TO_LE (size);
+  header[4] = kind;
+
+  offset = priv->log_size;
+  if (fwrite (header, RECORD_HEADER_SIZE, 1, priv->log) != 1 ||
+      fwrite (g_variant_get_data (record), size, 1, priv->log) != 1 ||
+      (ALIGN8 (size) > size && fwrite (padding, ALIGN8 (size) - size, 1, priv->log) != 1)) {
+    set_io_error (error, priv->path);
+    g_variant_unref (record);
+    return FALSE;
+  }
+
+  priv->log_size += RECORD_HEADER_SIZE + ALIGN8 (size);
+  add_tail_record (priv, offset, kind, record);
+  g_variant_unref (record);
+
+  return TRUE;
+}
+
+static GFBGraphNode*
+node_from_record (GVariant  *record,
+                  GError   **error)
+{
+  GFBGraphNode *node;
+  const gchar *type_name;
+  const gchar *id;
+  GVariant *properties;
+  JsonNode *jnode;
+  GType node_type;
+
+  g_variant_get (record, "(&s&sv)", &type_name, &id, &properties);
+
+  node_type = g_type_from_name (type_name);
+  if (node_type == G_TYPE_INVALID || !g_type_is_a (node_type, GFBGRAPH_TYPE_NODE)) {
+    g_set_error (error, GFBGRAPH_NODE_STORE_ERROR, GFBGRAPH_NODE_STORE_ERROR_UNKNOWN_TYPE,
+                 "The node %s has the unknown type %s", id, type_name);
+    g_variant_unref (properties);
+    return NULL;
+  }
+
+  jnode = json_gvariant_serialize (properties);
+  node = gfbgraph_node_deserialize (node_type, jnode);
+  json_node_free (jnode);
+  g_variant_unref (properties);
+
+  return node;
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_node_store_finalize (GObject *obj)
+{
+  GFBGraphNodeStorePrivate *priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (obj);
+  GError *error = NULL;
+
+  if (priv->log != NULL) {
+    /* Writing the index saves scanning the log when it's opened again */
+    if (!gfbgraph_node_store_flush_unlocked (priv, &error)) {
+      g_warning ("Couldn't write the index of %s: %s", priv->path, error->message);
+      g_error_free (error);
+    }
+    fclose (priv->log);
+  }
+
+  clear_index (priv);
+  g_clear_pointer (&priv->log_bytes, g_bytes_unref);
+  g_clear_pointer (&priv->log_map, g_mapped_file_unref);
+  g_hash_table_unref (priv->nodes);
+  g_hash_table_unref (priv->edges);
+  g_hash_table_unref (priv->superseded);
+  g_hash_table_unref (priv->live_edges);
+  g_free (priv->path);
+  g_free (priv->index_path);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_node_store_parent_class)->finalize (obj);
+}
+
+static void
+gfbgraph_node_store_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  GFBGraphNodeStorePrivate *priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_PATH:
+      g_free (priv->path);
+      priv->path = g_value_dup_string (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_node_store_get_property (GObject    *object,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  GFBGraphNodeStorePrivate *priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_PATH:
+      g_value_set_string (value, priv->path);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_node_store_init (GFBGraphNodeStore *obj)
+{
+  GFBGraphNodeStorePrivate *priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (obj);
+
+  g_mutex_init (&priv->mutex);
+  priv->nodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  priv->edges = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_array_unref);
+  priv->superseded = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+  priv->live_edges = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+}
+
+static void
+gfbgraph_node_store_class_init (GFBGraphNodeStoreClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gfbgraph_node_store_finalize;
+  gobject_class->set_property = gfbgraph_node_store_set_property;
+  gobject_class->get_property = gfbgraph_node_store_get_property;
+
+  /**
+   * GFBGraphNodeStore:path:
+   *
+   * The path of the log of the store. The index is written to the same path
+   * with the ".idx" suffix.
+   **/
+  properties [PROP_PATH] =
+    g_param_spec_string ("path", "Path",
+                         "The path of the log of the store.",
+                         NULL,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+/* --- Internal methods --- */
+static gboolean
+gfbgraph_node_store_initable_init (GInitable     *initable,
+                                   GCancellable  *cancellable,
+                                   GError       **error)
+{
+  GFBGraphNodeStorePrivate *priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (initable);
+  guint64 index_log_size;
+
+  g_return_val_if_fail (priv->path != NULL, FALSE);
+
+  /* The nodes are rehydrated by type name */
+  g_type_ensure (GFBGRAPH_TYPE_ALBUM);
+  g_type_ensure (GFBGRAPH_TYPE_PHOTO);
+  g_type_ensure (GFBGRAPH_TYPE_USER);
+
+  priv->index_path = g_strconcat (priv->path, ".idx", NULL);
+
+  priv->log = g_fopen (priv->path, "ab");
+  if (priv->log == NULL) {
+    int errsv = errno;
+
+    g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                 "Error opening %s: %s", priv->path, g_strerror (errsv));
+    return FALSE;
+  }
+
+  if (fseek (priv->log, 0, SEEK_END) != 0 ||
+      (ftell (priv->log) == 0 && fwrite (LOG_MAGIC, MAGIC_SIZE, 1, priv->log) != 1)) {
+    set_io_error (error, priv->path);
+    goto fail;
+  }
+
+  if (!map_log (priv, error))
+    goto fail;
+
+  if (g_bytes_get_size (priv->log_bytes) < MAGIC_SIZE ||
+      memcmp (g_bytes_get_data (priv->log_bytes, NULL), LOG_MAGIC, MAGIC_SIZE) != 0) {
+    g_set_error (error, GFBGRAPH_NODE_STORE_ERROR, GFBGRAPH_NODE_STORE_ERROR_CORRUPT,
+                 "%s isn't a node store", priv->path);
+    goto fail;
+  }
+
+  index_log_size = load_index (priv);
+
+  if (scan_log (priv, MAX (index_log_size, MAGIC_SIZE), error))
+    return TRUE;
+
+ fail:
+  /* Not to write an index for it when finalized */
+  fclose (priv->log);
+  priv->log = NULL;
+
+  return FALSE;
+}
+
+static void
+gfbgraph_node_store_initable_iface_init (GInitableIface *iface)
+{
+  iface->init = gfbgraph_node_store_initable_init;
+}
+
+static gboolean
+gfbgraph_node_store_flush_unlocked (GFBGraphNodeStorePrivate  *priv,
+                                    GError                   **error)
+{
+  GArray *nodes;
+  GArray *edges;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  IndexHeader header;
+  GString *contents;
+  guint64 i;
+  gboolean success;
+
+  if (fflush (priv->log) != 0 || fsync (fileno (priv->log)) != 0) {
+    set_io_error (error, priv->path);
+    return FALSE;
+  }
+
+  /* Nothing new since the index was written */
+  if (g_hash_table_size (priv->nodes) == 0 && g_hash_table_size (priv->edges) == 0 &&
+      priv->index_map != NULL)
+    return TRUE;
+
+  nodes = g_array_sized_new (FALSE, FALSE, sizeof (IndexEntry), priv->n_nodes);
+  for (i = 0; i < priv->n_index_nodes; i++) {
+    IndexEntry entry;
+
+    entry.hash = GUINT32_FROM_LE (priv->index_nodes[i].hash);
+    entry.updated_hash = GUINT32_FROM_LE (priv->index_nodes[i].updated_hash);
+    entry.offset = GUINT64_FROM_LE (priv->index_nodes[i].offset);
+    if (!g_hash_table_contains (priv->superseded, &entry.offset))
+      g_array_append_val (nodes, entry);
+  }
+
+  g_hash_table_iter_init (&iter, priv->nodes);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    TailNode *tail_node = value;
+    IndexEntry entry;
+
+    entry.hash = hash_id (key);
+    entry.updated_hash = tail_node->updated_hash;
+    entry.offset = tail_node->offset;
+    g_array_append_val (nodes, entry);
+  }
+
+  edges = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+  for (i = 0; i < priv->n_index_edges; i++) {
+    IndexEntry entry;
+
+    entry.hash = GUINT32_FROM_LE (priv->index_edges[i].hash);
+    entry.updated_hash = 0;
+    entry.offset = GUINT64_FROM_LE (priv->index_edges[i].offset);
+    g_array_append_val (edges, entry);
+  }
+
+  g_hash_table_iter_init (&iter, priv->edges);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    GArray *offsets = value;
+    guint j;
+
+    for (j = 0; j < offsets->len; j++) {
+      IndexEntry entry;
+
+      entry.hash = hash_id (key);
+      entry.updated_hash = 0;
+      entry.offset = g_array_index (offsets, guint64, j);
+      g_array_append_val (edges, entry);
+    }
+  }
+
+  g_array_sort (nodes, compare_entries);
+  g_array_sort (edges, compare_entries);
+
+  memcpy (header.magic, INDEX_MAGIC, MAGIC_SIZE);
+  header.log_size = GUINT64_TO_LE (priv->log_size);
+  header.n_nodes = GUINT64_TO_LE ((guint64) nodes->len);
+  header.n_edges = GUINT64_TO_LE ((guint64) edges->len);
+
+  contents = g_string_sized_new (sizeof (IndexHeader) + (nodes->len + edges->len) * sizeof (IndexEntry));
+  g_string_append_len (contents, (const gchar *) &header, sizeof (IndexHeader));
+  for (i = 0; i < nodes->len; i++) {
+    IndexEntry *entry = &g_array_index (nodes, IndexEntry, i);
+
+    entry->hash = GUINT32_TO_LE (entry->hash);
+    entry->updated_hash = GUINT32_TO_LE (entry->updated_hash);
+    entry->offset = GUINT64_TO_LE (entry->offset);
+  }
+  g_string_append_len (contents, nodes->data, nodes->len * sizeof (IndexEntry));
+  for (i = 0; i < edges->len; i++) {
+    IndexEntry *entry = &g_array_index (edges, IndexEntry, i);
+
+    entry->hash = GUINT32_TO_LE (entry->hash);
+    entry->offset = GUINT64_TO_LE (entry->offset);
+  }
+  g_string_append_len (contents, edges->data, edges->len * sizeof (IndexEntry));
+
+  g_array_unref (nodes);
+  g_array_unref (edges);
+
+  success = g_file_set_contents (priv->index_path, contents->str, contents->len, error);
+  g_string_free (contents, TRUE);
+
+  /* The new index covers the whole log, that must be mapped to be validated */
+  if (success && map_log (priv, error)) {
+    g_hash_table_remove_all (priv->nodes);
+    g_hash_table_remove_all (priv->edges);
+    g_hash_table_remove_all (priv->superseded);
+    load_index (priv);
+  } else {
+    success = FALSE;
+  }
+
+  return success;
+}
+
+/* --- Public APIs --- */
+
+GQuark
+gfbgraph_node_store_error_quark (void)
+{
+  return g_quark_from_static_string ("gfbgraph-node-store-error-quark");
+}
+
+/**
+ * gfbgraph_node_store_new:
+ * @path: The path of the store.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Opens the node store at @path, creating it if it doesn't exist.
+ *
+ * Returns: (transfer full): a new #GFBGraphNodeStore, or %NULL in case of error.
+ **/
+GFBGraphNodeStore*
+gfbgraph_node_store_new (const gchar  *path,
+                         GError      **error)
+{
+  g_return_val_if_fail (path != NULL, NULL);
+
+  return GFBGRAPH_NODE_STORE (g_initable_new (GFBGRAPH_TYPE_NODE_STORE, NULL, error,
+                                              "path", path,
+                                              NULL));
+}
+
+/**
+ * gfbgraph_node_store_get_path:
+ * @store: a #GFBGraphNodeStore.
+ *
+ * Returns: the #GFBGraphNodeStore:path of @store.
+ **/
+const gchar*
+gfbgraph_node_store_get_path (GFBGraphNodeStore *store)
+{
+  GFBGraphNodeStorePrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), NULL);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  return priv->path;
+}
+
+/**
+ * gfbgraph_node_store_get_n_nodes:
+ * @store: a #GFBGraphNodeStore.
+ *
+ * Returns: the number of different nodes in @store.
+ **/
+guint
+gfbgraph_node_store_get_n_nodes (GFBGraphNodeStore *store)
+{
+  GFBGraphNodeStorePrivate *priv;
+  guint n_nodes;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), 0);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  n_nodes = priv->n_nodes;
+  g_mutex_unlock (&priv->mutex);
+
+  return n_nodes;
+}
+
+/**
+ * gfbgraph_node_store_add_node:
+ * @store: a #GFBGraphNodeStore.
+ * @node: a #GFBGraphNode with an ID.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Appends @node to @store, replacing the node with the same ID if any. The
+ * node isn't durable until gfbgraph_node_store_flush() is called.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+gfbgraph_node_store_add_node (GFBGraphNodeStore  *store,
+                              GFBGraphNode       *node,
+                              GError            **error)
+{
+  GFBGraphNodeStorePrivate *priv;
+  JsonNode *jnode;
+  GVariant *properties;
+  gboolean success;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), FALSE);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), FALSE);
+  g_return_val_if_fail (gfbgraph_node_get_id (node) != NULL, FALSE);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  jnode = json_gobject_serialize (G_OBJECT (node));
+  properties = json_gvariant_deserialize (jnode, NULL, error);
+  json_node_free (jnode);
+  if (properties == NULL)
+    return FALSE;
+
+  g_mutex_lock (&priv->mutex);
+  success = append_record (priv, RECORD_NODE,
+                           g_variant_new ("(ssv)", G_OBJECT_TYPE_NAME (node), gfbgraph_node_get_id (node), properties),
+                           error);
+  g_mutex_unlock (&priv->mutex);
+
+  return success;
+}
+
+/**
+ * gfbgraph_node_store_add_connection:
+ * @store: a #GFBGraphNodeStore.
+ * @node: a #GFBGraphNode with an ID.
+ * @connected_node: a #GFBGraphNode with an ID, connected to @node.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Adds the connection between @node and @connected_node, like an album and
+ * one of its photos, if it isn't in @store yet. The nodes themselves are
+ * added with gfbgraph_node_store_add_node().
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+gfbgraph_node_store_add_connection (GFBGraphNodeStore  *store,
+                                    GFBGraphNode       *node,
+                                    GFBGraphNode       *connected_node,
+                                    GError            **error)
+{
+  GFBGraphNodeStorePrivate *priv;
+  const gchar *id;
+  const gchar *connected_id;
+  const gchar *type_name;
+  gboolean success = TRUE;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), FALSE);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), FALSE);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (connected_node), FALSE);
+
+  id = gfbgraph_node_get_id (node);
+  connected_id = gfbgraph_node_get_id (connected_node);
+  type_name = G_OBJECT_TYPE_NAME (connected_node);
+  g_return_val_if_fail (id != NULL && connected_id != NULL, FALSE);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  if (!g_hash_table_contains (ensure_live_edges (priv, id), connected_id))
+    success = append_record (priv, RECORD_EDGE, g_variant_new ("(sss)", id, type_name, connected_id), error);
+  g_mutex_unlock (&priv->mutex);
+
+  return success;
+}
+
+/**
+ * gfbgraph_node_store_remove_connection:
+ * @store: a #GFBGraphNodeStore.
+ * @node: a #GFBGraphNode with an ID.
+ * @connected_id: the ID of a node connected to @node.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Removes the connection between @node and the node @connected_id, if it's in
+ * @store. The connected node itself is kept, it can be connected to other
+ * nodes.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+gfbgraph_node_store_remove_connection (GFBGraphNodeStore  *store,
+                                       GFBGraphNode       *node,
+                                       const gchar        *connected_id,
+                                       GError            **error)
+{
+  GFBGraphNodeStorePrivate *priv;
+  const gchar *id;
+  gboolean success = TRUE;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), FALSE);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), FALSE);
+  g_return_val_if_fail (connected_id != NULL, FALSE);
+
+  id = gfbgraph_node_get_id (node);
+  g_return_val_if_fail (id != NULL, FALSE);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  if (g_hash_table_contains (ensure_live_edges (priv, id), connected_id))
+    success = append_record (priv, RECORD_EDGE_REMOVED, g_variant_new ("(sss)", id, "", connected_id), error);
+  g_mutex_unlock (&priv->mutex);
+
+  return success;
+}
+
+/**
+ * gfbgraph_node_store_contains:
+ * @store: a #GFBGraphNodeStore.
+ * @id: a node ID.
+ *
+ * Returns: %TRUE if the node @id is in @store.
+ **/
+gboolean
+gfbgraph_node_store_contains (GFBGraphNodeStore *store,
+                              const gchar       *id)
+{
+  GFBGraphNodeStorePrivate *priv;
+  gboolean found;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), FALSE);
+  g_return_val_if_fail (id != NULL, FALSE);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  found = lookup_node (priv, id) != 0;
+  g_mutex_unlock (&priv->mutex);
+
+  return found;
+}
+
+/**
+ * gfbgraph_node_store_is_up_to_date:
+ * @store: a #GFBGraphNodeStore.
+ * @id: a node ID.
+ * @updated_time: (allow-none): the #GFBGraphNode:updated-time of the node.
+ *
+ * Checks whether the node @id is in @store with the same @updated_time,
+ * without rehydrating it, to find the nodes changed since they were added.
+ * The time is compared by hash, so a change has a chance of 1 in 2^32 of
+ * going unnoticed.
+ *
+ * Returns: %TRUE if the node @id of @store has @updated_time.
+ **/
+gboolean
+gfbgraph_node_store_is_up_to_date (GFBGraphNodeStore *store,
+                                   const gchar       *id,
+                                   const gchar       *updated_time)
+{
+  GFBGraphNodeStorePrivate *priv;
+  guint32 updated_hash = 0;
+  gboolean up_to_date;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), FALSE);
+  g_return_val_if_fail (id != NULL, FALSE);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  up_to_date = lookup_node_full (priv, id, &updated_hash) != 0 &&
+    updated_hash == hash_updated_time (updated_time);
+  g_mutex_unlock (&priv->mutex);
+
+  return up_to_date;
+}
+
+/**
+ * gfbgraph_node_store_get_node:
+ * @store: a #GFBGraphNodeStore.
+ * @id: a node ID.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Rehydrates the node @id from @store, of the same type it was added with.
+ *
+ * Returns: (transfer full): a new #GFBGraphNode, or %NULL if it isn't in @store
+ * or in case of error.
+ **/
+GFBGraphNode*
+gfbgraph_node_store_get_node (GFBGraphNodeStore  *store,
+                              const gchar        *id,
+                              GError            **error)
+{
+  GFBGraphNodeStorePrivate *priv;
+  GFBGraphNode *node = NULL;
+  GVariant *record = NULL;
+  guint64 offset;
+  guint8 kind;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), NULL);
+  g_return_val_if_fail (id != NULL, NULL);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  offset = lookup_node (priv, id);
+  if (offset != 0)
+    record = get_record (priv, offset, &kind, error);
+  else
+    g_set_error (error, GFBGRAPH_NODE_STORE_ERROR, GFBGRAPH_NODE_STORE_ERROR_NOT_FOUND,
+                 "The node %s isn't in the store", id);
+  g_mutex_unlock (&priv->mutex);
+
+  /* The record stays valid out of the lock, it holds the mapping */
+  if (record != NULL) {
+    node = node_from_record (record, error);
+    g_variant_unref (record);
+  }
+
+  return node;
+}
+
+/**
+ * gfbgraph_node_store_get_connected_ids:
+ * @store: a #GFBGraphNodeStore.
+ * @id: a node ID.
+ * @node_type: a #GFBGraphNode type #GType.
+ *
+ * Gets the IDs of the nodes of type @node_type, or of a type derived from it,
+ * connected to the node @id, without rehydrating them.
+ *
+ * Returns: (transfer full): a %NULL terminated array of IDs, free it with g_strfreev().
+ **/
+gchar**
+gfbgraph_node_store_get_connected_ids (GFBGraphNodeStore *store,
+                                       const gchar       *id,
+                                       GType              node_type)
+{
+  GFBGraphNodeStorePrivate *priv;
+  GPtrArray *ids;
+  GPtrArray *edges;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), NULL);
+  g_return_val_if_fail (id != NULL, NULL);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  edges = get_live_edges (priv, id);
+  g_mutex_unlock (&priv->mutex);
+
+  ids = g_ptr_array_new ();
+  for (i = 0; i < edges->len; i++) {
+    const gchar *type_name;
+    const gchar *connected_id;
+    GType connected_type;
+
+    g_variant_get (g_ptr_array_index (edges, i), "(&s&s&s)", NULL, &type_name, &connected_id);
+    connected_type = g_type_from_name (type_name);
+    if (connected_type != G_TYPE_INVALID && g_type_is_a (connected_type, node_type))
+      g_ptr_array_add (ids, g_strdup (connected_id));
+  }
+  g_ptr_array_unref (edges);
+  g_ptr_array_add (ids, NULL);
+
+  return (gchar **) g_ptr_array_free (ids, FALSE);
+}
+
+/**
+ * gfbgraph_node_store_get_connection_nodes:
+ * @store: a #GFBGraphNodeStore.
+ * @node: a #GFBGraphNode.
+ * @node_type: a #GFBGraphNode type #GType.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Rehydrates the nodes of type @node_type connected to @node in @store, the
+ * offline counterpart of gfbgraph_node_get_connection_nodes(). The connected
+ * nodes missing in @store are skipped.
+ *
+ * Returns: (element-type GFBGraphNode) (transfer full): a newly-allocated #GList of #GFBGraphNode.
+ **/
+GList*
+gfbgraph_node_store_get_connection_nodes (GFBGraphNodeStore  *store,
+                                          GFBGraphNode       *node,
+                                          GType               node_type,
+                                          GError            **error)
+{
+  GList *nodes = NULL;
+  gchar **ids;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), NULL);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), NULL);
+
+  ids = gfbgraph_node_store_get_connected_ids (store, gfbgraph_node_get_id (node), node_type);
+  if (ids == NULL)
+    return NULL;
+
+  for (i = 0; ids[i] != NULL; i++) {
+    GFBGraphNode *connected_node;
+    GError *local_error = NULL;
+
+    connected_node = gfbgraph_node_store_get_node (store, ids[i], &local_error);
+    if (connected_node != NULL) {
+      nodes = g_list_prepend (nodes, connected_node);
+    } else if (!g_error_matches (local_error, GFBGRAPH_NODE_STORE_ERROR, GFBGRAPH_NODE_STORE_ERROR_NOT_FOUND)) {
+      g_propagate_error (error, local_error);
+      g_list_free_full (nodes, g_object_unref);
+      g_strfreev (ids);
+      return NULL;
+    } else {
+      g_error_free (local_error);
+    }
+  }
+
+  g_strfreev (ids);
+
+  return g_list_reverse (nodes);
+}
+
+/**
+ * gfbgraph_node_store_flush:
+ * @store: a #GFBGraphNodeStore.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Syncs the log of @store to disk and writes its index, so the nodes added
+ * are durable and the store opens without scanning the log.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+gfbgraph_node_store_flush (GFBGraphNodeStore  *store,
+                           GError            **error)
+{
+  GFBGraphNodeStorePrivate *priv;
+  gboolean success;
+
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), FALSE);
+
+  priv = GFBGRAPH_NODE_STORE_GET_PRIVATE (store);
+
+  g_mutex_lock (&priv->mutex);
+  success = gfbgraph_node_store_flush_unlocked (priv, error);
+  g_mutex_unlock (&priv->mutex);
+
+  return success;
+}
@@ -0,0 +1,91 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_NODE_STORE_H__
+#define __GFBGRAPH_NODE_STORE_H__
+
+#include <gio/gio.h>
+#include <gfbgraph/gfbgraph-node.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_NODE_STORE (gfbgraph_node_store_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphNodeStore, gfbgraph_node_store, GFBGRAPH, NODE_STORE, GObject)
+
+struct _GFBGraphNodeStoreClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+#define GFBGRAPH_NODE_STORE_ERROR (gfbgraph_node_store_error_quark ())
+
+typedef enum
+{
+  GFBGRAPH_NODE_STORE_ERROR_CORRUPT = 1,
+  GFBGRAPH_NODE_STORE_ERROR_NOT_FOUND,
+  GFBGRAPH_NODE_STORE_ERROR_UNKNOWN_TYPE
+} GFBGraphNodeStoreError;
+
+GQuark             gfbgraph_node_store_error_quark          (void);
+
+GFBGraphNodeStore* gfbgraph_node_store_new                  (const gchar        *path,
+                                                             GError            **error);
+
+const gchar*       gfbgraph_node_store_get_path             (GFBGraphNodeStore  *store);
+guint              gfbgraph_node_store_get_n_nodes          (GFBGraphNodeStore  *store);
+
+gboolean           gfbgraph_node_store_add_node             (GFBGraphNodeStore  *store,
+                                                             GFBGraphNode       *node,
+                                                             GError            **error);
+gboolean           gfbgraph_node_store_add_connection       (GFBGraphNodeStore  *store,
+                                                             GFBGraphNode       *node,
+                                                             GFBGraphNode       *connected_node,
+                                                             GError            **error);
+gboolean           gfbgraph_node_store_remove_connection    (GFBGraphNodeStore  *store,
+                                                             GFBGraphNode       *node,
+                                                             const gchar        *connected_id,
+                                                             GError            **error);
+gboolean           gfbgraph_node_store_contains             (GFBGraphNodeStore  *store,
+                                                             const gchar        *id);
+gboolean           gfbgraph_node_store_is_up_to_date        (GFBGraphNodeStore  *store,
+                                                             const gchar        *id,
+                                                             const gchar        *updated_time);
+GFBGraphNode*      gfbgraph_node_store_get_node             (GFBGraphNodeStore  *store,
+                                                             const gchar        *id,
+                                                             GError            **error);
+gchar**            gfbgraph_node_store_get_connected_ids    (GFBGraphNodeStore  *store,
+                                                             const gchar        *id,
+                                                             GType               node_type);
+GList*             gfbgraph_node_store_get_connection_nodes (GFBGraphNodeStore  *store,
+                                                             GFBGraphNode       *node,
+                                                             GType               node_type,
+                                                             GError            **error);
+gboolean           gfbgraph_node_store_flush                (GFBGraphNodeStore  *store,
+                                                             GError            **error);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_NODE_STORE_H__ */
@@ -35,9 +35,14 @@
 #include <json-glib/json-glib.h>
 #include <string.h>
 
+#include "gfbgraph-client.h"
 #include "gfbgraph-common.h"
 #include "gfbgraph-connectable.h"
 #include "gfbgraph-node.h"
+#include "gfbgraph-private.h"
+
+/* The Graph API limit of IDs in a single "?ids=" request */
+#define IDS_CHUNK_SIZE 50
 
 typedef struct
 {
@@ -50,10 +55,15 @@ typedef struct
 
 typedef struct
 {
-  GList *list;
-  GType node_type;
   GFBGraphAuthorizer *authorizer;
-} GFBGraphNodeConnectionAsyncData;
+  GType               node_type;
+  GCancellable       *cancellable;
+
+  /* Protected by mutex */
+  GMutex              mutex;
+  GHashTable         *nodes;
+  GError             *error;
+} GFBGraphNodeIdsData;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphNode, gfbgraph_node, G_TYPE_OBJECT)
 
@@ -68,7 +78,6 @@ enum {
 
 static GParamSpec *properties [N_PROPERTIES];
 
-#define GFBGRAPH_NODE_ERROR             gfbgraph_node_error_quark ()
 #define GFBGRAPH_NODE_GET_PRIVATE(_obj) gfbgraph_node_get_instance_private (GFBGRAPH_NODE (_obj))
 
 
@@ -152,6 +161,25 @@ gfbgraph_node_get_property (GObject    *object,
     }
 }
 
+static gboolean
+gfbgraph_node_deserialize_member (GFBGraphNode *node,
+                                  const gchar  *member_name,
+                                  JsonNode     *member_node)
+{
+  GFBGraphNodePrivate *priv = GFBGRAPH_NODE_GET_PRIVATE (node);
+
+  if (gfbgraph_json_member_is (member_name, "id"))
+    return gfbgraph_json_set_string (member_node, &priv->id);
+  else if (gfbgraph_json_member_is (member_name, "link"))
+    return gfbgraph_json_set_string (member_node, &priv->link);
+  else if (gfbgraph_json_member_is (member_name, "created_time"))
+    return gfbgraph_json_set_string (member_node, &priv->created_time);
+  else if (gfbgraph_json_member_is (member_name, "updated_time"))
+    return gfbgraph_json_set_string (member_node, &priv->updated_time);
+
+  return FALSE;
+}
+
 static void
 gfbgraph_node_class_init (GFBGraphNodeClass *klass)
 {
@@ -161,6 +189,8 @@ gfbgraph_node_class_init (GFBGraphNodeClass *klass)
   gobject_class->set_property = gfbgraph_node_set_property;
   gobject_class->get_property = gfbgraph_node_get_property;
 
+  klass->deserialize_member = gfbgraph_node_deserialize_member;
+
   /**
     * GFBGraphNode:id:
     *
@@ -224,31 +254,417 @@ gfbgraph_node_error_quark (void)
   return g_quark_from_static_string ("gfbgraph-node-error-quark");
 }
 
+/*
+ * gfbgraph_json_member_is:
+ * @member_name: the name of a member of a JSON object.
+ * @field: the name of a Graph API field, with underscores.
+ *
+ * Checks whether @member_name is @field, taking '-' for '_' so both the Graph API
+ * members and the property names written by json_gobject_serialize() match.
+ *
+ * Returns: %TRUE if @member_name is @field.
+ */
+gboolean
+gfbgraph_json_member_is (const gchar *member_name,
+                         const gchar *field)
+{
+  for (; *member_name != '\0' && *field != '\0'; member_name++, field++) {
+    if (*member_name != *field && !(*member_name == '-' && *field == '_'))
+      return FALSE;
+  }
+
+  return *member_name == *field;
+}
+
+/*
+ * gfbgraph_json_set_string:
+ * @member_node: the value of a member of a JSON object.
+ * @field: the string field to set.
+ *
+ * Replaces @field with the string held by @member_node, or with %NULL if it's a
+ * JSON null.
+ *
+ * Returns: %FALSE if @member_node holds another type, leaving @field untouched.
+ */
+gboolean
+gfbgraph_json_set_string (JsonNode  *member_node,
+                          gchar    **field)
+{
+  if (JSON_NODE_HOLDS_NULL (member_node)) {
+    g_clear_pointer (field, g_free);
+    return TRUE;
+  }
+
+  if (json_node_get_value_type (member_node) != G_TYPE_STRING)
+    return FALSE;
+
+  g_free (*field);
+  *field = g_strdup (json_node_get_string (member_node));
+  return TRUE;
+}
+
+/*
+ * gfbgraph_json_set_uint:
+ * @member_node: the value of a member of a JSON object.
+ * @field: the unsigned integer field to set.
+ *
+ * Sets @field to the integer held by @member_node.
+ *
+ * Returns: %FALSE if @member_node doesn't hold an integer in the range of a
+ * #guint, leaving @field untouched.
+ */
+gboolean
+gfbgraph_json_set_uint (JsonNode *member_node,
+                        guint    *field)
+{
+  gint64 value;
+
+  if (json_node_get_value_type (member_node) != G_TYPE_INT64)
+    return FALSE;
+
+  value = json_node_get_int (member_node);
+  if (value < 0 || value > G_MAXUINT)
+    return FALSE;
+
+  *field = (guint) value;
+  return TRUE;
+}
+
+typedef struct
+{
+  GFBGraphNode      *node;
+  GFBGraphNodeClass *klass;
+  gboolean           fallback;
+} GFBGraphNodeDeserializeData;
+
 static void
-gfbgraph_node_connection_async_data_free (GFBGraphNodeConnectionAsyncData *data)
+gfbgraph_node_deserialize_member_cb (JsonObject                  *object,
+                                     const gchar                 *member_name,
+                                     JsonNode                    *member_node,
+                                     GFBGraphNodeDeserializeData *data)
 {
-  g_list_free (data->list);
-  g_object_unref (data->authorizer);
+  GParamSpec *pspec;
+
+  if (data->fallback ||
+      data->klass->deserialize_member (data->node, member_name, member_node))
+    return;
+
+  /* Like json_gobject_deserialize(), skip the members without a property */
+  if (JSON_IS_SERIALIZABLE (data->node))
+    pspec = json_serializable_find_property (JSON_SERIALIZABLE (data->node), member_name);
+  else
+    pspec = g_object_class_find_property (G_OBJECT_CLASS (data->klass), member_name);
 
-  g_slice_free (GFBGraphNodeConnectionAsyncData, data);
+  if (pspec != NULL)
+    data->fallback = TRUE;
+}
+
+/*
+ * gfbgraph_node_deserialize:
+ * @node_type: a #GFBGraphNode type #GType.
+ * @jnode: the JSON object of a node.
+ *
+ * Creates a node of @node_type from @jnode, like json_gobject_deserialize(), but
+ * setting the members known by #GFBGraphNodeClass.deserialize_member straight
+ * into the node instead of through #GValue and its properties. Members without a
+ * property are skipped, and if a member has a property but isn't known, the
+ * whole node is deserialized by json_gobject_deserialize().
+ *
+ * Returns: (transfer full): a new node of @node_type.
+ */
+GFBGraphNode*
+gfbgraph_node_deserialize (GType     node_type,
+                           JsonNode *jnode)
+{
+  GFBGraphNodeDeserializeData data;
+
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
+  g_return_val_if_fail (jnode != NULL, NULL);
+
+  if (!JSON_NODE_HOLDS_OBJECT (jnode))
+    return GFBGRAPH_NODE (json_gobject_deserialize (node_type, jnode));
+
+  data.node = GFBGRAPH_NODE (g_object_new (node_type, NULL));
+  data.klass = GFBGRAPH_NODE_GET_CLASS (data.node);
+  data.fallback = (data.klass->deserialize_member == NULL);
+
+  if (!data.fallback)
+    json_object_foreach_member (json_node_get_object (jnode),
+                                (JsonObjectForeach) gfbgraph_node_deserialize_member_cb,
+                                &data);
+
+  if (data.fallback) {
+    g_object_unref (data.node);
+    return GFBGRAPH_NODE (json_gobject_deserialize (node_type, jnode));
+  }
+
+  return data.node;
+}
+
+static void
+gfbgraph_node_list_free (GList *nodes_list)
+{
+  g_list_free_full (nodes_list, g_object_unref);
 }
 
 static void
-gfbgraph_node_get_connection_nodes_async_thread (GSimpleAsyncResult *simple_async,
-                                                 GFBGraphNode       *node,
-                                                 GCancellable        cancellable)
+gfbgraph_node_get_connection_nodes_async_cb (GObject      *source_object,
+                                             GAsyncResult *result,
+                                             gpointer      user_data)
 {
-  GFBGraphNodeConnectionAsyncData *data;
+  GTask *task = G_TASK (user_data);
+  RestProxyCall *rest_call = REST_PROXY_CALL (source_object);
+  GPtrArray *nodes = NULL;
   GError *error = NULL;
 
-  data = (GFBGraphNodeConnectionAsyncData *) g_simple_async_result_get_op_res_gpointer (simple_async);
+  if (gfbgraph_rest_call_invoke_finish (rest_call, result, &error)) {
+    nodes = gfbgraph_connectable_parse_connection_page (g_task_get_task_data (task),
+                                                        rest_call,
+                                                        gfbgraph_rest_call_get_payload (rest_call),
+                                                        NULL, NULL, &error);
+  }
 
-  data->list = gfbgraph_node_get_connection_nodes (node,
-                                                   data->node_type,
-                                                   data->authorizer,
-                                                   &error);
   if (error != NULL)
-    g_simple_async_result_take_error (simple_async, error);
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, gfbgraph_node_array_to_list (nodes), (GDestroyNotify) gfbgraph_node_list_free);
+
+  g_object_unref (task);
+}
+
+/* Deserializes the members of the response to a "?ids=" request into a new
+ * table, without the nodes mutex so the chunks are deserialized in parallel.
+ * The members that aren't an object, like a %null for an ID that wasn't found,
+ * are skipped. */
+static GHashTable*
+gfbgraph_node_new_from_ids_deserialize (JsonObject *object,
+                                        GType       node_type)
+{
+  GHashTable *nodes;
+  GList *members, *l;
+
+  nodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+  members = json_object_get_members (object);
+  for (l = members; l != NULL; l = l->next) {
+    JsonNode *node_jnode;
+    GFBGraphNode *node;
+
+    node_jnode = json_object_get_member (object, l->data);
+    if (!JSON_NODE_HOLDS_OBJECT (node_jnode))
+      continue;
+
+    node = gfbgraph_node_deserialize (node_type, node_jnode);
+    if (node != NULL)
+      g_hash_table_insert (nodes, g_strdup (l->data), node);
+  }
+  g_list_free (members);
+
+  return nodes;
+}
+
+/* Whether the remaining chunks have to be fetched: not after a failed chunk
+ * or once the call is cancelled */
+static gboolean
+gfbgraph_node_new_from_ids_continue (GFBGraphNodeIdsData *data)
+{
+  gboolean failed;
+
+  g_mutex_lock (&data->mutex);
+  failed = data->error != NULL;
+  g_mutex_unlock (&data->mutex);
+
+  return !failed && !g_cancellable_is_cancelled (data->cancellable);
+}
+
+/* Fetches the comma separated @ids in a single request, and adds the
+ * deserialized nodes to data->nodes. Runs in the threads of a #GThreadPool. */
+static void
+gfbgraph_node_new_from_ids_chunk (gchar               *ids,
+                                  GFBGraphNodeIdsData *data)
+{
+  RestProxyCall *rest_call;
+  GError *error = NULL;
+
+  /* The chunks queued before a failure aren't requested anymore */
+  if (!gfbgraph_node_new_from_ids_continue (data)) {
+    g_free (ids);
+    return;
+  }
+
+  rest_call = gfbgraph_new_rest_call (data->authorizer);
+  rest_proxy_call_set_method (rest_call, "GET");
+  rest_proxy_call_add_param (rest_call, "ids", ids);
+  gfbgraph_rest_call_set_node_type (rest_call, data->node_type);
+
+  if (gfbgraph_rest_call_invoke (rest_call, data->cancellable, &error)) {
+    JsonParser *jparser;
+    JsonNode *root;
+    const gchar *payload;
+    gint64 timer;
+
+    timer = gfbgraph_rest_call_start_timer (rest_call);
+
+    payload = gfbgraph_rest_call_get_payload (rest_call);
+    jparser = json_parser_new ();
+    if (json_parser_load_from_data (jparser, payload, -1, &error)) {
+      root = json_parser_get_root (jparser);
+      gfbgraph_rest_call_stop_parse_timer (rest_call, &timer);
+
+      if (gfbgraph_api_error_from_json (root, &error)) {
+        /* Error already set */
+      } else if (JSON_NODE_HOLDS_OBJECT (root)) {
+        GHashTable *nodes;
+        GHashTableIter iter;
+        gpointer id, node;
+
+        /* The response is an object with the requested IDs as members */
+        nodes = gfbgraph_node_new_from_ids_deserialize (json_node_get_object (root),
+                                                        data->node_type);
+        gfbgraph_rest_call_stop_deserialize_timer (rest_call, &timer);
+
+        g_mutex_lock (&data->mutex);
+        g_hash_table_iter_init (&iter, nodes);
+        while (g_hash_table_iter_next (&iter, &id, &node)) {
+          g_hash_table_insert (data->nodes, id, node);
+          g_hash_table_iter_steal (&iter);
+        }
+        g_mutex_unlock (&data->mutex);
+        g_hash_table_unref (nodes);
+      } else {
+        g_set_error_literal (&error, GFBGRAPH_API_ERROR, GFBGRAPH_API_ERROR_UNKNOWN,
+                             "Unexpected response to a multiple IDs request");
+      }
+    }
+
+    g_object_unref (jparser);
+  }
+
+  if (error != NULL) {
+    g_mutex_lock (&data->mutex);
+    if (data->error == NULL)
+      data->error = error;
+    else
+      g_error_free (error);
+    g_mutex_unlock (&data->mutex);
+  }
+
+  g_object_unref (rest_call);
+  g_free (ids);
+}
+
+static GFBGraphNode*
+gfbgraph_node_new_from_id_real (GFBGraphAuthorizer  *authorizer,
+                                const gchar         *id,
+                                GType                node_type,
+                                const gchar         *fields_param,
+                                GError             **error)
+{
+  GFBGraphNode *node = NULL;
+  RestProxyCall *rest_call;
+
+  rest_call = gfbgraph_new_rest_call (authorizer);
+  rest_proxy_call_set_method (rest_call, "GET");
+  rest_proxy_call_set_function (rest_call, id);
+  gfbgraph_rest_call_set_node_type (rest_call, node_type);
+  if (fields_param != NULL)
+    rest_proxy_call_add_param (rest_call, "fields", fields_param);
+
+  if (gfbgraph_rest_call_invoke (rest_call, NULL, error)) {
+    JsonParser *jparser;
+    JsonNode *jnode;
+    const gchar *payload;
+    gint64 timer;
+
+    timer = gfbgraph_rest_call_start_timer (rest_call);
+
+    payload = gfbgraph_rest_call_get_payload (rest_call);
+    jparser = json_parser_new ();
+    if (json_parser_load_from_data (jparser, payload, -1, error)) {
+      jnode = json_parser_get_root (jparser);
+      gfbgraph_rest_call_stop_parse_timer (rest_call, &timer);
+      node = gfbgraph_node_deserialize (node_type, jnode);
+      gfbgraph_rest_call_stop_deserialize_timer (rest_call, &timer);
+    }
+
+    g_object_unref (jparser);
+  }
+
+  g_object_unref (rest_call);
+  return node;
+}
+
+/* Builds the comma separated list of the writable properties of node_type,
+ * which are the members filled by gfbgraph_node_deserialize() */
+static gchar*
+gfbgraph_node_type_build_fields (GType node_type)
+{
+  GObjectClass *klass;
+  GParamSpec **pspecs;
+  GString *fields;
+  guint n_pspecs;
+  guint i;
+
+  klass = g_type_class_ref (node_type);
+  pspecs = g_object_class_list_properties (klass, &n_pspecs);
+
+  fields = g_string_new (NULL);
+  for (i = 0; i < n_pspecs; i++) {
+    gchar *field;
+
+    if ((pspecs[i]->flags & G_PARAM_WRITABLE) == 0 ||
+        (pspecs[i]->flags & G_PARAM_CONSTRUCT_ONLY) != 0)
+      continue;
+
+    field = g_strdelimit (g_strdup (g_param_spec_get_name (pspecs[i])), "-", '_');
+    if (fields->len > 0)
+      g_string_append_c (fields, ',');
+    g_string_append (fields, field);
+    g_free (field);
+  }
+
+  g_free (pspecs);
+  g_type_class_unref (klass);
+
+  return g_string_free (fields, FALSE);
+}
+
+/*
+ * gfbgraph_node_fields_to_param:
+ * @node_type: a #GFBGraphNode type #GType.
+ * @fields: (allow-none): a %NULL-terminated array of Graph API fields, or %NULL.
+ *
+ * Builds the value of the "fields" param of a request. If @fields is %NULL, the
+ * fields are derived from the properties of @node_type, computed only once per type.
+ *
+ * Returns: a newly allocated string.
+ */
+gchar*
+gfbgraph_node_fields_to_param (GType                node_type,
+                               const gchar * const *fields)
+{
+  static GHashTable *type_fields = NULL;
+  G_LOCK_DEFINE_STATIC (type_fields);
+  const gchar *cached;
+
+  if (fields != NULL)
+    return g_strjoinv (",", (gchar **) fields);
+
+  G_LOCK (type_fields);
+  if (type_fields == NULL)
+    type_fields = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  cached = g_hash_table_lookup (type_fields, GSIZE_TO_POINTER (node_type));
+  if (cached == NULL) {
+    gchar *derived;
+
+    derived = gfbgraph_node_type_build_fields (node_type);
+    g_hash_table_insert (type_fields, GSIZE_TO_POINTER (node_type), derived);
+    cached = derived;
+  }
+  G_UNLOCK (type_fields);
+
+  return g_strdup (cached);
 }
 
 /**
@@ -281,34 +697,156 @@ gfbgraph_node_new_from_id (GFBGraphAuthorizer  *authorizer,
                            GType                node_type,
                            GError             **error)
 {
-  GFBGraphNode *node = NULL;
-  RestProxyCall *rest_call;
+  g_return_val_if_fail ((strlen (id) > 0), NULL);
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
+
+  return gfbgraph_node_new_from_id_real (authorizer, id, node_type, NULL, error);
+}
+
+/**
+ * gfbgraph_node_new_from_id_with_fields:
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @id: a const #gchar with the node ID.
+ * @node_type: a #GFBGraphNode type #GType.
+ * @fields: (array zero-terminated=1) (allow-none): a %NULL-terminated array with the
+ * Graph API fields to retrieve, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_node_new_from_id() but only retrieving the given @fields of the node,
+ * instead of the default set of fields chosen by the Graph API. If @fields is %NULL,
+ * the fields are the properties of @node_type, with the dashes replaced by underscores,
+ * so all of them must exist in the Graph API node or the request will fail.
+ *
+ * Returns: (transfer full): a #GFBGraphNode or %NULL.
+ **/
+GFBGraphNode*
+gfbgraph_node_new_from_id_with_fields (GFBGraphAuthorizer   *authorizer,
+                                       const gchar          *id,
+                                       GType                 node_type,
+                                       const gchar * const  *fields,
+                                       GError              **error)
+{
+  GFBGraphNode *node;
+  gchar *fields_param;
 
   g_return_val_if_fail ((strlen (id) > 0), NULL);
   g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
   g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
 
-  rest_call = gfbgraph_new_rest_call (authorizer);
-  rest_proxy_call_set_method (rest_call, "GET");
-  rest_proxy_call_set_function (rest_call, id);
+  fields_param = gfbgraph_node_fields_to_param (node_type, fields);
+  node = gfbgraph_node_new_from_id_real (authorizer, id, node_type, fields_param, error);
+  g_free (fields_param);
 
-  if (rest_proxy_call_sync (rest_call, error)) {
-    JsonParser *jparser;
-    JsonNode *jnode;
-    const gchar *payload;
+  return node;
+}
 
-    payload = rest_proxy_call_get_payload (rest_call);
-    jparser = json_parser_new ();
-    if (json_parser_load_from_data (jparser, payload, -1, error)) {
-      jnode = json_parser_get_root (jparser);
-      node = GFBGRAPH_NODE (json_gobject_deserialize (node_type, jnode));
+/**
+ * gfbgraph_node_new_from_ids:
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @ids: (array zero-terminated=1): a %NULL-terminated array with the node IDs.
+ * @node_type: a #GFBGraphNode type #GType.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Retrieve several nodes of #node_type type from the Facebook Graph, using a
+ * "?ids=" request for every 50 IDs instead of a request per node. The requests are
+ * run at the same time, up to the #GFBGraphClient:max-requests-in-flight of the
+ * default #GFBGraphClient, or its #GFBGraphClient:max-connections without a limit. The IDs that aren't found are missing from the result.
+ *
+ * If any of the requests fails or @cancellable is cancelled, the remaining
+ * requests aren't sent, the function fails and no node is returned.
+ *
+ * Returns: (element-type utf8 GFBGraphNode) (transfer full): a #GHashTable with the
+ * found nodes keyed by their ID, or %NULL. Free with g_hash_table_unref().
+ **/
+GHashTable*
+gfbgraph_node_new_from_ids (GFBGraphAuthorizer   *authorizer,
+                            const gchar * const  *ids,
+                            GType                 node_type,
+                            GCancellable         *cancellable,
+                            GError              **error)
+{
+  GFBGraphNodeIdsData data;
+  GThreadPool *pool = NULL;
+  GHashTable *seen;
+  GPtrArray *chunk;
+  GFBGraphClient *client;
+  guint max_threads;
+  guint n_ids;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
+  g_return_val_if_fail (ids != NULL, NULL);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
+
+  data.authorizer = authorizer;
+  data.node_type = node_type;
+  data.cancellable = cancellable;
+  data.nodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  data.error = NULL;
+  g_mutex_init (&data.mutex);
+
+  n_ids = g_strv_length ((gchar **) ids);
+  client = gfbgraph_client_get_default ();
+  max_threads = gfbgraph_client_get_max_requests_in_flight (client);
+  /* Without a limit on the requests, as many as there are connections */
+  if (max_threads == 0)
+    max_threads = gfbgraph_client_get_max_connections (client);
+  max_threads = MIN (max_threads, (n_ids + IDS_CHUNK_SIZE - 1) / IDS_CHUNK_SIZE);
+
+  /* A single chunk is fetched in the calling thread */
+  if (max_threads > 1)
+    pool = g_thread_pool_new ((GFunc) gfbgraph_node_new_from_ids_chunk, &data,
+                              max_threads, FALSE, NULL);
+
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+  chunk = g_ptr_array_sized_new (IDS_CHUNK_SIZE + 1);
+  for (i = 0; i <= n_ids; i++) {
+    gchar *chunk_ids;
+
+    if (i < n_ids) {
+      if (ids[i][0] == '\0' || !g_hash_table_add (seen, (gpointer) ids[i]))
+        continue;
+
+      g_ptr_array_add (chunk, (gpointer) ids[i]);
+      if (chunk->len < IDS_CHUNK_SIZE)
+        continue;
     }
 
-    g_object_unref (jparser);
+    if (chunk->len == 0)
+      continue;
+
+    if (!gfbgraph_node_new_from_ids_continue (&data))
+      break;
+
+    g_ptr_array_add (chunk, NULL);
+    chunk_ids = g_strjoinv (",", (gchar **) chunk->pdata);
+    g_ptr_array_set_size (chunk, 0);
+
+    if (pool != NULL)
+      g_thread_pool_push (pool, chunk_ids, NULL);
+    else
+      gfbgraph_node_new_from_ids_chunk (chunk_ids, &data);
   }
 
-  g_object_unref (rest_call);
-  return node;
+  if (pool != NULL)
+    g_thread_pool_free (pool, FALSE, TRUE);
+
+  g_ptr_array_unref (chunk);
+  g_hash_table_unref (seen);
+  g_mutex_clear (&data.mutex);
+
+  if (data.error == NULL)
+    g_cancellable_set_error_if_cancelled (cancellable, &data.error);
+
+  if (data.error != NULL) {
+    g_propagate_error (error, data.error);
+    g_hash_table_unref (data.nodes);
+    return NULL;
+  }
+
+  return data.nodes;
 }
 
 /**
@@ -411,6 +949,65 @@ gfbgraph_node_set_id (GFBGraphNode *node,
                 NULL);
 }
 
+/* Creates the call to retrieve the nodes of type node_type connected to node,
+ * and returns the connection used to parse the response */
+static RestProxyCall*
+gfbgraph_node_new_connection_call (GFBGraphNode              *node,
+                                   GType                      node_type,
+                                   GFBGraphAuthorizer        *authorizer,
+                                   const gchar               *fields_param,
+                                   const GFBGraphConnection **connection,
+                                   GError                   **error)
+{
+  GFBGraphNodePrivate *priv;
+  RestProxyCall *rest_call;
+  gchar *function_path;
+
+  priv = GFBGRAPH_NODE_GET_PRIVATE (node);
+
+  *connection = gfbgraph_connectable_lookup_connection (node_type, G_OBJECT_TYPE (node), error);
+  if (*connection == NULL)
+    return NULL;
+
+  rest_call = gfbgraph_new_rest_call (authorizer);
+  rest_proxy_call_set_method (rest_call, "GET");
+  function_path = g_strdup_printf ("%s/%s", priv->id, (*connection)->path);
+  rest_proxy_call_set_function (rest_call, function_path);
+  g_free (function_path);
+  gfbgraph_rest_call_set_node_type (rest_call, node_type);
+  if (fields_param != NULL)
+    rest_proxy_call_add_param (rest_call, "fields", fields_param);
+
+  return rest_call;
+}
+
+static GPtrArray*
+gfbgraph_node_get_connection_nodes_real (GFBGraphNode        *node,
+                                         GType                node_type,
+                                         GFBGraphAuthorizer  *authorizer,
+                                         const gchar         *fields_param,
+                                         GError             **error)
+{
+  GPtrArray *nodes = NULL;
+  const GFBGraphConnection *connection;
+  RestProxyCall *rest_call;
+
+  rest_call = gfbgraph_node_new_connection_call (node, node_type, authorizer, fields_param, &connection, error);
+  if (rest_call == NULL)
+    return NULL;
+
+  if (gfbgraph_rest_call_invoke (rest_call, NULL, error)) {
+    const gchar *payload;
+
+    payload = gfbgraph_rest_call_get_payload (rest_call);
+    nodes = gfbgraph_connectable_parse_connection_page (connection, rest_call, payload, NULL, NULL, error);
+  }
+
+  g_object_unref (rest_call);
+
+  return nodes;
+}
+
 /**
  * gfbgraph_node_get_connection_nodes:
  * @node: a #GFBGraphNode object which retrieve the connected nodes.
@@ -430,56 +1027,72 @@ gfbgraph_node_get_connection_nodes (GFBGraphNode        *node,
                                     GFBGraphAuthorizer  *authorizer,
                                     GError             **error)
 {
-  GFBGraphNodePrivate *priv;
-  GList *nodes_list = NULL;
-  GFBGraphNode *connected_node;
-  RestProxyCall *rest_call;
-  gchar *function_path;
-
   g_return_val_if_fail (GFBGRAPH_IS_NODE (node), NULL);
   g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
   g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
 
-  priv = GFBGRAPH_NODE_GET_PRIVATE (node);
-
-  /* Dummy node just for test */
-  connected_node = g_object_new (node_type, NULL);
-  if (GFBGRAPH_IS_CONNECTABLE (connected_node) == FALSE) {
-    g_set_error (error, GFBGRAPH_NODE_ERROR,
-                 GFBGRAPH_NODE_ERROR_NO_CONNECTABLE,
-                 "The given node type (%s) doesn't implement connectable interface", g_type_name (node_type));
-    return NULL;
-  }
-
-  if (gfbgraph_connectable_is_connectable_to (GFBGRAPH_CONNECTABLE (connected_node), G_OBJECT_TYPE (node)) == FALSE) {
-    g_set_error (error, GFBGRAPH_NODE_ERROR,
-                 GFBGRAPH_NODE_ERROR_NO_CONNECTABLE,
-                 "The given node type (%s) can't connect with the node", g_type_name (node_type));
-    return NULL;
-  }
+  return gfbgraph_node_array_to_list (gfbgraph_node_get_connection_nodes_real (node, node_type, authorizer, NULL, error));
+}
 
-  rest_call = gfbgraph_new_rest_call (authorizer);
-  rest_proxy_call_set_method (rest_call, "GET");
-  function_path = g_strdup_printf ("%s/%s",
-                                   priv->id,
-                                   gfbgraph_connectable_get_connection_path (GFBGRAPH_CONNECTABLE (connected_node),
-                                                                                G_OBJECT_TYPE (node)));
-  rest_proxy_call_set_function (rest_call, function_path);
-  g_free (function_path);
+/**
+ * gfbgraph_node_get_connection_nodes_array:
+ * @node: a #GFBGraphNode object which retrieve the connected nodes.
+ * @node_type: a #GFBGraphNode type #GType that determines the kind of nodes to retrieve.
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_node_get_connection_nodes() but returning the nodes in a #GPtrArray,
+ * which is cheaper to build and to index for big connections.
+ *
+ * Returns: (element-type GFBGraphNode) (transfer full): a newly-allocated #GPtrArray of type @node_type
+ * objects with the found nodes, or %NULL in case of error. Free with g_ptr_array_unref().
+ **/
+GPtrArray*
+gfbgraph_node_get_connection_nodes_array (GFBGraphNode        *node,
+                                          GType                node_type,
+                                          GFBGraphAuthorizer  *authorizer,
+                                          GError             **error)
+{
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), NULL);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
 
-  if (rest_proxy_call_sync (rest_call, error)) {
-    const gchar *payload;
+  return gfbgraph_node_get_connection_nodes_real (node, node_type, authorizer, NULL, error);
+}
 
-    payload = rest_proxy_call_get_payload (rest_call);
-    nodes_list = gfbgraph_connectable_parse_connected_data (GFBGRAPH_CONNECTABLE (connected_node), payload, error);
-  }
+/**
+ * gfbgraph_node_get_connection_nodes_with_fields:
+ * @node: a #GFBGraphNode object which retrieve the connected nodes.
+ * @node_type: a #GFBGraphNode type #GType that determines the kind of nodes to retrieve.
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @fields: (array zero-terminated=1) (allow-none): a %NULL-terminated array with the
+ * Graph API fields to retrieve, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_node_get_connection_nodes() but only retrieving the given @fields of
+ * the connected nodes. If @fields is %NULL, the fields are the properties of @node_type.
+ *
+ * Returns: (element-type GFBGraphNode) (transfer full): a newly-allocated #GList of type @node_type objects with the found nodes.
+ **/
+GList*
+gfbgraph_node_get_connection_nodes_with_fields (GFBGraphNode         *node,
+                                                GType                 node_type,
+                                                GFBGraphAuthorizer   *authorizer,
+                                                const gchar * const  *fields,
+                                                GError              **error)
+{
+  GPtrArray *nodes;
+  gchar *fields_param;
 
-  /* We don't need this node again */
-  g_object_unref (connected_node);
-  g_object_unref (rest_call);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), NULL);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), NULL);
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
 
+  fields_param = gfbgraph_node_fields_to_param (node_type, fields);
+  nodes = gfbgraph_node_get_connection_nodes_real (node, node_type, authorizer, fields_param, error);
+  g_free (fields_param);
 
-  return nodes_list;
+  return gfbgraph_node_array_to_list (nodes);
 }
 
 /**
@@ -505,34 +1118,33 @@ gfbgraph_node_get_connection_nodes_async (GFBGraphNode        *node,
                                           GAsyncReadyCallback  callback,
                                           gpointer             user_data)
 {
-  GSimpleAsyncResult *result;
-  GFBGraphNodeConnectionAsyncData *data;
+  GTask *task;
+  const GFBGraphConnection *connection;
+  RestProxyCall *rest_call;
+  GError *error = NULL;
 
   g_return_if_fail (GFBGRAPH_IS_NODE (node));
+  g_return_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE));
+  g_return_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer));
   g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
   g_return_if_fail (callback != NULL);
 
-  result = g_simple_async_result_new (G_OBJECT (node),
-                                      callback,
-                                      user_data,
-                                      gfbgraph_node_get_connection_nodes_async);
-  g_simple_async_result_set_check_cancellable (result, cancellable);
+  task = g_task_new (node, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gfbgraph_node_get_connection_nodes_async);
 
-  data = g_slice_new (GFBGraphNodeConnectionAsyncData);
-  data->list = NULL;
-  data->node_type = node_type;
-  data->authorizer = authorizer;
-  g_object_ref (data->authorizer);
+  rest_call = gfbgraph_node_new_connection_call (node, node_type, authorizer, NULL, &connection, &error);
+  if (rest_call == NULL) {
+    g_task_return_error (task, error);
+    g_object_unref (task);
+    return;
+  }
 
-  g_simple_async_result_set_op_res_gpointer (result,
-                                             data,
-                                             (GDestroyNotify) gfbgraph_node_connection_async_data_free);
-  g_simple_async_result_run_in_thread (result,
-                                       (GSimpleAsyncThreadFunc) gfbgraph_node_get_connection_nodes_async_thread,
-                                       G_PRIORITY_DEFAULT,
-                                       cancellable);
+  g_task_set_task_data (task, (gpointer) connection, NULL);
+  gfbgraph_rest_call_invoke_async (rest_call, cancellable,
+                                   gfbgraph_node_get_connection_nodes_async_cb,
+                                   task);
 
-  g_object_unref (result);
+  g_object_unref (rest_call);
 }
 
 /**
@@ -551,19 +1163,10 @@ gfbgraph_node_get_connection_nodes_async_finish (GFBGraphNode  *node,
                                                  GAsyncResult  *result,
                                                  GError       **error)
 {
-  GSimpleAsyncResult *simple_async;
-  GFBGraphNodeConnectionAsyncData *data;
-
-  g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (node), gfbgraph_node_get_connection_nodes_async), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, node), NULL);
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  simple_async = G_SIMPLE_ASYNC_RESULT (result);
-
-  if (g_simple_async_result_propagate_error (simple_async, error))
-    return NULL;
-
-  data = (GFBGraphNodeConnectionAsyncData *) g_simple_async_result_get_op_res_gpointer (simple_async);
-  return data->list;
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -585,6 +1188,7 @@ gfbgraph_node_append_connection (GFBGraphNode        *node,
                                  GError             **error)
 {
   GFBGraphNodePrivate *priv;
+  const GFBGraphConnection *connection;
   RestProxyCall *rest_call;
   GHashTable *params;
   gchar *function_path;
@@ -594,29 +1198,16 @@ gfbgraph_node_append_connection (GFBGraphNode        *node,
   g_return_val_if_fail (GFBGRAPH_IS_NODE (connect_node), FALSE);
   g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), FALSE);
 
-  if (GFBGRAPH_IS_CONNECTABLE (connect_node) == FALSE) {
-    g_set_error (error, GFBGRAPH_NODE_ERROR,
-                 GFBGRAPH_NODE_ERROR_NO_CONNECTABLE,
-                 "The given node type (%s) doesn't implement connectable interface", G_OBJECT_TYPE_NAME (connect_node));
+  connection = gfbgraph_connectable_lookup_connection (G_OBJECT_TYPE (connect_node), G_OBJECT_TYPE (node), error);
+  if (connection == NULL)
     return FALSE;
-  }
-
-  if (gfbgraph_connectable_is_connectable_to (GFBGRAPH_CONNECTABLE (connect_node), G_OBJECT_TYPE (node)) == FALSE) {
-    g_set_error (error, GFBGRAPH_NODE_ERROR,
-                 GFBGRAPH_NODE_ERROR_NO_CONNECTABLE,
-                 "The given node type (%s) can't append a %s connection", G_OBJECT_TYPE_NAME (node), G_OBJECT_TYPE_NAME (connect_node));
-    return FALSE;
-  }
 
   priv = GFBGRAPH_NODE_GET_PRIVATE (node);
 
   success = FALSE;
   rest_call = gfbgraph_new_rest_call (authorizer);
   rest_proxy_call_set_method (rest_call, "POST");
-  function_path = g_strdup_printf ("%s/%s",
-                                   priv->id,
-                                   gfbgraph_connectable_get_connection_path (GFBGRAPH_CONNECTABLE (connect_node),
-                                                                             G_OBJECT_TYPE (node)));
+  function_path = g_strdup_printf ("%s/%s", priv->id, connection->path);
   rest_proxy_call_set_function (rest_call, function_path);
   g_free (function_path);
 
@@ -632,13 +1223,13 @@ gfbgraph_node_append_connection (GFBGraphNode        *node,
     }
   }
 
-  if (rest_proxy_call_sync (rest_call, error)) {
+  if (gfbgraph_rest_call_invoke (rest_call, NULL, error)) {
     const gchar *payload;
     JsonParser *jparser;
     JsonNode *jnode;
     JsonReader *jreader;
 
-    payload = rest_proxy_call_get_payload (rest_call);
+    payload = gfbgraph_rest_call_get_payload (rest_call);
     /* Parssing the new ID */
     jparser = json_parser_new ();
     json_parser_load_from_data (jparser, payload, -1, error);
@@ -21,6 +21,7 @@
 #define __GFBGRAPH_NODE_H__
 
 #include <glib-object.h>
+#include <json-glib/json-glib.h>
 #include <gfbgraph/gfbgraph-authorizer.h>
 
 G_BEGIN_DECLS
@@ -29,11 +30,23 @@ G_BEGIN_DECLS
 
 G_DECLARE_DERIVABLE_TYPE (GFBGraphNode, gfbgraph_node, GFBGRAPH, NODE, GObject)
 
+/**
+ * GFBGraphNodeClass:
+ * @parent_class: The parent class.
+ * @deserialize_member: A method to set a field straight from a member of the JSON
+ *  object of the node, returning %FALSE for the members it doesn't know. Those are
+ *  set through the properties. Subclasses chain up for the members of their parent.
+ *
+ * Class structure for #GFBGraphNode.
+ **/
 struct _GFBGraphNodeClass
 {
   GObjectClass parent_class;
 
-  gpointer  _reserved1;
+  gboolean (*deserialize_member) (GFBGraphNode *node,
+                                  const gchar  *member_name,
+                                  JsonNode     *member_node);
+
   gpointer  _reserved2;
   gpointer  _reserved3;
   gpointer  _reserved4;
@@ -41,18 +54,32 @@ struct _GFBGraphNodeClass
   gpointer  _reserved6;
 };
 
+#define GFBGRAPH_NODE_ERROR (gfbgraph_node_error_quark ())
+
 typedef enum
 {
   GFBGRAPH_NODE_ERROR_NO_CONNECTIONABLE = 1,
   GFBGRAPH_NODE_ERROR_NO_CONNECTABLE
 } GFBGraphNodeError;
 
+GQuark         gfbgraph_node_error_quark (void);
+
 GFBGraphNode*  gfbgraph_node_new         (void);
 
 GFBGraphNode*  gfbgraph_node_new_from_id (GFBGraphAuthorizer  *authorizer,
                                           const gchar         *id,
                                           GType                node_type,
                                           GError             **error);
+GFBGraphNode*  gfbgraph_node_new_from_id_with_fields (GFBGraphAuthorizer   *authorizer,
+                                                     const gchar          *id,
+                                                     GType                 node_type,
+                                                     const gchar * const  *fields,
+                                                     GError              **error);
+GHashTable*    gfbgraph_node_new_from_ids (GFBGraphAuthorizer   *authorizer,
+                                           const gchar * const  *ids,
+                                           GType                 node_type,
+                                           GCancellable         *cancellable,
+                                           GError              **error);
 
 const gchar*   gfbgraph_node_get_id           (GFBGraphNode *node);
 const gchar*   gfbgraph_node_get_link         (GFBGraphNode *node);
@@ -66,6 +93,15 @@ GList*         gfbgraph_node_get_connection_nodes              (GFBGraphNode
                                                                 GType                 node_type,
                                                                 GFBGraphAuthorizer   *authorizer,
                                                                 GError              **error);
+GPtrArray*     gfbgraph_node_get_connection_nodes_array        (GFBGraphNode         *node,
+                                                                GType                 node_type,
+                                                                GFBGraphAuthorizer   *authorizer,
+                                                                GError              **error);
+GList*         gfbgraph_node_get_connection_nodes_with_fields  (GFBGraphNode         *node,
+                                                                GType                 node_type,
+                                                                GFBGraphAuthorizer   *authorizer,
+                                                                const gchar * const  *fields,
+                                                                GError              **error);
 void           gfbgraph_node_get_connection_nodes_async        (GFBGraphNode         *node, 
                                                                 GType                 node_type, 
                                                                 GFBGraphAuthorizer   *authorizer,
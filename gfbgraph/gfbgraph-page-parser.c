@@ -0,0 +1,354 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Incremental parser for the connection pages returned by the Graph API:
+ *
+ *   {"data": [{...}, {...}], "paging": {...}}
+ *
+ * Instead of building the JsonNode tree of the whole page, the payload is
+ * scanned for the boundaries of the "data" elements, and every element is
+ * parsed and handed to the caller as soon as its closing brace is fed. Only
+ * the text of the element being scanned is kept, so the memory used doesn't
+ * depend on the size of the page. The "paging" and "error" members are
+ * captured the same way.
+ *
+ * The scanner only tracks the structure of the document, the captured values
+ * are validated by a JsonParser but the skipped ones are not.
+ */
+
+#include <string.h>
+
+#include "gfbgraph-common.h"
+#include "gfbgraph-private.h"
+
+typedef enum
+{
+  MEMBER_OTHER,
+  MEMBER_DATA,
+  MEMBER_PAGING,
+  MEMBER_ERROR
+} Member;
+
+struct _GFBGraphPageParser
+{
+  GFBGraphPageParserElementFunc  element_func;
+  gpointer                       user_data;
+
+  JsonParser                    *jparser;
+
+  /* Scanner state */
+  guint                          depth;
+  gboolean                       started;
+  gboolean                       in_string;
+  gboolean                       escaped;
+  gboolean                       expect_key;
+  GString                       *key;
+  gboolean                       in_key;
+  Member                         member;
+  gboolean                       in_data;
+
+  /* The value being captured, and the depth where it started */
+  GString                       *capture;
+  guint                          capture_depth;
+  Member                         capture_member;
+
+  gchar                         *after;
+  gchar                         *next;
+  GError                        *error;
+};
+
+static void
+parse_paging (JsonObject  *paging_jobject,
+              gchar      **after,
+              gchar      **next)
+{
+  JsonObject *cursors_jobject;
+
+  /* Without "next" this is the last page, even if there are cursors */
+  if (!json_object_has_member (paging_jobject, "next"))
+    return;
+
+  *next = g_strdup (json_object_get_string_member (paging_jobject, "next"));
+
+  if (json_object_has_member (paging_jobject, "cursors")) {
+    cursors_jobject = json_object_get_object_member (paging_jobject, "cursors");
+    if (cursors_jobject != NULL && json_object_has_member (cursors_jobject, "after"))
+      *after = g_strdup (json_object_get_string_member (cursors_jobject, "after"));
+  }
+}
+
+static gboolean
+gfbgraph_page_parser_captured (GFBGraphPageParser  *parser,
+                               GError             **error)
+{
+  JsonNode *root;
+
+  if (!json_parser_load_from_data (parser->jparser, parser->capture->str, parser->capture->len, error))
+    return FALSE;
+
+  root = json_parser_get_root (parser->jparser);
+
+  switch (parser->capture_member)
+    {
+    case MEMBER_DATA:
+      parser->element_func (root, parser->user_data);
+      break;
+
+    case MEMBER_PAGING:
+      if (JSON_NODE_HOLDS_OBJECT (root))
+        parse_paging (json_node_get_object (root), &parser->after, &parser->next);
+      break;
+
+    case MEMBER_ERROR:
+      {
+        JsonObject *wrapper;
+        JsonNode *wrapper_jnode;
+
+        /* gfbgraph_api_error_from_json() expects the whole response */
+        wrapper = json_object_new ();
+        json_object_set_member (wrapper, "error", json_node_copy (root));
+        wrapper_jnode = json_node_new (JSON_NODE_OBJECT);
+        json_node_take_object (wrapper_jnode, wrapper);
+        g_clear_error (&parser->error);
+        gfbgraph_api_error_from_json (wrapper_jnode, &parser->error);
+        json_node_free (wrapper_jnode);
+      }
+      break;
+
+    default:
+      break;
+    }
+
+  return TRUE;
+}
+
+/*
+ * gfbgraph_page_parser_new:
+ * @element_func: (allow-none): function called with every element of "data", or %NULL
+ * to only parse the paging.
+ * @user_data: data passed to @element_func.
+ *
+ * Returns: a new #GFBGraphPageParser, free it with gfbgraph_page_parser_free().
+ */
+GFBGraphPageParser*
+gfbgraph_page_parser_new (GFBGraphPageParserElementFunc element_func,
+                          gpointer                      user_data)
+{
+  GFBGraphPageParser *parser;
+
+  parser = g_slice_new0 (GFBGraphPageParser);
+  parser->element_func = element_func;
+  parser->user_data = user_data;
+  parser->jparser = json_parser_new ();
+  parser->key = g_string_new (NULL);
+  parser->capture = g_string_new (NULL);
+
+  return parser;
+}
+
+void
+gfbgraph_page_parser_free (GFBGraphPageParser *parser)
+{
+  g_object_unref (parser->jparser);
+  g_string_free (parser->key, TRUE);
+  g_string_free (parser->capture, TRUE);
+  g_free (parser->after);
+  g_free (parser->next);
+  g_clear_error (&parser->error);
+
+  g_slice_free (GFBGraphPageParser, parser);
+}
+
+/*
+ * gfbgraph_page_parser_feed:
+ * @parser: a #GFBGraphPageParser.
+ * @data: the next chunk of the payload.
+ * @length: the length of @data, or -1 if it's nul-terminated.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Scans @data, calling the element function for each "data" element completed
+ * by it. The payload can be split at any byte.
+ *
+ * Returns: %FALSE if the payload isn't a valid connection page.
+ */
+gboolean
+gfbgraph_page_parser_feed (GFBGraphPageParser  *parser,
+                           const gchar         *data,
+                           gssize               length,
+                           GError             **error)
+{
+  gsize i;
+
+  if (length < 0)
+    length = strlen (data);
+
+  for (i = 0; i < (gsize) length; i++) {
+    gchar c = data[i];
+    gboolean capturing = parser->capture_depth > 0;
+
+    if (parser->in_string) {
+      if (capturing)
+        g_string_append_c (parser->capture, c);
+      else if (parser->in_key && !(c == '"' && !parser->escaped))
+        g_string_append_c (parser->key, c);
+
+      if (parser->escaped)
+        parser->escaped = FALSE;
+      else if (c == '\\')
+        parser->escaped = TRUE;
+      else if (c == '"') {
+        parser->in_string = FALSE;
+        parser->in_key = FALSE;
+      }
+      continue;
+    }
+
+    if (g_ascii_isspace (c)) {
+      if (capturing)
+        g_string_append_c (parser->capture, c);
+      continue;
+    }
+
+    if (parser->depth == 0) {
+      if (c != '{' || parser->started) {
+        g_set_error_literal (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_PARSE,
+                             "A Graph API connection page must be a JSON object");
+        return FALSE;
+      }
+      parser->started = TRUE;
+      parser->depth = 1;
+      parser->expect_key = TRUE;
+      continue;
+    }
+
+    /* Start capturing the elements of "data" and the "paging" and "error" objects */
+    if (!capturing && c == '{' &&
+        ((parser->depth == 2 && parser->in_data && parser->element_func != NULL) ||
+         (parser->depth == 1 && !parser->expect_key &&
+          (parser->member == MEMBER_PAGING || parser->member == MEMBER_ERROR)))) {
+      parser->capture_depth = parser->depth;
+      parser->capture_member = parser->depth == 2 ? MEMBER_DATA : parser->member;
+      g_string_truncate (parser->capture, 0);
+      capturing = TRUE;
+    }
+
+    if (capturing)
+      g_string_append_c (parser->capture, c);
+
+    switch (c)
+      {
+      case '"':
+        parser->in_string = TRUE;
+        if (parser->depth == 1 && parser->expect_key) {
+          parser->in_key = TRUE;
+          g_string_truncate (parser->key, 0);
+        }
+        break;
+
+      case ':':
+        if (parser->depth == 1 && parser->expect_key) {
+          parser->expect_key = FALSE;
+          if (g_strcmp0 (parser->key->str, "data") == 0)
+            parser->member = MEMBER_DATA;
+          else if (g_strcmp0 (parser->key->str, "paging") == 0)
+            parser->member = MEMBER_PAGING;
+          else if (g_strcmp0 (parser->key->str, "error") == 0)
+            parser->member = MEMBER_ERROR;
+          else
+            parser->member = MEMBER_OTHER;
+        }
+        break;
+
+      case ',':
+        if (parser->depth == 1) {
+          parser->expect_key = TRUE;
+          parser->member = MEMBER_OTHER;
+        }
+        break;
+
+      case '[':
+      case '{':
+        if (parser->depth == 1 && c == '[' && parser->member == MEMBER_DATA)
+          parser->in_data = TRUE;
+        parser->depth++;
+        break;
+
+      case ']':
+      case '}':
+        parser->depth--;
+        if (parser->depth == 1)
+          parser->in_data = FALSE;
+
+        if (capturing && parser->depth == parser->capture_depth) {
+          parser->capture_depth = 0;
+          if (!gfbgraph_page_parser_captured (parser, error))
+            return FALSE;
+        }
+        break;
+
+      default:
+        break;
+      }
+  }
+
+  return TRUE;
+}
+
+/*
+ * gfbgraph_page_parser_end:
+ * @parser: a #GFBGraphPageParser.
+ * @after: (out) (allow-none): return location for the "after" cursor of the next page, or %NULL.
+ * @next: (out) (allow-none): return location for the URL of the next page, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Finishes the parsing, after all the payload has been fed. If the payload was a
+ * Graph API error, it's set in @error.
+ *
+ * Returns: %TRUE if the whole page was parsed.
+ */
+gboolean
+gfbgraph_page_parser_end (GFBGraphPageParser  *parser,
+                          gchar              **after,
+                          gchar              **next,
+                          GError             **error)
+{
+  if (parser->error != NULL) {
+    g_propagate_error (error, parser->error);
+    parser->error = NULL;
+    return FALSE;
+  }
+
+  if (!parser->started || parser->depth > 0 || parser->in_string) {
+    g_set_error_literal (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_PARSE,
+                         "The Graph API connection page is incomplete");
+    return FALSE;
+  }
+
+  if (after != NULL) {
+    *after = parser->after;
+    parser->after = NULL;
+  }
+  if (next != NULL) {
+    *next = parser->next;
+    parser->next = NULL;
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,667 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-photo-cache
+ * @title: GFBGraphPhotoCache
+ * @short_description: On-disk cache of photos and other media.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphPhotoCache keeps the downloaded photos in
+ * #GFBGraphPhotoCache:directory, so they aren't downloaded again by
+ * gfbgraph_photo_download_default_size() nor #GFBGraphPhotoDownloader once
+ * it's set in the #GFBGraphClient with gfbgraph_client_set_photo_cache().
+ *
+ * The bytes are stored once in the "blobs" subdirectory, in a file named by
+ * their SHA-256, and the "uris" subdirectory maps the SHA-256 of every URI to
+ * its blob. The same image available in several URIs, like a photo in many
+ * albums, takes the space of a single one.
+ *
+ * When the blobs take more than #GFBGraphPhotoCache:max-size bytes, the least
+ * recently used ones are removed. The modification time of the blobs is
+ * updated when they're used, so the order is kept between processes.
+ *
+ * The cached blobs are memory-mapped instead of read, so serving a cached
+ * photo doesn't copy it.
+ **/
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "gfbgraph-photo-cache.h"
+
+#define DEFAULT_MAX_SIZE (512 * 1024 * 1024)
+#define HASH_LENGTH      64
+
+typedef struct
+{
+  gchar   *hash;
+  guint64  size;
+  gint64   mtime;
+  /* In the LRU queue, the data is the entry */
+  GList    link;
+} BlobEntry;
+
+typedef struct
+{
+  gchar      *directory;
+  gchar      *blobs_directory;
+  gchar      *uris_directory;
+  guint64     max_size;
+
+  /* Protected by mutex */
+  GMutex      mutex;
+  GHashTable *blobs;
+  GQueue      lru;
+  guint64     size;
+  guint64     n_hits;
+  guint64     n_misses;
+} GFBGraphPhotoCachePrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphPhotoCache, gfbgraph_photo_cache, G_TYPE_OBJECT)
+
+enum
+{
+  PROP_0,
+  PROP_DIRECTORY,
+  PROP_MAX_SIZE,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_PHOTO_CACHE_GET_PRIVATE(_obj) gfbgraph_photo_cache_get_instance_private (GFBGRAPH_PHOTO_CACHE (_obj))
+
+static BlobEntry*
+blob_entry_new (const gchar *hash,
+                guint64      size,
+                gint64       mtime)
+{
+  BlobEntry *entry;
+
+  entry = g_slice_new0 (BlobEntry);
+  entry->hash = g_strdup (hash);
+  entry->size = size;
+  entry->mtime = mtime;
+  entry->link.data = entry;
+
+  return entry;
+}
+
+static void
+blob_entry_free (BlobEntry *entry)
+{
+  g_free (entry->hash);
+  g_slice_free (BlobEntry, entry);
+}
+
+static gchar*
+get_uri_path (GFBGraphPhotoCachePrivate *priv,
+              const gchar               *uri)
+{
+  gchar *name;
+  gchar *path;
+
+  name = g_compute_checksum_for_string (G_CHECKSUM_SHA256, uri, -1);
+  path = g_build_filename (priv->uris_directory, name, NULL);
+  g_free (name);
+
+  return path;
+}
+
+/* Removes the least recently used blobs until they fit in the maximum size,
+ * except @keep */
+static void
+evict_unlocked (GFBGraphPhotoCachePrivate *priv,
+                BlobEntry                 *keep)
+{
+  while (priv->size > priv->max_size && priv->lru.head != NULL) {
+    BlobEntry *entry = priv->lru.head->data;
+    gchar *path;
+
+    if (entry == keep)
+      break;
+
+    path = g_build_filename (priv->blobs_directory, entry->hash, NULL);
+    g_unlink (path);
+    g_free (path);
+
+    /* The URIs pointing to it are removed when they're looked up */
+    g_queue_unlink (&priv->lru, &entry->link);
+    priv->size -= entry->size;
+    g_hash_table_remove (priv->blobs, entry->hash);
+  }
+}
+
+static gint
+compare_entries_by_mtime (gconstpointer a,
+                          gconstpointer b)
+{
+  const BlobEntry *entry_a = *(BlobEntry * const *) a;
+  const BlobEntry *entry_b = *(BlobEntry * const *) b;
+
+  return entry_a->mtime < entry_b->mtime ? -1 : entry_a->mtime > entry_b->mtime;
+}
+
+/* Loads the blobs stored by previous processes, oldest first */
+static void
+load_blobs (GFBGraphPhotoCachePrivate *priv)
+{
+  GPtrArray *entries;
+  GDir *dir;
+  const gchar *name;
+  guint i;
+
+  dir = g_dir_open (priv->blobs_directory, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  entries = g_ptr_array_new ();
+  while ((name = g_dir_read_name (dir)) != NULL) {
+    GStatBuf buf;
+    gchar *path;
+
+    /* Leftovers of g_file_set_contents() have a suffix */
+    if (strlen (name) != HASH_LENGTH)
+      continue;
+
+    path = g_build_filename (priv->blobs_directory, name, NULL);
+    if (g_stat (path, &buf) == 0)
+      g_ptr_array_add (entries, blob_entry_new (name, buf.st_size, buf.st_mtime));
+    g_free (path);
+  }
+  g_dir_close (dir);
+
+  g_ptr_array_sort (entries, compare_entries_by_mtime);
+  for (i = 0; i < entries->len; i++) {
+    BlobEntry *entry = g_ptr_array_index (entries, i);
+
+    g_hash_table_insert (priv->blobs, entry->hash, entry);
+    g_queue_push_tail_link (&priv->lru, &entry->link);
+    priv->size += entry->size;
+  }
+  g_ptr_array_unref (entries);
+
+  evict_unlocked (priv, NULL);
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_photo_cache_constructed (GObject *obj)
+{
+  GFBGraphPhotoCachePrivate *priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (obj);
+
+  G_OBJECT_CLASS (gfbgraph_photo_cache_parent_class)->constructed (obj);
+
+  if (priv->directory == NULL)
+    priv->directory = g_build_filename (g_get_user_cache_dir (), "gfbgraph", "photos", NULL);
+  priv->blobs_directory = g_build_filename (priv->directory, "blobs", NULL);
+  priv->uris_directory = g_build_filename (priv->directory, "uris", NULL);
+
+  if (g_mkdir_with_parents (priv->blobs_directory, 0700) != 0 ||
+      g_mkdir_with_parents (priv->uris_directory, 0700) != 0)
+    g_warning ("Couldn't create the photo cache directory %s: %s", priv->directory, g_strerror (errno));
+
+  load_blobs (priv);
+}
+
+static void
+gfbgraph_photo_cache_finalize (GObject *obj)
+{
+  GFBGraphPhotoCachePrivate *priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (obj);
+
+  g_hash_table_unref (priv->blobs);
+  g_free (priv->directory);
+  g_free (priv->blobs_directory);
+  g_free (priv->uris_directory);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_photo_cache_parent_class)->finalize (obj);
+}
+
+static void
+gfbgraph_photo_cache_set_property (GObject      *object,
+                                   guint         prop_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  GFBGraphPhotoCachePrivate *priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_DIRECTORY:
+      g_free (priv->directory);
+      priv->directory = g_value_dup_string (value);
+      break;
+
+    case PROP_MAX_SIZE:
+      priv->max_size = g_value_get_uint64 (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_photo_cache_get_property (GObject    *object,
+                                   guint       prop_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+  GFBGraphPhotoCachePrivate *priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_DIRECTORY:
+      g_value_set_string (value, priv->directory);
+      break;
+
+    case PROP_MAX_SIZE:
+      g_value_set_uint64 (value, priv->max_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_photo_cache_init (GFBGraphPhotoCache *obj)
+{
+  GFBGraphPhotoCachePrivate *priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (obj);
+
+  g_mutex_init (&priv->mutex);
+  g_queue_init (&priv->lru);
+  priv->blobs = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) blob_entry_free);
+}
+
+static void
+gfbgraph_photo_cache_class_init (GFBGraphPhotoCacheClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gfbgraph_photo_cache_constructed;
+  gobject_class->finalize = gfbgraph_photo_cache_finalize;
+  gobject_class->set_property = gfbgraph_photo_cache_set_property;
+  gobject_class->get_property = gfbgraph_photo_cache_get_property;
+
+  /**
+   * GFBGraphPhotoCache:directory:
+   *
+   * The directory where the photos are stored. If %NULL, the "gfbgraph/photos"
+   * directory inside g_get_user_cache_dir() is used.
+   **/
+  properties [PROP_DIRECTORY] =
+    g_param_spec_string ("directory", "Directory",
+                         "The directory where the photos are stored.",
+                         NULL,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GFBGraphPhotoCache:max-size:
+   *
+   * The maximum size in bytes of the stored photos.
+   **/
+  properties [PROP_MAX_SIZE] =
+    g_param_spec_uint64 ("max-size", "Max size",
+                         "The maximum size in bytes of the stored photos.",
+                         1, G_MAXUINT64, DEFAULT_MAX_SIZE,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_photo_cache_new:
+ * @directory: (allow-none): the directory where the photos are stored, or %NULL
+ *  to use the default one.
+ * @max_size: the maximum size in bytes of the stored photos, or 0 for the default.
+ *
+ * Creates a new #GFBGraphPhotoCache, with the photos already in @directory.
+ *
+ * Returns: (transfer full): a new #GFBGraphPhotoCache.
+ **/
+GFBGraphPhotoCache*
+gfbgraph_photo_cache_new (const gchar *directory,
+                          guint64      max_size)
+{
+  return GFBGRAPH_PHOTO_CACHE (g_object_new (GFBGRAPH_TYPE_PHOTO_CACHE,
+                                             "directory", directory,
+                                             "max-size", max_size > 0 ? max_size : (guint64) DEFAULT_MAX_SIZE,
+                                             NULL));
+}
+
+/**
+ * gfbgraph_photo_cache_get_directory:
+ * @cache: a #GFBGraphPhotoCache.
+ *
+ * Returns: the #GFBGraphPhotoCache:directory of @cache.
+ **/
+const gchar*
+gfbgraph_photo_cache_get_directory (GFBGraphPhotoCache *cache)
+{
+  GFBGraphPhotoCachePrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), NULL);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  return priv->directory;
+}
+
+/**
+ * gfbgraph_photo_cache_get_max_size:
+ * @cache: a #GFBGraphPhotoCache.
+ *
+ * Returns: the #GFBGraphPhotoCache:max-size of @cache.
+ **/
+guint64
+gfbgraph_photo_cache_get_max_size (GFBGraphPhotoCache *cache)
+{
+  GFBGraphPhotoCachePrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), 0);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  return priv->max_size;
+}
+
+/**
+ * gfbgraph_photo_cache_get_size:
+ * @cache: a #GFBGraphPhotoCache.
+ *
+ * Returns: the size in bytes of the stored photos, counting the duplicated ones once.
+ **/
+guint64
+gfbgraph_photo_cache_get_size (GFBGraphPhotoCache *cache)
+{
+  GFBGraphPhotoCachePrivate *priv;
+  guint64 size;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), 0);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  g_mutex_lock (&priv->mutex);
+  size = priv->size;
+  g_mutex_unlock (&priv->mutex);
+
+  return size;
+}
+
+/**
+ * gfbgraph_photo_cache_get_n_blobs:
+ * @cache: a #GFBGraphPhotoCache.
+ *
+ * Returns: the number of different photos stored.
+ **/
+guint
+gfbgraph_photo_cache_get_n_blobs (GFBGraphPhotoCache *cache)
+{
+  GFBGraphPhotoCachePrivate *priv;
+  guint n_blobs;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), 0);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  g_mutex_lock (&priv->mutex);
+  n_blobs = g_hash_table_size (priv->blobs);
+  g_mutex_unlock (&priv->mutex);
+
+  return n_blobs;
+}
+
+/**
+ * gfbgraph_photo_cache_get_n_hits:
+ * @cache: a #GFBGraphPhotoCache.
+ *
+ * Returns: the number of lookups that found the photo since @cache was created.
+ **/
+guint64
+gfbgraph_photo_cache_get_n_hits (GFBGraphPhotoCache *cache)
+{
+  GFBGraphPhotoCachePrivate *priv;
+  guint64 n_hits;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), 0);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  g_mutex_lock (&priv->mutex);
+  n_hits = priv->n_hits;
+  g_mutex_unlock (&priv->mutex);
+
+  return n_hits;
+}
+
+/**
+ * gfbgraph_photo_cache_get_n_misses:
+ * @cache: a #GFBGraphPhotoCache.
+ *
+ * Returns: the number of lookups that didn't find the photo since @cache was created.
+ **/
+guint64
+gfbgraph_photo_cache_get_n_misses (GFBGraphPhotoCache *cache)
+{
+  GFBGraphPhotoCachePrivate *priv;
+  guint64 n_misses;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), 0);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  g_mutex_lock (&priv->mutex);
+  n_misses = priv->n_misses;
+  g_mutex_unlock (&priv->mutex);
+
+  return n_misses;
+}
+
+/**
+ * gfbgraph_photo_cache_lookup:
+ * @cache: a #GFBGraphPhotoCache.
+ * @uri: the URI of a photo.
+ *
+ * Looks up the photo downloaded from @uri. The stream reads the memory-mapped
+ * blob, so it's still valid if the photo is removed from @cache afterwards.
+ *
+ * Returns: (transfer full) (nullable): a #GInputStream with the photo, or
+ * %NULL if it isn't in @cache.
+ **/
+GInputStream*
+gfbgraph_photo_cache_lookup (GFBGraphPhotoCache *cache,
+                             const gchar        *uri)
+{
+  GFBGraphPhotoCachePrivate *priv;
+  GInputStream *stream = NULL;
+  GMappedFile *mapped = NULL;
+  BlobEntry *entry = NULL;
+  gchar *uri_path;
+  gchar *hash = NULL;
+  gsize length;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), NULL);
+  g_return_val_if_fail (uri != NULL, NULL);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  uri_path = get_uri_path (priv, uri);
+  if (!g_file_get_contents (uri_path, &hash, &length, NULL) || length != HASH_LENGTH)
+    g_clear_pointer (&hash, g_free);
+
+  g_mutex_lock (&priv->mutex);
+  if (hash != NULL)
+    entry = g_hash_table_lookup (priv->blobs, hash);
+
+  if (entry != NULL) {
+    gchar *blob_path;
+
+    /* Mapped with the lock held, so it isn't evicted before */
+    blob_path = g_build_filename (priv->blobs_directory, entry->hash, NULL);
+    mapped = g_mapped_file_new (blob_path, FALSE, NULL);
+    if (mapped != NULL) {
+      g_queue_unlink (&priv->lru, &entry->link);
+      g_queue_push_tail_link (&priv->lru, &entry->link);
+      g_utime (blob_path, NULL);
+    }
+    g_free (blob_path);
+  }
+
+  if (mapped != NULL)
+    priv->n_hits++;
+  else
+    priv->n_misses++;
+  g_mutex_unlock (&priv->mutex);
+
+  if (mapped != NULL) {
+    GBytes *bytes;
+
+    bytes = g_mapped_file_get_bytes (mapped);
+    stream = g_memory_input_stream_new_from_bytes (bytes);
+    g_bytes_unref (bytes);
+    g_mapped_file_unref (mapped);
+  } else if (hash != NULL) {
+    /* The blob was evicted */
+    g_unlink (uri_path);
+  }
+
+  g_free (hash);
+  g_free (uri_path);
+
+  return stream;
+}
+
+/**
+ * gfbgraph_photo_cache_store:
+ * @cache: a #GFBGraphPhotoCache.
+ * @uri: the URI of a photo.
+ * @bytes: the photo downloaded from @uri.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Stores the photo downloaded from @uri. If the same bytes are already stored
+ * for another URI, they're shared by both.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+gfbgraph_photo_cache_store (GFBGraphPhotoCache  *cache,
+                            const gchar         *uri,
+                            GBytes              *bytes,
+                            GError             **error)
+{
+  GFBGraphPhotoCachePrivate *priv;
+  BlobEntry *entry;
+  gchar *hash;
+  gchar *blob_path;
+  gchar *uri_path;
+  gboolean success = FALSE;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), FALSE);
+  g_return_val_if_fail (uri != NULL, FALSE);
+  g_return_val_if_fail (bytes != NULL, FALSE);
+
+  priv = GFBGRAPH_PHOTO_CACHE_GET_PRIVATE (cache);
+
+  hash = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+  blob_path = g_build_filename (priv->blobs_directory, hash, NULL);
+  uri_path = get_uri_path (priv, uri);
+
+  g_mutex_lock (&priv->mutex);
+  entry = g_hash_table_lookup (priv->blobs, hash);
+  if (entry != NULL) {
+    g_queue_unlink (&priv->lru, &entry->link);
+    g_queue_push_tail_link (&priv->lru, &entry->link);
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  /* Written without the lock, the same name always has the same bytes */
+  if (entry == NULL) {
+    if (!g_file_set_contents (blob_path, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), error))
+      goto out;
+
+    g_mutex_lock (&priv->mutex);
+    if (!g_hash_table_contains (priv->blobs, hash)) {
+      entry = blob_entry_new (hash, g_bytes_get_size (bytes), g_get_real_time () / G_USEC_PER_SEC);
+      g_hash_table_insert (priv->blobs, entry->hash, entry);
+      g_queue_push_tail_link (&priv->lru, &entry->link);
+      priv->size += entry->size;
+      evict_unlocked (priv, entry);
+    }
+    g_mutex_unlock (&priv->mutex);
+  }
+
+  success = g_file_set_contents (uri_path, hash, HASH_LENGTH, error);
+
+ out:
+  g_free (uri_path);
+  g_free (blob_path);
+  g_free (hash);
+
+  return success;
+}
+
+/**
+ * gfbgraph_photo_cache_store_file:
+ * @cache: a #GFBGraphPhotoCache.
+ * @uri: the URI of a photo.
+ * @file: a local #GFile with the photo downloaded from @uri.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_photo_cache_store() with the contents of @file.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+gfbgraph_photo_cache_store_file (GFBGraphPhotoCache  *cache,
+                                 const gchar         *uri,
+                                 GFile               *file,
+                                 GError             **error)
+{
+  GMappedFile *mapped;
+  GBytes *bytes;
+  gchar *path;
+  gboolean success;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_CACHE (cache), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+
+  path = g_file_get_path (file);
+  if (path == NULL) {
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "The photo cache only supports local files");
+    return FALSE;
+  }
+
+  mapped = g_mapped_file_new (path, FALSE, error);
+  g_free (path);
+  if (mapped == NULL)
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  success = gfbgraph_photo_cache_store (cache, uri, bytes, error);
+  g_bytes_unref (bytes);
+  g_mapped_file_unref (mapped);
+
+  return success;
+}
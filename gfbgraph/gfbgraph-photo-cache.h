@@ -0,0 +1,65 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_PHOTO_CACHE_H__
+#define __GFBGRAPH_PHOTO_CACHE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_PHOTO_CACHE (gfbgraph_photo_cache_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphPhotoCache, gfbgraph_photo_cache, GFBGRAPH, PHOTO_CACHE, GObject)
+
+struct _GFBGraphPhotoCacheClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+GFBGraphPhotoCache* gfbgraph_photo_cache_new           (const gchar         *directory,
+                                                        guint64              max_size);
+
+const gchar*        gfbgraph_photo_cache_get_directory (GFBGraphPhotoCache  *cache);
+guint64             gfbgraph_photo_cache_get_max_size  (GFBGraphPhotoCache  *cache);
+guint64             gfbgraph_photo_cache_get_size      (GFBGraphPhotoCache  *cache);
+guint               gfbgraph_photo_cache_get_n_blobs   (GFBGraphPhotoCache  *cache);
+guint64             gfbgraph_photo_cache_get_n_hits    (GFBGraphPhotoCache  *cache);
+guint64             gfbgraph_photo_cache_get_n_misses  (GFBGraphPhotoCache  *cache);
+
+GInputStream*       gfbgraph_photo_cache_lookup        (GFBGraphPhotoCache  *cache,
+                                                        const gchar         *uri);
+gboolean            gfbgraph_photo_cache_store         (GFBGraphPhotoCache  *cache,
+                                                        const gchar         *uri,
+                                                        GBytes              *bytes,
+                                                        GError             **error);
+gboolean            gfbgraph_photo_cache_store_file    (GFBGraphPhotoCache  *cache,
+                                                        const gchar         *uri,
+                                                        GFile               *file,
+                                                        GError             **error);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_PHOTO_CACHE_H__ */
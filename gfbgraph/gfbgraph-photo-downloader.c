@@ -0,0 +1,738 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-photo-downloader
+ * @title: GFBGraphPhotoDownloader
+ * @short_description: Concurrent and resumable download of photos to files.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphPhotoDownloader downloads photos, or any other media, to files
+ * with up to #GFBGraphPhotoDownloader:max-downloads downloads at the same
+ * time, using the #SoupSession of the default #GFBGraphClient so the
+ * connections to the CDN are kept alive between downloads.
+ *
+ * The downloads are queued with gfbgraph_photo_downloader_add(), which
+ * blocks while #GFBGraphPhotoDownloader:max-queued downloads are waiting to
+ * start, so a large backup doesn't queue every photo in memory at once.
+ *
+ * The bytes are written to a file next to the destination, with the ".part"
+ * suffix, which is renamed to the destination once complete. The ETag, or
+ * the Last-Modified date, of the response is kept in another file with the
+ * ".part.if-range" suffix. If both exist when the download starts, because a
+ * previous download was interrupted, only the missing bytes are requested
+ * with Range and If-Range headers, so the server sends the whole file again
+ * if it changed since. Destinations that already exist aren't downloaded
+ * again.
+ *
+ * If the default #GFBGraphClient has a #GFBGraphPhotoCache when the
+ * downloader is created, the photos found in it are copied from it, and the
+ * downloaded ones are stored in it.
+ *
+ * The #GFBGraphPhotoDownloader::download-progress and
+ * #GFBGraphPhotoDownloader::download-finished signals report the state of
+ * every download. They're emitted in the thread doing the download.
+ *
+ * The queued downloads hold a reference to the downloader, they're still
+ * done after the last reference of the application is dropped.
+ **/
+
+#include <string.h>
+#include <libsoup/soup.h>
+
+#include "gfbgraph-client.h"
+#include "gfbgraph-photo-downloader.h"
+#include "gfbgraph-private.h"
+
+#define DEFAULT_MAX_DOWNLOADS 4
+#define DEFAULT_MAX_QUEUED    64
+#define BUFFER_SIZE           (64 * 1024)
+
+typedef struct
+{
+  gchar        *uri;
+  GFile        *destination;
+  GCancellable *cancellable;
+} DownloadJob;
+
+typedef struct
+{
+  guint        max_downloads;
+  guint        max_queued;
+
+  SoupSession *session;
+  GFBGraphPhotoCache *photo_cache;
+  GThreadPool *pool;
+
+  /* Protected by mutex */
+  GMutex       mutex;
+  GCond        cond;
+  guint        n_queued;
+  guint        n_pending;
+} GFBGraphPhotoDownloaderPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphPhotoDownloader, gfbgraph_photo_downloader, G_TYPE_OBJECT)
+
+enum
+{
+  PROP_0,
+  PROP_MAX_DOWNLOADS,
+  PROP_MAX_QUEUED,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+enum
+{
+  SIGNAL_DOWNLOAD_PROGRESS,
+  SIGNAL_DOWNLOAD_FINISHED,
+  N_SIGNALS
+};
+
+static guint signals [N_SIGNALS];
+
+#define GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE(_obj) gfbgraph_photo_downloader_get_instance_private (GFBGRAPH_PHOTO_DOWNLOADER (_obj))
+
+static void gfbgraph_photo_downloader_run_job (DownloadJob             *job,
+                                               GFBGraphPhotoDownloader *downloader);
+
+/* --- GObject --- */
+static void
+gfbgraph_photo_downloader_constructed (GObject *object)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (object);
+
+  G_OBJECT_CLASS (gfbgraph_photo_downloader_parent_class)->constructed (object);
+
+  priv->session = g_object_ref (gfbgraph_client_get_session (gfbgraph_client_get_default ()));
+  priv->photo_cache = gfbgraph_client_get_photo_cache (gfbgraph_client_get_default ());
+  priv->pool = g_thread_pool_new ((GFunc) gfbgraph_photo_downloader_run_job, object,
+                                  priv->max_downloads, FALSE, NULL);
+}
+
+static void
+gfbgraph_photo_downloader_finalize (GObject *object)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (object);
+
+  /* The queued downloads hold a reference, none is left. The last one can
+   * be released by a thread of the pool, which can't wait for itself. */
+  if (priv->pool != NULL)
+    g_thread_pool_free (priv->pool, FALSE, FALSE);
+  g_clear_object (&priv->session);
+  g_clear_object (&priv->photo_cache);
+  g_mutex_clear (&priv->mutex);
+  g_cond_clear (&priv->cond);
+
+  G_OBJECT_CLASS (gfbgraph_photo_downloader_parent_class)->finalize (object);
+}
+
+static void
+gfbgraph_photo_downloader_set_property (GObject      *object,
+                                        guint         prop_id,
+                                        const GValue *value,
+                                        GParamSpec   *pspec)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_DOWNLOADS:
+      priv->max_downloads = g_value_get_uint (value);
+      break;
+
+    case PROP_MAX_QUEUED:
+      priv->max_queued = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_photo_downloader_get_property (GObject    *object,
+                                        guint       prop_id,
+                                        GValue     *value,
+                                        GParamSpec *pspec)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_DOWNLOADS:
+      g_value_set_uint (value, priv->max_downloads);
+      break;
+
+    case PROP_MAX_QUEUED:
+      g_value_set_uint (value, priv->max_queued);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_photo_downloader_init (GFBGraphPhotoDownloader *obj)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (obj);
+
+  g_mutex_init (&priv->mutex);
+  g_cond_init (&priv->cond);
+}
+
+static void
+gfbgraph_photo_downloader_class_init (GFBGraphPhotoDownloaderClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gfbgraph_photo_downloader_constructed;
+  gobject_class->finalize = gfbgraph_photo_downloader_finalize;
+  gobject_class->set_property = gfbgraph_photo_downloader_set_property;
+  gobject_class->get_property = gfbgraph_photo_downloader_get_property;
+
+  /**
+   * GFBGraphPhotoDownloader:max-downloads:
+   *
+   * The maximum number of downloads done at the same time. They share the
+   * connections of the #SoupSession of the default #GFBGraphClient, limited
+   * by its #GFBGraphClient:max-connections.
+   **/
+  properties [PROP_MAX_DOWNLOADS] =
+    g_param_spec_uint ("max-downloads", "Max downloads",
+                       "The maximum number of downloads done at the same time.",
+                       1, G_MAXUINT, DEFAULT_MAX_DOWNLOADS,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GFBGraphPhotoDownloader:max-queued:
+   *
+   * The maximum number of downloads waiting to start. Adding more blocks
+   * until one of them starts.
+   **/
+  properties [PROP_MAX_QUEUED] =
+    g_param_spec_uint ("max-queued", "Max queued",
+                       "The maximum number of downloads waiting to start.",
+                       1, G_MAXUINT, DEFAULT_MAX_QUEUED,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+
+  /**
+   * GFBGraphPhotoDownloader::download-progress:
+   * @downloader: the #GFBGraphPhotoDownloader.
+   * @uri: the URI being downloaded.
+   * @destination: the #GFile where @uri is written.
+   * @received: the number of bytes written, including the ones of a previous download.
+   * @total: the size of the file, or -1 if the server didn't send it.
+   *
+   * Emitted every time a block of bytes of a download is written.
+   **/
+  signals [SIGNAL_DOWNLOAD_PROGRESS] =
+    g_signal_new ("download-progress",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 4,
+                  G_TYPE_STRING, G_TYPE_FILE, G_TYPE_INT64, G_TYPE_INT64);
+
+  /**
+   * GFBGraphPhotoDownloader::download-finished:
+   * @downloader: the #GFBGraphPhotoDownloader.
+   * @uri: the URI downloaded.
+   * @destination: the #GFile where @uri was written.
+   * @error: (allow-none): the #GError of a failed download, or %NULL.
+   *
+   * Emitted when a download ends. When it fails, the ".part" file is kept so
+   * it can be resumed later.
+   **/
+  signals [SIGNAL_DOWNLOAD_FINISHED] =
+    g_signal_new ("download-finished",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 3,
+                  G_TYPE_STRING, G_TYPE_FILE, G_TYPE_ERROR);
+}
+
+/* --- Internal methods --- */
+static void
+download_job_free (DownloadJob *job)
+{
+  g_free (job->uri);
+  g_object_unref (job->destination);
+  g_clear_object (&job->cancellable);
+  g_slice_free (DownloadJob, job);
+}
+
+static GFile*
+get_sibling_file (GFile       *destination,
+                  const gchar *suffix)
+{
+  GFile *parent;
+  GFile *sibling;
+  gchar *basename;
+  gchar *sibling_name;
+
+  parent = g_file_get_parent (destination);
+  basename = g_file_get_basename (destination);
+  sibling_name = g_strconcat (basename, suffix, NULL);
+  sibling = g_file_get_child (parent, sibling_name);
+
+  g_free (sibling_name);
+  g_free (basename);
+  g_object_unref (parent);
+
+  return sibling;
+}
+
+static GFile*
+get_part_file (GFile *destination)
+{
+  return get_sibling_file (destination, ".part");
+}
+
+static GFile*
+get_validator_file (GFile *destination)
+{
+  return get_sibling_file (destination, ".part.if-range");
+}
+
+/* Keeps the validator of the response written to the part file, for the
+ * If-Range header of a resumed download. Weak ETags can't be used there. */
+static void
+save_validator (DownloadJob *job,
+                SoupMessage *msg)
+{
+  GFile *validator_file;
+  const gchar *validator;
+
+  validator = soup_message_headers_get_one (msg->response_headers, "ETag");
+  if (validator == NULL || g_str_has_prefix (validator, "W/"))
+    validator = soup_message_headers_get_one (msg->response_headers, "Last-Modified");
+
+  /* Without it, the download is started again if interrupted */
+  validator_file = get_validator_file (job->destination);
+  if (validator == NULL ||
+      !g_file_replace_contents (validator_file, validator, strlen (validator), NULL, FALSE,
+                                G_FILE_CREATE_NONE, NULL, job->cancellable, NULL))
+    g_file_delete (validator_file, NULL, NULL);
+  g_object_unref (validator_file);
+}
+
+/* Sends the request of @job, resuming it from @offset if it isn't 0 and the
+ * file still matches @validator, and opens the part file where the response
+ * must be written. On success, @offset is the position of the response in the
+ * file and @total its size, or -1. */
+static GInputStream*
+gfbgraph_photo_downloader_send (GFBGraphPhotoDownloader  *downloader,
+                                DownloadJob              *job,
+                                GFile                    *part,
+                                const gchar              *validator,
+                                goffset                  *offset,
+                                goffset                  *total,
+                                GOutputStream           **output,
+                                GError                  **error)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+  SoupMessage *msg;
+  GInputStream *input;
+  goffset start;
+  goffset end;
+
+  msg = soup_message_new (SOUP_METHOD_GET, job->uri);
+  if (msg == NULL) {
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "Invalid URI %s", job->uri);
+    return NULL;
+  }
+
+  if (*offset > 0) {
+    soup_message_headers_set_range (msg->request_headers, *offset, -1);
+    soup_message_headers_replace (msg->request_headers, "If-Range", validator);
+  }
+
+  input = soup_session_send (priv->session, msg, job->cancellable, error);
+  if (input == NULL)
+    goto out;
+
+  if (*offset > 0 && msg->status_code == SOUP_STATUS_PARTIAL_CONTENT &&
+      soup_message_headers_get_content_range (msg->response_headers, &start, &end, total) &&
+      start == *offset) {
+    *output = G_OUTPUT_STREAM (g_file_append_to (part, G_FILE_CREATE_NONE, job->cancellable, error));
+  } else if (msg->status_code == SOUP_STATUS_OK) {
+    /* The server doesn't support ranges, the file changed since the part
+     * file was written, or it was empty */
+    *offset = 0;
+    if (soup_message_headers_get_encoding (msg->response_headers) == SOUP_ENCODING_CONTENT_LENGTH)
+      *total = soup_message_headers_get_content_length (msg->response_headers);
+    else
+      *total = -1;
+    *output = G_OUTPUT_STREAM (g_file_replace (part, NULL, FALSE, G_FILE_CREATE_NONE, job->cancellable, error));
+    if (*output != NULL)
+      save_validator (job, msg);
+  } else {
+    g_set_error (error, SOUP_HTTP_ERROR, msg->status_code,
+                 "Couldn't download %s: %s", job->uri, msg->reason_phrase);
+  }
+
+  if (*output == NULL)
+    g_clear_object (&input);
+
+ out:
+  g_object_unref (msg);
+
+  return input;
+}
+
+/* Copies the photo of @job from the cache, through the part file so the
+ * destination is never incomplete. Returns %FALSE if it isn't cached. */
+static gboolean
+gfbgraph_photo_downloader_copy_cached (GFBGraphPhotoDownloader  *downloader,
+                                       DownloadJob              *job,
+                                       gboolean                 *success,
+                                       GError                  **error)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+  GInputStream *input;
+  GOutputStream *output;
+  GFile *part;
+
+  if (priv->photo_cache == NULL)
+    return FALSE;
+
+  input = gfbgraph_photo_cache_lookup (priv->photo_cache, job->uri);
+  if (input == NULL)
+    return FALSE;
+
+  part = get_part_file (job->destination);
+  output = G_OUTPUT_STREAM (g_file_replace (part, NULL, FALSE, G_FILE_CREATE_NONE, job->cancellable, error));
+  *success = output != NULL &&
+    g_output_stream_splice (output, input, G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, job->cancellable, error) >= 0 &&
+    g_file_move (part, job->destination, G_FILE_COPY_OVERWRITE, job->cancellable, NULL, NULL, error);
+
+  g_clear_object (&output);
+  g_object_unref (input);
+  g_object_unref (part);
+
+  return TRUE;
+}
+
+static gboolean
+gfbgraph_photo_downloader_download (GFBGraphPhotoDownloader  *downloader,
+                                    DownloadJob              *job,
+                                    GError                  **error)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+  GFile *part;
+  GFile *validator_file;
+  GFileInfo *info;
+  GInputStream *input;
+  GOutputStream *output = NULL;
+  GError *local_error = NULL;
+  gchar *validator = NULL;
+  goffset offset = 0;
+  goffset total = -1;
+  gboolean success = FALSE;
+  guint8 *buffer;
+
+  if (g_file_query_exists (job->destination, job->cancellable))
+    return TRUE;
+
+  validator_file = get_validator_file (job->destination);
+
+  if (gfbgraph_photo_downloader_copy_cached (downloader, job, &success, error)) {
+    if (success)
+      g_file_delete (validator_file, NULL, NULL);
+    g_object_unref (validator_file);
+    return success;
+  }
+
+  part = get_part_file (job->destination);
+  info = g_file_query_info (part, G_FILE_ATTRIBUTE_STANDARD_SIZE, G_FILE_QUERY_INFO_NONE, job->cancellable, NULL);
+  if (info != NULL) {
+    offset = g_file_info_get_size (info);
+    g_object_unref (info);
+  }
+
+  /* Without a validator, the part file could be from another version of
+   * the file */
+  if (offset > 0 && !g_file_load_contents (validator_file, job->cancellable, &validator, NULL, NULL, NULL))
+    offset = 0;
+
+  input = gfbgraph_photo_downloader_send (downloader, job, part, validator, &offset, &total, &output, &local_error);
+  if (input == NULL && offset > 0 &&
+      g_error_matches (local_error, SOUP_HTTP_ERROR, SOUP_STATUS_REQUESTED_RANGE_NOT_SATISFIABLE)) {
+    /* The part file doesn't match the current file, start again */
+    g_clear_error (&local_error);
+    offset = 0;
+    input = gfbgraph_photo_downloader_send (downloader, job, part, NULL, &offset, &total, &output, &local_error);
+  }
+  g_free (validator);
+
+  if (input == NULL) {
+    g_propagate_error (error, local_error);
+    g_object_unref (validator_file);
+    g_object_unref (part);
+    return FALSE;
+  }
+
+  buffer = g_malloc (BUFFER_SIZE);
+  while (TRUE) {
+    gssize n_read;
+
+    n_read = g_input_stream_read (input, buffer, BUFFER_SIZE, job->cancellable, error);
+    if (n_read < 0)
+      goto out;
+    if (n_read == 0)
+      break;
+
+    if (!g_output_stream_write_all (output, buffer, n_read, NULL, job->cancellable, error))
+      goto out;
+
+    offset += n_read;
+    g_signal_emit (downloader, signals [SIGNAL_DOWNLOAD_PROGRESS], 0,
+                   job->uri, job->destination, (gint64) offset, (gint64) total);
+  }
+
+  success = g_output_stream_close (output, job->cancellable, error) &&
+    g_file_move (part, job->destination, G_FILE_COPY_OVERWRITE, job->cancellable, NULL, NULL, error);
+  if (success)
+    g_file_delete (validator_file, NULL, NULL);
+
+  /* A failure to store it isn't a failure to download it */
+  if (success && priv->photo_cache != NULL)
+    gfbgraph_photo_cache_store_file (priv->photo_cache, job->uri, job->destination, NULL);
+
+ out:
+  g_free (buffer);
+  g_object_unref (output);
+  g_object_unref (input);
+  g_object_unref (validator_file);
+  g_object_unref (part);
+
+  return success;
+}
+
+/* Runs in the threads of the pool */
+static void
+gfbgraph_photo_downloader_run_job (DownloadJob             *job,
+                                   GFBGraphPhotoDownloader *downloader)
+{
+  GFBGraphPhotoDownloaderPrivate *priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+  GError *error = NULL;
+
+  g_mutex_lock (&priv->mutex);
+  priv->n_queued--;
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->mutex);
+
+  gfbgraph_photo_downloader_download (downloader, job, &error);
+  g_signal_emit (downloader, signals [SIGNAL_DOWNLOAD_FINISHED], 0, job->uri, job->destination, error);
+  g_clear_error (&error);
+  download_job_free (job);
+
+  g_mutex_lock (&priv->mutex);
+  priv->n_pending--;
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->mutex);
+
+  /* Taken by gfbgraph_photo_downloader_add() */
+  g_object_unref (downloader);
+}
+
+static void
+cancelled_cb (GCancellable                   *cancellable,
+              GFBGraphPhotoDownloaderPrivate *priv)
+{
+  g_mutex_lock (&priv->mutex);
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->mutex);
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_photo_downloader_new:
+ * @max_downloads: the maximum number of downloads at the same time, or 0 for the default.
+ * @max_queued: the maximum number of downloads waiting to start, or 0 for the default.
+ *
+ * Creates a new #GFBGraphPhotoDownloader.
+ *
+ * Returns: (transfer full): a new #GFBGraphPhotoDownloader; unref with g_object_unref()
+ **/
+GFBGraphPhotoDownloader*
+gfbgraph_photo_downloader_new (guint max_downloads,
+                               guint max_queued)
+{
+  return GFBGRAPH_PHOTO_DOWNLOADER (g_object_new (GFBGRAPH_TYPE_PHOTO_DOWNLOADER,
+                                                  "max-downloads", max_downloads > 0 ? max_downloads : DEFAULT_MAX_DOWNLOADS,
+                                                  "max-queued", max_queued > 0 ? max_queued : DEFAULT_MAX_QUEUED,
+                                                  NULL));
+}
+
+/**
+ * gfbgraph_photo_downloader_get_max_downloads:
+ * @downloader: a #GFBGraphPhotoDownloader.
+ *
+ * Returns: the maximum number of downloads done at the same time.
+ **/
+guint
+gfbgraph_photo_downloader_get_max_downloads (GFBGraphPhotoDownloader *downloader)
+{
+  GFBGraphPhotoDownloaderPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_DOWNLOADER (downloader), 0);
+
+  priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+
+  return priv->max_downloads;
+}
+
+/**
+ * gfbgraph_photo_downloader_get_max_queued:
+ * @downloader: a #GFBGraphPhotoDownloader.
+ *
+ * Returns: the maximum number of downloads waiting to start.
+ **/
+guint
+gfbgraph_photo_downloader_get_max_queued (GFBGraphPhotoDownloader *downloader)
+{
+  GFBGraphPhotoDownloaderPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_DOWNLOADER (downloader), 0);
+
+  priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+
+  return priv->max_queued;
+}
+
+/**
+ * gfbgraph_photo_downloader_add:
+ * @downloader: a #GFBGraphPhotoDownloader.
+ * @uri: the URI to download.
+ * @destination: the #GFile where @uri is written.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Queues the download of @uri to @destination, blocking while the queue is
+ * full. @cancellable is also used to cancel the download once queued. The
+ * result of the download is reported by #GFBGraphPhotoDownloader::download-finished.
+ *
+ * Returns: %TRUE if the download was queued, %FALSE if @cancellable was
+ * cancelled before.
+ **/
+gboolean
+gfbgraph_photo_downloader_add (GFBGraphPhotoDownloader  *downloader,
+                               const gchar              *uri,
+                               GFile                    *destination,
+                               GCancellable             *cancellable,
+                               GError                  **error)
+{
+  GFBGraphPhotoDownloaderPrivate *priv;
+  DownloadJob *job;
+  gulong handler_id = 0;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO_DOWNLOADER (downloader), FALSE);
+  g_return_val_if_fail (uri != NULL, FALSE);
+  g_return_val_if_fail (G_IS_FILE (destination), FALSE);
+
+  priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+
+  if (cancellable != NULL)
+    handler_id = g_cancellable_connect (cancellable, G_CALLBACK (cancelled_cb), priv, NULL);
+
+  g_mutex_lock (&priv->mutex);
+  while (priv->n_queued >= priv->max_queued && !g_cancellable_is_cancelled (cancellable))
+    g_cond_wait (&priv->cond, &priv->mutex);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+    g_mutex_unlock (&priv->mutex);
+    g_cancellable_disconnect (cancellable, handler_id);
+    return FALSE;
+  }
+
+  priv->n_queued++;
+  priv->n_pending++;
+  g_mutex_unlock (&priv->mutex);
+
+  if (cancellable != NULL)
+    g_cancellable_disconnect (cancellable, handler_id);
+
+  job = g_slice_new0 (DownloadJob);
+  job->uri = g_strdup (uri);
+  job->destination = g_object_ref (destination);
+  job->cancellable = cancellable != NULL ? g_object_ref (cancellable) : NULL;
+  /* Released by the job, the signals are emitted on a live downloader */
+  g_object_ref (downloader);
+  g_thread_pool_push (priv->pool, job, NULL);
+
+  return TRUE;
+}
+
+/**
+ * gfbgraph_photo_downloader_add_photo:
+ * @downloader: a #GFBGraphPhotoDownloader.
+ * @photo: a #GFBGraphPhoto.
+ * @destination: the #GFile where @photo is written.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Like gfbgraph_photo_downloader_add() with the default sized image of @photo,
+ * the one downloaded by gfbgraph_photo_download_default_size().
+ *
+ * Returns: %TRUE if the download was queued, %FALSE if @cancellable was
+ * cancelled before.
+ **/
+gboolean
+gfbgraph_photo_downloader_add_photo (GFBGraphPhotoDownloader  *downloader,
+                                     GFBGraphPhoto            *photo,
+                                     GFile                    *destination,
+                                     GCancellable             *cancellable,
+                                     GError                  **error)
+{
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO (photo), FALSE);
+  g_return_val_if_fail (gfbgraph_photo_get_default_source_uri (photo) != NULL, FALSE);
+
+  return gfbgraph_photo_downloader_add (downloader, gfbgraph_photo_get_default_source_uri (photo),
+                                        destination, cancellable, error);
+}
+
+/**
+ * gfbgraph_photo_downloader_wait:
+ * @downloader: a #GFBGraphPhotoDownloader.
+ *
+ * Blocks until all the queued downloads have finished. It must not be called
+ * from the handlers of the #GFBGraphPhotoDownloader signals.
+ **/
+void
+gfbgraph_photo_downloader_wait (GFBGraphPhotoDownloader *downloader)
+{
+  GFBGraphPhotoDownloaderPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_PHOTO_DOWNLOADER (downloader));
+
+  priv = GFBGRAPH_PHOTO_DOWNLOADER_GET_PRIVATE (downloader);
+
+  g_mutex_lock (&priv->mutex);
+  while (priv->n_pending > 0)
+    g_cond_wait (&priv->cond, &priv->mutex);
+  g_mutex_unlock (&priv->mutex);
+}
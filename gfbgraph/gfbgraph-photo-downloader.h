@@ -0,0 +1,63 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_PHOTO_DOWNLOADER_H__
+#define __GFBGRAPH_PHOTO_DOWNLOADER_H__
+
+#include <gio/gio.h>
+#include <gfbgraph/gfbgraph-photo.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_PHOTO_DOWNLOADER (gfbgraph_photo_downloader_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphPhotoDownloader, gfbgraph_photo_downloader, GFBGRAPH, PHOTO_DOWNLOADER, GObject)
+
+struct _GFBGraphPhotoDownloaderClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+GFBGraphPhotoDownloader* gfbgraph_photo_downloader_new               (guint                     max_downloads,
+                                                                      guint                     max_queued);
+
+guint                    gfbgraph_photo_downloader_get_max_downloads (GFBGraphPhotoDownloader  *downloader);
+guint                    gfbgraph_photo_downloader_get_max_queued    (GFBGraphPhotoDownloader  *downloader);
+
+gboolean                 gfbgraph_photo_downloader_add               (GFBGraphPhotoDownloader  *downloader,
+                                                                      const gchar              *uri,
+                                                                      GFile                    *destination,
+                                                                      GCancellable             *cancellable,
+                                                                      GError                  **error);
+gboolean                 gfbgraph_photo_downloader_add_photo         (GFBGraphPhotoDownloader  *downloader,
+                                                                      GFBGraphPhoto            *photo,
+                                                                      GFile                    *destination,
+                                                                      GCancellable             *cancellable,
+                                                                      GError                  **error);
+void                     gfbgraph_photo_downloader_wait              (GFBGraphPhotoDownloader  *downloader);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_PHOTO_DOWNLOADER_H__ */
@@ -27,14 +27,13 @@
  **/
 
 #include "gfbgraph-photo.h"
+#include "gfbgraph-client.h"
 #include "gfbgraph-connectable.h"
 #include "gfbgraph-album.h"
+#include "gfbgraph-private.h"
 
 #include <json-glib/json-glib.h>
 #include <libsoup/soup.h>
-#include <libsoup/soup-request.h>
-#include <libsoup/soup-request-http.h>
-#include <libsoup/soup-requester.h>
 
 typedef struct
 {
@@ -42,10 +41,21 @@ typedef struct
   gchar              *source;
   guint               width;
   guint               height;
+  /* The images in the order of the Graph API, pointing to image_array */
   GList              *images;
-  GFBGraphPhotoImage *hires_image;
+  /* Sorted by width, then by height */
+  GFBGraphPhotoImage *image_array;
+  /* Pointers to image_array, sorted by height, then by width */
+  GFBGraphPhotoImage **images_by_height;
+  guint               n_images;
 } GFBGraphPhotoPrivate;
 
+typedef struct
+{
+  GFBGraphPhotoImage image;
+  guint              position;
+} SortedImage;
+
 static void  gfbgraph_photo_connectable_iface_init    (GFBGraphConnectableInterface *iface);
 static void  gfbgraph_photo_serializable_iface_init   (JsonSerializableIface *iface);
 
@@ -70,23 +80,19 @@ static GParamSpec* properties [N_PROPERTIES];
 #define GFBGRAPH_PHOTO_GET_PRIVATE(_obj) gfbgraph_photo_get_instance_private (GFBGRAPH_PHOTO (_obj))
 
 
+static void   gfbgraph_photo_set_images  (GFBGraphPhoto *photo,
+                                         GList         *images);
+static GList* gfbgraph_photo_images_copy (GList         *images);
+
 /* --- GObject --- */
 static void
 gfbgraph_photo_finalize (GObject *object)
 {
   GFBGraphPhotoPrivate *priv = GFBGRAPH_PHOTO_GET_PRIVATE (object);
-  GList *image;
-
-  for (image = priv->images; image; image = g_list_next (image)) {
-    GFBGraphPhotoImage *photo_image = (GFBGraphPhotoImage*) image->data;
-
-    g_free (photo_image->source);
-    g_free (photo_image);
-  }
 
+  gfbgraph_photo_set_images (GFBGRAPH_PHOTO (object), NULL);
   g_free (priv->name);
   g_free (priv->source);
-  g_list_free (priv->images);
 
   G_OBJECT_CLASS (gfbgraph_photo_parent_class)->finalize (object);
 }
@@ -119,8 +125,8 @@ gfbgraph_photo_set_property (GObject      *object,
       break;
 
     case PROP_IMAGES:
-      /* TODO: Free GList memory with g_list_free_full */
-      priv->images = g_value_get_pointer (value);
+      gfbgraph_photo_set_images (GFBGRAPH_PHOTO (object),
+                                 gfbgraph_photo_images_copy (g_value_get_pointer (value)));
       break;
 
     default:
@@ -170,15 +176,69 @@ gfbgraph_photo_init (GFBGraphPhoto *object)
   priv->images = NULL;
 }
 
+/* Builds the list of images of the "images" array of the Graph API */
+static GList*
+gfbgraph_photo_images_from_json (JsonArray *jarray)
+{
+  guint i, num_images;
+  GList *images = NULL;
+
+  num_images = json_array_get_length (jarray);
+  for (i = 0; i < num_images; i++) {
+    JsonObject *image_object;
+    GFBGraphPhotoImage *photo_image;
+
+    image_object = json_array_get_object_element (jarray, i);
+    photo_image = g_new0 (GFBGraphPhotoImage, 1);
+    photo_image->width = json_object_get_int_member (image_object, "width");
+    photo_image->height = json_object_get_int_member (image_object, "height");
+    photo_image->source = g_strdup (json_object_get_string_member (image_object, "source"));
+
+    images = g_list_prepend (images, photo_image);
+  }
+
+  return g_list_reverse (images);
+}
+
+static gboolean
+gfbgraph_photo_deserialize_member (GFBGraphNode *node,
+                                   const gchar  *member_name,
+                                   JsonNode     *member_node)
+{
+  GFBGraphPhotoPrivate *priv = GFBGRAPH_PHOTO_GET_PRIVATE (node);
+
+  if (gfbgraph_json_member_is (member_name, "name"))
+    return gfbgraph_json_set_string (member_node, &priv->name);
+  else if (gfbgraph_json_member_is (member_name, "source"))
+    return gfbgraph_json_set_string (member_node, &priv->source);
+  else if (gfbgraph_json_member_is (member_name, "width"))
+    return gfbgraph_json_set_uint (member_node, &priv->width);
+  else if (gfbgraph_json_member_is (member_name, "height"))
+    return gfbgraph_json_set_uint (member_node, &priv->height);
+  else if (gfbgraph_json_member_is (member_name, "images")) {
+    if (!JSON_NODE_HOLDS_ARRAY (member_node))
+      return FALSE;
+
+    gfbgraph_photo_set_images (GFBGRAPH_PHOTO (node),
+                               gfbgraph_photo_images_from_json (json_node_get_array (member_node)));
+    return TRUE;
+  }
+
+  return GFBGRAPH_NODE_CLASS (gfbgraph_photo_parent_class)->deserialize_member (node, member_name, member_node);
+}
+
 static void
 gfbgraph_photo_class_init (GFBGraphPhotoClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GFBGraphNodeClass *node_class = GFBGRAPH_NODE_CLASS (klass);
 
   gobject_class->finalize = gfbgraph_photo_finalize;
   gobject_class->set_property = gfbgraph_photo_set_property;
   gobject_class->get_property = gfbgraph_photo_get_property;
 
+  node_class->deserialize_member = gfbgraph_photo_deserialize_member;
+
   /**
    * GFBGraphPhoto:name:
    *
@@ -226,7 +286,9 @@ gfbgraph_photo_class_init (GFBGraphPhotoClass *klass)
   /**
    * GFBGraphPhoto:images:
    *
-   * A list with the available representations of the photo, in differents sizes
+   * A list with the available representations of the photo, in differents sizes.
+   * The list and its #GFBGraphPhotoImage are owned by the photo: when set, the
+   * photo keeps a copy of them, so the list of another photo can be set.
    **/
   properties [PROP_IMAGES] =
     g_param_spec_pointer ("images", "Sizes of the photo",
@@ -237,6 +299,168 @@ gfbgraph_photo_class_init (GFBGraphPhotoClass *klass)
 }
 
 /* --- Private methods --- */
+static gint
+compare_sorted_images (gconstpointer a,
+                       gconstpointer b,
+                       gpointer      user_data)
+{
+  const GFBGraphPhotoImage *image_a = &((const SortedImage *) a)->image;
+  const GFBGraphPhotoImage *image_b = &((const SortedImage *) b)->image;
+
+  if (image_a->width != image_b->width)
+    return image_a->width < image_b->width ? -1 : 1;
+  if (image_a->height != image_b->height)
+    return image_a->height < image_b->height ? -1 : 1;
+
+  return 0;
+}
+
+static gint
+compare_images_by_height (gconstpointer a,
+                          gconstpointer b,
+                          gpointer      user_data)
+{
+  const GFBGraphPhotoImage *image_a = *(GFBGraphPhotoImage * const *) a;
+  const GFBGraphPhotoImage *image_b = *(GFBGraphPhotoImage * const *) b;
+
+  if (image_a->height != image_b->height)
+    return image_a->height < image_b->height ? -1 : 1;
+  if (image_a->width != image_b->width)
+    return image_a->width < image_b->width ? -1 : 1;
+
+  return 0;
+}
+
+/* A deep copy of @images, to be passed to gfbgraph_photo_set_images() */
+static GList*
+gfbgraph_photo_images_copy (GList *images)
+{
+  GList *copy = NULL;
+  GList *image;
+
+  for (image = images; image != NULL; image = image->next) {
+    GFBGraphPhotoImage *photo_image;
+
+    photo_image = g_new (GFBGraphPhotoImage, 1);
+    *photo_image = *(GFBGraphPhotoImage *) image->data;
+    photo_image->source = g_strdup (photo_image->source);
+    copy = g_list_prepend (copy, photo_image);
+  }
+
+  return g_list_reverse (copy);
+}
+
+/* Replaces the images of @photo with @images, taking their ownership. They're
+ * copied into a single array sorted by size, so the lookups are binary searches. */
+static void
+gfbgraph_photo_set_images (GFBGraphPhoto *photo,
+                           GList         *images)
+{
+  GFBGraphPhotoPrivate *priv = GFBGRAPH_PHOTO_GET_PRIVATE (photo);
+  SortedImage *sorted;
+  GFBGraphPhotoImage **by_position;
+  GList *image;
+  guint i;
+
+  for (i = 0; i < priv->n_images; i++)
+    g_free (priv->image_array[i].source);
+  g_clear_pointer (&priv->image_array, g_free);
+  g_clear_pointer (&priv->images_by_height, g_free);
+  g_clear_pointer (&priv->images, g_list_free);
+  priv->n_images = g_list_length (images);
+
+  if (priv->n_images == 0)
+    return;
+
+  sorted = g_new (SortedImage, priv->n_images);
+  for (image = images, i = 0; image != NULL; image = image->next, i++) {
+    sorted[i].image = *(GFBGraphPhotoImage *) image->data;
+    sorted[i].position = i;
+    /* The source is moved to the array */
+    g_free (image->data);
+  }
+  g_list_free (images);
+
+  g_qsort_with_data (sorted, priv->n_images, sizeof (SortedImage), compare_sorted_images, NULL);
+
+  priv->image_array = g_new (GFBGraphPhotoImage, priv->n_images);
+  priv->images_by_height = g_new (GFBGraphPhotoImage *, priv->n_images);
+  by_position = g_new (GFBGraphPhotoImage *, priv->n_images);
+  for (i = 0; i < priv->n_images; i++) {
+    priv->image_array[i] = sorted[i].image;
+    priv->images_by_height[i] = &priv->image_array[i];
+    by_position[sorted[i].position] = &priv->image_array[i];
+  }
+  g_qsort_with_data (priv->images_by_height, priv->n_images, sizeof (GFBGraphPhotoImage *),
+                     compare_images_by_height, NULL);
+
+  for (i = priv->n_images; i > 0; i--)
+    priv->images = g_list_prepend (priv->images, by_position[i - 1]);
+
+  g_free (by_position);
+  g_free (sorted);
+}
+
+/* The number of images narrower than @width, or than or as wide as it if
+ * @inclusive is set */
+static guint
+count_images_by_width (GFBGraphPhotoPrivate *priv,
+                       guint                 width,
+                       gboolean              inclusive)
+{
+  guint low = 0;
+  guint high = priv->n_images;
+
+  while (low < high) {
+    guint middle = low + (high - low) / 2;
+    guint middle_width = priv->image_array[middle].width;
+
+    if (middle_width < width || (inclusive && middle_width == width))
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  return low;
+}
+
+/* The number of images shorter than @height */
+static guint
+count_images_by_height (GFBGraphPhotoPrivate *priv,
+                        guint                 height)
+{
+  guint low = 0;
+  guint high = priv->n_images;
+
+  while (low < high) {
+    guint middle = low + (high - low) / 2;
+
+    if (priv->images_by_height[middle]->height < height)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  return low;
+}
+
+/* The closest to @size of @smaller, below it, and @larger, at least as large.
+ * Any of them can be %NULL. */
+static const GFBGraphPhotoImage*
+pick_nearest (GFBGraphPhotoImage *smaller,
+              guint               smaller_size,
+              GFBGraphPhotoImage *larger,
+              guint               larger_size,
+              guint               size)
+{
+  if (smaller == NULL)
+    return larger;
+  if (larger == NULL)
+    return smaller;
+
+  return size - smaller_size < larger_size - size ? smaller : larger;
+}
+
 /* --- Implement GFBGraphConnectable interface --- */
 GHashTable*
 gfbgraph_photo_get_connection_post_params (GFBGraphConnectable *self,
@@ -274,9 +498,25 @@ gfbgraph_photo_serializable_serialize_property (JsonSerializable *serializable,
 {
   JsonNode *node = NULL;
 
-  g_print ("Serializing %s\n", property_name);
-
   if (g_strcmp0 ("images", property_name) == 0) {
+    JsonArray *jarray;
+    GList *image;
+
+    /* The same format of the Graph API, so it can be deserialized again */
+    jarray = json_array_new ();
+    for (image = g_value_get_pointer (value); image != NULL; image = image->next) {
+      GFBGraphPhotoImage *photo_image = image->data;
+      JsonObject *image_object;
+
+      image_object = json_object_new ();
+      json_object_set_int_member (image_object, "width", photo_image->width);
+      json_object_set_int_member (image_object, "height", photo_image->height);
+      json_object_set_string_member (image_object, "source", photo_image->source);
+      json_array_add_object_element (jarray, image_object);
+    }
+
+    node = json_node_new (JSON_NODE_ARRAY);
+    json_node_take_array (node, jarray);
   } else {
     node = json_serializable_default_serialize_property (serializable, property_name, value, pspec);
   }
@@ -295,27 +535,13 @@ gfbgraph_photo_serializable_deserialize_property (JsonSerializable *serializable
 
   if (g_strcmp0 ("images", property_name) == 0) {
     if (JSON_NODE_HOLDS_ARRAY (property_node)) {
-      guint i, num_images;
-      JsonArray *jarray;
-      GList *images = NULL;
-
-      jarray = json_node_get_array (property_node);
-      num_images = json_array_get_length (jarray);
-      for (i = 0; i < num_images; i++) {
-        JsonObject *image_object;
-        GFBGraphPhotoImage *photo_image;
-
-        image_object = json_array_get_object_element (jarray, i);
-        photo_image = g_new0 (GFBGraphPhotoImage, 1);
-        photo_image->width = json_object_get_int_member (image_object, "width");
-        photo_image->height = json_object_get_int_member (image_object, "height");
-        photo_image->source = g_strdup (json_object_get_string_member (image_object, "source"));
-
-        images = g_list_append (images, photo_image);
-      }
-
-      g_value_set_pointer (value, (gpointer *) images);
-      res = TRUE;
+      /* The images are set straight into the photo, because the property
+       * copies them and nothing would free a list passed in @value. The
+       * property isn't construct-only, so the photo already exists, and
+       * json-glib doesn't set a pointer property that can't be deserialized. */
+      gfbgraph_photo_set_images (GFBGRAPH_PHOTO (serializable),
+                                 gfbgraph_photo_images_from_json (json_node_get_array (property_node)));
+      res = FALSE;
     } else {
       g_warning ("The 'images' node retrieved from the Facebook Graph API isn't an array, it's holding a %s\n", json_node_type_name (property_node));
       res = FALSE;
@@ -404,6 +630,32 @@ gfbgraph_photo_new_from_id (GFBGraphAuthorizer  *authorizer,
                                                     error));
 }
 
+/**
+ * gfbgraph_photo_new_from_id_with_fields:
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @id: a const #gchar with the photo ID.
+ * @fields: (array zero-terminated=1) (allow-none): a %NULL-terminated array with the fields to retrieve, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Retrieves only the given @fields of the photo node with the give ID, see
+ * gfbgraph_node_new_from_id_with_fields(). Useful to skip the "images" field
+ * when only the default size is used.
+ *
+ * Returns: (transfer full): a new #GFBGraphPhoto; unref with g_object_unref()
+ **/
+GFBGraphPhoto*
+gfbgraph_photo_new_from_id_with_fields (GFBGraphAuthorizer   *authorizer,
+                                        const gchar          *id,
+                                        const gchar * const  *fields,
+                                        GError              **error)
+{
+  return GFBGRAPH_PHOTO (gfbgraph_node_new_from_id_with_fields (authorizer,
+                                                                id,
+                                                                GFBGRAPH_TYPE_PHOTO,
+                                                                fields,
+                                                                error));
+}
+
 
 /**
  * gfbgraph_photo_download_default_size:
@@ -414,6 +666,12 @@ gfbgraph_photo_new_from_id (GFBGraphAuthorizer  *authorizer,
  * Download the default sized photo pointed by @photo, with a maximum width or height of 720px.
  * The photo always is a JPEG.
  *
+ * To download many photos to files, #GFBGraphPhotoDownloader does it
+ * concurrently and can resume the interrupted downloads.
+ *
+ * If the default client has a #GFBGraphPhotoCache, the photo is read from it
+ * when it was already downloaded, and stored in it otherwise.
+ *
  * Returns: (transfer full): a #GInputStream with the photo content or %NULL in case of error.
  **/
 GInputStream*
@@ -422,10 +680,10 @@ gfbgraph_photo_download_default_size (GFBGraphPhoto       *photo,
                                       GError             **error)
 {
   GInputStream *stream = NULL;
+  GFBGraphClient *client;
+  GFBGraphPhotoCache *photo_cache;
   SoupSession *session;
-  SoupRequester *requester;
   SoupRequest *request;
-  SoupMessage *message;
   GFBGraphPhotoPrivate *priv;
 
   g_return_val_if_fail (GFBGRAPH_IS_PHOTO (photo), NULL);
@@ -433,24 +691,62 @@ gfbgraph_photo_download_default_size (GFBGraphPhoto       *photo,
 
   priv = GFBGRAPH_PHOTO_GET_PRIVATE (photo);
 
-  session = soup_session_sync_new ();
-  requester = soup_requester_new ();
-  soup_session_add_feature (session, SOUP_SESSION_FEATURE (requester));
+  client = gfbgraph_client_get_default ();
+  photo_cache = gfbgraph_client_get_photo_cache (client);
+  if (photo_cache != NULL) {
+    stream = gfbgraph_photo_cache_lookup (photo_cache, priv->source);
+    if (stream != NULL) {
+      g_object_unref (photo_cache);
+      return stream;
+    }
+  }
 
-  request = soup_requester_request (requester, priv->source, error);
-  if (request != NULL) {
-    message = soup_request_http_get_message (SOUP_REQUEST_HTTP (request));
+  /* Shared with every other download, so the connections to the CDN are reused */
+  session = gfbgraph_client_get_session (client);
 
+  request = soup_session_request (session, priv->source, error);
+  if (request != NULL) {
     stream = soup_request_send (request, NULL, error);
-    if (stream != NULL) {
-      g_object_weak_ref (G_OBJECT (stream), (GWeakNotify) g_object_unref, session);
+
+    /* The body of an error response isn't the photo, and mustn't be cached */
+    if (stream != NULL && SOUP_IS_REQUEST_HTTP (request)) {
+      SoupMessage *msg;
+
+      msg = soup_request_http_get_message (SOUP_REQUEST_HTTP (request));
+      if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code)) {
+        g_set_error (error, SOUP_HTTP_ERROR, msg->status_code,
+                     "Couldn't download %s: %s", priv->source, msg->reason_phrase);
+        g_clear_object (&stream);
+      }
+      g_object_unref (msg);
     }
 
-    g_clear_object (&message);
-    g_clear_object (&request);
+    g_object_unref (request);
+  }
+
+  /* Read whole to store it, the photos are small */
+  if (stream != NULL && photo_cache != NULL) {
+    GOutputStream *output;
+    GBytes *bytes;
+
+    output = g_memory_output_stream_new_resizable ();
+    if (g_output_stream_splice (output, stream,
+                                G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                NULL, error) < 0) {
+      g_clear_object (&stream);
+    } else {
+      bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+      /* A failure to store it isn't a failure to download it */
+      gfbgraph_photo_cache_store (photo_cache, priv->source, bytes, NULL);
+
+      g_object_unref (stream);
+      stream = g_memory_input_stream_new_from_bytes (bytes);
+      g_bytes_unref (bytes);
+    }
+    g_object_unref (output);
   }
 
-  g_clear_object (&requester);
+  g_clear_object (&photo_cache);
 
   return stream;
 }
@@ -560,71 +856,171 @@ gfbgraph_photo_get_image_hires (GFBGraphPhoto *photo)
 
   priv = GFBGRAPH_PHOTO_GET_PRIVATE (photo);
 
-  if (priv->hires_image == NULL) {
-    GList *image;
-    guint bigger_width = 0;
+  return priv->n_images > 0 ? &priv->image_array[priv->n_images - 1] : NULL;
+}
 
-    for (image = priv->images; image; image = g_list_next (image)) {
-      GFBGraphPhotoImage *photo_image = (GFBGraphPhotoImage*) image->data;
+/**
+ * gfbgraph_photo_get_image_near_width:
+ * @photo: a #GFBGraphPhoto.
+ * @width: a width in pixels.
+ *
+ * Returns: (transfer none): the #GFBGraphPhotoImage with the width closest to @width, or %NULL.
+ **/
+const GFBGraphPhotoImage*
+gfbgraph_photo_get_image_near_width (GFBGraphPhoto *photo,
+                                     guint          width)
+{
+  GFBGraphPhotoPrivate *priv;
+  GFBGraphPhotoImage *smaller = NULL;
+  GFBGraphPhotoImage *larger = NULL;
+  guint index;
 
-      if (photo_image->width > bigger_width) {
-        priv->hires_image = photo_image;
-        bigger_width = photo_image->width;
-      }
-    }
-  }
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO (photo), NULL);
+
+  priv = GFBGRAPH_PHOTO_GET_PRIVATE (photo);
 
-  return priv->hires_image;
+  index = count_images_by_width (priv, width, FALSE);
+  if (index > 0)
+    smaller = &priv->image_array[index - 1];
+  if (index < priv->n_images)
+    larger = &priv->image_array[index];
+
+  return pick_nearest (smaller, smaller != NULL ? smaller->width : 0,
+                       larger, larger != NULL ? larger->width : 0,
+                       width);
 }
 
+/**
+ * gfbgraph_photo_get_image_near_height:
+ * @photo: a #GFBGraphPhoto.
+ * @height: a height in pixels.
+ *
+ * Returns: (transfer none): the #GFBGraphPhotoImage with the height closest to @height, or %NULL.
+ **/
 const GFBGraphPhotoImage*
-gfbgraph_photo_get_image_near_width (GFBGraphPhoto *photo,
-                                     guint          width)
+gfbgraph_photo_get_image_near_height (GFBGraphPhoto *photo,
+                                      guint          height)
 {
   GFBGraphPhotoPrivate *priv;
-  GFBGraphPhotoImage *photo_image = NULL;
-  GList *image;
-  gint least_diff = width << 1;
+  GFBGraphPhotoImage *smaller = NULL;
+  GFBGraphPhotoImage *larger = NULL;
+  guint index;
 
   g_return_val_if_fail (GFBGRAPH_IS_PHOTO (photo), NULL);
 
   priv = GFBGRAPH_PHOTO_GET_PRIVATE (photo);
 
-  for (image = priv->images; image; image = g_list_next (image)) {
-    GFBGraphPhotoImage *tmp_image = (GFBGraphPhotoImage*) image->data;
-    gint tmp_diff = ABS (tmp_image->width - width);
+  index = count_images_by_height (priv, height);
+  if (index > 0)
+    smaller = priv->images_by_height[index - 1];
+  if (index < priv->n_images)
+    larger = priv->images_by_height[index];
 
-    if (photo_image == NULL || tmp_diff < least_diff) {
-      least_diff = tmp_diff;
-      photo_image = tmp_image;
-    }
+  return pick_nearest (smaller, smaller != NULL ? smaller->height : 0,
+                       larger, larger != NULL ? larger->height : 0,
+                       height);
+}
+
+/**
+ * gfbgraph_photo_get_image_at_least:
+ * @photo: a #GFBGraphPhoto.
+ * @width: the minimum width in pixels.
+ * @height: the minimum height in pixels.
+ *
+ * Gets the smallest image of @photo at least @width pixels wide and @height
+ * pixels high, like the image to scale down for a thumbnail of that size. If
+ * all the images are smaller, the largest one is returned.
+ *
+ * Returns: (transfer none): a #GFBGraphPhotoImage, or %NULL if @photo has no images.
+ **/
+const GFBGraphPhotoImage*
+gfbgraph_photo_get_image_at_least (GFBGraphPhoto *photo,
+                                   guint          width,
+                                   guint          height)
+{
+  GFBGraphPhotoPrivate *priv;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_PHOTO (photo), NULL);
+
+  priv = GFBGRAPH_PHOTO_GET_PRIVATE (photo);
+
+  /* The images are usually wider as they're higher, so the first one wide
+   * enough is usually high enough too */
+  for (i = count_images_by_width (priv, width, FALSE); i < priv->n_images; i++) {
+    if (priv->image_array[i].height >= height)
+      return &priv->image_array[i];
   }
 
-  return photo_image;
+  return priv->n_images > 0 ? &priv->image_array[priv->n_images - 1] : NULL;
 }
 
+/**
+ * gfbgraph_photo_get_image_best_fit:
+ * @photo: a #GFBGraphPhoto.
+ * @width: the maximum width in pixels.
+ * @height: the maximum height in pixels.
+ *
+ * Gets the largest image of @photo fitting in a box of @width per @height
+ * pixels, so it can be shown without scaling it up. If all the images are
+ * larger, the smallest one is returned.
+ *
+ * Returns: (transfer none): a #GFBGraphPhotoImage, or %NULL if @photo has no images.
+ **/
 const GFBGraphPhotoImage*
-gfbgraph_photo_get_image_near_height (GFBGraphPhoto *photo,
-                                      guint          height)
+gfbgraph_photo_get_image_best_fit (GFBGraphPhoto *photo,
+                                   guint          width,
+                                   guint          height)
 {
   GFBGraphPhotoPrivate *priv;
-  GFBGraphPhotoImage *photo_image = NULL;
-  GList *image;
-  gint least_diff = height << 1;
+  guint i;
 
   g_return_val_if_fail (GFBGRAPH_IS_PHOTO (photo), NULL);
 
   priv = GFBGRAPH_PHOTO_GET_PRIVATE (photo);
 
-  for (image = priv->images; image; image = g_list_next (image)) {
-    GFBGraphPhotoImage *tmp_image = (GFBGraphPhotoImage*) image->data;
-    gint tmp_diff = ABS (tmp_image->height - height);
+  for (i = count_images_by_width (priv, width, TRUE); i > 0; i--) {
+    if (priv->image_array[i - 1].height <= height)
+      return &priv->image_array[i - 1];
+  }
 
-    if (photo_image == NULL || tmp_diff < least_diff) {
-      least_diff = tmp_diff;
-      photo_image = tmp_image;
-    }
+  return priv->n_images > 0 ? &priv->image_array[0] : NULL;
+}
+
+/**
+ * gfbgraph_photo_select_images:
+ * @photos: (element-type GFBGraphPhoto): a #GList of #GFBGraphPhoto.
+ * @width: a width in pixels.
+ * @height: a height in pixels.
+ * @fit: how the images are selected.
+ *
+ * Selects an image of every photo of @photos for the same size, with
+ * gfbgraph_photo_get_image_at_least() or gfbgraph_photo_get_image_best_fit()
+ * depending on @fit. Useful to pick the images of a whole page of photos.
+ *
+ * Returns: (element-type GFBGraphPhotoImage) (transfer container): a #GPtrArray
+ * with the image of every photo, in the same order, or %NULL for the photos
+ * without images. The images are owned by the photos.
+ **/
+GPtrArray*
+gfbgraph_photo_select_images (GList                 *photos,
+                              guint                  width,
+                              guint                  height,
+                              GFBGraphPhotoImageFit  fit)
+{
+  GPtrArray *images;
+  GList *l;
+
+  images = g_ptr_array_sized_new (g_list_length (photos));
+  for (l = photos; l != NULL; l = l->next) {
+    const GFBGraphPhotoImage *image;
+
+    if (fit == GFBGRAPH_PHOTO_IMAGE_BEST_FIT)
+      image = gfbgraph_photo_get_image_best_fit (l->data, width, height);
+    else
+      image = gfbgraph_photo_get_image_at_least (l->data, width, height);
+    g_ptr_array_add (images, (gpointer) image);
   }
 
-  return photo_image;
+  return images;
 }
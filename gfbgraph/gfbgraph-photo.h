@@ -45,10 +45,27 @@ struct _GFBGraphPhotoImage {
   gchar *source;
 };
 
+/**
+ * GFBGraphPhotoImageFit:
+ * @GFBGRAPH_PHOTO_IMAGE_AT_LEAST: the smallest image at least as large as the size.
+ * @GFBGRAPH_PHOTO_IMAGE_BEST_FIT: the largest image fitting in the size.
+ *
+ * How gfbgraph_photo_select_images() selects the images for a size.
+ */
+typedef enum
+{
+  GFBGRAPH_PHOTO_IMAGE_AT_LEAST,
+  GFBGRAPH_PHOTO_IMAGE_BEST_FIT
+} GFBGraphPhotoImageFit;
+
 GFBGraphPhoto*            gfbgraph_photo_new                    (void);
 GFBGraphPhoto*            gfbgraph_photo_new_from_id            (GFBGraphAuthorizer  *authorizer,
                                                                  const gchar         *id,
                                                                  GError             **error);
+GFBGraphPhoto*            gfbgraph_photo_new_from_id_with_fields (GFBGraphAuthorizer   *authorizer,
+                                                                  const gchar          *id,
+                                                                  const gchar * const  *fields,
+                                                                  GError              **error);
 GInputStream*             gfbgraph_photo_download_default_size  (GFBGraphPhoto       *photo,
                                                                  GFBGraphAuthorizer  *authorizer,
                                                                  GError             **error);
@@ -63,6 +80,17 @@ const GFBGraphPhotoImage* gfbgraph_photo_get_image_near_width   (GFBGraphPhoto *
                                                                  guint          width);
 const GFBGraphPhotoImage* gfbgraph_photo_get_image_near_height  (GFBGraphPhoto *photo,
                                                                  guint          height);
+const GFBGraphPhotoImage* gfbgraph_photo_get_image_at_least     (GFBGraphPhoto *photo,
+                                                                 guint          width,
+                                                                 guint          height);
+const GFBGraphPhotoImage* gfbgraph_photo_get_image_best_fit     (GFBGraphPhoto *photo,
+                                                                 guint          width,
+                                                                 guint          height);
+
+GPtrArray*                gfbgraph_photo_select_images          (GList                 *photos,
+                                                                 guint                  width,
+                                                                 guint                  height,
+                                                                 GFBGraphPhotoImageFit  fit);
 
 G_END_DECLS
 
@@ -0,0 +1,213 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Internal functions shared between the library modules, not installed. */
+
+#ifndef __GFBGRAPH_PRIVATE_H__
+#define __GFBGRAPH_PRIVATE_H__
+
+#include <json-glib/json-glib.h>
+#include <rest/rest-proxy-call.h>
+#include <gfbgraph/gfbgraph-client.h>
+#include <gfbgraph/gfbgraph-connectable.h>
+
+G_BEGIN_DECLS
+
+gboolean gfbgraph_rest_call_invoke                 (RestProxyCall        *call,
+                                                    GCancellable         *cancellable,
+                                                    GError              **error);
+void     gfbgraph_rest_call_invoke_async           (RestProxyCall        *call,
+                                                    GCancellable         *cancellable,
+                                                    GAsyncReadyCallback   callback,
+                                                    gpointer              user_data);
+gboolean gfbgraph_rest_call_invoke_finish          (RestProxyCall        *call,
+                                                    GAsyncResult         *result,
+                                                    GError              **error);
+const gchar* gfbgraph_rest_call_get_payload        (RestProxyCall        *call);
+goffset      gfbgraph_rest_call_get_payload_length (RestProxyCall        *call);
+
+gboolean gfbgraph_api_error_from_json              (JsonNode  *root,
+                                                    GError   **error);
+gboolean gfbgraph_api_error_from_payload           (const gchar  *payload,
+                                                    gssize        length,
+                                                    GError      **error);
+
+gchar*   gfbgraph_node_fields_to_param             (GType                node_type,
+                                                    const gchar * const *fields);
+GFBGraphNode* gfbgraph_node_deserialize            (GType                node_type,
+                                                    JsonNode            *jnode);
+gboolean gfbgraph_json_member_is                   (const gchar  *member_name,
+                                                    const gchar  *field);
+gboolean gfbgraph_json_set_string                  (JsonNode     *member_node,
+                                                    gchar       **field);
+gboolean gfbgraph_json_set_uint                    (JsonNode     *member_node,
+                                                    guint        *field);
+
+typedef struct _GFBGraphPageParser GFBGraphPageParser;
+
+typedef void (*GFBGraphPageParserElementFunc) (JsonNode *element,
+                                               gpointer  user_data);
+
+GFBGraphPageParser* gfbgraph_page_parser_new  (GFBGraphPageParserElementFunc   element_func,
+                                               gpointer                        user_data);
+gboolean            gfbgraph_page_parser_feed (GFBGraphPageParser             *parser,
+                                               const gchar                    *data,
+                                               gssize                          length,
+                                               GError                        **error);
+gboolean            gfbgraph_page_parser_end  (GFBGraphPageParser             *parser,
+                                               gchar                         **after,
+                                               gchar                         **next,
+                                               GError                        **error);
+void                gfbgraph_page_parser_free (GFBGraphPageParser             *parser);
+
+/* An immutable access token, shared by the requests that use it */
+typedef struct
+{
+  gint    ref_count;
+  gchar  *access_token;
+  /* The wall-clock time when it expires, or 0 if unknown. The monotonic
+   * clock stops while the system is suspended. */
+  gint64  expiration;
+} GFBGraphToken;
+
+/* The current token of an authorizer, see gfbgraph-token.c */
+typedef struct
+{
+  /* Protected by token_mutex */
+  GFBGraphToken *token;
+  GMutex         token_mutex;
+
+  /* Protected by mutex */
+  GMutex         mutex;
+  GCond          cond;
+  gboolean       refreshing;
+  guint          n_refreshes;
+  GError        *refresh_error;
+} GFBGraphTokenSlot;
+
+typedef GFBGraphToken* (*GFBGraphTokenRefreshFunc) (gpointer       user_data,
+                                                     GCancellable  *cancellable,
+                                                     GError       **error);
+
+GFBGraphToken* gfbgraph_token_new          (const gchar               *access_token);
+GFBGraphToken* gfbgraph_token_ref          (GFBGraphToken             *token);
+void           gfbgraph_token_unref        (GFBGraphToken             *token);
+gboolean       gfbgraph_token_is_expired   (GFBGraphToken             *token);
+void           gfbgraph_token_slot_init    (GFBGraphTokenSlot         *slot);
+void           gfbgraph_token_slot_clear   (GFBGraphTokenSlot         *slot);
+GFBGraphToken* gfbgraph_token_slot_get     (GFBGraphTokenSlot         *slot);
+void           gfbgraph_token_slot_publish (GFBGraphTokenSlot         *slot,
+                                            GFBGraphToken             *token);
+gboolean       gfbgraph_token_slot_refresh (GFBGraphTokenSlot         *slot,
+                                            GFBGraphTokenRefreshFunc   func,
+                                            gpointer                   user_data,
+                                            GCancellable              *cancellable,
+                                            GError                   **error);
+
+typedef struct _GFBGraphScheduler GFBGraphScheduler;
+
+GFBGraphScheduler* gfbgraph_scheduler_new            (guint                 max_in_flight,
+                                                      gdouble               rate);
+void               gfbgraph_scheduler_free           (GFBGraphScheduler    *scheduler);
+gboolean           gfbgraph_scheduler_acquire        (GFBGraphScheduler    *scheduler,
+                                                      const gchar          *token,
+                                                      GCancellable         *cancellable,
+                                                      GError              **error);
+void               gfbgraph_scheduler_acquire_async  (GFBGraphScheduler    *scheduler,
+                                                      const gchar          *token,
+                                                      GCancellable         *cancellable,
+                                                      GAsyncReadyCallback   callback,
+                                                      gpointer              user_data);
+gboolean           gfbgraph_scheduler_acquire_finish (GFBGraphScheduler    *scheduler,
+                                                      GAsyncResult         *result,
+                                                      GError              **error);
+void               gfbgraph_scheduler_release        (GFBGraphScheduler    *scheduler,
+                                                      const gchar          *token,
+                                                      RestProxyCall        *call,
+                                                      const GError         *error);
+void               gfbgraph_rest_call_get_usage      (RestProxyCall        *call,
+                                                      gdouble              *app_usage,
+                                                      gdouble              *token_usage,
+                                                      gint64               *regain_usec);
+
+GFBGraphClient*     gfbgraph_rest_call_get_client     (RestProxyCall        *call);
+GFBGraphAuthorizer* gfbgraph_rest_call_get_authorizer (RestProxyCall        *call);
+GFBGraphScheduler*  gfbgraph_rest_call_get_scheduler  (RestProxyCall        *call);
+GFBGraphCache*      gfbgraph_rest_call_ref_cache      (RestProxyCall        *call);
+GFBGraphMetrics*    gfbgraph_rest_call_get_metrics    (RestProxyCall        *call);
+void                gfbgraph_client_emit_request_started  (GFBGraphClient *client,
+                                                           RestProxyCall  *call);
+void                gfbgraph_client_emit_request_finished (GFBGraphClient *client,
+                                                           RestProxyCall  *call,
+                                                           gint64          latency,
+                                                           const GError   *error);
+gboolean            gfbgraph_rest_call_is_traced      (RestProxyCall        *call);
+void                gfbgraph_rest_call_trace          (RestProxyCall        *call,
+                                                       const gchar          *name,
+                                                       gint64                start,
+                                                       gint64                end,
+                                                       const GError         *error);
+void                gfbgraph_rest_call_trace_items    (RestProxyCall        *call,
+                                                       const gchar          *name,
+                                                       gint64                start,
+                                                       gint64                end,
+                                                       guint                 n_items,
+                                                       const GError         *error);
+gint64              gfbgraph_rest_call_start_timer            (RestProxyCall *call);
+void                gfbgraph_rest_call_stop_parse_timer       (RestProxyCall *call,
+                                                               gint64        *timer);
+void                gfbgraph_rest_call_stop_deserialize_timer (RestProxyCall *call,
+                                                               gint64        *timer);
+guint               gfbgraph_tracer_new_request_id    (void);
+void                gfbgraph_rest_call_set_node_type  (RestProxyCall        *call,
+                                                       GType                 node_type);
+GType               gfbgraph_rest_call_get_node_type  (RestProxyCall        *call);
+void                gfbgraph_rest_call_set_idempotent (RestProxyCall        *call);
+gboolean            gfbgraph_rest_call_is_idempotent  (RestProxyCall        *call);
+
+GList*   gfbgraph_node_array_to_list               (GPtrArray *nodes);
+
+GPtrArray* gfbgraph_connectable_parse_connected_page (GFBGraphConnectable  *self,
+                                                      const gchar          *payload,
+                                                      gchar               **after,
+                                                      gchar               **next,
+                                                      GError              **error);
+
+/* A connection of the nodes of node_type to the nodes of parent_type */
+typedef struct
+{
+  GType                         node_type;
+  GType                         parent_type;
+  const gchar                  *path;
+  GFBGraphConnectableInterface *iface;
+} GFBGraphConnection;
+
+const GFBGraphConnection* gfbgraph_connectable_lookup_connection     (GType                      node_type,
+                                                                      GType                      parent_type,
+                                                                      GError                   **error);
+GPtrArray*                gfbgraph_connectable_parse_connection_page (const GFBGraphConnection  *connection,
+                                                                      RestProxyCall             *call,
+                                                                      const gchar               *payload,
+                                                                      gchar                    **after,
+                                                                      gchar                    **next,
+                                                                      GError                   **error);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_PRIVATE_H__ */
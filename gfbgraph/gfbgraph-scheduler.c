@@ -0,0 +1,588 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Admission control for the Graph API requests of a #GFBGraphClient.
+ *
+ * A request must acquire a slot before being sent and release it when the
+ * response arrives. The scheduler limits the number of requests in flight and
+ * the rate of requests per access token with a token bucket. The rate of a
+ * token is lowered as the usage reported by the X-App-Usage and
+ * X-Business-Use-Case-Usage headers approaches 100%, and requests are held
+ * back when the Graph API reports a throttling error, instead of piling more
+ * requests on a throttled token.
+ */
+
+#include <string.h>
+
+#include "gfbgraph-common.h"
+#include "gfbgraph-private.h"
+
+/* Usage percentage from which the rate starts to be lowered */
+#define USAGE_SLOWDOWN_THRESHOLD 50.0
+/* Minimum fraction of the configured rate kept while the usage is high */
+#define MIN_RATE_FACTOR          0.05
+/* Pause after a throttling error without estimated time to regain access */
+#define THROTTLE_PAUSE_USEC      (10 * G_USEC_PER_SEC)
+/* Maximum time a synchronous waiter sleeps before checking its cancellable */
+#define SYNC_WAIT_SLICE_USEC     (100 * 1000)
+
+typedef struct
+{
+  gdouble tokens;
+  gint64  last_refill;
+  gdouble rate_factor;
+  gint64  paused_until;
+} Bucket;
+
+typedef struct
+{
+  GFBGraphScheduler *scheduler;
+  GTask             *task;
+  gchar             *token;
+  GSource           *timeout;
+  GCancellable      *cancellable;
+  gulong             cancelled_id;
+  gboolean           cancelled;
+} Waiter;
+
+struct _GFBGraphScheduler
+{
+  GMutex      mutex;
+  GCond       cond;
+
+  guint       max_in_flight;
+  gdouble     rate;
+  gdouble     burst;
+
+  guint       in_flight;
+  GHashTable *buckets;
+  gdouble     app_rate_factor;
+  gint64      app_paused_until;
+
+  /* Asynchronous requests waiting for a slot, in arrival order */
+  GQueue      waiters;
+};
+
+static void gfbgraph_scheduler_dispatch (GFBGraphScheduler *scheduler);
+
+static Bucket*
+get_bucket (GFBGraphScheduler *scheduler,
+            const gchar       *token)
+{
+  Bucket *bucket;
+
+  bucket = g_hash_table_lookup (scheduler->buckets, token != NULL ? token : "");
+  if (bucket == NULL) {
+    bucket = g_slice_new0 (Bucket);
+    bucket->tokens = scheduler->burst;
+    bucket->last_refill = g_get_monotonic_time ();
+    bucket->rate_factor = 1.0;
+    g_hash_table_insert (scheduler->buckets, g_strdup (token != NULL ? token : ""), bucket);
+  }
+
+  return bucket;
+}
+
+static void
+bucket_free (Bucket *bucket)
+{
+  g_slice_free (Bucket, bucket);
+}
+
+/* Takes a slot for a request with token if possible. Returns 0 on success, the
+ * microseconds to wait until a retry can succeed, or -1 if the request has to
+ * wait for another one to finish. Called with the mutex held. */
+static gint64
+try_acquire (GFBGraphScheduler *scheduler,
+             const gchar       *token)
+{
+  Bucket *bucket;
+  gint64 now;
+  gdouble rate;
+
+  if (scheduler->max_in_flight > 0 && scheduler->in_flight >= scheduler->max_in_flight)
+    return -1;
+
+  now = g_get_monotonic_time ();
+  if (scheduler->app_paused_until > now)
+    return scheduler->app_paused_until - now;
+
+  bucket = get_bucket (scheduler, token);
+  if (bucket->paused_until > now)
+    return bucket->paused_until - now;
+
+  if (scheduler->rate > 0) {
+    rate = scheduler->rate * MIN (bucket->rate_factor, scheduler->app_rate_factor);
+    bucket->tokens = MIN (scheduler->burst,
+                          bucket->tokens + rate * (now - bucket->last_refill) / G_USEC_PER_SEC);
+    bucket->last_refill = now;
+
+    if (bucket->tokens < 1.0)
+      return (gint64) ((1.0 - bucket->tokens) / rate * G_USEC_PER_SEC) + 1;
+
+    bucket->tokens -= 1.0;
+  }
+
+  scheduler->in_flight++;
+
+  return 0;
+}
+
+/* Returns the highest usage percentage of an usage object, like
+ * {"call_count": 28, "total_time": 25, "total_cputime": 25} */
+static gdouble
+get_usage_percentage (JsonObject *usage_jobject,
+                      gint64     *regain_usec)
+{
+  const gchar *members[] = { "call_count", "total_time", "total_cputime", NULL };
+  gdouble usage = 0;
+  guint i;
+
+  for (i = 0; members[i] != NULL; i++) {
+    if (json_object_has_member (usage_jobject, members[i]))
+      usage = MAX (usage, json_object_get_double_member (usage_jobject, members[i]));
+  }
+
+  if (regain_usec != NULL && json_object_has_member (usage_jobject, "estimated_time_to_regain_access")) {
+    gint64 minutes;
+
+    minutes = json_object_get_int_member (usage_jobject, "estimated_time_to_regain_access");
+    *regain_usec = MAX (*regain_usec, minutes * 60 * G_USEC_PER_SEC);
+  }
+
+  return usage;
+}
+
+static gdouble
+usage_to_rate_factor (gdouble usage)
+{
+  if (usage < USAGE_SLOWDOWN_THRESHOLD)
+    return 1.0;
+
+  return MAX (MIN_RATE_FACTOR, (100.0 - usage) / (100.0 - USAGE_SLOWDOWN_THRESHOLD));
+}
+
+static JsonNode*
+parse_header (RestProxyCall *call,
+              const gchar   *header,
+              JsonParser    *jparser)
+{
+  const gchar *value;
+
+  value = rest_proxy_call_lookup_response_header (call, header);
+  if (value == NULL || !json_parser_load_from_data (jparser, value, -1, NULL))
+    return NULL;
+
+  return json_parser_get_root (jparser);
+}
+
+/*
+ * gfbgraph_rest_call_get_usage:
+ * @call: a #RestProxyCall after its response arrived.
+ * @app_usage: (out): the usage of the whole app, from X-App-Usage.
+ * @token_usage: (out): the usage of the business objects used by the token,
+ *   from X-Business-Use-Case-Usage.
+ * @regain_usec: (out): the time until the token regains access, or 0.
+ *
+ * Reads the usage percentages reported by the Graph API in the response to
+ * @call, -1 when the header is missing.
+ */
+void
+gfbgraph_rest_call_get_usage (RestProxyCall *call,
+                              gdouble       *app_usage,
+                              gdouble       *token_usage,
+                              gint64        *regain_usec)
+{
+  JsonParser *jparser;
+  JsonNode *root;
+
+  *app_usage = -1;
+  *token_usage = -1;
+  *regain_usec = 0;
+
+  jparser = json_parser_new ();
+
+  /* Usage of the whole app: {"call_count":28,"total_time":25,"total_cputime":25} */
+  root = parse_header (call, "X-App-Usage", jparser);
+  if (root != NULL && JSON_NODE_HOLDS_OBJECT (root))
+    *app_usage = get_usage_percentage (json_node_get_object (root), NULL);
+
+  /* Usage of the business objects used by the token:
+   * {"<business id>": [{"type": "pages", "call_count": 10, ..., "estimated_time_to_regain_access": 0}]} */
+  root = parse_header (call, "X-Business-Use-Case-Usage", jparser);
+  if (root != NULL && JSON_NODE_HOLDS_OBJECT (root)) {
+    GList *business_ids;
+    GList *l;
+
+    *token_usage = 0;
+
+    business_ids = json_object_get_members (json_node_get_object (root));
+    for (l = business_ids; l != NULL; l = l->next) {
+      JsonNode *uses_jnode;
+      JsonArray *uses;
+      guint i;
+
+      uses_jnode = json_object_get_member (json_node_get_object (root), l->data);
+      if (!JSON_NODE_HOLDS_ARRAY (uses_jnode))
+        continue;
+
+      uses = json_node_get_array (uses_jnode);
+      for (i = 0; i < json_array_get_length (uses); i++) {
+        JsonNode *use_jnode = json_array_get_element (uses, i);
+
+        if (JSON_NODE_HOLDS_OBJECT (use_jnode))
+          *token_usage = MAX (*token_usage, get_usage_percentage (json_node_get_object (use_jnode), regain_usec));
+      }
+    }
+    g_list_free (business_ids);
+  }
+
+  g_object_unref (jparser);
+}
+
+/* Updates the rate of the scheduler and of bucket from the usage headers of
+ * the response. Called with the mutex held. */
+static void
+update_from_usage_headers (GFBGraphScheduler *scheduler,
+                           Bucket            *bucket,
+                           RestProxyCall     *call)
+{
+  gdouble app_usage;
+  gdouble token_usage;
+  gint64 regain_usec;
+  gint64 now;
+
+  now = g_get_monotonic_time ();
+  gfbgraph_rest_call_get_usage (call, &app_usage, &token_usage, &regain_usec);
+
+  if (app_usage >= 0) {
+    scheduler->app_rate_factor = usage_to_rate_factor (app_usage);
+    if (app_usage >= 100.0)
+      scheduler->app_paused_until = MAX (scheduler->app_paused_until, now + THROTTLE_PAUSE_USEC);
+  }
+
+  if (token_usage >= 0) {
+    bucket->rate_factor = usage_to_rate_factor (token_usage);
+    if (regain_usec > 0)
+      bucket->paused_until = MAX (bucket->paused_until, now + regain_usec);
+    else if (token_usage >= 100.0)
+      bucket->paused_until = MAX (bucket->paused_until, now + THROTTLE_PAUSE_USEC);
+  }
+}
+
+static void
+update_from_error (GFBGraphScheduler *scheduler,
+                   Bucket            *bucket,
+                   const GError      *error)
+{
+  gint64 now;
+
+  if (error == NULL || error->domain != GFBGRAPH_API_ERROR)
+    return;
+
+  now = g_get_monotonic_time ();
+
+  switch (error->code)
+    {
+    case GFBGRAPH_API_ERROR_TOO_MANY_CALLS:
+      scheduler->app_paused_until = MAX (scheduler->app_paused_until, now + THROTTLE_PAUSE_USEC);
+      scheduler->app_rate_factor = MIN_RATE_FACTOR;
+      break;
+
+    case GFBGRAPH_API_ERROR_USER_TOO_MANY_CALLS:
+    case GFBGRAPH_API_ERROR_PAGE_TOO_MANY_CALLS:
+    case GFBGRAPH_API_ERROR_RATE_LIMIT:
+      bucket->paused_until = MAX (bucket->paused_until, now + THROTTLE_PAUSE_USEC);
+      bucket->rate_factor = MIN_RATE_FACTOR;
+      break;
+
+    default:
+      break;
+    }
+}
+
+static void
+waiter_free (Waiter *waiter)
+{
+  if (waiter->timeout != NULL) {
+    g_source_destroy (waiter->timeout);
+    g_source_unref (waiter->timeout);
+  }
+  /* Not g_cancellable_disconnect(), the waiter can be freed from its handler */
+  if (waiter->cancelled_id != 0)
+    g_signal_handler_disconnect (waiter->cancellable, waiter->cancelled_id);
+  g_clear_object (&waiter->cancellable);
+  g_clear_object (&waiter->task);
+  g_free (waiter->token);
+
+  g_slice_free (Waiter, waiter);
+}
+
+static gboolean
+waiter_timeout_cb (gpointer user_data)
+{
+  gfbgraph_scheduler_dispatch ((GFBGraphScheduler *) user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+waiter_cancelled_cb (GCancellable *cancellable,
+                     Waiter       *waiter)
+{
+  GFBGraphScheduler *scheduler = waiter->scheduler;
+  GTask *task = NULL;
+
+  g_mutex_lock (&scheduler->mutex);
+  waiter->cancelled = TRUE;
+  if (g_queue_remove (&scheduler->waiters, waiter))
+    task = g_object_ref (waiter->task);
+  g_mutex_unlock (&scheduler->mutex);
+
+  if (task != NULL) {
+    g_task_return_error_if_cancelled (task);
+    g_object_unref (task);
+  }
+}
+
+/* Gives the free slots to the waiting asynchronous requests */
+static void
+gfbgraph_scheduler_dispatch (GFBGraphScheduler *scheduler)
+{
+  GList *ready = NULL;
+  GList *l;
+
+  g_mutex_lock (&scheduler->mutex);
+  l = scheduler->waiters.head;
+  while (l != NULL) {
+    Waiter *waiter = l->data;
+    GList *next = l->next;
+    gint64 wait;
+
+    wait = try_acquire (scheduler, waiter->token);
+    if (wait == 0) {
+      g_queue_delete_link (&scheduler->waiters, l);
+      ready = g_list_prepend (ready, waiter);
+    } else if (wait > 0 && (waiter->timeout == NULL || g_source_is_destroyed (waiter->timeout))) {
+      g_clear_pointer (&waiter->timeout, g_source_unref);
+      waiter->timeout = g_timeout_source_new (MAX (1, wait / 1000));
+      g_source_set_callback (waiter->timeout, waiter_timeout_cb, scheduler, NULL);
+      g_source_attach (waiter->timeout, g_task_get_context (waiter->task));
+    } else if (wait < 0) {
+      /* No more free slots */
+      break;
+    }
+
+    l = next;
+  }
+  g_mutex_unlock (&scheduler->mutex);
+
+  /* The tasks are completed without the mutex held, as their callbacks send
+   * new requests */
+  for (l = g_list_reverse (ready); l != NULL; l = l->next) {
+    Waiter *waiter = l->data;
+
+    if (waiter->cancelled_id != 0) {
+      g_cancellable_disconnect (waiter->cancellable, waiter->cancelled_id);
+      waiter->cancelled_id = 0;
+    }
+    g_task_return_boolean (waiter->task, TRUE);
+  }
+  g_list_free (ready);
+}
+
+/*
+ * gfbgraph_scheduler_new:
+ * @max_in_flight: the maximum number of requests sent at the same time, or 0 for no limit.
+ * @rate: the maximum number of requests per second and access token, or 0 for no limit.
+ *
+ * Returns: a new #GFBGraphScheduler, free it with gfbgraph_scheduler_free().
+ */
+GFBGraphScheduler*
+gfbgraph_scheduler_new (guint   max_in_flight,
+                        gdouble rate)
+{
+  GFBGraphScheduler *scheduler;
+
+  scheduler = g_slice_new0 (GFBGraphScheduler);
+  g_mutex_init (&scheduler->mutex);
+  g_cond_init (&scheduler->cond);
+  scheduler->max_in_flight = max_in_flight;
+  scheduler->rate = rate;
+  /* Allow bursts of up to two seconds of requests */
+  scheduler->burst = MAX (1.0, 2 * rate);
+  scheduler->app_rate_factor = 1.0;
+  scheduler->buckets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) bucket_free);
+  g_queue_init (&scheduler->waiters);
+
+  return scheduler;
+}
+
+void
+gfbgraph_scheduler_free (GFBGraphScheduler *scheduler)
+{
+  g_warn_if_fail (g_queue_is_empty (&scheduler->waiters));
+
+  g_hash_table_unref (scheduler->buckets);
+  g_mutex_clear (&scheduler->mutex);
+  g_cond_clear (&scheduler->cond);
+
+  g_slice_free (GFBGraphScheduler, scheduler);
+}
+
+/*
+ * gfbgraph_scheduler_acquire:
+ * @scheduler: a #GFBGraphScheduler.
+ * @token: (allow-none): the access token of the request.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Blocks until the request can be sent. Every successful call must be
+ * followed by a call to gfbgraph_scheduler_release().
+ *
+ * Returns: %TRUE if the request can be sent, %FALSE if it was cancelled.
+ */
+gboolean
+gfbgraph_scheduler_acquire (GFBGraphScheduler  *scheduler,
+                            const gchar        *token,
+                            GCancellable       *cancellable,
+                            GError            **error)
+{
+  gint64 wait;
+
+  g_mutex_lock (&scheduler->mutex);
+  while ((wait = try_acquire (scheduler, token)) != 0) {
+    if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+      g_mutex_unlock (&scheduler->mutex);
+      return FALSE;
+    }
+
+    if (wait < 0 || wait > SYNC_WAIT_SLICE_USEC)
+      wait = SYNC_WAIT_SLICE_USEC;
+    g_cond_wait_until (&scheduler->cond, &scheduler->mutex, g_get_monotonic_time () + wait);
+  }
+  g_mutex_unlock (&scheduler->mutex);
+
+  return TRUE;
+}
+
+/*
+ * gfbgraph_scheduler_acquire_async:
+ * @scheduler: a #GFBGraphScheduler.
+ * @token: (allow-none): the access token of the request.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @callback: (scope async): A #GAsyncReadyCallback to call when the request can be sent.
+ * @user_data: (closure): The data to pass to @callback.
+ *
+ * Asynchronous version of gfbgraph_scheduler_acquire(), it doesn't block any
+ * thread while waiting.
+ */
+void
+gfbgraph_scheduler_acquire_async (GFBGraphScheduler   *scheduler,
+                                  const gchar         *token,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  GTask *task;
+  Waiter *waiter;
+  gboolean cancelled;
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gfbgraph_scheduler_acquire_async);
+
+  waiter = g_slice_new0 (Waiter);
+  waiter->scheduler = scheduler;
+  waiter->task = task;
+  waiter->token = g_strdup (token);
+  g_task_set_task_data (task, waiter, (GDestroyNotify) waiter_free);
+
+  /* The handler is connected before the waiter is visible to
+   * gfbgraph_scheduler_dispatch(), that disconnects it */
+  if (cancellable != NULL) {
+    waiter->cancellable = g_object_ref (cancellable);
+    waiter->cancelled_id = g_cancellable_connect (cancellable, G_CALLBACK (waiter_cancelled_cb), waiter, NULL);
+  }
+
+  g_mutex_lock (&scheduler->mutex);
+  cancelled = waiter->cancelled;
+  if (!cancelled)
+    g_queue_push_tail (&scheduler->waiters, waiter);
+  g_mutex_unlock (&scheduler->mutex);
+
+  /* The task holds the waiter, and the waiter a reference to the task until
+   * it's finished */
+  g_object_ref (task);
+  if (cancelled)
+    g_task_return_error_if_cancelled (task);
+  else
+    gfbgraph_scheduler_dispatch (scheduler);
+  g_object_unref (task);
+}
+
+gboolean
+gfbgraph_scheduler_acquire_finish (GFBGraphScheduler  *scheduler,
+                                   GAsyncResult       *result,
+                                   GError            **error)
+{
+  gboolean acquired;
+  Waiter *waiter;
+
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+  acquired = g_task_propagate_boolean (G_TASK (result), error);
+
+  /* Break the reference cycle between the task and its waiter */
+  waiter = g_task_get_task_data (G_TASK (result));
+  g_clear_object (&waiter->task);
+
+  return acquired;
+}
+
+/*
+ * gfbgraph_scheduler_release:
+ * @scheduler: a #GFBGraphScheduler.
+ * @token: (allow-none): the access token of the request.
+ * @call: the #RestProxyCall sent, to read its usage headers.
+ * @error: (allow-none): the error of the request, or %NULL.
+ *
+ * Frees the slot taken by a request and updates the rate of @token from its
+ * response.
+ */
+void
+gfbgraph_scheduler_release (GFBGraphScheduler *scheduler,
+                            const gchar       *token,
+                            RestProxyCall     *call,
+                            const GError      *error)
+{
+  Bucket *bucket;
+
+  g_mutex_lock (&scheduler->mutex);
+  scheduler->in_flight--;
+
+  bucket = get_bucket (scheduler, token);
+  update_from_usage_headers (scheduler, bucket, call);
+  update_from_error (scheduler, bucket, error);
+
+  g_cond_broadcast (&scheduler->cond);
+  g_mutex_unlock (&scheduler->mutex);
+
+  gfbgraph_scheduler_dispatch (scheduler);
+}
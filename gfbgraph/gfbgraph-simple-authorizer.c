@@ -29,12 +29,12 @@
  **/
 
 #include "gfbgraph-authorizer.h"
+#include "gfbgraph-private.h"
 #include "gfbgraph-simple-authorizer.h"
 
 typedef struct
 {
-  GMutex mutex;
-  gchar *access_token;
+  GFBGraphTokenSlot slot;
 } GFBGraphSimpleAuthorizerPrivate;
 
 static void gfbgraph_simple_authorizer_iface_init (GFBGraphAuthorizerInterface *iface);
@@ -59,7 +59,7 @@ gfbgraph_simple_authorizer_finalize (GObject *obj)
 {
   GFBGraphSimpleAuthorizerPrivate *priv = GFBGRAPH_SIMPLE_AUTHORIZER_GET_PRIVATE (obj);
 
-  g_free (priv->access_token);
+  gfbgraph_token_slot_clear (&priv->slot);
 
   G_OBJECT_CLASS (gfbgraph_simple_authorizer_parent_class)->finalize (obj);
 }
@@ -75,8 +75,7 @@ gfbgraph_simple_authorizer_set_property (GObject      *object,
   switch (prop_id)
     {
     case PROP_ACCESS_TOKEN:
-      g_free (priv->access_token);
-      priv->access_token = g_strdup (g_value_get_string (value));
+      gfbgraph_token_slot_publish (&priv->slot, gfbgraph_token_new (g_value_get_string (value)));
       break;
 
     default:
@@ -91,11 +90,15 @@ gfbgraph_simple_authorizer_get_property (GObject    *object,
                                          GParamSpec *pspec)
 {
   GFBGraphSimpleAuthorizerPrivate *priv = GFBGRAPH_SIMPLE_AUTHORIZER_GET_PRIVATE (object);
+  GFBGraphToken *token;
 
   switch (prop_id)
     {
     case PROP_ACCESS_TOKEN:
-      g_value_set_string (value, priv->access_token);
+      token = gfbgraph_token_slot_get (&priv->slot);
+      g_value_set_string (value, token != NULL ? token->access_token : NULL);
+      if (token != NULL)
+        gfbgraph_token_unref (token);
       break;
 
     default:
@@ -107,7 +110,8 @@ static void
 gfbgraph_simple_authorizer_init (GFBGraphSimpleAuthorizer *obj)
 {
   GFBGraphSimpleAuthorizerPrivate *priv = GFBGRAPH_SIMPLE_AUTHORIZER_GET_PRIVATE (obj);
-  g_mutex_init (&priv->mutex);
+
+  gfbgraph_token_slot_init (&priv->slot);
 }
 
 static void
@@ -139,14 +143,17 @@ gfbgraph_simple_authorizer_process_call (GFBGraphAuthorizer *iface,
                                          RestProxyCall      *call)
 {
   GFBGraphSimpleAuthorizerPrivate *priv;
+  GFBGraphToken *token;
 
   g_return_if_fail (GFBGRAPH_IS_SIMPLE_AUTHORIZER (iface));
 
   priv = GFBGRAPH_SIMPLE_AUTHORIZER_GET_PRIVATE (iface);
 
-  g_mutex_lock (&priv->mutex);
-  rest_proxy_call_add_param (call, "access_token", priv->access_token);
-  g_mutex_unlock (&priv->mutex);
+  token = gfbgraph_token_slot_get (&priv->slot);
+  if (token != NULL) {
+    rest_proxy_call_add_param (call, "access_token", token->access_token);
+    gfbgraph_token_unref (token);
+  }
 }
 
 static void
@@ -156,20 +163,21 @@ gfbgraph_simple_authorizer_process_message (GFBGraphAuthorizer *iface,
   gchar *auth_value;
   SoupURI *uri;
   GFBGraphSimpleAuthorizerPrivate *priv;
+  GFBGraphToken *token;
 
   g_return_if_fail (GFBGRAPH_IS_SIMPLE_AUTHORIZER (iface));
 
   priv = GFBGRAPH_SIMPLE_AUTHORIZER_GET_PRIVATE (iface);
 
-  g_mutex_lock (&priv->mutex);
+  token = gfbgraph_token_slot_get (&priv->slot);
 
   uri = soup_message_get_uri (message);
-  auth_value = g_strconcat ("access_token=", priv->access_token, NULL);
+  auth_value = g_strconcat ("access_token=", token != NULL ? token->access_token : NULL, NULL);
   soup_uri_set_query (uri, auth_value);
 
   g_free (auth_value);
-
-  g_mutex_unlock (&priv->mutex);
+  if (token != NULL)
+    gfbgraph_token_unref (token);
 }
 
 static gboolean
@@ -0,0 +1,672 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-sync
+ * @title: GFBGraphSync
+ * @short_description: Incremental synchronization of connections into a store.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphSync keeps the nodes connected to a node, like the albums of a
+ * user or the photos of an album, up to date in a #GFBGraphNodeStore without
+ * downloading the whole connection every time.
+ *
+ * Every successful gfbgraph_sync_run() saves a watermark for the connection,
+ * the time the run started. The next run only requests in full the nodes
+ * created since the watermark, with the "since" Graph API parameter, which
+ * filters by "created_time" and so doesn't find the edited nodes. To find
+ * them, the run also lists the IDs and update times of all the connected
+ * nodes, which is much cheaper than the nodes themselves, and requests only
+ * the ones whose "updated_time" differs from the stored one. The changes are
+ * reported with the #GFBGraphSync::node-added and #GFBGraphSync::node-changed
+ * signals.
+ *
+ * The Graph API doesn't list the deleted nodes. When
+ * #GFBGraphSync:detect-removals is set, the connected nodes missing in that
+ * listing are reported with #GFBGraphSync::node-removed.
+ *
+ * The watermarks are saved next to the store, in a file with the path of the
+ * store and the ".sync" suffix.
+ **/
+
+#include <string.h>
+
+#include "gfbgraph-connection-iterator.h"
+#include "gfbgraph-sync.h"
+
+/* The requests with "since" go back this number of seconds before the
+ * watermark, in case the clocks of the client and the Graph API differ */
+#define WATERMARK_OVERLAP 60
+
+typedef struct
+{
+  GFBGraphNodeStore  *store;
+  GFBGraphAuthorizer *authorizer;
+  gboolean            detect_removals;
+
+  /* Protected by mutex */
+  GMutex              mutex;
+  GKeyFile           *watermarks;
+  gchar              *watermarks_path;
+} GFBGraphSyncPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphSync, gfbgraph_sync, G_TYPE_OBJECT)
+
+enum
+{
+  PROP_0,
+  PROP_STORE,
+  PROP_AUTHORIZER,
+  PROP_DETECT_REMOVALS,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+enum
+{
+  SIGNAL_NODE_ADDED,
+  SIGNAL_NODE_CHANGED,
+  SIGNAL_NODE_REMOVED,
+  N_SIGNALS
+};
+
+static guint signals [N_SIGNALS];
+
+#define GFBGRAPH_SYNC_GET_PRIVATE(_obj) gfbgraph_sync_get_instance_private (GFBGRAPH_SYNC (_obj))
+
+/* --- GObject --- */
+static void
+gfbgraph_sync_constructed (GObject *object)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (object);
+  GError *error = NULL;
+
+  G_OBJECT_CLASS (gfbgraph_sync_parent_class)->constructed (object);
+
+  g_return_if_fail (GFBGRAPH_IS_NODE_STORE (priv->store));
+
+  priv->watermarks_path = g_strconcat (gfbgraph_node_store_get_path (priv->store), ".sync", NULL);
+  if (!g_key_file_load_from_file (priv->watermarks, priv->watermarks_path, G_KEY_FILE_NONE, &error)) {
+    /* Without watermarks the next runs are full ones */
+    if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+      g_warning ("Couldn't load the watermarks from %s: %s", priv->watermarks_path, error->message);
+    g_error_free (error);
+  }
+}
+
+static void
+gfbgraph_sync_dispose (GObject *object)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (object);
+
+  g_clear_object (&priv->store);
+  g_clear_object (&priv->authorizer);
+
+  G_OBJECT_CLASS (gfbgraph_sync_parent_class)->dispose (object);
+}
+
+static void
+gfbgraph_sync_finalize (GObject *object)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (object);
+
+  g_key_file_unref (priv->watermarks);
+  g_free (priv->watermarks_path);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_sync_parent_class)->finalize (object);
+}
+
+static void
+gfbgraph_sync_set_property (GObject      *object,
+                            guint         prop_id,
+                            const GValue *value,
+                            GParamSpec   *pspec)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_STORE:
+      priv->store = g_value_dup_object (value);
+      break;
+
+    case PROP_AUTHORIZER:
+      priv->authorizer = g_value_dup_object (value);
+      break;
+
+    case PROP_DETECT_REMOVALS:
+      priv->detect_removals = g_value_get_boolean (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_sync_get_property (GObject    *object,
+                            guint       prop_id,
+                            GValue     *value,
+                            GParamSpec *pspec)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_STORE:
+      g_value_set_object (value, priv->store);
+      break;
+
+    case PROP_AUTHORIZER:
+      g_value_set_object (value, priv->authorizer);
+      break;
+
+    case PROP_DETECT_REMOVALS:
+      g_value_set_boolean (value, priv->detect_removals);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_sync_init (GFBGraphSync *obj)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (obj);
+
+  g_mutex_init (&priv->mutex);
+  priv->watermarks = g_key_file_new ();
+}
+
+static void
+gfbgraph_sync_class_init (GFBGraphSyncClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gfbgraph_sync_constructed;
+  gobject_class->dispose = gfbgraph_sync_dispose;
+  gobject_class->finalize = gfbgraph_sync_finalize;
+  gobject_class->set_property = gfbgraph_sync_set_property;
+  gobject_class->get_property = gfbgraph_sync_get_property;
+
+  /**
+   * GFBGraphSync:store:
+   *
+   * The #GFBGraphNodeStore where the connected nodes are kept.
+   **/
+  properties [PROP_STORE] =
+    g_param_spec_object ("store", "Store",
+                         "The store where the connected nodes are kept.",
+                         GFBGRAPH_TYPE_NODE_STORE,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GFBGraphSync:authorizer:
+   *
+   * The #GFBGraphAuthorizer used for the requests.
+   **/
+  properties [PROP_AUTHORIZER] =
+    g_param_spec_object ("authorizer", "Authorizer",
+                         "The authorizer used for the requests.",
+                         GFBGRAPH_TYPE_AUTHORIZER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GFBGraphSync:detect-removals:
+   *
+   * Whether the runs remove the connections to the nodes not listed anymore.
+   **/
+  properties [PROP_DETECT_REMOVALS] =
+    g_param_spec_boolean ("detect-removals", "Detect removals",
+                          "Whether the runs remove the connections to the nodes not listed anymore.",
+                          FALSE,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+
+  /**
+   * GFBGraphSync::node-added:
+   * @sync: the #GFBGraphSync.
+   * @node: the #GFBGraphNode synchronized.
+   * @connected_node: the new node connected to @node.
+   *
+   * Emitted when a node connected to @node is found for the first time. It's
+   * already in the #GFBGraphSync:store.
+   **/
+  signals [SIGNAL_NODE_ADDED] =
+    g_signal_new ("node-added",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 2,
+                  GFBGRAPH_TYPE_NODE, GFBGRAPH_TYPE_NODE);
+
+  /**
+   * GFBGraphSync::node-changed:
+   * @sync: the #GFBGraphSync.
+   * @node: the #GFBGraphNode synchronized.
+   * @connected_node: the updated node connected to @node.
+   *
+   * Emitted when a node connected to @node was updated since the previous run.
+   * The new version has already replaced the old one in the #GFBGraphSync:store.
+   **/
+  signals [SIGNAL_NODE_CHANGED] =
+    g_signal_new ("node-changed",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 2,
+                  GFBGRAPH_TYPE_NODE, GFBGRAPH_TYPE_NODE);
+
+  /**
+   * GFBGraphSync::node-removed:
+   * @sync: the #GFBGraphSync.
+   * @node: the #GFBGraphNode synchronized.
+   * @connected_id: the ID of the node not connected to @node anymore.
+   *
+   * Emitted when a node isn't connected to @node anymore, only if
+   * #GFBGraphSync:detect-removals is set. The connection has already been
+   * removed from the #GFBGraphSync:store, but not the node.
+   **/
+  signals [SIGNAL_NODE_REMOVED] =
+    g_signal_new ("node-removed",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, NULL, NULL, NULL,
+                  G_TYPE_NONE, 2,
+                  GFBGRAPH_TYPE_NODE, G_TYPE_STRING);
+}
+
+/* --- Internal methods --- */
+
+/* Stores @connected_node if it's new or was updated, and emits the signal.
+ * @connected is the set of IDs connected to @node in the store. */
+static gboolean
+gfbgraph_sync_store_node (GFBGraphSync  *sync,
+                          GFBGraphNode  *node,
+                          GFBGraphNode  *connected_node,
+                          GHashTable    *connected,
+                          GError       **error)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+  const gchar *id;
+  guint signal_id;
+
+  id = gfbgraph_node_get_id (connected_node);
+  if (id == NULL)
+    return TRUE;
+
+  if (g_hash_table_contains (connected, id)) {
+    GFBGraphNode *stored;
+    gboolean unchanged;
+
+    stored = gfbgraph_node_store_get_node (priv->store, id, NULL);
+    unchanged = stored != NULL &&
+      g_strcmp0 (gfbgraph_node_get_updated_time (stored), gfbgraph_node_get_updated_time (connected_node)) == 0;
+    g_clear_object (&stored);
+
+    if (unchanged)
+      return TRUE;
+
+    signal_id = signals [SIGNAL_NODE_CHANGED];
+  } else {
+    signal_id = signals [SIGNAL_NODE_ADDED];
+  }
+
+  if (!gfbgraph_node_store_add_node (priv->store, connected_node, error) ||
+      !gfbgraph_node_store_add_connection (priv->store, node, connected_node, error))
+    return FALSE;
+
+  g_hash_table_add (connected, g_strdup (id));
+  g_signal_emit (sync, signal_id, 0, node, connected_node);
+
+  return TRUE;
+}
+
+/* Requests the nodes of type @node_type connected to @node created since
+ * @since, or all of them if it's 0, and stores the new and changed ones. */
+static gboolean
+gfbgraph_sync_fetch_created (GFBGraphSync  *sync,
+                             GFBGraphNode  *node,
+                             GType          node_type,
+                             gint64         since,
+                             GHashTable    *connected,
+                             GCancellable  *cancellable,
+                             GError       **error)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+  GFBGraphConnectionIterator *iterator;
+  GList *page;
+  GError *local_error = NULL;
+
+  iterator = gfbgraph_connection_iterator_new (node, node_type, priv->authorizer, 0);
+  /* The Graph API doesn't return "updated_time" by default */
+  gfbgraph_connection_iterator_set_fields (iterator, NULL);
+  gfbgraph_connection_iterator_set_time_range (iterator, since, 0);
+
+  while (local_error == NULL &&
+         (page = gfbgraph_connection_iterator_next_page (iterator, cancellable, &local_error)) != NULL) {
+    GList *l;
+
+    for (l = page; l != NULL && local_error == NULL; l = l->next)
+      gfbgraph_sync_store_node (sync, node, l->data, connected, &local_error);
+    g_list_free_full (page, g_object_unref);
+  }
+
+  g_object_unref (iterator);
+
+  if (local_error != NULL) {
+    g_propagate_error (error, local_error);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Lists the IDs and update times of all the nodes of type @node_type
+ * connected to @node, fetches the ones missing or outdated in the store, and
+ * if @remove is set, removes the connections to the ones not listed. */
+static gboolean
+gfbgraph_sync_list_connection (GFBGraphSync  *sync,
+                               GFBGraphNode  *node,
+                               GType          node_type,
+                               GHashTable    *connected,
+                               gboolean       remove,
+                               GCancellable  *cancellable,
+                               GError       **error)
+{
+  static const gchar * const fields[] = { "id", "updated_time", NULL };
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+  GFBGraphConnectionIterator *iterator;
+  GHashTable *listed;
+  GPtrArray *outdated;
+  GPtrArray *removed;
+  GHashTableIter iter;
+  GList *page;
+  const gchar *id;
+  GError *local_error = NULL;
+  guint i;
+
+  listed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  outdated = g_ptr_array_new_with_free_func (g_free);
+
+  iterator = gfbgraph_connection_iterator_new (node, node_type, priv->authorizer, 0);
+  gfbgraph_connection_iterator_set_fields (iterator, fields);
+
+  while (local_error == NULL &&
+         (page = gfbgraph_connection_iterator_next_page (iterator, cancellable, &local_error)) != NULL) {
+    GList *l;
+
+    for (l = page; l != NULL; l = l->next) {
+      id = gfbgraph_node_get_id (l->data);
+      if (id == NULL)
+        continue;
+
+      /* Compared with the index of the store, not the rehydrated node */
+      g_hash_table_add (listed, g_strdup (id));
+      if (!g_hash_table_contains (connected, id) ||
+          !gfbgraph_node_store_is_up_to_date (priv->store, id, gfbgraph_node_get_updated_time (l->data)))
+        g_ptr_array_add (outdated, g_strdup (id));
+    }
+    g_list_free_full (page, g_object_unref);
+  }
+
+  g_object_unref (iterator);
+
+  if (local_error == NULL && outdated->len > 0) {
+    GHashTable *nodes;
+
+    g_ptr_array_add (outdated, NULL);
+    nodes = gfbgraph_node_new_from_ids (priv->authorizer, (const gchar * const *) outdated->pdata,
+                                        node_type, cancellable, &local_error);
+    if (nodes != NULL) {
+      for (i = 0; i < outdated->len - 1 && local_error == NULL; i++) {
+        GFBGraphNode *connected_node;
+
+        /* Deleted between both requests, it's removed below if asked */
+        connected_node = g_hash_table_lookup (nodes, g_ptr_array_index (outdated, i));
+        if (connected_node == NULL) {
+          g_hash_table_remove (listed, g_ptr_array_index (outdated, i));
+          continue;
+        }
+
+        gfbgraph_sync_store_node (sync, node, connected_node, connected, &local_error);
+      }
+      g_hash_table_unref (nodes);
+    }
+  }
+
+  if (local_error == NULL && remove) {
+    removed = g_ptr_array_new ();
+    g_hash_table_iter_init (&iter, connected);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &id, NULL)) {
+      if (!g_hash_table_contains (listed, id))
+        g_ptr_array_add (removed, (gpointer) id);
+    }
+
+    for (i = 0; i < removed->len && local_error == NULL; i++) {
+      id = g_ptr_array_index (removed, i);
+      if (gfbgraph_node_store_remove_connection (priv->store, node, id, &local_error))
+        g_signal_emit (sync, signals [SIGNAL_NODE_REMOVED], 0, node, id);
+    }
+
+    for (i = 0; i < removed->len; i++)
+      g_hash_table_remove (connected, g_ptr_array_index (removed, i));
+    g_ptr_array_unref (removed);
+  }
+
+  g_ptr_array_unref (outdated);
+  g_hash_table_unref (listed);
+
+  if (local_error != NULL) {
+    g_propagate_error (error, local_error);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gfbgraph_sync_set_watermark (GFBGraphSync  *sync,
+                             GFBGraphNode  *node,
+                             GType          node_type,
+                             gint64         watermark,
+                             GError       **error)
+{
+  GFBGraphSyncPrivate *priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+  gchar *data;
+  gsize length;
+  gboolean success;
+
+  g_mutex_lock (&priv->mutex);
+  g_key_file_set_int64 (priv->watermarks, gfbgraph_node_get_id (node), g_type_name (node_type), watermark);
+  data = g_key_file_to_data (priv->watermarks, &length, NULL);
+  success = g_file_set_contents (priv->watermarks_path, data, length, error);
+  g_mutex_unlock (&priv->mutex);
+
+  g_free (data);
+
+  return success;
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_sync_new:
+ * @store: a #GFBGraphNodeStore.
+ * @authorizer: a #GFBGraphAuthorizer.
+ *
+ * Creates a new #GFBGraphSync keeping the connections in @store up to date,
+ * with the watermarks of the previous runs on the same store.
+ *
+ * Returns: (transfer full): a new #GFBGraphSync; unref with g_object_unref()
+ **/
+GFBGraphSync*
+gfbgraph_sync_new (GFBGraphNodeStore  *store,
+                   GFBGraphAuthorizer *authorizer)
+{
+  g_return_val_if_fail (GFBGRAPH_IS_NODE_STORE (store), NULL);
+  g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
+
+  return GFBGRAPH_SYNC (g_object_new (GFBGRAPH_TYPE_SYNC,
+                                      "store", store,
+                                      "authorizer", authorizer,
+                                      NULL));
+}
+
+/**
+ * gfbgraph_sync_run:
+ * @sync: a #GFBGraphSync.
+ * @node: a #GFBGraphNode with an ID.
+ * @node_type: a #GFBGraphNode type #GType, implementing the #GFBGraphConnectable interface.
+ * @cancellable: (allow-none): An optional #GCancellable object, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Brings the nodes of type @node_type connected to @node in the store up to
+ * date, emitting a signal for every change, then flushes the store and moves
+ * the watermark of the connection. The first run of a connection retrieves
+ * all its nodes. If it fails, the watermark is kept, so the changes stored
+ * before the error are requested again by the next run.
+ *
+ * Only a run per connection must be done at the same time.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+gfbgraph_sync_run (GFBGraphSync  *sync,
+                   GFBGraphNode  *node,
+                   GType          node_type,
+                   GCancellable  *cancellable,
+                   GError       **error)
+{
+  GFBGraphSyncPrivate *priv;
+  GHashTable *connected;
+  gchar **ids;
+  gint64 start;
+  gint64 watermark;
+  gboolean success;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_SYNC (sync), FALSE);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), FALSE);
+  g_return_val_if_fail (gfbgraph_node_get_id (node) != NULL, FALSE);
+  g_return_val_if_fail (g_type_is_a (node_type, GFBGRAPH_TYPE_NODE), FALSE);
+
+  priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+
+  start = g_get_real_time () / G_USEC_PER_SEC;
+  watermark = gfbgraph_sync_get_watermark (sync, node, node_type);
+
+  connected = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  ids = gfbgraph_node_store_get_connected_ids (priv->store, gfbgraph_node_get_id (node), node_type);
+  for (i = 0; ids[i] != NULL; i++)
+    g_hash_table_add (connected, ids[i]);
+  /* The strings are owned by the table now */
+  g_free (ids);
+
+  success = gfbgraph_sync_fetch_created (sync, node, node_type,
+                                         watermark > 0 ? MAX (watermark - WATERMARK_OVERLAP, 1) : 0,
+                                         connected, cancellable, error);
+  /* The first run already got every node */
+  if (success && (watermark > 0 || priv->detect_removals))
+    success = gfbgraph_sync_list_connection (sync, node, node_type, connected,
+                                             priv->detect_removals, cancellable, error);
+
+  g_hash_table_unref (connected);
+
+  /* The watermark must not be ahead of the stored nodes */
+  return success &&
+    gfbgraph_node_store_flush (priv->store, error) &&
+    gfbgraph_sync_set_watermark (sync, node, node_type, start, error);
+}
+
+/**
+ * gfbgraph_sync_get_watermark:
+ * @sync: a #GFBGraphSync.
+ * @node: a #GFBGraphNode with an ID.
+ * @node_type: a #GFBGraphNode type #GType.
+ *
+ * Returns: the UNIX time when the last successful run of the connection
+ * started, or 0 if it has never been synchronized.
+ **/
+gint64
+gfbgraph_sync_get_watermark (GFBGraphSync *sync,
+                             GFBGraphNode *node,
+                             GType         node_type)
+{
+  GFBGraphSyncPrivate *priv;
+  gint64 watermark;
+
+  g_return_val_if_fail (GFBGRAPH_IS_SYNC (sync), 0);
+  g_return_val_if_fail (GFBGRAPH_IS_NODE (node), 0);
+  g_return_val_if_fail (gfbgraph_node_get_id (node) != NULL, 0);
+
+  priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+
+  g_mutex_lock (&priv->mutex);
+  watermark = g_key_file_get_int64 (priv->watermarks, gfbgraph_node_get_id (node), g_type_name (node_type), NULL);
+  g_mutex_unlock (&priv->mutex);
+
+  return MAX (watermark, 0);
+}
+
+/**
+ * gfbgraph_sync_get_detect_removals:
+ * @sync: a #GFBGraphSync.
+ *
+ * Returns: the value of #GFBGraphSync:detect-removals.
+ **/
+gboolean
+gfbgraph_sync_get_detect_removals (GFBGraphSync *sync)
+{
+  GFBGraphSyncPrivate *priv;
+
+  g_return_val_if_fail (GFBGRAPH_IS_SYNC (sync), FALSE);
+
+  priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+
+  return priv->detect_removals;
+}
+
+/**
+ * gfbgraph_sync_set_detect_removals:
+ * @sync: a #GFBGraphSync.
+ * @detect_removals: whether the runs find the removed nodes.
+ *
+ * Sets #GFBGraphSync:detect-removals.
+ **/
+void
+gfbgraph_sync_set_detect_removals (GFBGraphSync *sync,
+                                   gboolean      detect_removals)
+{
+  GFBGraphSyncPrivate *priv;
+
+  g_return_if_fail (GFBGRAPH_IS_SYNC (sync));
+
+  priv = GFBGRAPH_SYNC_GET_PRIVATE (sync);
+
+  if (priv->detect_removals == !!detect_removals)
+    return;
+
+  priv->detect_removals = !!detect_removals;
+  g_object_notify_by_pspec (G_OBJECT (sync), properties [PROP_DETECT_REMOVALS]);
+}
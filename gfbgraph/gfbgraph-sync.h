@@ -0,0 +1,63 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_SYNC_H__
+#define __GFBGRAPH_SYNC_H__
+
+#include <gio/gio.h>
+#include <gfbgraph/gfbgraph-authorizer.h>
+#include <gfbgraph/gfbgraph-node.h>
+#include <gfbgraph/gfbgraph-node-store.h>
+
+G_BEGIN_DECLS
+
+#define GFBGRAPH_TYPE_SYNC (gfbgraph_sync_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphSync, gfbgraph_sync, GFBGRAPH, SYNC, GObject)
+
+struct _GFBGraphSyncClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+GFBGraphSync*      gfbgraph_sync_new                 (GFBGraphNodeStore   *store,
+                                                      GFBGraphAuthorizer  *authorizer);
+
+gboolean           gfbgraph_sync_run                 (GFBGraphSync        *sync,
+                                                      GFBGraphNode        *node,
+                                                      GType                node_type,
+                                                      GCancellable        *cancellable,
+                                                      GError             **error);
+
+gint64             gfbgraph_sync_get_watermark       (GFBGraphSync        *sync,
+                                                      GFBGraphNode        *node,
+                                                      GType                node_type);
+gboolean           gfbgraph_sync_get_detect_removals (GFBGraphSync        *sync);
+void               gfbgraph_sync_set_detect_removals (GFBGraphSync        *sync,
+                                                      gboolean             detect_removals);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_SYNC_H__ */
@@ -0,0 +1,249 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Access token snapshots shared by the authorizers.
+ *
+ * A #GFBGraphTokenSlot holds the current #GFBGraphToken of an authorizer.
+ * Tokens are immutable and reference counted: every request takes a reference
+ * to the current one, under a lock held for a few instructions, and a refresh
+ * publishes a new token instead of changing it, so the requests being sent
+ * keep a valid one.
+ *
+ * gfbgraph_token_slot_refresh() runs a single refresh at a time. The callers
+ * arriving while a refresh is running wait for it and share its result, so
+ * many requests failing at once with an expired token refresh it once.
+ */
+
+#include "gfbgraph-private.h"
+
+/*
+ * gfbgraph_token_new:
+ * @access_token: (allow-none): an access token, or %NULL.
+ *
+ * Returns: (transfer full): a new #GFBGraphToken.
+ */
+GFBGraphToken*
+gfbgraph_token_new (const gchar *access_token)
+{
+  GFBGraphToken *token;
+
+  token = g_slice_new (GFBGraphToken);
+  token->ref_count = 1;
+  token->access_token = g_strdup (access_token);
+  token->expiration = 0;
+
+  return token;
+}
+
+GFBGraphToken*
+gfbgraph_token_ref (GFBGraphToken *token)
+{
+  g_atomic_int_inc (&token->ref_count);
+
+  return token;
+}
+
+void
+gfbgraph_token_unref (GFBGraphToken *token)
+{
+  if (!g_atomic_int_dec_and_test (&token->ref_count))
+    return;
+
+  g_free (token->access_token);
+  g_slice_free (GFBGraphToken, token);
+}
+
+gboolean
+gfbgraph_token_is_expired (GFBGraphToken *token)
+{
+  return token->expiration != 0 && token->expiration <= g_get_real_time ();
+}
+
+void
+gfbgraph_token_slot_init (GFBGraphTokenSlot *slot)
+{
+  slot->token = NULL;
+  g_mutex_init (&slot->token_mutex);
+  g_mutex_init (&slot->mutex);
+  g_cond_init (&slot->cond);
+  slot->refreshing = FALSE;
+  slot->n_refreshes = 0;
+  slot->refresh_error = NULL;
+}
+
+void
+gfbgraph_token_slot_clear (GFBGraphTokenSlot *slot)
+{
+  g_clear_pointer (&slot->token, gfbgraph_token_unref);
+  g_clear_error (&slot->refresh_error);
+  g_mutex_clear (&slot->token_mutex);
+  g_mutex_clear (&slot->mutex);
+  g_cond_clear (&slot->cond);
+}
+
+/*
+ * gfbgraph_token_slot_get:
+ * @slot: a #GFBGraphTokenSlot.
+ *
+ * Takes the current token of @slot.
+ *
+ * Returns: (transfer full) (nullable): the current #GFBGraphToken, or %NULL
+ * if there isn't one yet.
+ */
+GFBGraphToken*
+gfbgraph_token_slot_get (GFBGraphTokenSlot *slot)
+{
+  GFBGraphToken *token;
+
+  /* The token loaded isn't released by a concurrent
+   * gfbgraph_token_slot_publish() before it's referenced */
+  g_mutex_lock (&slot->token_mutex);
+  token = slot->token;
+  if (token != NULL)
+    gfbgraph_token_ref (token);
+  g_mutex_unlock (&slot->token_mutex);
+
+  return token;
+}
+
+/*
+ * gfbgraph_token_slot_publish:
+ * @slot: a #GFBGraphTokenSlot.
+ * @token: (transfer full) (allow-none): the new #GFBGraphToken.
+ *
+ * Replaces the current token of @slot with @token. The requests holding the
+ * previous one keep it until they release it.
+ */
+void
+gfbgraph_token_slot_publish (GFBGraphTokenSlot *slot,
+                             GFBGraphToken     *token)
+{
+  GFBGraphToken *old;
+
+  g_mutex_lock (&slot->token_mutex);
+  old = slot->token;
+  slot->token = token;
+  g_mutex_unlock (&slot->token_mutex);
+
+  if (old != NULL)
+    gfbgraph_token_unref (old);
+}
+
+static void
+gfbgraph_token_slot_cancelled_cb (GCancellable      *cancellable,
+                                  GFBGraphTokenSlot *slot)
+{
+  g_mutex_lock (&slot->mutex);
+  g_cond_broadcast (&slot->cond);
+  g_mutex_unlock (&slot->mutex);
+}
+
+/*
+ * gfbgraph_token_slot_refresh:
+ * @slot: a #GFBGraphTokenSlot.
+ * @func: the function getting a new token.
+ * @user_data: the data passed to @func.
+ * @cancellable: (allow-none): a #GCancellable, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Publishes the token returned by @func, which is called without any lock
+ * held, so the requests keep using the current token while it runs. If a
+ * refresh is already running, waits for it instead and returns its result,
+ * unless @cancellable is cancelled first. A refresh cancelled by its own
+ * caller is taken over by one of the waiters.
+ *
+ * Returns: %TRUE if a new token was published.
+ */
+gboolean
+gfbgraph_token_slot_refresh (GFBGraphTokenSlot         *slot,
+                             GFBGraphTokenRefreshFunc   func,
+                             gpointer                   user_data,
+                             GCancellable              *cancellable,
+                             GError                   **error)
+{
+  GFBGraphToken *token;
+  GError *local_error = NULL;
+  gulong cancelled_id = 0;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  if (cancellable != NULL)
+    cancelled_id = g_cancellable_connect (cancellable,
+                                          G_CALLBACK (gfbgraph_token_slot_cancelled_cb),
+                                          slot, NULL);
+
+  g_mutex_lock (&slot->mutex);
+  while (slot->refreshing) {
+    guint n_refreshes = slot->n_refreshes;
+
+    while (slot->n_refreshes == n_refreshes && !g_cancellable_is_cancelled (cancellable))
+      g_cond_wait (&slot->cond, &slot->mutex);
+
+    if (g_cancellable_is_cancelled (cancellable)) {
+      /* The running refresh isn't ours to cancel, so it goes on */
+      g_mutex_unlock (&slot->mutex);
+      g_cancellable_disconnect (cancellable, cancelled_id);
+      g_cancellable_set_error_if_cancelled (cancellable, error);
+
+      return FALSE;
+    }
+
+    if (!g_error_matches (slot->refresh_error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      gboolean success;
+
+      success = slot->refresh_error == NULL;
+      if (!success)
+        g_propagate_error (error, g_error_copy (slot->refresh_error));
+      g_mutex_unlock (&slot->mutex);
+      g_cancellable_disconnect (cancellable, cancelled_id);
+
+      return success;
+    }
+
+    /* The leader was cancelled: the first waiter to get here takes over,
+     * the others wait for it */
+  }
+  slot->refreshing = TRUE;
+  g_mutex_unlock (&slot->mutex);
+  g_cancellable_disconnect (cancellable, cancelled_id);
+
+  token = func (user_data, cancellable, &local_error);
+  if (token != NULL)
+    gfbgraph_token_slot_publish (slot, token);
+  else if (local_error == NULL)
+    g_set_error (&local_error, G_IO_ERROR, G_IO_ERROR_FAILED, "Couldn't refresh the access token");
+
+  g_mutex_lock (&slot->mutex);
+  slot->refreshing = FALSE;
+  slot->n_refreshes++;
+  g_clear_error (&slot->refresh_error);
+  if (local_error != NULL)
+    slot->refresh_error = g_error_copy (local_error);
+  g_cond_broadcast (&slot->cond);
+  g_mutex_unlock (&slot->mutex);
+
+  if (local_error != NULL) {
+    g_propagate_error (error, local_error);
+    return FALSE;
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,519 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gfbgraph-tracer
+ * @title: GFBGraphTracer
+ * @short_description: Trace spans of the requests to the Graph API.
+ * @include: gfbgraph/gfbgraph.h
+ *
+ * #GFBGraphTracer records where the time of every request goes. Once set in
+ * a #GFBGraphClient with gfbgraph_client_set_tracer(), every request created
+ * by the client gets an ID and a span for each stage it goes through:
+ *
+ * - "request": from the call to the result, with the cache lookup and the
+ *   retries.
+ * - "queue": the wait for the scheduler of the client.
+ * - "http": an attempt to send the request, from the connection to the end
+ *   of the response.
+ * - "refresh": the refresh of the authorization after an OAuth error.
+ * - "backoff": the wait before a retry.
+ * - "parse": the parsing of the JSON response. The pages of the connections
+ *   are deserialized while they are parsed, so their "parse" spans contain a
+ *   "deserialize" span, starting with the first node, whose duration is the
+ *   time spent in all the nodes of the page and whose
+ *   #GFBGraphTraceSpan.n_items is their number.
+ * - "deserialize": the deserialization of the nodes.
+ *
+ * The last spans are kept in memory, up to #GFBGraphTracer:max-spans, and
+ * can be read with gfbgraph_tracer_foreach() or dumped in the Chrome trace
+ * event format with gfbgraph_tracer_dump_chrome_trace(), that can be loaded
+ * in chrome://tracing or Perfetto.
+ *
+ * When the library is built with <literal>--enable-usdt</literal>, every span
+ * also fires the <literal>gfbgraph:span</literal> USDT probe, with the name,
+ * the request ID, the thread ID, the start, the end and the endpoint of the
+ * span as arguments, so perf, bpftrace or SystemTap can trace real workloads
+ * without keeping the spans: use a tracer with no spans for it.
+ **/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_USDT
+#include <sys/sdt.h>
+#endif
+
+#include <json-glib/json-glib.h>
+
+#include "gfbgraph-tracer.h"
+#include "gfbgraph-private.h"
+
+#define DEFAULT_MAX_SPANS 65536
+
+typedef struct
+{
+  guint              max_spans;
+
+  /* Protected by mutex. A ring of max_spans spans, next is the oldest one
+   * once it's full. */
+  GMutex             mutex;
+  GFBGraphTraceSpan *spans;
+  guint              n_spans;
+  guint              next;
+} GFBGraphTracerPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphTracer, gfbgraph_tracer, G_TYPE_OBJECT)
+
+enum
+{
+  PROP_0,
+  PROP_MAX_SPANS,
+  N_PROPERTIES
+};
+
+static GParamSpec *properties [N_PROPERTIES];
+
+#define GFBGRAPH_TRACER_GET_PRIVATE(_obj) gfbgraph_tracer_get_instance_private (GFBGRAPH_TRACER (_obj))
+
+static void
+span_clear (GFBGraphTraceSpan *span)
+{
+  g_free (span->name);
+  g_free (span->endpoint);
+  g_free (span->error);
+}
+
+/* The threads are numbered in the order they record their first span */
+static guint
+get_thread_id (void)
+{
+  static GPrivate thread_id;
+  static gint last_id = 0;
+  guint id;
+
+  id = GPOINTER_TO_UINT (g_private_get (&thread_id));
+  if (id == 0) {
+    id = g_atomic_int_add (&last_id, 1) + 1;
+    g_private_set (&thread_id, GUINT_TO_POINTER (id));
+  }
+
+  return id;
+}
+
+/* Copies the spans, oldest first, so they can be read without the mutex */
+static GArray*
+snapshot_spans (GFBGraphTracerPrivate *priv)
+{
+  GArray *snapshot;
+  guint first;
+  guint i;
+
+  snapshot = g_array_new (FALSE, FALSE, sizeof (GFBGraphTraceSpan));
+  g_array_set_clear_func (snapshot, (GDestroyNotify) span_clear);
+
+  g_mutex_lock (&priv->mutex);
+  g_array_set_size (snapshot, priv->n_spans);
+  first = priv->n_spans < priv->max_spans ? 0 : priv->next;
+  for (i = 0; i < priv->n_spans; i++) {
+    GFBGraphTraceSpan *span = &priv->spans[(first + i) % priv->max_spans];
+    GFBGraphTraceSpan *copy = &g_array_index (snapshot, GFBGraphTraceSpan, i);
+
+    *copy = *span;
+    copy->name = g_strdup (span->name);
+    copy->endpoint = g_strdup (span->endpoint);
+    copy->error = g_strdup (span->error);
+  }
+  g_mutex_unlock (&priv->mutex);
+
+  return snapshot;
+}
+
+/* --- GObject --- */
+static void
+gfbgraph_tracer_finalize (GObject *object)
+{
+  GFBGraphTracerPrivate *priv = GFBGRAPH_TRACER_GET_PRIVATE (object);
+  guint i;
+
+  for (i = 0; i < priv->n_spans; i++)
+    span_clear (&priv->spans[i]);
+  g_free (priv->spans);
+  g_mutex_clear (&priv->mutex);
+
+  G_OBJECT_CLASS (gfbgraph_tracer_parent_class)->finalize (object);
+}
+
+static void
+gfbgraph_tracer_constructed (GObject *object)
+{
+  GFBGraphTracerPrivate *priv = GFBGRAPH_TRACER_GET_PRIVATE (object);
+
+  G_OBJECT_CLASS (gfbgraph_tracer_parent_class)->constructed (object);
+
+  priv->spans = g_new0 (GFBGraphTraceSpan, priv->max_spans);
+}
+
+static void
+gfbgraph_tracer_set_property (GObject      *object,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  GFBGraphTracerPrivate *priv = GFBGRAPH_TRACER_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_SPANS:
+      priv->max_spans = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_tracer_get_property (GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  GFBGraphTracerPrivate *priv = GFBGRAPH_TRACER_GET_PRIVATE (object);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_SPANS:
+      g_value_set_uint (value, priv->max_spans);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gfbgraph_tracer_init (GFBGraphTracer *self)
+{
+  GFBGraphTracerPrivate *priv = GFBGRAPH_TRACER_GET_PRIVATE (self);
+
+  g_mutex_init (&priv->mutex);
+}
+
+static void
+gfbgraph_tracer_class_init (GFBGraphTracerClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gfbgraph_tracer_finalize;
+  gobject_class->constructed = gfbgraph_tracer_constructed;
+  gobject_class->set_property = gfbgraph_tracer_set_property;
+  gobject_class->get_property = gfbgraph_tracer_get_property;
+
+  /**
+   * GFBGraphTracer:max-spans:
+   *
+   * The number of spans kept in memory, the oldest ones are dropped. With 0
+   * the spans only fire the USDT probe.
+   **/
+  properties [PROP_MAX_SPANS] =
+    g_param_spec_uint ("max-spans", "Maximum spans",
+                       "The number of spans kept in memory.",
+                       0, G_MAXUINT, DEFAULT_MAX_SPANS,
+                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES, properties);
+}
+
+/* --- Public APIs --- */
+
+/**
+ * gfbgraph_tracer_new:
+ * @max_spans: the number of spans kept in memory.
+ *
+ * Creates a new #GFBGraphTracer, set it in a #GFBGraphClient with
+ * gfbgraph_client_set_tracer() to trace its requests.
+ *
+ * Returns: (transfer full): a new #GFBGraphTracer.
+ **/
+GFBGraphTracer*
+gfbgraph_tracer_new (guint max_spans)
+{
+  return GFBGRAPH_TRACER (g_object_new (GFBGRAPH_TYPE_TRACER,
+                                        "max-spans", max_spans,
+                                        NULL));
+}
+
+/**
+ * gfbgraph_tracer_get_max_spans:
+ * @tracer: a #GFBGraphTracer.
+ *
+ * Returns: the number of spans kept by @tracer.
+ **/
+guint
+gfbgraph_tracer_get_max_spans (GFBGraphTracer *tracer)
+{
+  g_return_val_if_fail (GFBGRAPH_IS_TRACER (tracer), 0);
+
+  return GFBGRAPH_TRACER_GET_PRIVATE (tracer)->max_spans;
+}
+
+/**
+ * gfbgraph_tracer_add_span:
+ * @tracer: a #GFBGraphTracer.
+ * @name: the name of the span, it's copied.
+ * @request_id: the ID of the request, or 0.
+ * @start: when the span started, in the g_get_monotonic_time() clock.
+ * @end: when the span ended, in the same clock.
+ * @n_items: the number of items handled in the span, or 0.
+ * @endpoint: (allow-none): the method and the path of the request, or %NULL.
+ * @error: (allow-none): the message of the error the span ended with, or %NULL.
+ *
+ * Records a span in the current thread. The #GFBGraphClient does it for every
+ * stage of its requests, applications can add their own spans around them.
+ **/
+void
+gfbgraph_tracer_add_span (GFBGraphTracer *tracer,
+                          const gchar    *name,
+                          guint           request_id,
+                          gint64          start,
+                          gint64          end,
+                          guint           n_items,
+                          const gchar    *endpoint,
+                          const gchar    *error)
+{
+  GFBGraphTracerPrivate *priv;
+  GFBGraphTraceSpan *span;
+  guint thread_id;
+
+  g_return_if_fail (GFBGRAPH_IS_TRACER (tracer));
+  g_return_if_fail (name != NULL);
+
+  priv = GFBGRAPH_TRACER_GET_PRIVATE (tracer);
+  thread_id = get_thread_id ();
+
+#ifdef HAVE_USDT
+  DTRACE_PROBE6 (gfbgraph, span, name, request_id, thread_id, start, end, endpoint);
+#endif
+
+  if (priv->max_spans == 0)
+    return;
+
+  g_mutex_lock (&priv->mutex);
+
+  span = &priv->spans[priv->next];
+  if (priv->n_spans == priv->max_spans)
+    span_clear (span);
+  else
+    priv->n_spans++;
+  priv->next = (priv->next + 1) % priv->max_spans;
+
+  span->name = g_strdup (name);
+  span->request_id = request_id;
+  span->thread_id = thread_id;
+  span->start = start;
+  span->end = end;
+  span->n_items = n_items;
+  span->endpoint = g_strdup (endpoint);
+  span->error = g_strdup (error);
+
+  g_mutex_unlock (&priv->mutex);
+}
+
+/**
+ * gfbgraph_tracer_get_n_spans:
+ * @tracer: a #GFBGraphTracer.
+ *
+ * Returns: the number of spans kept by @tracer.
+ **/
+guint
+gfbgraph_tracer_get_n_spans (GFBGraphTracer *tracer)
+{
+  GFBGraphTracerPrivate *priv;
+  guint n_spans;
+
+  g_return_val_if_fail (GFBGRAPH_IS_TRACER (tracer), 0);
+
+  priv = GFBGRAPH_TRACER_GET_PRIVATE (tracer);
+
+  g_mutex_lock (&priv->mutex);
+  n_spans = priv->n_spans;
+  g_mutex_unlock (&priv->mutex);
+
+  return n_spans;
+}
+
+/**
+ * gfbgraph_tracer_foreach:
+ * @tracer: a #GFBGraphTracer.
+ * @func: (scope call): the function to call for every span.
+ * @user_data: the data to pass to @func.
+ *
+ * Calls @func with every span kept by @tracer, in the order they were
+ * recorded. The spans are copied before, so @func can use @tracer.
+ **/
+void
+gfbgraph_tracer_foreach (GFBGraphTracer            *tracer,
+                         GFBGraphTracerForeachFunc  func,
+                         gpointer                   user_data)
+{
+  GArray *snapshot;
+  guint i;
+
+  g_return_if_fail (GFBGRAPH_IS_TRACER (tracer));
+  g_return_if_fail (func != NULL);
+
+  snapshot = snapshot_spans (GFBGRAPH_TRACER_GET_PRIVATE (tracer));
+  for (i = 0; i < snapshot->len; i++)
+    func (&g_array_index (snapshot, GFBGraphTraceSpan, i), user_data);
+  g_array_unref (snapshot);
+}
+
+/**
+ * gfbgraph_tracer_dump_chrome_trace:
+ * @tracer: a #GFBGraphTracer.
+ *
+ * Dumps the spans kept by @tracer as complete events of the Chrome trace
+ * event format, with the request ID, the endpoint and the error of every span
+ * in its arguments. The timestamps are the ones of g_get_monotonic_time().
+ *
+ * Returns: (transfer full): a JSON string, free it with g_free().
+ **/
+gchar*
+gfbgraph_tracer_dump_chrome_trace (GFBGraphTracer *tracer)
+{
+  JsonBuilder *builder;
+  JsonGenerator *generator;
+  JsonNode *root;
+  GArray *snapshot;
+  gint64 pid;
+  gchar *dump;
+  guint i;
+
+  g_return_val_if_fail (GFBGRAPH_IS_TRACER (tracer), NULL);
+
+  snapshot = snapshot_spans (GFBGRAPH_TRACER_GET_PRIVATE (tracer));
+  pid = getpid ();
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "traceEvents");
+  json_builder_begin_array (builder);
+
+  for (i = 0; i < snapshot->len; i++) {
+    GFBGraphTraceSpan *span = &g_array_index (snapshot, GFBGraphTraceSpan, i);
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "name");
+    json_builder_add_string_value (builder, span->name);
+    json_builder_set_member_name (builder, "cat");
+    json_builder_add_string_value (builder, "gfbgraph");
+    json_builder_set_member_name (builder, "ph");
+    json_builder_add_string_value (builder, "X");
+    json_builder_set_member_name (builder, "ts");
+    json_builder_add_int_value (builder, span->start);
+    json_builder_set_member_name (builder, "dur");
+    json_builder_add_int_value (builder, span->end - span->start);
+    json_builder_set_member_name (builder, "pid");
+    json_builder_add_int_value (builder, pid);
+    json_builder_set_member_name (builder, "tid");
+    json_builder_add_int_value (builder, span->thread_id);
+
+    json_builder_set_member_name (builder, "args");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "request_id");
+    json_builder_add_int_value (builder, span->request_id);
+    if (span->n_items > 0) {
+      json_builder_set_member_name (builder, "n_items");
+      json_builder_add_int_value (builder, span->n_items);
+    }
+    if (span->endpoint != NULL) {
+      json_builder_set_member_name (builder, "endpoint");
+      json_builder_add_string_value (builder, span->endpoint);
+    }
+    if (span->error != NULL) {
+      json_builder_set_member_name (builder, "error");
+      json_builder_add_string_value (builder, span->error);
+    }
+    json_builder_end_object (builder);
+
+    json_builder_end_object (builder);
+  }
+
+  json_builder_end_array (builder);
+  json_builder_set_member_name (builder, "displayTimeUnit");
+  json_builder_add_string_value (builder, "ms");
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  generator = json_generator_new ();
+  json_generator_set_root (generator, root);
+  dump = json_generator_to_data (generator, NULL);
+
+  g_object_unref (generator);
+  json_node_free (root);
+  g_object_unref (builder);
+  g_array_unref (snapshot);
+
+  return dump;
+}
+
+/**
+ * gfbgraph_tracer_clear:
+ * @tracer: a #GFBGraphTracer.
+ *
+ * Drops all the spans kept by @tracer.
+ **/
+void
+gfbgraph_tracer_clear (GFBGraphTracer *tracer)
+{
+  GFBGraphTracerPrivate *priv;
+  guint i;
+
+  g_return_if_fail (GFBGRAPH_IS_TRACER (tracer));
+
+  priv = GFBGRAPH_TRACER_GET_PRIVATE (tracer);
+
+  g_mutex_lock (&priv->mutex);
+  for (i = 0; i < priv->n_spans; i++)
+    span_clear (&priv->spans[i]);
+  memset (priv->spans, 0, priv->max_spans * sizeof (GFBGraphTraceSpan));
+  priv->n_spans = 0;
+  priv->next = 0;
+  g_mutex_unlock (&priv->mutex);
+}
+
+/* --- Private API --- */
+
+/*
+ * gfbgraph_tracer_new_request_id:
+ *
+ * Returns: a new request ID, unique in the process.
+ */
+guint
+gfbgraph_tracer_new_request_id (void)
+{
+  static gint last_id = 0;
+
+  return g_atomic_int_add (&last_id, 1) + 1;
+}
@@ -0,0 +1,98 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GFBGRAPH_TRACER_H__
+#define __GFBGRAPH_TRACER_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GFBGraphTraceSpan:
+ * @name: the stage of the request, like "queue" or "http".
+ * @request_id: the ID of the request, unique in the process.
+ * @thread_id: the thread that ran the stage, numbered from 1.
+ * @start: when the stage started, in the g_get_monotonic_time() clock.
+ * @end: when the stage ended, in the same clock.
+ * @n_items: the number of items handled by the stage, like the nodes of a
+ *   page deserialized, or 0.
+ * @endpoint: (allow-none): the method and the path of the request, like "GET me".
+ * @error: (allow-none): the message of the error the stage ended with, or %NULL.
+ *
+ * A stage of a request to the Graph API, see #GFBGraphTracer.
+ **/
+typedef struct
+{
+  gchar       *name;
+  guint        request_id;
+  guint        thread_id;
+  gint64       start;
+  gint64       end;
+  guint        n_items;
+  gchar       *endpoint;
+  gchar       *error;
+} GFBGraphTraceSpan;
+
+/**
+ * GFBGraphTracerForeachFunc:
+ * @span: a #GFBGraphTraceSpan.
+ * @user_data: the data passed to gfbgraph_tracer_foreach().
+ *
+ * The function called by gfbgraph_tracer_foreach() for every span.
+ **/
+typedef void (*GFBGraphTracerForeachFunc) (const GFBGraphTraceSpan *span,
+                                           gpointer                 user_data);
+
+#define GFBGRAPH_TYPE_TRACER (gfbgraph_tracer_get_type())
+G_DECLARE_DERIVABLE_TYPE (GFBGraphTracer, gfbgraph_tracer, GFBGRAPH, TRACER, GObject)
+
+struct _GFBGraphTracerClass
+{
+  GObjectClass  parent_class;
+
+  gpointer      _reserved1;
+  gpointer      _reserved2;
+  gpointer      _reserved3;
+  gpointer      _reserved4;
+  gpointer      _reserved5;
+  gpointer      _reserved6;
+};
+
+GFBGraphTracer* gfbgraph_tracer_new               (guint                      max_spans);
+
+guint           gfbgraph_tracer_get_max_spans     (GFBGraphTracer            *tracer);
+void            gfbgraph_tracer_add_span          (GFBGraphTracer            *tracer,
+                                                   const gchar               *name,
+                                                   guint                      request_id,
+                                                   gint64                     start,
+                                                   gint64                     end,
+                                                   guint                      n_items,
+                                                   const gchar               *endpoint,
+                                                   const gchar               *error);
+guint           gfbgraph_tracer_get_n_spans       (GFBGraphTracer            *tracer);
+void            gfbgraph_tracer_foreach           (GFBGraphTracer            *tracer,
+                                                   GFBGraphTracerForeachFunc  func,
+                                                   gpointer                   user_data);
+gchar*          gfbgraph_tracer_dump_chrome_trace (GFBGraphTracer            *tracer);
+void            gfbgraph_tracer_clear             (GFBGraphTracer            *tracer);
+
+G_END_DECLS
+
+#endif /* __GFBGRAPH_TRACER_H__ */
@@ -32,6 +32,7 @@
 #include "gfbgraph-user.h"
 #include "gfbgraph-album.h"
 #include "gfbgraph-common.h"
+#include "gfbgraph-private.h"
 
 #define ME_FUNCTION "me"
 
@@ -41,17 +42,6 @@ typedef struct
   gchar *email;
 } GFBGraphUserPrivate;
 
-typedef struct
-{
-  GFBGraphUser *user;
-} GFBGraphUserAsyncData;
-
-typedef struct
-{
-  GFBGraphAuthorizer *authorizer;
-  GList *nodes;
-} GFBGraphUserConnectionAsyncData;
-
 G_DEFINE_TYPE_WITH_PRIVATE (GFBGraphUser, gfbgraph_user, GFBGRAPH_TYPE_NODE);
 
 /* Properties */
@@ -132,15 +122,33 @@ gfbgraph_user_init (GFBGraphUser *obj)
 {
 }
 
+static gboolean
+gfbgraph_user_deserialize_member (GFBGraphNode *node,
+                                  const gchar  *member_name,
+                                  JsonNode     *member_node)
+{
+  GFBGraphUserPrivate *priv = GFBGRAPH_USER_GET_PRIVATE (node);
+
+  if (gfbgraph_json_member_is (member_name, "name"))
+    return gfbgraph_json_set_string (member_node, &priv->name);
+  else if (gfbgraph_json_member_is (member_name, "email"))
+    return gfbgraph_json_set_string (member_node, &priv->email);
+
+  return GFBGRAPH_NODE_CLASS (gfbgraph_user_parent_class)->deserialize_member (node, member_name, member_node);
+}
+
 static void
 gfbgraph_user_class_init (GFBGraphUserClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GFBGraphNodeClass *node_class = GFBGRAPH_NODE_CLASS (klass);
 
   gobject_class->finalize = gfbgraph_user_finalize;
   gobject_class->set_property = gfbgraph_user_set_property;
   gobject_class->get_property = gfbgraph_user_get_property;
 
+  node_class->deserialize_member = gfbgraph_user_deserialize_member;
+
   /**
    * GFBGraphUser:name:
    *
@@ -167,52 +175,90 @@ gfbgraph_user_class_init (GFBGraphUserClass *klass)
 }
 
 /* --- Internal methods --- */
-static void
-gfbgraph_user_async_data_free (GFBGraphUserAsyncData *data)
+static RestProxyCall*
+gfbgraph_user_new_me_call (GFBGraphAuthorizer *authorizer)
 {
-  g_object_unref (data->user);
+  RestProxyCall *rest_call;
 
-  g_slice_free (GFBGraphUserAsyncData, data);
+  rest_call = gfbgraph_new_rest_call (authorizer);
+  rest_proxy_call_set_function (rest_call, ME_FUNCTION);
+  rest_proxy_call_set_method (rest_call, "GET");
+  rest_proxy_call_add_param (rest_call, "fields", "name,email");
+  gfbgraph_rest_call_set_node_type (rest_call, GFBGRAPH_TYPE_USER);
+
+  return rest_call;
 }
 
-static void
-gfbgraph_user_connection_async_data_free (GFBGraphUserConnectionAsyncData *data)
+static GFBGraphUser*
+gfbgraph_user_parse_me (RestProxyCall  *rest_call,
+                        GError        **error)
 {
-  g_object_unref (data->authorizer);
+  GFBGraphUser *me = NULL;
+  JsonParser *parser;
+  JsonNode *node;
+  const gchar *payload;
+  gint64 timer;
+
+  timer = gfbgraph_rest_call_start_timer (rest_call);
+
+  payload = gfbgraph_rest_call_get_payload (rest_call);
+  parser = json_parser_new ();
+  if (json_parser_load_from_data (parser, payload, -1, error)) {
+    node = json_parser_get_root (parser);
+    gfbgraph_rest_call_stop_parse_timer (rest_call, &timer);
+    me = GFBGRAPH_USER (gfbgraph_node_deserialize (GFBGRAPH_TYPE_USER, node));
+    gfbgraph_rest_call_stop_deserialize_timer (rest_call, &timer);
+  }
 
-  g_slice_free (GFBGraphUserConnectionAsyncData, data);
+  g_object_unref (parser);
+
+  return me;
 }
 
 static void
-gfbgraph_user_get_me_async_thread (GSimpleAsyncResult *simple_async,
-                                   GFBGraphAuthorizer *authorizer,
-                                   GCancellable        cancellable)
+gfbgraph_user_get_me_async_cb (GObject      *source_object,
+                               GAsyncResult *result,
+                               gpointer      user_data)
 {
-  GFBGraphUserAsyncData *data;
+  GTask *task = G_TASK (user_data);
+  RestProxyCall *rest_call = REST_PROXY_CALL (source_object);
+  GFBGraphUser *me = NULL;
   GError *error = NULL;
 
-  data = (GFBGraphUserAsyncData *) g_simple_async_result_get_op_res_gpointer (simple_async);
+  if (gfbgraph_rest_call_invoke_finish (rest_call, result, &error))
+    me = gfbgraph_user_parse_me (rest_call, &error);
 
-  data->user = gfbgraph_user_get_me (authorizer, &error);
   if (error != NULL)
-    g_simple_async_result_take_error (simple_async, error);
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, me, g_object_unref);
+
+  g_object_unref (task);
 }
 
 static void
-gfbgraph_user_get_albums_async_thread (GSimpleAsyncResult *simple_async,
-                                       GFBGraphUser       *user,
-                                       GCancellable        cancellable)
+gfbgraph_user_list_free (GList *nodes_list)
 {
-  GFBGraphUserConnectionAsyncData *data;
-  GError *error = NULL;
+  g_list_free_full (nodes_list, g_object_unref);
+}
 
-  data = (GFBGraphUserConnectionAsyncData *) g_simple_async_result_get_op_res_gpointer (simple_async);
+static void
+gfbgraph_user_get_albums_async_cb (GObject      *source_object,
+                                   GAsyncResult *result,
+                                   gpointer      user_data)
+{
+  GTask *task = G_TASK (user_data);
+  GList *albums;
+  GError *error = NULL;
 
-  data->nodes = gfbgraph_user_get_albums (user, data->authorizer, &error);
+  albums = gfbgraph_node_get_connection_nodes_async_finish (GFBGRAPH_NODE (source_object), result, &error);
   if (error != NULL)
-    g_simple_async_result_take_error (simple_async, error);
-}
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, albums, (GDestroyNotify) gfbgraph_user_list_free);
 
+  g_object_unref (task);
+}
 
 /* --- Public APIs --- */
 
@@ -250,6 +296,31 @@ gfbgraph_user_new_from_id (GFBGraphAuthorizer  *authorizer,
                                                    error));
 }
 
+/**
+ * gfbgraph_user_new_from_id_with_fields:
+ * @authorizer: a #GFBGraphAuthorizer.
+ * @id: a const #gchar with the user ID.
+ * @fields: (array zero-terminated=1) (allow-none): a %NULL-terminated array with the fields to retrieve, or %NULL.
+ * @error: (allow-none): a #GError or %NULL.
+ *
+ * Retrieves only the given @fields of the user with the give ID, see
+ * gfbgraph_node_new_from_id_with_fields().
+ *
+ * Returns: (transfer full): a new #GFBGraphUser; unref with g_object_unref()
+ **/
+GFBGraphUser*
+gfbgraph_user_new_from_id_with_fields (GFBGraphAuthorizer   *authorizer,
+                                       const gchar          *id,
+                                       const gchar * const  *fields,
+                                       GError              **error)
+{
+  return GFBGRAPH_USER (gfbgraph_node_new_from_id_with_fields (authorizer,
+                                                               id,
+                                                               GFBGRAPH_TYPE_USER,
+                                                               fields,
+                                                               error));
+}
+
 /**
  * gfbgraph_user_get_me:
  * @authorizer: a #GFBGraphAuthorizer.
@@ -266,30 +337,14 @@ gfbgraph_user_get_me (GFBGraphAuthorizer  *authorizer,
 {
   GFBGraphUser *me = NULL;
   RestProxyCall *rest_call;
-  const gchar *payload;
-  gboolean result;
 
   g_return_val_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer), NULL);
 
-  rest_call = gfbgraph_new_rest_call (authorizer);
-  rest_proxy_call_set_function (rest_call, ME_FUNCTION);
-  rest_proxy_call_set_method (rest_call, "GET");
-  rest_proxy_call_add_param (rest_call, "fields", "name,email");
-
-  result = rest_proxy_call_sync (rest_call, error);
-  if (result) {
-    JsonParser *parser;
-    JsonNode *node;
+  rest_call = gfbgraph_user_new_me_call (authorizer);
+  if (gfbgraph_rest_call_invoke (rest_call, NULL, error))
+    me = gfbgraph_user_parse_me (rest_call, error);
 
-    payload = rest_proxy_call_get_payload (rest_call);
-    parser = json_parser_new ();
-    if (json_parser_load_from_data (parser, payload, -1, error)) {
-      node = json_parser_get_root (parser);
-      me = GFBGRAPH_USER (json_gobject_deserialize (GFBGRAPH_TYPE_USER, node));
-    }
-
-    g_object_unref (parser);
-  }
+  g_object_unref (rest_call);
 
   return me;
 }
@@ -313,31 +368,20 @@ gfbgraph_user_get_me_async (GFBGraphAuthorizer  *authorizer,
                             GAsyncReadyCallback  callback,
                             gpointer             user_data)
 {
-  GSimpleAsyncResult *simple_async;
-  GFBGraphUserAsyncData *data;
+  GTask *task;
+  RestProxyCall *rest_call;
 
   g_return_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer));
   g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
   g_return_if_fail (callback != NULL);
 
-  simple_async = g_simple_async_result_new (G_OBJECT (authorizer),
-                                            callback,
-                                            user_data,
-                                            gfbgraph_user_get_me_async);
-  g_simple_async_result_set_check_cancellable (simple_async, cancellable);
+  task = g_task_new (authorizer, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gfbgraph_user_get_me_async);
 
-  data = g_slice_new (GFBGraphUserAsyncData);
-  data->user = NULL;
+  rest_call = gfbgraph_user_new_me_call (authorizer);
+  gfbgraph_rest_call_invoke_async (rest_call, cancellable, gfbgraph_user_get_me_async_cb, task);
 
-  g_simple_async_result_set_op_res_gpointer (simple_async,
-                                             data,
-                                             (GDestroyNotify) gfbgraph_user_async_data_free);
-  g_simple_async_result_run_in_thread (simple_async,
-                                       (GSimpleAsyncThreadFunc) gfbgraph_user_get_me_async_thread,
-                                       G_PRIORITY_DEFAULT,
-                                       cancellable);
-
-  g_object_unref (simple_async);
+  g_object_unref (rest_call);
 }
 
 /**
@@ -356,19 +400,10 @@ gfbgraph_user_get_me_async_finish (GFBGraphAuthorizer  *authorizer,
                                    GAsyncResult        *result,
                                    GError             **error)
 {
-  GSimpleAsyncResult *simple_async;
-  GFBGraphUserAsyncData *data;
-
-  g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (authorizer), gfbgraph_user_get_me_async), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, authorizer), NULL);
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  simple_async = G_SIMPLE_ASYNC_RESULT (result);
-
-  if (g_simple_async_result_propagate_error (simple_async, error))
-    return NULL;
-
-  data = (GFBGraphUserAsyncData *) g_simple_async_result_get_op_res_gpointer (simple_async);
-  return data->user;
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -416,34 +451,22 @@ gfbgraph_user_get_albums_async (GFBGraphUser        *user,
                                 GAsyncReadyCallback  callback,
                                 gpointer             user_data)
 {
-  GSimpleAsyncResult *simple_async;
-  GFBGraphUserConnectionAsyncData *data;
+  GTask *task;
 
   g_return_if_fail (GFBGRAPH_IS_USER (user));
   g_return_if_fail (GFBGRAPH_IS_AUTHORIZER (authorizer));
   g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
   g_return_if_fail (callback != NULL);
 
-  simple_async = g_simple_async_result_new (G_OBJECT (user),
-                                            callback,
-                                            user_data,
-                                            gfbgraph_user_get_albums_async);
-  g_simple_async_result_set_check_cancellable (simple_async, cancellable);
-
-  data = g_slice_new (GFBGraphUserConnectionAsyncData);
-  data->nodes = NULL;
-  data->authorizer = authorizer;
-  g_object_ref (data->authorizer);
-
-  g_simple_async_result_set_op_res_gpointer (simple_async,
-                                             data,
-                                             (GDestroyNotify) gfbgraph_user_connection_async_data_free);
-  g_simple_async_result_run_in_thread (simple_async,
-                                       (GSimpleAsyncThreadFunc) gfbgraph_user_get_albums_async_thread,
-                                       G_PRIORITY_DEFAULT,
-                                       cancellable);
-
-  g_object_unref (simple_async);
+  task = g_task_new (user, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gfbgraph_user_get_albums_async);
+
+  gfbgraph_node_get_connection_nodes_async (GFBGRAPH_NODE (user),
+                                            GFBGRAPH_TYPE_ALBUM,
+                                            authorizer,
+                                            cancellable,
+                                            gfbgraph_user_get_albums_async_cb,
+                                            task);
 }
 
 /**
@@ -462,20 +485,11 @@ gfbgraph_user_get_albums_async_finish (GFBGraphUser  *user,
                                        GAsyncResult  *result,
                                        GError       **error)
 {
-  GSimpleAsyncResult *simple_async;
-  GFBGraphUserConnectionAsyncData *data;
-
   g_return_val_if_fail (GFBGRAPH_IS_USER (user), NULL);
-  g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (user), gfbgraph_user_get_albums_async), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, user), NULL);
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  simple_async = G_SIMPLE_ASYNC_RESULT (result);
-
-  if (g_simple_async_result_propagate_error (simple_async, error))
-    return NULL;
-
-  data = (GFBGraphUserConnectionAsyncData *) g_simple_async_result_get_op_res_gpointer (simple_async);
-  return data->nodes;
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -46,6 +46,10 @@ GFBGraphUser* gfbgraph_user_new                     (void);
 GFBGraphUser* gfbgraph_user_new_from_id             (GFBGraphAuthorizer  *authorizer,
                                                      const gchar         *id,
                                                      GError             **error);
+GFBGraphUser* gfbgraph_user_new_from_id_with_fields (GFBGraphAuthorizer   *authorizer,
+                                                     const gchar          *id,
+                                                     const gchar * const  *fields,
+                                                     GError              **error);
 
 GFBGraphUser* gfbgraph_user_get_me                  (GFBGraphAuthorizer  *authorizer,
                                                      GError             **error);
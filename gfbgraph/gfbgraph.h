@@ -21,9 +21,22 @@
 #define __GFBGRAPH_H__
 
 #include <gfbgraph/gfbgraph-album.h>
+#include <gfbgraph/gfbgraph-authorizer-pool.h>
+#include <gfbgraph/gfbgraph-batch.h>
+#include <gfbgraph/gfbgraph-cache.h>
+#include <gfbgraph/gfbgraph-client.h>
 #include <gfbgraph/gfbgraph-connectable.h>
+#include <gfbgraph/gfbgraph-connection-iterator.h>
+#include <gfbgraph/gfbgraph-disk-cache.h>
+#include <gfbgraph/gfbgraph-memory-cache.h>
+#include <gfbgraph/gfbgraph-metrics.h>
 #include <gfbgraph/gfbgraph-node.h>
+#include <gfbgraph/gfbgraph-node-store.h>
 #include <gfbgraph/gfbgraph-photo.h>
+#include <gfbgraph/gfbgraph-photo-cache.h>
+#include <gfbgraph/gfbgraph-photo-downloader.h>
+#include <gfbgraph/gfbgraph-sync.h>
+#include <gfbgraph/gfbgraph-tracer.h>
 #include <gfbgraph/gfbgraph-user.h>
 
 #endif /* __GFBGRAPH_H__ */
@@ -26,6 +26,8 @@
 #include <gfbgraph/gfbgraph.h>
 #include <gfbgraph/gfbgraph-simple-authorizer.h>
 
+#include "test-store.h"
+
 static void
 test_gfbgraph_album (void)
 {
@@ -35,6 +37,83 @@ test_gfbgraph_album (void)
   g_assert_nonnull (val);
 }
 
+static void
+test_gfbgraph_authorizer_pool (void)
+{
+  g_autoptr (GFBGraphAuthorizerPool) val = NULL;
+
+  val = gfbgraph_authorizer_pool_new (GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN);
+  g_assert_nonnull (val);
+}
+
+static void
+test_gfbgraph_batch (void)
+{
+  g_autoptr (GFBGraphBatch) val = NULL;
+  g_autoptr (GFBGraphSimpleAuthorizer) authorizer = NULL;
+
+  authorizer = gfbgraph_simple_authorizer_new ("");
+  val = gfbgraph_batch_new (GFBGRAPH_AUTHORIZER (authorizer));
+  g_assert_nonnull (val);
+}
+
+static void
+test_gfbgraph_client (void)
+{
+  g_autoptr (GFBGraphClient) val = NULL;
+
+  val = gfbgraph_client_new ();
+  g_assert_nonnull (val);
+}
+
+static void
+test_gfbgraph_connection_iterator (void)
+{
+  g_autoptr (GFBGraphConnectionIterator) val = NULL;
+  g_autoptr (GFBGraphAlbum) album = NULL;
+  g_autoptr (GFBGraphSimpleAuthorizer) authorizer = NULL;
+
+  album = gfbgraph_album_new ();
+  authorizer = gfbgraph_simple_authorizer_new ("");
+  val = gfbgraph_connection_iterator_new (GFBGRAPH_NODE (album),
+                                          GFBGRAPH_TYPE_PHOTO,
+                                          GFBGRAPH_AUTHORIZER (authorizer),
+                                          100);
+  g_assert_nonnull (val);
+}
+
+static void
+test_gfbgraph_disk_cache (void)
+{
+  g_autoptr (GFBGraphDiskCache) val = NULL;
+  gchar *directory;
+
+  directory = g_dir_make_tmp ("gfbgraph-cache-XXXXXX", NULL);
+  val = gfbgraph_disk_cache_new (directory, 0);
+  g_assert_nonnull (val);
+
+  test_remove_directory (directory);
+  g_free (directory);
+}
+
+static void
+test_gfbgraph_memory_cache (void)
+{
+  g_autoptr (GFBGraphMemoryCache) val = NULL;
+
+  val = gfbgraph_memory_cache_new (1024);
+  g_assert_nonnull (val);
+}
+
+static void
+test_gfbgraph_metrics (void)
+{
+  g_autoptr (GFBGraphMetrics) val = NULL;
+
+  val = gfbgraph_metrics_new ();
+  g_assert_nonnull (val);
+}
+
 static void
 test_gfbgraph_node (void)
 {
@@ -44,6 +123,21 @@ test_gfbgraph_node (void)
   g_assert_nonnull (val);
 }
 
+static void
+test_gfbgraph_node_store (void)
+{
+  g_autoptr (GFBGraphNodeStore) val = NULL;
+  TestStore test_store;
+
+  test_store_init (&test_store);
+
+  val = gfbgraph_node_store_new (test_store.path, NULL);
+  g_assert_nonnull (val);
+  g_clear_object (&val);
+
+  test_store_clear (&test_store);
+}
+
 static void
 test_gfbgraph_photo (void)
 {
@@ -53,6 +147,58 @@ test_gfbgraph_photo (void)
   g_assert_nonnull (val);
 }
 
+static void
+test_gfbgraph_sync (void)
+{
+  g_autoptr (GFBGraphSync) val = NULL;
+  g_autoptr (GFBGraphNodeStore) store = NULL;
+  g_autoptr (GFBGraphSimpleAuthorizer) authorizer = NULL;
+  TestStore test_store;
+
+  test_store_init (&test_store);
+
+  store = gfbgraph_node_store_new (test_store.path, NULL);
+  authorizer = gfbgraph_simple_authorizer_new ("");
+  val = gfbgraph_sync_new (store, GFBGRAPH_AUTHORIZER (authorizer));
+  g_assert_nonnull (val);
+  g_clear_object (&val);
+  g_clear_object (&store);
+
+  test_store_clear (&test_store);
+}
+
+static void
+test_gfbgraph_photo_cache (void)
+{
+  g_autoptr (GFBGraphPhotoCache) val = NULL;
+  gchar *directory;
+
+  directory = g_dir_make_tmp ("gfbgraph-photo-cache-XXXXXX", NULL);
+  val = gfbgraph_photo_cache_new (directory, 0);
+  g_assert_nonnull (val);
+
+  test_remove_directory (directory);
+  g_free (directory);
+}
+
+static void
+test_gfbgraph_photo_downloader (void)
+{
+  g_autoptr (GFBGraphPhotoDownloader) val = NULL;
+
+  val = gfbgraph_photo_downloader_new (0, 0);
+  g_assert_nonnull (val);
+}
+
+static void
+test_gfbgraph_tracer (void)
+{
+  g_autoptr (GFBGraphTracer) val = NULL;
+
+  val = gfbgraph_tracer_new (16);
+  g_assert_nonnull (val);
+}
+
 static void
 test_gfbgraph_user (void)
 {
@@ -78,8 +224,20 @@ main (int   argc,
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/GFBGraph/autoptr/Album", test_gfbgraph_album);
+  g_test_add_func ("/GFBGraph/autoptr/AuthorizerPool", test_gfbgraph_authorizer_pool);
+  g_test_add_func ("/GFBGraph/autoptr/Batch", test_gfbgraph_batch);
+  g_test_add_func ("/GFBGraph/autoptr/Client", test_gfbgraph_client);
+  g_test_add_func ("/GFBGraph/autoptr/ConnectionIterator", test_gfbgraph_connection_iterator);
+  g_test_add_func ("/GFBGraph/autoptr/DiskCache", test_gfbgraph_disk_cache);
+  g_test_add_func ("/GFBGraph/autoptr/MemoryCache", test_gfbgraph_memory_cache);
+  g_test_add_func ("/GFBGraph/autoptr/Metrics", test_gfbgraph_metrics);
   g_test_add_func ("/GFBGraph/autoptr/Node", test_gfbgraph_node);
+  g_test_add_func ("/GFBGraph/autoptr/NodeStore", test_gfbgraph_node_store);
   g_test_add_func ("/GFBGraph/autoptr/Photo", test_gfbgraph_photo);
+  g_test_add_func ("/GFBGraph/autoptr/PhotoCache", test_gfbgraph_photo_cache);
+  g_test_add_func ("/GFBGraph/autoptr/PhotoDownloader", test_gfbgraph_photo_downloader);
+  g_test_add_func ("/GFBGraph/autoptr/Sync", test_gfbgraph_sync);
+  g_test_add_func ("/GFBGraph/autoptr/Tracer", test_gfbgraph_tracer);
   g_test_add_func ("/GFBGraph/autoptr/User", test_gfbgraph_user);
   g_test_add_func ("/GFBGraph/autoptr/SimpleAuthorizer", test_gfbgraph_simple_authorizer);
 
@@ -0,0 +1,411 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmarks of the request, parsing and deserialization pipeline, run
+ * against the mock Graph API server. The results are printed as JSON:
+ *
+ *   {"benchmarks": [{"name": "node-new-from-id", "iterations": 200,
+ *                    "requests_per_second": 1520.3, "p50_usec": 610,
+ *                    "p99_usec": 1302, "nodes_per_iteration": 1,
+ *                    "heap_bytes_per_node": 1480}, ...]}
+ *
+ * heap_bytes_per_node is the heap in use while the nodes of an iteration are
+ * alive, divided by the number of nodes. It's only measured where mallinfo2()
+ * is available, and it's 0 otherwise.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+#include <json-glib/json-glib.h>
+
+#include <gfbgraph/gfbgraph.h>
+#include <gfbgraph/gfbgraph-simple-authorizer.h>
+
+#include "mock-server.h"
+
+typedef struct
+{
+  const gchar        *name;
+  guint               nodes_per_iteration;
+
+  GArray             *samples;
+  guint               n_requests;
+  gint64              start;
+  gint64              heap_bytes;
+  guint               heap_samples;
+} Bench;
+
+static MockServer *server = NULL;
+static GFBGraphAuthorizer *authorizer = NULL;
+static JsonBuilder *results = NULL;
+
+static gint iterations = 200;
+static gchar *filter = NULL;
+static gint concurrency = 8;
+
+static GOptionEntry entries[] =
+{
+  { "iterations", 'i', 0, G_OPTION_ARG_INT, &iterations, "Iterations of every benchmark", "N" },
+  { "filter", 'f', 0, G_OPTION_ARG_STRING, &filter, "Only run the benchmarks containing NAME", "NAME" },
+  { "concurrency", 'c', 0, G_OPTION_ARG_INT, &concurrency, "Requests in flight in the async benchmarks", "N" },
+  { NULL }
+};
+
+static gsize
+heap_in_use (void)
+{
+#ifdef HAVE_MALLINFO2
+  return mallinfo2 ().uordblks;
+#else
+  return 0;
+#endif
+}
+
+static gboolean
+bench_start (Bench       *bench,
+             const gchar *name,
+             guint        nodes_per_iteration)
+{
+  if (filter != NULL && strstr (name, filter) == NULL)
+    return FALSE;
+
+  memset (bench, 0, sizeof (Bench));
+  bench->name = name;
+  bench->nodes_per_iteration = nodes_per_iteration;
+  bench->samples = g_array_new (FALSE, FALSE, sizeof (gint64));
+  bench->n_requests = mock_server_get_n_requests (server);
+  bench->start = g_get_monotonic_time ();
+
+  return TRUE;
+}
+
+static void
+bench_add_sample (Bench  *bench,
+                  gint64  usec)
+{
+  g_array_append_val (bench->samples, usec);
+}
+
+/* Called with the nodes of an iteration still alive, @heap_before being the
+ * heap in use before the iteration started */
+static void
+bench_add_heap_sample (Bench *bench,
+                       gsize  heap_before)
+{
+  gsize heap_after = heap_in_use ();
+
+  if (heap_after > heap_before) {
+    bench->heap_bytes += heap_after - heap_before;
+    bench->heap_samples++;
+  }
+}
+
+static gint
+compare_samples (gconstpointer a,
+                 gconstpointer b)
+{
+  gint64 sample_a = *(const gint64 *) a;
+  gint64 sample_b = *(const gint64 *) b;
+
+  return sample_a < sample_b ? -1 : sample_a > sample_b;
+}
+
+static gint64
+percentile (GArray *samples,
+            guint   percent)
+{
+  guint index;
+
+  if (samples->len == 0)
+    return 0;
+
+  index = MIN (samples->len - 1, samples->len * percent / 100);
+
+  return g_array_index (samples, gint64, index);
+}
+
+static void
+bench_end (Bench *bench)
+{
+  gdouble seconds;
+  guint n_requests;
+
+  seconds = (g_get_monotonic_time () - bench->start) / (gdouble) G_USEC_PER_SEC;
+  n_requests = mock_server_get_n_requests (server) - bench->n_requests;
+  g_array_sort (bench->samples, compare_samples);
+
+  json_builder_begin_object (results);
+  json_builder_set_member_name (results, "name");
+  json_builder_add_string_value (results, bench->name);
+  json_builder_set_member_name (results, "iterations");
+  json_builder_add_int_value (results, bench->samples->len);
+  json_builder_set_member_name (results, "requests");
+  json_builder_add_int_value (results, n_requests);
+  json_builder_set_member_name (results, "requests_per_second");
+  json_builder_add_double_value (results, seconds > 0 ? n_requests / seconds : 0);
+  json_builder_set_member_name (results, "p50_usec");
+  json_builder_add_int_value (results, percentile (bench->samples, 50));
+  json_builder_set_member_name (results, "p99_usec");
+  json_builder_add_int_value (results, percentile (bench->samples, 99));
+  json_builder_set_member_name (results, "nodes_per_iteration");
+  json_builder_add_int_value (results, bench->nodes_per_iteration);
+  json_builder_set_member_name (results, "heap_bytes_per_node");
+  json_builder_add_int_value (results, bench->heap_samples > 0 && bench->nodes_per_iteration > 0 ?
+                              bench->heap_bytes / bench->heap_samples / bench->nodes_per_iteration : 0);
+  json_builder_end_object (results);
+
+  g_array_unref (bench->samples);
+}
+
+static void
+bench_node_new_from_id (const gchar *name,
+                        const gchar *id,
+                        GType        node_type)
+{
+  Bench bench;
+  gint i;
+
+  if (!bench_start (&bench, name, 1))
+    return;
+
+  for (i = 0; i < iterations; i++) {
+    GFBGraphNode *node;
+    GError *error = NULL;
+    gsize heap;
+    gint64 start;
+
+    heap = heap_in_use ();
+    start = g_get_monotonic_time ();
+    node = gfbgraph_node_new_from_id (authorizer, id, node_type, &error);
+    bench_add_sample (&bench, g_get_monotonic_time () - start);
+    g_assert_no_error (error);
+
+    bench_add_heap_sample (&bench, heap);
+    g_object_unref (node);
+  }
+
+  bench_end (&bench);
+}
+
+static void
+bench_connection_nodes (const gchar *name,
+                        guint        page_size)
+{
+  g_autoptr (GFBGraphAlbum) album = NULL;
+  gchar *album_id;
+  Bench bench;
+  gint n_iterations;
+  gint i;
+
+  if (!bench_start (&bench, name, page_size))
+    return;
+
+  mock_server_set_n_photos (server, page_size);
+  mock_server_set_page_limit (server, page_size);
+
+  album = gfbgraph_album_new ();
+  album_id = g_strdup_printf ("%u", MOCK_ALBUM_ID_BASE);
+  gfbgraph_node_set_id (GFBGRAPH_NODE (album), album_id);
+  g_free (album_id);
+
+  /* The big pages take much longer */
+  n_iterations = MAX (3, iterations * 100 / (gint) page_size);
+  n_iterations = MIN (n_iterations, iterations);
+
+  for (i = 0; i < n_iterations; i++) {
+    GList *nodes;
+    GError *error = NULL;
+    gsize heap;
+    gint64 start;
+
+    heap = heap_in_use ();
+    start = g_get_monotonic_time ();
+    nodes = gfbgraph_node_get_connection_nodes (GFBGRAPH_NODE (album), GFBGRAPH_TYPE_PHOTO, authorizer, &error);
+    bench_add_sample (&bench, g_get_monotonic_time () - start);
+    g_assert_no_error (error);
+    g_assert_cmpuint (g_list_length (nodes), ==, page_size);
+
+    bench_add_heap_sample (&bench, heap);
+    g_list_free_full (nodes, g_object_unref);
+  }
+
+  bench_end (&bench);
+}
+
+typedef struct
+{
+  Bench        *bench;
+  GFBGraphNode *node;
+  guint         started;
+  guint         finished;
+  guint         total;
+} AsyncBench;
+
+static void bench_async_start_one (AsyncBench *async_bench);
+
+static void
+bench_async_cb (GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  AsyncBench *async_bench;
+  gint64 *start = user_data;
+  GList *nodes;
+  GError *error = NULL;
+
+  async_bench = g_object_get_data (source_object, "bench");
+  nodes = gfbgraph_node_get_connection_nodes_async_finish (GFBGRAPH_NODE (source_object), result, &error);
+  bench_add_sample (async_bench->bench, g_get_monotonic_time () - *start);
+  g_assert_no_error (error);
+  g_list_free_full (nodes, g_object_unref);
+  g_free (start);
+
+  async_bench->finished++;
+  if (async_bench->started < async_bench->total)
+    bench_async_start_one (async_bench);
+}
+
+static void
+bench_async_start_one (AsyncBench *async_bench)
+{
+  gint64 *start;
+
+  start = g_new (gint64, 1);
+  *start = g_get_monotonic_time ();
+  async_bench->started++;
+  gfbgraph_node_get_connection_nodes_async (async_bench->node, GFBGRAPH_TYPE_PHOTO, authorizer,
+                                            NULL, bench_async_cb, start);
+}
+
+static void
+bench_connection_nodes_async (const gchar *name,
+                              guint        page_size)
+{
+  g_autoptr (GFBGraphAlbum) album = NULL;
+  AsyncBench async_bench;
+  gchar *album_id;
+  Bench bench;
+  gint i;
+
+  if (!bench_start (&bench, name, page_size))
+    return;
+
+  mock_server_set_n_photos (server, page_size);
+  mock_server_set_page_limit (server, page_size);
+
+  album = gfbgraph_album_new ();
+  album_id = g_strdup_printf ("%u", MOCK_ALBUM_ID_BASE);
+  gfbgraph_node_set_id (GFBGRAPH_NODE (album), album_id);
+  g_free (album_id);
+
+  async_bench.bench = &bench;
+  async_bench.node = GFBGRAPH_NODE (album);
+  async_bench.started = 0;
+  async_bench.finished = 0;
+  async_bench.total = iterations;
+  g_object_set_data (G_OBJECT (album), "bench", &async_bench);
+
+  for (i = 0; i < MIN (concurrency, iterations); i++)
+    bench_async_start_one (&async_bench);
+
+  while (async_bench.finished < async_bench.total)
+    g_main_context_iteration (NULL, TRUE);
+
+  bench_end (&bench);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  GOptionContext *context;
+  GFBGraphClient *client;
+  JsonGenerator *generator;
+  JsonNode *root;
+  gchar *photo_id;
+  gchar *output;
+  GError *error = NULL;
+
+  context = g_option_context_new ("- benchmark the GFBGraph request pipeline");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error)) {
+    g_printerr ("%s\n", error->message);
+    return 1;
+  }
+  g_option_context_free (context);
+
+  server = mock_server_new ();
+
+  /* Without rate limit, to measure the library and not the scheduler */
+  client = g_object_new (GFBGRAPH_TYPE_CLIENT,
+                         "endpoint", mock_server_get_endpoint (server),
+                         "requests-per-second", 0.0,
+                         "max-requests-in-flight", MAX (concurrency, 1),
+                         NULL);
+  gfbgraph_client_set_default (client);
+  g_object_unref (client);
+
+  authorizer = GFBGRAPH_AUTHORIZER (gfbgraph_simple_authorizer_new ("mock-bench-token"));
+  results = json_builder_new ();
+  json_builder_begin_object (results);
+  json_builder_set_member_name (results, "benchmarks");
+  json_builder_begin_array (results);
+
+  bench_node_new_from_id ("node-new-from-id", MOCK_USER_ID, GFBGRAPH_TYPE_USER);
+
+  photo_id = g_strdup_printf ("%u", MOCK_PHOTO_ID_BASE);
+  bench_node_new_from_id ("photo-4-images", photo_id, GFBGRAPH_TYPE_PHOTO);
+  mock_server_set_n_images (server, 200);
+  bench_node_new_from_id ("photo-200-images", photo_id, GFBGRAPH_TYPE_PHOTO);
+  mock_server_set_n_images (server, 4);
+  g_free (photo_id);
+
+  bench_connection_nodes ("connection-nodes-100", 100);
+  bench_connection_nodes ("connection-nodes-1000", 1000);
+  bench_connection_nodes ("connection-nodes-10000", 10000);
+
+  bench_connection_nodes_async ("connection-nodes-async-100", 100);
+
+  json_builder_end_array (results);
+  json_builder_end_object (results);
+
+  root = json_builder_get_root (results);
+  generator = json_generator_new ();
+  json_generator_set_pretty (generator, TRUE);
+  json_generator_set_root (generator, root);
+  output = json_generator_to_data (generator, NULL);
+  g_print ("%s\n", output);
+
+  g_free (output);
+  g_object_unref (generator);
+  json_node_free (root);
+  g_object_unref (results);
+  g_object_unref (authorizer);
+  mock_server_free (server);
+
+  return 0;
+}
@@ -24,6 +24,8 @@
 #include <gfbgraph/gfbgraph.h>
 #include <gfbgraph/gfbgraph-simple-authorizer.h>
 
+#include "mock-server.h"
+
 /* #include "config.h" */
 
 typedef struct _GFBGraphTestFixture GFBGraphTestFixture;
@@ -48,6 +50,10 @@ struct _GFBGraphTestApp
 
 #define FACEBOOK_TEST_USER_PERMISSIONS "email,user_about_me,user_photos,publish_actions"
 
+/* Without credentials.ini the tests run against a mock of the Graph API */
+static MockServer *mock_server = NULL;
+static gchar *endpoint = NULL;
+
 GFBGraphTestApp*
 gfbgraph_test_app_setup (void)
 {
@@ -63,6 +69,14 @@ gfbgraph_test_app_setup (void)
   JsonParser *jparser;
   JsonReader *jreader;
 
+  if (mock_server != NULL) {
+    app = g_new0(GFBGraphTestApp, 1);
+    app->client_id = g_strdup ("mock-app");
+    app->client_secret = g_strdup ("mock-secret");
+    app->access_token = g_strdup ("mock-app-token");
+    return app;
+  }
+
   app_key_filename = g_test_build_filename (G_TEST_BUILT,
                                             "credentials.ini",
                                             NULL);
@@ -86,7 +100,7 @@ gfbgraph_test_app_setup (void)
                                               &error);
   g_assert_no_error(error);
 
-  proxy = rest_proxy_new (FACEBOOK_ENDPOINT, FALSE);
+  proxy = rest_proxy_new (endpoint, FALSE);
   rest_call = rest_proxy_new_call (proxy);
 
   rest_proxy_call_add_param (rest_call, "client_id", app->client_id);
@@ -134,7 +148,7 @@ gfbgraph_test_fixture_setup (GFBGraphTestFixture *fixture,
 
   /* Create a new user */
 
-  proxy = rest_proxy_new (FACEBOOK_ENDPOINT, FALSE);
+  proxy = rest_proxy_new (endpoint, FALSE);
   rest_call = rest_proxy_new_call (proxy);
 
   /* Params as documented here: https://developers.facebook.com/docs/graph-api/reference/app/accounts/test-users#publish */
@@ -187,7 +201,7 @@ gfbgraph_test_fixture_teardown (GFBGraphTestFixture         *fixture,
 
   ssession = soup_session_new ();
 
-  function_path = g_strdup_printf ("%s/%s", FACEBOOK_ENDPOINT, fixture->user_id);
+  function_path = g_strdup_printf ("%s/%s", endpoint, fixture->user_id);
   smessage = soup_message_new ("DELETE", function_path);
   gfbgraph_authorizer_process_message (GFBGRAPH_AUTHORIZER (fixture->authorizer), smessage);
 
@@ -252,12 +266,23 @@ main (int    argc,
       char **argv)
 {
   GFBGraphTestApp *app = NULL;
+  gchar *app_key_filename;
   int test_result;
 
   g_test_init (&argc, &argv, NULL);
 
   g_log_set_always_fatal (G_LOG_LEVEL_ERROR | G_LOG_FLAG_RECURSION | G_LOG_FLAG_FATAL | G_LOG_LEVEL_CRITICAL);
 
+  app_key_filename = g_test_build_filename (G_TEST_BUILT, "credentials.ini", NULL);
+  if (g_file_test (app_key_filename, G_FILE_TEST_EXISTS)) {
+    endpoint = g_strdup (FACEBOOK_ENDPOINT);
+  } else {
+    mock_server = mock_server_new ();
+    endpoint = g_strdup_printf ("%s/v2.10", mock_server_get_endpoint (mock_server));
+    g_setenv ("GFBGRAPH_ENDPOINT", endpoint, TRUE);
+  }
+  g_free (app_key_filename);
+
   app = gfbgraph_test_app_setup ();
 
   g_test_add ("/GFBGraph/Me",
@@ -291,5 +316,8 @@ main (int    argc,
       g_free (app->access_token);
   }
 
+  g_clear_pointer (&mock_server, mock_server_free);
+  g_free (endpoint);
+
   return test_result;
 }
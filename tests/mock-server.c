@@ -0,0 +1,1037 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A fake Graph API endpoint running in its own thread, so the tests and
+ * benchmarks don't need a Facebook app nor network access. It serves
+ * synthetic and deterministic nodes:
+ *
+ *   GET  /me, /{id}                    a node, "fields" is honored
+ *   GET  /?ids=id1,id2                 several nodes
+ *   GET  /{id}/albums, /{id}/photos    connection pages, with "limit", "after" and "since"
+ *   POST /                             a batch of requests
+ *   POST /{id}/albums                  a new album
+ *   GET  /media/{name}                 the bytes of an image, with "Range" and
+ *                                      "If-Range", its ETag is the quoted name,
+ *                                      or 404 if the name starts with "missing"
+ *
+ * plus the app and test users functions used by gtestutils. Requests can be
+ * made to fail with mock_server_fail_requests(), to test the throttling and
+ * error handling, and the X-App-Usage header of the responses is set with
+ * mock_server_set_usage().
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <json-glib/json-glib.h>
+#include <libsoup/soup.h>
+
+#include "mock-server.h"
+
+#define DEFAULT_N_ALBUMS   60
+#define DEFAULT_N_PHOTOS   100
+#define DEFAULT_PAGE_LIMIT 25
+#define DEFAULT_N_IMAGES   4
+/* The "updated_time" of the nodes not touched, 2013-01-01T10:00:00+0000 */
+#define DEFAULT_UPDATED_TIME 1357034400
+
+struct _MockServer
+{
+  GMutex        mutex;
+
+  GMainContext *context;
+  GMainLoop    *loop;
+  GThread      *thread;
+  SoupServer   *soup_server;
+  gchar        *endpoint;
+
+  guint         n_albums;
+  guint         n_photos;
+  guint         n_images;
+  guint         page_limit;
+  guint         usage;
+  guint         n_requests;
+  guint         n_not_modified;
+
+  guint         n_failures;
+  guint         failure_status;
+  gint          failure_code;
+
+  guint         next_album_id;
+  /* The update times set by mock_server_touch_node(), by node ID */
+  GHashTable   *updated_times;
+};
+
+static JsonNode*
+mock_error_new (gint         code,
+                const gchar *message)
+{
+  JsonBuilder *builder;
+  JsonNode *root;
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "error");
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "message");
+  json_builder_add_string_value (builder, message);
+  json_builder_set_member_name (builder, "type");
+  json_builder_add_string_value (builder, code == 190 ? "OAuthException" : "GraphMethodException");
+  json_builder_set_member_name (builder, "code");
+  json_builder_add_int_value (builder, code);
+  json_builder_end_object (builder);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  g_object_unref (builder);
+
+  return root;
+}
+
+static JsonNode*
+mock_user_new (MockServer *server)
+{
+  JsonBuilder *builder;
+  JsonNode *root;
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "id");
+  json_builder_add_string_value (builder, MOCK_USER_ID);
+  json_builder_set_member_name (builder, "name");
+  json_builder_add_string_value (builder, MOCK_USER_NAME);
+  json_builder_set_member_name (builder, "email");
+  json_builder_add_string_value (builder, MOCK_USER_EMAIL);
+  json_builder_set_member_name (builder, "link");
+  json_builder_add_string_value (builder, "https://www.facebook.com/" MOCK_USER_ID);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  g_object_unref (builder);
+
+  return root;
+}
+
+static void
+add_string_printf (JsonBuilder *builder,
+                   const gchar *member,
+                   const gchar *format,
+                   ...) G_GNUC_PRINTF (3, 4);
+
+static void
+add_string_printf (JsonBuilder *builder,
+                   const gchar *member,
+                   const gchar *format,
+                   ...)
+{
+  va_list args;
+  gchar *value;
+
+  va_start (args, format);
+  value = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  json_builder_set_member_name (builder, member);
+  json_builder_add_string_value (builder, value);
+  g_free (value);
+}
+
+/* Called with the mutex held */
+static gint64
+get_updated_time (MockServer *server,
+                  guint       id)
+{
+  gint64 *updated_time;
+
+  updated_time = g_hash_table_lookup (server->updated_times, GUINT_TO_POINTER (id));
+
+  return updated_time != NULL ? *updated_time : DEFAULT_UPDATED_TIME;
+}
+
+/* The albums were created in January 2013, and the photos in February */
+static gint64
+get_created_time (guint id)
+{
+  GDateTime *date_time;
+  gint64 created_time;
+
+  date_time = g_date_time_new_utc (2013, id >= MOCK_PHOTO_ID_BASE ? 2 : 1, id % 28 + 1, 10, 0, 0);
+  created_time = g_date_time_to_unix (date_time);
+  g_date_time_unref (date_time);
+
+  return created_time;
+}
+
+static void
+add_created_time (JsonBuilder *builder,
+                  guint        id)
+{
+  GDateTime *date_time;
+  gchar *value;
+
+  date_time = g_date_time_new_from_unix_utc (get_created_time (id));
+  value = g_date_time_format (date_time, "%Y-%m-%dT%H:%M:%S+0000");
+  json_builder_set_member_name (builder, "created_time");
+  json_builder_add_string_value (builder, value);
+  g_free (value);
+  g_date_time_unref (date_time);
+}
+
+static void
+add_updated_time (MockServer  *server,
+                  JsonBuilder *builder,
+                  guint        id)
+{
+  GDateTime *date_time;
+  gchar *value;
+
+  date_time = g_date_time_new_from_unix_utc (get_updated_time (server, id));
+  value = g_date_time_format (date_time, "%Y-%m-%dT%H:%M:%S+0000");
+  json_builder_set_member_name (builder, "updated_time");
+  json_builder_add_string_value (builder, value);
+  g_free (value);
+  g_date_time_unref (date_time);
+}
+
+static JsonNode*
+mock_album_new (MockServer *server,
+                guint       album_id)
+{
+  JsonBuilder *builder;
+  JsonNode *root;
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  add_string_printf (builder, "id", "%u", album_id);
+  add_string_printf (builder, "name", "Album %u", album_id - MOCK_ALBUM_ID_BASE);
+  add_string_printf (builder, "description", "The album number %u", album_id - MOCK_ALBUM_ID_BASE);
+  add_string_printf (builder, "cover_photo", "%u", MOCK_PHOTO_ID_BASE);
+  json_builder_set_member_name (builder, "count");
+  json_builder_add_int_value (builder, server->n_photos);
+  add_created_time (builder, album_id);
+  add_updated_time (server, builder, album_id);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  g_object_unref (builder);
+
+  return root;
+}
+
+static JsonNode*
+mock_photo_new (MockServer *server,
+                guint       photo_id)
+{
+  JsonBuilder *builder;
+  JsonNode *root;
+  guint i;
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  add_string_printf (builder, "id", "%u", photo_id);
+  add_string_printf (builder, "name", "Photo %u", photo_id - MOCK_PHOTO_ID_BASE);
+  add_string_printf (builder, "source", "%s/media/%u-960.jpg", server->endpoint, photo_id);
+  json_builder_set_member_name (builder, "width");
+  json_builder_add_int_value (builder, 960);
+  json_builder_set_member_name (builder, "height");
+  json_builder_add_int_value (builder, 720);
+  json_builder_set_member_name (builder, "images");
+  json_builder_begin_array (builder);
+  /* From 2048 pixels wide down */
+  for (i = 0; i < server->n_images; i++) {
+    guint width = 2048 - i * (2048 / server->n_images);
+
+    json_builder_begin_object (builder);
+    add_string_printf (builder, "source", "%s/media/%u-%u.jpg", server->endpoint, photo_id, width);
+    json_builder_set_member_name (builder, "width");
+    json_builder_add_int_value (builder, width);
+    json_builder_set_member_name (builder, "height");
+    json_builder_add_int_value (builder, width * 3 / 4);
+    json_builder_end_object (builder);
+  }
+  json_builder_end_array (builder);
+  add_created_time (builder, photo_id);
+  add_updated_time (server, builder, photo_id);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  g_object_unref (builder);
+
+  return root;
+}
+
+/* Returns the node with @id, or %NULL if it doesn't exist. Called with the mutex held. */
+static JsonNode*
+mock_node_new (MockServer  *server,
+               const gchar *id)
+{
+  gchar *end;
+  guint64 number;
+
+  if (g_strcmp0 (id, "me") == 0 || g_strcmp0 (id, MOCK_USER_ID) == 0)
+    return mock_user_new (server);
+
+  number = g_ascii_strtoull (id, &end, 10);
+  if (*id == '\0' || *end != '\0')
+    return NULL;
+
+  if (number >= MOCK_ALBUM_ID_BASE && number < MOCK_ALBUM_ID_BASE + server->n_albums)
+    return mock_album_new (server, number);
+  if (number >= MOCK_ALBUM_ID_BASE && number < server->next_album_id)
+    return mock_album_new (server, number);
+  if (number >= MOCK_PHOTO_ID_BASE && number < MOCK_PHOTO_ID_BASE + server->n_photos)
+    return mock_photo_new (server, number);
+
+  return NULL;
+}
+
+/* Removes the members of @node not in the comma separated @fields */
+static void
+apply_fields (JsonNode    *node,
+              const gchar *fields)
+{
+  JsonObject *object;
+  GList *members;
+  GList *l;
+  gchar **field_names;
+
+  if (fields == NULL || !JSON_NODE_HOLDS_OBJECT (node))
+    return;
+
+  object = json_node_get_object (node);
+  field_names = g_strsplit (fields, ",", -1);
+
+  members = json_object_get_members (object);
+  for (l = members; l != NULL; l = l->next) {
+    if (g_strcmp0 (l->data, "id") != 0 && !g_strv_contains ((const gchar * const *) field_names, l->data))
+      json_object_remove_member (object, l->data);
+  }
+  g_list_free (members);
+
+  g_strfreev (field_names);
+}
+
+static JsonNode*
+mock_page_new (MockServer  *server,
+               const gchar *path,
+               guint        base_id,
+               guint        n_nodes,
+               GHashTable  *params)
+{
+  JsonBuilder *builder;
+  JsonNode *root;
+  GArray *ids;
+  const gchar *value;
+  const gchar *fields;
+  gchar *since_param = NULL;
+  gint64 since = 0;
+  guint limit = server->page_limit;
+  guint offset = 0;
+  guint i;
+
+  value = params != NULL ? g_hash_table_lookup (params, "limit") : NULL;
+  if (value != NULL && atoi (value) > 0)
+    limit = atoi (value);
+
+  /* Only the nodes created since then, like the Graph API does for albums
+   * and photos. The cursors are offsets in that list. */
+  value = params != NULL ? g_hash_table_lookup (params, "since") : NULL;
+  if (value != NULL) {
+    since = g_ascii_strtoll (value, NULL, 10);
+    since_param = g_strdup_printf ("&since=%s", value);
+  }
+
+  ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  for (i = 0; i < n_nodes; i++) {
+    guint id = base_id + i;
+
+    if (get_created_time (id) >= since)
+      g_array_append_val (ids, id);
+  }
+  n_nodes = ids->len;
+
+  /* The cursors are opaque for the clients, here they're just the offset */
+  value = params != NULL ? g_hash_table_lookup (params, "after") : NULL;
+  if (value != NULL && g_str_has_prefix (value, "cursor-"))
+    offset = MIN (n_nodes, (guint) atoi (value + strlen ("cursor-")));
+
+  fields = params != NULL ? g_hash_table_lookup (params, "fields") : NULL;
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "data");
+  json_builder_begin_array (builder);
+  for (i = offset; i < MIN (n_nodes, offset + limit); i++) {
+    JsonNode *node;
+
+    guint id = g_array_index (ids, guint, i);
+
+    node = base_id == MOCK_ALBUM_ID_BASE ? mock_album_new (server, id) : mock_photo_new (server, id);
+    apply_fields (node, fields);
+    json_builder_add_value (builder, node);
+  }
+  json_builder_end_array (builder);
+
+  json_builder_set_member_name (builder, "paging");
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "cursors");
+  json_builder_begin_object (builder);
+  add_string_printf (builder, "before", "cursor-%u", offset);
+  add_string_printf (builder, "after", "cursor-%u", MIN (n_nodes, offset + limit));
+  json_builder_end_object (builder);
+  if (offset + limit < n_nodes)
+    add_string_printf (builder, "next", "%s/%s?limit=%u&after=cursor-%u%s", server->endpoint, path, limit, offset + limit,
+                       since_param != NULL ? since_param : "");
+  json_builder_end_object (builder);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  g_object_unref (builder);
+  g_array_unref (ids);
+  g_free (since_param);
+
+  return root;
+}
+
+/* Strips the leading slash and API version of @path */
+static const gchar*
+normalize_path (const gchar *path)
+{
+  while (*path == '/')
+    path++;
+
+  if (path[0] == 'v' && g_ascii_isdigit (path[1])) {
+    const gchar *slash = strchr (path, '/');
+
+    path = slash != NULL ? slash + 1 : "";
+  }
+
+  return path;
+}
+
+/* Handles a Graph API GET request. Called with the mutex held. */
+static guint
+mock_server_get (MockServer  *server,
+                 const gchar *path,
+                 GHashTable  *params,
+                 JsonNode   **root)
+{
+  const gchar *fields;
+  gchar **parts;
+  guint status = SOUP_STATUS_OK;
+
+  fields = params != NULL ? g_hash_table_lookup (params, "fields") : NULL;
+
+  /* The tokens of the apps used by gtestutils */
+  if (g_strcmp0 (path, "oauth/access_token") == 0) {
+    JsonObject *object = json_object_new ();
+
+    json_object_set_string_member (object, "access_token", "mock-app-token");
+    json_object_set_string_member (object, "token_type", "bearer");
+    *root = json_node_new (JSON_NODE_OBJECT);
+    json_node_take_object (*root, object);
+    return status;
+  }
+
+  if (*path == '\0') {
+    const gchar *ids = params != NULL ? g_hash_table_lookup (params, "ids") : NULL;
+    JsonObject *object;
+    gchar **id_list;
+    guint i;
+
+    if (ids == NULL) {
+      *root = mock_error_new (100, "(#100) Missing the ids parameter");
+      return SOUP_STATUS_BAD_REQUEST;
+    }
+
+    object = json_object_new ();
+    id_list = g_strsplit (ids, ",", -1);
+    for (i = 0; id_list[i] != NULL; i++) {
+      JsonNode *node = mock_node_new (server, id_list[i]);
+
+      if (node == NULL) {
+        json_object_unref (object);
+        g_strfreev (id_list);
+        *root = mock_error_new (803, "(#803) Some of the aliases you requested do not exist");
+        return SOUP_STATUS_NOT_FOUND;
+      }
+      apply_fields (node, fields);
+      json_object_set_member (object, id_list[i], node);
+    }
+    g_strfreev (id_list);
+
+    *root = json_node_new (JSON_NODE_OBJECT);
+    json_node_take_object (*root, object);
+    return status;
+  }
+
+  parts = g_strsplit (path, "/", 2);
+  if (parts[1] == NULL) {
+    *root = mock_node_new (server, parts[0]);
+    apply_fields (*root, fields);
+  } else if (g_strcmp0 (parts[1], "albums") == 0 &&
+             (g_strcmp0 (parts[0], "me") == 0 || g_strcmp0 (parts[0], MOCK_USER_ID) == 0)) {
+    *root = mock_page_new (server, path, MOCK_ALBUM_ID_BASE, server->n_albums, params);
+  } else if (g_strcmp0 (parts[1], "photos") == 0 && (*root = mock_node_new (server, parts[0])) != NULL) {
+    /* Every album, and the user, have the same photos */
+    json_node_free (*root);
+    *root = mock_page_new (server, path, MOCK_PHOTO_ID_BASE, server->n_photos, params);
+  } else {
+    *root = NULL;
+  }
+  g_strfreev (parts);
+
+  if (*root == NULL) {
+    *root = mock_error_new (803, "(#803) Some of the aliases you requested do not exist");
+    status = SOUP_STATUS_NOT_FOUND;
+  }
+
+  return status;
+}
+
+static guint mock_server_post (MockServer  *server,
+                               const gchar *path,
+                               GHashTable  *params,
+                               JsonNode   **root);
+
+/* Splits a relative URL of a batch request into its path and params */
+static GHashTable*
+parse_relative_url (const gchar  *relative_url,
+                    gchar       **path)
+{
+  const gchar *query;
+
+  relative_url = normalize_path (relative_url);
+  query = strchr (relative_url, '?');
+  if (query == NULL) {
+    *path = g_strdup (relative_url);
+    return NULL;
+  }
+
+  *path = g_strndup (relative_url, query - relative_url);
+
+  return soup_form_decode (query + 1);
+}
+
+static JsonNode*
+mock_batch_new (MockServer  *server,
+                const gchar *batch)
+{
+  JsonParser *jparser;
+  JsonArray *requests;
+  JsonBuilder *builder;
+  JsonNode *root;
+  guint i;
+
+  jparser = json_parser_new ();
+  if (!json_parser_load_from_data (jparser, batch, -1, NULL) ||
+      !JSON_NODE_HOLDS_ARRAY (json_parser_get_root (jparser))) {
+    g_object_unref (jparser);
+    return NULL;
+  }
+  requests = json_node_get_array (json_parser_get_root (jparser));
+
+  builder = json_builder_new ();
+  json_builder_begin_array (builder);
+  for (i = 0; i < json_array_get_length (requests); i++) {
+    JsonObject *request = json_array_get_object_element (requests, i);
+    const gchar *method;
+    JsonNode *response = NULL;
+    JsonGenerator *generator;
+    GHashTable *params;
+    gchar *path;
+    gchar *body;
+    guint status;
+
+    method = json_object_has_member (request, "method") ? json_object_get_string_member (request, "method") : "GET";
+    params = parse_relative_url (json_object_get_string_member (request, "relative_url"), &path);
+
+    if (g_strcmp0 (method, "POST") == 0) {
+      if (params == NULL && json_object_has_member (request, "body"))
+        params = soup_form_decode (json_object_get_string_member (request, "body"));
+      status = mock_server_post (server, path, params, &response);
+    } else {
+      status = mock_server_get (server, path, params, &response);
+    }
+
+    generator = json_generator_new ();
+    json_generator_set_root (generator, response);
+    body = json_generator_to_data (generator, NULL);
+    g_object_unref (generator);
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "code");
+    json_builder_add_int_value (builder, status);
+    json_builder_set_member_name (builder, "body");
+    json_builder_add_string_value (builder, body);
+    json_builder_end_object (builder);
+
+    g_free (body);
+    g_free (path);
+    json_node_free (response);
+    g_clear_pointer (&params, g_hash_table_unref);
+  }
+  json_builder_end_array (builder);
+
+  root = json_builder_get_root (builder);
+  g_object_unref (builder);
+  g_object_unref (jparser);
+
+  return root;
+}
+
+/* Handles a Graph API POST request. Called with the mutex held. */
+static guint
+mock_server_post (MockServer  *server,
+                  const gchar *path,
+                  GHashTable  *params,
+                  JsonNode   **root)
+{
+  JsonObject *object;
+  const gchar *batch;
+
+  batch = params != NULL ? g_hash_table_lookup (params, "batch") : NULL;
+  if (*path == '\0' && batch != NULL) {
+    *root = mock_batch_new (server, batch);
+    if (*root == NULL) {
+      *root = mock_error_new (100, "(#100) The batch parameter must be a JSON array");
+      return SOUP_STATUS_BAD_REQUEST;
+    }
+    return SOUP_STATUS_OK;
+  }
+
+  object = json_object_new ();
+  if (g_str_has_suffix (path, "/accounts/test-users")) {
+    /* The members are read by position in gtestutils */
+    json_object_set_string_member (object, "id", MOCK_USER_ID);
+    json_object_set_string_member (object, "access_token", "mock-user-token");
+    json_object_set_string_member (object, "login_url", "https://www.facebook.com/login");
+    json_object_set_string_member (object, "email", MOCK_USER_EMAIL);
+    json_object_set_string_member (object, "password", "mock-password");
+  } else if (g_str_has_suffix (path, "/albums")) {
+    gchar *id;
+
+    id = g_strdup_printf ("%u", server->next_album_id++);
+    json_object_set_string_member (object, "id", id);
+    g_free (id);
+  } else {
+    json_object_unref (object);
+    *root = mock_error_new (100, "(#100) Unsupported post request");
+    return SOUP_STATUS_BAD_REQUEST;
+  }
+
+  *root = json_node_new (JSON_NODE_OBJECT);
+  json_node_take_object (*root, object);
+
+  return SOUP_STATUS_OK;
+}
+
+static void
+mock_server_respond (MockServer  *server,
+                     SoupMessage *msg,
+                     guint        status,
+                     JsonNode    *root)
+{
+  JsonGenerator *generator;
+  gchar *usage;
+  gchar *body;
+  gsize length;
+
+  generator = json_generator_new ();
+  json_generator_set_root (generator, root);
+  body = json_generator_to_data (generator, &length);
+  g_object_unref (generator);
+
+  usage = g_strdup_printf ("{\"call_count\":%u,\"total_time\":%u,\"total_cputime\":%u}",
+                           server->usage, server->usage / 2, server->usage / 2);
+  soup_message_headers_replace (msg->response_headers, "X-App-Usage", usage);
+  g_free (usage);
+
+  /* The nodes are only validated by their content, as the Graph API does */
+  if (msg->method == SOUP_METHOD_GET && status == SOUP_STATUS_OK) {
+    gchar *hash;
+    gchar *etag;
+
+    hash = g_compute_checksum_for_data (G_CHECKSUM_MD5, (const guchar *) body, length);
+    etag = g_strdup_printf ("\"%s\"", hash);
+    soup_message_headers_replace (msg->response_headers, "ETag", etag);
+
+    if (g_strcmp0 (soup_message_headers_get_one (msg->request_headers, "If-None-Match"), etag) == 0) {
+      server->n_not_modified++;
+      soup_message_set_status (msg, SOUP_STATUS_NOT_MODIFIED);
+      g_free (etag);
+      g_free (hash);
+      g_free (body);
+      return;
+    }
+
+    g_free (etag);
+    g_free (hash);
+  }
+
+  soup_message_set_status (msg, status);
+  soup_message_set_response (msg, "application/json", SOUP_MEMORY_TAKE, body, length);
+}
+
+static void
+mock_server_serve_media (MockServer  *server,
+                         SoupMessage *msg,
+                         const gchar *name)
+{
+  SoupRange *ranges;
+  const gchar *if_range;
+  guchar *data;
+  gchar *etag;
+  gboolean whole;
+  guint seed;
+  guint i;
+  gint n_ranges;
+
+  if (g_str_has_prefix (name, "missing")) {
+    soup_message_set_status (msg, SOUP_STATUS_NOT_FOUND);
+    soup_message_set_response (msg, "text/html", SOUP_MEMORY_STATIC, "Not Found", strlen ("Not Found"));
+    return;
+  }
+
+  /* The same bytes every time for the same image */
+  seed = g_str_hash (name);
+  data = g_malloc (MOCK_MEDIA_SIZE);
+  for (i = 0; i < MOCK_MEDIA_SIZE; i++)
+    data[i] = (seed + i * 31) & 0xff;
+
+  etag = g_strdup_printf ("\"%s\"", name);
+  soup_message_headers_replace (msg->response_headers, "ETag", etag);
+  if_range = soup_message_headers_get_one (msg->request_headers, "If-Range");
+  /* The whole image if the range is of another version of it */
+  whole = soup_message_headers_get_one (msg->request_headers, "Range") == NULL ||
+    (if_range != NULL && g_strcmp0 (if_range, etag) != 0);
+  g_free (etag);
+
+  if (whole) {
+    /* Not to have it served by the partial responses of SoupServer */
+    soup_message_headers_remove (msg->request_headers, "Range");
+    soup_message_set_status (msg, SOUP_STATUS_OK);
+    soup_message_set_response (msg, "image/jpeg", SOUP_MEMORY_TAKE, (gchar *) data, MOCK_MEDIA_SIZE);
+    return;
+  }
+
+  /* Only single ranges, like the ones used to resume a download */
+  if (!soup_message_headers_get_ranges (msg->request_headers, MOCK_MEDIA_SIZE, &ranges, &n_ranges)) {
+    soup_message_set_status (msg, SOUP_STATUS_REQUESTED_RANGE_NOT_SATISFIABLE);
+    soup_message_headers_set_content_range (msg->response_headers, -1, -1, MOCK_MEDIA_SIZE);
+    g_free (data);
+    return;
+  }
+
+  soup_message_set_status (msg, SOUP_STATUS_PARTIAL_CONTENT);
+  soup_message_headers_set_content_range (msg->response_headers, ranges[0].start, ranges[0].end, MOCK_MEDIA_SIZE);
+  soup_message_set_response (msg, "image/jpeg", SOUP_MEMORY_COPY, (gchar *) data + ranges[0].start,
+                             ranges[0].end - ranges[0].start + 1);
+  soup_message_headers_free_ranges (msg->request_headers, ranges);
+  g_free (data);
+}
+
+static void
+mock_server_handler (SoupServer        *soup_server,
+                     SoupMessage       *msg,
+                     const char        *request_path,
+                     GHashTable        *query,
+                     SoupClientContext *client,
+                     gpointer           user_data)
+{
+  MockServer *server = user_data;
+  GHashTable *params = NULL;
+  JsonNode *root = NULL;
+  const gchar *path;
+  guint status;
+
+  path = normalize_path (request_path);
+
+  g_mutex_lock (&server->mutex);
+  server->n_requests++;
+
+  if (g_str_has_prefix (path, "media/")) {
+    mock_server_serve_media (server, msg, path + strlen ("media/"));
+    g_mutex_unlock (&server->mutex);
+    return;
+  }
+
+  if (msg->method == SOUP_METHOD_POST && msg->request_body->length > 0) {
+    gchar *form;
+
+    form = g_strndup (msg->request_body->data, msg->request_body->length);
+    params = soup_form_decode (form);
+    g_free (form);
+  } else if (query != NULL) {
+    params = g_hash_table_ref (query);
+  }
+
+  if (server->n_failures > 0) {
+    server->n_failures--;
+    status = server->failure_status;
+    root = mock_error_new (server->failure_code, "Mock failure");
+  } else if (g_strcmp0 (path, "oauth/access_token") != 0 &&
+             (params == NULL || g_hash_table_lookup (params, "access_token") == NULL)) {
+    status = SOUP_STATUS_BAD_REQUEST;
+    root = mock_error_new (190, "An active access token must be used");
+  } else if (msg->method == SOUP_METHOD_POST) {
+    status = mock_server_post (server, path, params, &root);
+  } else if (msg->method == SOUP_METHOD_DELETE) {
+    JsonObject *object = json_object_new ();
+
+    json_object_set_boolean_member (object, "success", TRUE);
+    root = json_node_new (JSON_NODE_OBJECT);
+    json_node_take_object (root, object);
+    status = SOUP_STATUS_OK;
+  } else {
+    status = mock_server_get (server, path, params, &root);
+  }
+
+  mock_server_respond (server, msg, status, root);
+  g_mutex_unlock (&server->mutex);
+
+  json_node_free (root);
+  g_clear_pointer (&params, g_hash_table_unref);
+}
+
+static gpointer
+mock_server_thread (gpointer user_data)
+{
+  MockServer *server = user_data;
+
+  g_main_context_push_thread_default (server->context);
+  g_main_loop_run (server->loop);
+  g_main_context_pop_thread_default (server->context);
+
+  return NULL;
+}
+
+/*
+ * mock_server_new:
+ *
+ * Starts a mock Graph API server listening on a random port of the loopback
+ * interface. Its endpoint can be set in the GFBGRAPH_ENDPOINT environment
+ * variable before the library is used.
+ *
+ * Returns: a new #MockServer, free it with mock_server_free().
+ */
+MockServer*
+mock_server_new (void)
+{
+  MockServer *server;
+  GSList *uris;
+  gchar *uri;
+  GError *error = NULL;
+
+  server = g_new0 (MockServer, 1);
+  g_mutex_init (&server->mutex);
+  server->n_albums = DEFAULT_N_ALBUMS;
+  server->n_photos = DEFAULT_N_PHOTOS;
+  server->n_images = DEFAULT_N_IMAGES;
+  server->page_limit = DEFAULT_PAGE_LIMIT;
+  server->next_album_id = MOCK_ALBUM_ID_BASE + 50000;
+  server->updated_times = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+  server->context = g_main_context_new ();
+  server->loop = g_main_loop_new (server->context, FALSE);
+
+  /* The listening socket is attached to the thread-default context */
+  g_main_context_push_thread_default (server->context);
+  server->soup_server = soup_server_new (SOUP_SERVER_SERVER_HEADER, "gfbgraph-mock-server", NULL);
+  soup_server_add_handler (server->soup_server, NULL, mock_server_handler, server, NULL);
+  soup_server_listen_local (server->soup_server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error);
+  g_assert_no_error (error);
+  g_main_context_pop_thread_default (server->context);
+
+  uris = soup_server_get_uris (server->soup_server);
+  uri = soup_uri_to_string (uris->data, FALSE);
+  /* Without the trailing slash */
+  if (g_str_has_suffix (uri, "/"))
+    uri[strlen (uri) - 1] = '\0';
+  server->endpoint = uri;
+  g_slist_free_full (uris, (GDestroyNotify) soup_uri_free);
+
+  server->thread = g_thread_new ("mock-server", mock_server_thread, server);
+
+  return server;
+}
+
+void
+mock_server_free (MockServer *server)
+{
+  g_main_loop_quit (server->loop);
+  g_thread_join (server->thread);
+
+  g_main_context_push_thread_default (server->context);
+  soup_server_disconnect (server->soup_server);
+  g_object_unref (server->soup_server);
+  g_main_context_pop_thread_default (server->context);
+
+  g_main_loop_unref (server->loop);
+  g_main_context_unref (server->context);
+  g_mutex_clear (&server->mutex);
+  g_hash_table_unref (server->updated_times);
+  g_free (server->endpoint);
+
+  g_free (server);
+}
+
+/*
+ * mock_server_get_endpoint:
+ *
+ * Returns: the base URL of the server, like "http://127.0.0.1:41234".
+ */
+const gchar*
+mock_server_get_endpoint (MockServer *server)
+{
+  return server->endpoint;
+}
+
+void
+mock_server_set_n_albums (MockServer *server,
+                          guint       n_albums)
+{
+  g_mutex_lock (&server->mutex);
+  server->n_albums = n_albums;
+  g_mutex_unlock (&server->mutex);
+}
+
+/*
+ * mock_server_touch_node:
+ * @id: the ID of an album or a photo.
+ *
+ * Sets the "updated_time" of the node @id to the current time.
+ */
+void
+mock_server_touch_node (MockServer *server,
+                        guint       id)
+{
+  gint64 *updated_time;
+
+  updated_time = g_new (gint64, 1);
+  *updated_time = g_get_real_time () / G_USEC_PER_SEC;
+
+  g_mutex_lock (&server->mutex);
+  g_hash_table_insert (server->updated_times, GUINT_TO_POINTER (id), updated_time);
+  g_mutex_unlock (&server->mutex);
+}
+
+void
+mock_server_set_n_photos (MockServer *server,
+                          guint       n_photos)
+{
+  g_mutex_lock (&server->mutex);
+  server->n_photos = n_photos;
+  g_mutex_unlock (&server->mutex);
+}
+
+/*
+ * mock_server_set_n_images:
+ * @n_images: the number of sizes in the "images" of every photo.
+ */
+void
+mock_server_set_n_images (MockServer *server,
+                          guint       n_images)
+{
+  g_mutex_lock (&server->mutex);
+  server->n_images = MAX (1, n_images);
+  g_mutex_unlock (&server->mutex);
+}
+
+/*
+ * mock_server_set_page_limit:
+ * @limit: the size of the connection pages when the request has no "limit".
+ */
+void
+mock_server_set_page_limit (MockServer *server,
+                            guint       limit)
+{
+  g_mutex_lock (&server->mutex);
+  server->page_limit = MAX (1, limit);
+  g_mutex_unlock (&server->mutex);
+}
+
+/*
+ * mock_server_set_usage:
+ * @percentage: the "call_count" reported in the X-App-Usage header.
+ */
+void
+mock_server_set_usage (MockServer *server,
+                       guint       percentage)
+{
+  g_mutex_lock (&server->mutex);
+  server->usage = percentage;
+  g_mutex_unlock (&server->mutex);
+}
+
+/*
+ * mock_server_fail_requests:
+ * @n_requests: the number of requests to fail.
+ * @status: the HTTP status of the failures.
+ * @code: the Graph API error code of the failures, like 4 for a throttled app.
+ *
+ * Makes the next @n_requests requests, of any kind, fail.
+ */
+void
+mock_server_fail_requests (MockServer *server,
+                           guint       n_requests,
+                           guint       status,
+                           gint        code)
+{
+  g_mutex_lock (&server->mutex);
+  server->n_failures = n_requests;
+  server->failure_status = status;
+  server->failure_code = code;
+  g_mutex_unlock (&server->mutex);
+}
+
+/*
+ * mock_server_get_n_requests:
+ *
+ * Returns: the number of requests received by the server.
+ */
+guint
+mock_server_get_n_requests (MockServer *server)
+{
+  guint n_requests;
+
+  g_mutex_lock (&server->mutex);
+  n_requests = server->n_requests;
+  g_mutex_unlock (&server->mutex);
+
+  return n_requests;
+}
+
+/*
+ * mock_server_get_n_not_modified:
+ *
+ * Returns: the number of requests answered with 304 Not Modified, because
+ * their If-None-Match header matched the ETag of the response.
+ */
+guint
+mock_server_get_n_not_modified (MockServer *server)
+{
+  guint n_not_modified;
+
+  g_mutex_lock (&server->mutex);
+  n_not_modified = server->n_not_modified;
+  g_mutex_unlock (&server->mutex);
+
+  return n_not_modified;
+}
@@ -0,0 +1,65 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MOCK_SERVER_H__
+#define __MOCK_SERVER_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* The nodes served by the mock Graph API. The user "me" has the albums
+ * MOCK_ALBUM_ID_BASE + i, and every album the photos MOCK_PHOTO_ID_BASE + i. */
+#define MOCK_USER_ID        "100"
+#define MOCK_USER_NAME      "Mock User"
+#define MOCK_USER_EMAIL     "mock@example.org"
+#define MOCK_ALBUM_ID_BASE  200000
+#define MOCK_PHOTO_ID_BASE  300000
+#define MOCK_MEDIA_SIZE     (64 * 1024)
+
+typedef struct _MockServer MockServer;
+
+MockServer*  mock_server_new            (void);
+void         mock_server_free           (MockServer  *server);
+
+const gchar* mock_server_get_endpoint   (MockServer  *server);
+
+void         mock_server_set_n_albums   (MockServer  *server,
+                                         guint        n_albums);
+void         mock_server_set_n_photos   (MockServer  *server,
+                                         guint        n_photos);
+void         mock_server_set_n_images   (MockServer  *server,
+                                         guint        n_images);
+void         mock_server_touch_node     (MockServer  *server,
+                                         guint        id);
+void         mock_server_set_page_limit (MockServer  *server,
+                                         guint        limit);
+void         mock_server_set_usage      (MockServer  *server,
+                                         guint        percentage);
+void         mock_server_fail_requests  (MockServer  *server,
+                                         guint        n_requests,
+                                         guint        status,
+                                         gint         code);
+
+guint        mock_server_get_n_requests     (MockServer  *server);
+guint        mock_server_get_n_not_modified (MockServer  *server);
+
+G_END_DECLS
+
+#endif /* __MOCK_SERVER_H__ */
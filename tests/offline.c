@@ -0,0 +1,1754 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Tests of the Graph API functions against the mock server, they don't need
+ * credentials nor network access.
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <gfbgraph/gfbgraph.h>
+#include <gfbgraph/gfbgraph-common.h>
+#include <gfbgraph/gfbgraph-simple-authorizer.h>
+/* For the token slot of OfflineAuthorizer */
+#include <gfbgraph/gfbgraph-private.h>
+
+#include "mock-server.h"
+#include "test-store.h"
+
+typedef struct
+{
+  GFBGraphSimpleAuthorizer *authorizer;
+} OfflineFixture;
+
+static MockServer *server = NULL;
+
+/* An authorizer whose refreshes take a while and are counted, to test the
+ * requests rejected at the same time with an expired token */
+typedef struct
+{
+  GObject           parent;
+  GFBGraphTokenSlot slot;
+  gint              n_refreshes;
+} OfflineAuthorizer;
+
+typedef struct
+{
+  GObjectClass parent_class;
+} OfflineAuthorizerClass;
+
+static GType offline_authorizer_get_type (void);
+static void  offline_authorizer_iface_init (GFBGraphAuthorizerInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (OfflineAuthorizer, offline_authorizer, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GFBGRAPH_TYPE_AUTHORIZER, offline_authorizer_iface_init))
+
+static void
+offline_authorizer_finalize (GObject *object)
+{
+  gfbgraph_token_slot_clear (&((OfflineAuthorizer *) object)->slot);
+
+  G_OBJECT_CLASS (offline_authorizer_parent_class)->finalize (object);
+}
+
+static void
+offline_authorizer_class_init (OfflineAuthorizerClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = offline_authorizer_finalize;
+}
+
+static void
+offline_authorizer_init (OfflineAuthorizer *authorizer)
+{
+  gfbgraph_token_slot_init (&authorizer->slot);
+  gfbgraph_token_slot_publish (&authorizer->slot, gfbgraph_token_new ("mock-expired-token"));
+}
+
+static void
+offline_authorizer_process_call (GFBGraphAuthorizer *iface,
+                                 RestProxyCall      *call)
+{
+  GFBGraphToken *token;
+
+  token = gfbgraph_token_slot_get (&((OfflineAuthorizer *) iface)->slot);
+  rest_proxy_call_add_param (call, "access_token", token->access_token);
+  gfbgraph_token_unref (token);
+}
+
+static void
+offline_authorizer_process_message (GFBGraphAuthorizer *iface,
+                                    SoupMessage        *message)
+{
+}
+
+static GFBGraphToken*
+offline_authorizer_get_token (OfflineAuthorizer  *authorizer,
+                              GCancellable       *cancellable,
+                              GError            **error)
+{
+  GFBGraphToken *token;
+  gchar *access_token;
+  gint n_refreshes;
+
+  /* Long enough for the other rejected requests to wait for it */
+  g_usleep (G_USEC_PER_SEC / 5);
+
+  n_refreshes = g_atomic_int_add (&authorizer->n_refreshes, 1) + 1;
+  access_token = g_strdup_printf ("mock-refreshed-token-%d", n_refreshes);
+  token = gfbgraph_token_new (access_token);
+  g_free (access_token);
+
+  return token;
+}
+
+static gboolean
+offline_authorizer_refresh_authorization (GFBGraphAuthorizer  *iface,
+                                          GCancellable        *cancellable,
+                                          GError             **error)
+{
+  return gfbgraph_token_slot_refresh (&((OfflineAuthorizer *) iface)->slot,
+                                      (GFBGraphTokenRefreshFunc) offline_authorizer_get_token, iface,
+                                      cancellable, error);
+}
+
+static gchar*
+offline_authorizer_get_identity (GFBGraphAuthorizer *iface,
+                                 RestProxyCall      *call)
+{
+  return g_strdup ("mock-user");
+}
+
+static void
+offline_authorizer_iface_init (GFBGraphAuthorizerInterface *iface)
+{
+  iface->process_call = offline_authorizer_process_call;
+  iface->process_message = offline_authorizer_process_message;
+  iface->refresh_authorization = offline_authorizer_refresh_authorization;
+  iface->get_identity = offline_authorizer_get_identity;
+}
+
+/* A node type without its own deserialize_member, so it's filled through its
+ * properties, to compare with the nodes of the library */
+typedef struct
+{
+  GFBGraphNode  parent;
+  gchar        *name;
+  guint         count;
+} OfflineNode;
+
+typedef struct
+{
+  GFBGraphNodeClass parent_class;
+} OfflineNodeClass;
+
+enum {
+  OFFLINE_NODE_PROP_0,
+  OFFLINE_NODE_PROP_NAME,
+  OFFLINE_NODE_PROP_COUNT
+};
+
+static GType offline_node_get_type (void);
+
+G_DEFINE_TYPE (OfflineNode, offline_node, GFBGRAPH_TYPE_NODE)
+
+static void
+offline_node_finalize (GObject *object)
+{
+  g_free (((OfflineNode *) object)->name);
+
+  G_OBJECT_CLASS (offline_node_parent_class)->finalize (object);
+}
+
+static void
+offline_node_set_property (GObject      *object,
+                           guint         prop_id,
+                           const GValue *value,
+                           GParamSpec   *pspec)
+{
+  OfflineNode *node = (OfflineNode *) object;
+
+  switch (prop_id)
+    {
+    case OFFLINE_NODE_PROP_NAME:
+      g_free (node->name);
+      node->name = g_value_dup_string (value);
+      break;
+
+    case OFFLINE_NODE_PROP_COUNT:
+      node->count = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+offline_node_get_property (GObject    *object,
+                           guint       prop_id,
+                           GValue     *value,
+                           GParamSpec *pspec)
+{
+  OfflineNode *node = (OfflineNode *) object;
+
+  switch (prop_id)
+    {
+    case OFFLINE_NODE_PROP_NAME:
+      g_value_set_string (value, node->name);
+      break;
+
+    case OFFLINE_NODE_PROP_COUNT:
+      g_value_set_uint (value, node->count);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+offline_node_class_init (OfflineNodeClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = offline_node_finalize;
+  gobject_class->set_property = offline_node_set_property;
+  gobject_class->get_property = offline_node_get_property;
+
+  g_object_class_install_property (gobject_class, OFFLINE_NODE_PROP_NAME,
+                                   g_param_spec_string ("name", "Name", "The node name",
+                                                        NULL, G_PARAM_READWRITE));
+  g_object_class_install_property (gobject_class, OFFLINE_NODE_PROP_COUNT,
+                                   g_param_spec_uint ("count", "Count", "The number of items",
+                                                      0, G_MAXUINT, 0, G_PARAM_READWRITE));
+}
+
+static void
+offline_node_init (OfflineNode *node)
+{
+}
+
+static void
+offline_fixture_setup (OfflineFixture *fixture,
+                       gconstpointer   user_data)
+{
+  fixture->authorizer = gfbgraph_simple_authorizer_new (user_data != NULL ? user_data : "mock-user-token");
+
+  mock_server_fail_requests (server, 0, 0, 0);
+  mock_server_set_usage (server, 0);
+}
+
+static void
+offline_fixture_teardown (OfflineFixture *fixture,
+                          gconstpointer   user_data)
+{
+  g_object_unref (fixture->authorizer);
+}
+
+static void
+test_offline_me (OfflineFixture *fixture,
+                 gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphUser) me = NULL;
+  GError *error = NULL;
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert (GFBGRAPH_IS_USER (me));
+
+  g_assert_cmpstr (gfbgraph_node_get_id (GFBGRAPH_NODE (me)), ==, MOCK_USER_ID);
+  g_assert_cmpstr (gfbgraph_user_get_name (me), ==, MOCK_USER_NAME);
+  g_assert_cmpstr (gfbgraph_user_get_email (me), ==, MOCK_USER_EMAIL);
+}
+
+static void
+test_offline_me_async_cb (GObject      *source_object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GFBGraphUser **me = user_data;
+  GError *error = NULL;
+
+  *me = gfbgraph_user_get_me_async_finish (GFBGRAPH_AUTHORIZER (source_object), result, &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_offline_me_async (OfflineFixture *fixture,
+                       gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphUser) me = NULL;
+
+  gfbgraph_user_get_me_async (GFBGRAPH_AUTHORIZER (fixture->authorizer), NULL, test_offline_me_async_cb, &me);
+  while (me == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpstr (gfbgraph_node_get_id (GFBGRAPH_NODE (me)), ==, MOCK_USER_ID);
+}
+
+static void
+test_offline_node_from_id (OfflineFixture *fixture,
+                           gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphNode) album = NULL;
+  g_autoptr (GFBGraphNode) photo = NULL;
+  GError *error = NULL;
+  gchar *id;
+
+  id = g_strdup_printf ("%u", MOCK_ALBUM_ID_BASE + 3);
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), id, GFBGRAPH_TYPE_ALBUM, &error);
+  g_free (id);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Album 3");
+
+  id = g_strdup_printf ("%u", MOCK_PHOTO_ID_BASE);
+  photo = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), id, GFBGRAPH_TYPE_PHOTO, &error);
+  g_free (id);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_length (gfbgraph_photo_get_images (GFBGRAPH_PHOTO (photo))), ==, 4);
+  g_assert_cmpuint (gfbgraph_photo_get_image_hires (GFBGRAPH_PHOTO (photo))->width, ==, 2048);
+}
+
+static void
+test_offline_node_from_ids (OfflineFixture *fixture,
+                            gconstpointer   user_data)
+{
+  GHashTable *nodes;
+  GPtrArray *ids;
+  GCancellable *cancellable;
+  GError *error = NULL;
+  guint n_requests;
+  guint i;
+
+  /* More than one chunk of ids */
+  ids = g_ptr_array_new_with_free_func (g_free);
+  for (i = 0; i < 60; i++)
+    g_ptr_array_add (ids, g_strdup_printf ("%u", MOCK_PHOTO_ID_BASE + i));
+  g_ptr_array_add (ids, NULL);
+
+  nodes = gfbgraph_node_new_from_ids (GFBGRAPH_AUTHORIZER (fixture->authorizer),
+                                      (const gchar * const *) ids->pdata,
+                                      GFBGRAPH_TYPE_PHOTO, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_hash_table_size (nodes), ==, 60);
+  g_assert (GFBGRAPH_IS_PHOTO (g_hash_table_lookup (nodes, g_ptr_array_index (ids, 59))));
+  g_hash_table_unref (nodes);
+
+  /* No chunk is requested once cancelled */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  n_requests = mock_server_get_n_requests (server);
+  nodes = gfbgraph_node_new_from_ids (GFBGRAPH_AUTHORIZER (fixture->authorizer),
+                                      (const gchar * const *) ids->pdata,
+                                      GFBGRAPH_TYPE_PHOTO, cancellable, &error);
+  g_assert_null (nodes);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&error);
+  g_assert_cmpuint (mock_server_get_n_requests (server), ==, n_requests);
+
+  g_object_unref (cancellable);
+  g_ptr_array_unref (ids);
+}
+
+static void
+test_offline_photo_images (OfflineFixture *fixture,
+                           gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphNode) album = NULL;
+  GFBGraphPhoto *photo;
+  GFBGraphPhoto *copy;
+  GPtrArray *images;
+  GList *photos;
+  GList *list;
+  GError *error = NULL;
+  guint i;
+
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200000", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  photos = gfbgraph_node_get_connection_nodes (album, GFBGRAPH_TYPE_PHOTO, GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+
+  /* The images are 2048x1536, 1536x1152, 1024x768 and 512x384, largest first */
+  photo = photos->data;
+  g_assert_cmpuint (((GFBGraphPhotoImage *) gfbgraph_photo_get_images (photo)->data)->width, ==, 2048);
+  g_assert_cmpuint (gfbgraph_photo_get_image_near_width (photo, 1100)->width, ==, 1024);
+  g_assert_cmpuint (gfbgraph_photo_get_image_near_width (photo, 4000)->width, ==, 2048);
+  g_assert_cmpuint (gfbgraph_photo_get_image_near_height (photo, 1000)->height, ==, 1152);
+  g_assert_cmpuint (gfbgraph_photo_get_image_near_height (photo, 0)->height, ==, 384);
+  g_assert_cmpuint (gfbgraph_photo_get_image_at_least (photo, 600, 200)->width, ==, 1024);
+  g_assert_cmpuint (gfbgraph_photo_get_image_at_least (photo, 600, 800)->width, ==, 1536);
+  g_assert_cmpuint (gfbgraph_photo_get_image_at_least (photo, 5000, 5000)->width, ==, 2048);
+  g_assert_cmpuint (gfbgraph_photo_get_image_best_fit (photo, 1536, 1000)->width, ==, 1024);
+  g_assert_cmpuint (gfbgraph_photo_get_image_best_fit (photo, 1536, 1152)->width, ==, 1536);
+  g_assert_cmpuint (gfbgraph_photo_get_image_best_fit (photo, 100, 100)->width, ==, 512);
+
+  /* The images of a photo can be set on another one, they're copied */
+  copy = gfbgraph_photo_new ();
+  g_object_get (photo, "images", &list, NULL);
+  g_object_set (copy, "images", list, NULL);
+  g_object_set (photo, "images", gfbgraph_photo_get_images (copy), NULL);
+  g_assert_cmpuint (g_list_length (gfbgraph_photo_get_images (copy)), ==, 4);
+  g_assert_cmpuint (gfbgraph_photo_get_image_near_width (copy, 1100)->width, ==, 1024);
+  g_assert_cmpstr (gfbgraph_photo_get_image_hires (copy)->source, ==,
+                   gfbgraph_photo_get_image_hires (photo)->source);
+  g_object_unref (copy);
+  g_assert_cmpuint (gfbgraph_photo_get_image_hires (photo)->width, ==, 2048);
+
+  images = gfbgraph_photo_select_images (photos, 300, 300, GFBGRAPH_PHOTO_IMAGE_AT_LEAST);
+  g_assert_cmpuint (images->len, ==, g_list_length (photos));
+  for (i = 0; i < images->len; i++)
+    g_assert_cmpuint (((GFBGraphPhotoImage *) g_ptr_array_index (images, i))->width, ==, 512);
+  g_ptr_array_unref (images);
+
+  g_list_free_full (photos, g_object_unref);
+}
+
+static void
+test_offline_connection_nodes (OfflineFixture *fixture,
+                               gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphUser) me = NULL;
+  GList *albums;
+  GError *error = NULL;
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+
+  /* Only the first page */
+  albums = gfbgraph_user_get_albums (me, GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_length (albums), ==, 25);
+  g_assert_cmpstr (gfbgraph_album_get_name (albums->data), ==, "Album 0");
+
+  /* Resolved once per type, without a request */
+  g_assert (gfbgraph_connectable_is_connectable_to (albums->data, GFBGRAPH_TYPE_USER));
+  g_assert (!gfbgraph_connectable_is_connectable_to (albums->data, GFBGRAPH_TYPE_ALBUM));
+  g_assert_cmpstr (gfbgraph_connectable_get_connection_path (albums->data, GFBGRAPH_TYPE_USER), ==, "albums");
+
+  g_assert_null (gfbgraph_node_get_connection_nodes (GFBGRAPH_NODE (me), GFBGRAPH_TYPE_PHOTO,
+                                                     GFBGRAPH_AUTHORIZER (fixture->authorizer), &error));
+  g_assert_error (error, GFBGRAPH_NODE_ERROR, GFBGRAPH_NODE_ERROR_NO_CONNECTABLE);
+  g_clear_error (&error);
+  g_assert_null (gfbgraph_node_get_connection_nodes (GFBGRAPH_NODE (me), GFBGRAPH_TYPE_USER,
+                                                     GFBGRAPH_AUTHORIZER (fixture->authorizer), &error));
+  g_assert_error (error, GFBGRAPH_NODE_ERROR, GFBGRAPH_NODE_ERROR_NO_CONNECTABLE);
+  g_clear_error (&error);
+
+  g_list_free_full (albums, g_object_unref);
+}
+
+static void
+test_offline_connection_iterator (OfflineFixture *fixture,
+                                  gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphUser) me = NULL;
+  g_autoptr (GFBGraphConnectionIterator) iterator = NULL;
+  guint n_albums = 0;
+  guint n_pages = 0;
+  GError *error = NULL;
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+
+  iterator = gfbgraph_connection_iterator_new (GFBGRAPH_NODE (me), GFBGRAPH_TYPE_ALBUM,
+                                               GFBGRAPH_AUTHORIZER (fixture->authorizer), 10);
+  while (!gfbgraph_connection_iterator_is_done (iterator)) {
+    GList *page;
+
+    page = gfbgraph_connection_iterator_next_page (iterator, NULL, &error);
+    g_assert_no_error (error);
+
+    n_albums += g_list_length (page);
+    n_pages++;
+    g_list_free_full (page, g_object_unref);
+  }
+
+  g_assert_cmpuint (n_albums, ==, 60);
+  g_assert_cmpuint (n_pages, ==, 6);
+}
+
+static void
+test_offline_connection_iterator_cancel (OfflineFixture *fixture,
+                                         gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphUser) me = NULL;
+  g_autoptr (GFBGraphConnectionIterator) iterator = NULL;
+  g_autoptr (GCancellable) cancellable = NULL;
+  GList *page;
+  guint n_albums = 0;
+  GError *error = NULL;
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+
+  iterator = gfbgraph_connection_iterator_new (GFBGRAPH_NODE (me), GFBGRAPH_TYPE_ALBUM,
+                                               GFBGRAPH_AUTHORIZER (fixture->authorizer), 10);
+
+  /* The second page is prefetched with the cancellable */
+  cancellable = g_cancellable_new ();
+  page = gfbgraph_connection_iterator_next_page (iterator, cancellable, &error);
+  g_assert_no_error (error);
+  n_albums += g_list_length (page);
+  g_list_free_full (page, g_object_unref);
+
+  g_cancellable_cancel (cancellable);
+  page = gfbgraph_connection_iterator_next_page (iterator, cancellable, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert (page == NULL);
+  g_clear_error (&error);
+
+  /* No page is lost, whether the prefetch was cancelled or not */
+  while (!gfbgraph_connection_iterator_is_done (iterator)) {
+    page = gfbgraph_connection_iterator_next_page (iterator, NULL, &error);
+    g_assert_no_error (error);
+    n_albums += g_list_length (page);
+    g_list_free_full (page, g_object_unref);
+  }
+
+  g_assert_cmpuint (n_albums, ==, 60);
+}
+
+static void
+test_offline_batch (OfflineFixture *fixture,
+                    gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphBatch) batch = NULL;
+  g_autoptr (GFBGraphUser) me = NULL;
+  g_autoptr (GFBGraphNode) album = NULL;
+  GList *albums;
+  guint album_index;
+  guint albums_index;
+  guint missing_index;
+  guint n_requests;
+  GError *error = NULL;
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+
+  batch = gfbgraph_batch_new (GFBGRAPH_AUTHORIZER (fixture->authorizer));
+  album_index = gfbgraph_batch_add_node (batch, "200001", GFBGRAPH_TYPE_ALBUM);
+  albums_index = gfbgraph_batch_add_connection (batch, GFBGRAPH_NODE (me), GFBGRAPH_TYPE_ALBUM);
+  missing_index = gfbgraph_batch_add_node (batch, "1", GFBGRAPH_TYPE_ALBUM);
+
+  g_assert (gfbgraph_batch_execute (batch, NULL, &error));
+  g_assert_no_error (error);
+
+  album = gfbgraph_batch_get_node (batch, album_index, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Album 1");
+
+  albums = gfbgraph_batch_get_connection_nodes (batch, albums_index, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_length (albums), ==, 25);
+  g_list_free_full (albums, g_object_unref);
+
+  /* A failed request doesn't fail the batch */
+  g_assert (!gfbgraph_batch_check_request (batch, missing_index, &error));
+  g_assert (error != NULL && error->domain == GFBGRAPH_API_ERROR);
+  g_clear_error (&error);
+  g_assert_null (gfbgraph_batch_get_node (batch, missing_index, &error));
+  g_assert (error != NULL && error->domain == GFBGRAPH_API_ERROR);
+  g_clear_error (&error);
+
+  /* A batch of GET requests is retried after a server error */
+  g_clear_object (&batch);
+  g_clear_object (&album);
+  batch = gfbgraph_batch_new (GFBGRAPH_AUTHORIZER (fixture->authorizer));
+  album_index = gfbgraph_batch_add_node (batch, "200001", GFBGRAPH_TYPE_ALBUM);
+  n_requests = mock_server_get_n_requests (server);
+  mock_server_fail_requests (server, 1, SOUP_STATUS_INTERNAL_SERVER_ERROR, GFBGRAPH_API_ERROR_SERVICE);
+
+  g_assert (gfbgraph_batch_execute (batch, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (mock_server_get_n_requests (server), ==, n_requests + 2);
+
+  album = gfbgraph_batch_get_node (batch, album_index, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Album 1");
+}
+
+static void
+test_offline_api_error (OfflineFixture *fixture,
+                        gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphNode) node = NULL;
+  GError *error = NULL;
+
+  node = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "1", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_null (node);
+  g_assert (error != NULL && error->domain == GFBGRAPH_API_ERROR);
+  g_assert_cmpint (error->code, ==, 803);
+  g_clear_error (&error);
+}
+
+static void
+test_offline_retry (OfflineFixture *fixture,
+                    gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphUser) me = NULL;
+  GError *error = NULL;
+  guint n_requests;
+
+  /* A transient error is retried */
+  n_requests = mock_server_get_n_requests (server);
+  mock_server_fail_requests (server, 1, SOUP_STATUS_INTERNAL_SERVER_ERROR, GFBGRAPH_API_ERROR_SERVICE);
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_node_get_id (GFBGRAPH_NODE (me)), ==, MOCK_USER_ID);
+  g_assert_cmpuint (mock_server_get_n_requests (server), ==, n_requests + 2);
+}
+
+static void
+test_offline_cache (OfflineFixture *fixture,
+                    gconstpointer   user_data)
+{
+  GFBGraphClient *client;
+  g_autoptr (GFBGraphMemoryCache) cache = NULL;
+  g_autoptr (GFBGraphNode) album = NULL;
+  GFBGraphAuthorizer *authorizer;
+  guint n_requests;
+  guint n_not_modified;
+  GError *error = NULL;
+
+  client = gfbgraph_client_get_default ();
+  cache = gfbgraph_memory_cache_new (1024 * 1024);
+  gfbgraph_client_set_cache (client, GFBGRAPH_CACHE (cache));
+
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200002", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_clear_object (&album);
+  g_assert_cmpuint (gfbgraph_memory_cache_get_size (cache), >, 0);
+
+  /* Without a TTL the cached response is revalidated with its ETag */
+  n_not_modified = mock_server_get_n_not_modified (server);
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200002", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Album 2");
+  g_assert_cmpuint (mock_server_get_n_not_modified (server), ==, n_not_modified + 1);
+  g_clear_object (&album);
+
+  /* Fresh responses don't need a request */
+  gfbgraph_client_set_cache_ttl (client, GFBGRAPH_TYPE_NODE, 60);
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200002", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_clear_object (&album);
+
+  n_requests = mock_server_get_n_requests (server);
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200002", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Album 2");
+  g_assert_cmpuint (mock_server_get_n_requests (server), ==, n_requests);
+  g_clear_object (&album);
+
+  gfbgraph_client_set_cache_ttl (client, GFBGRAPH_TYPE_NODE, 0);
+
+  /* The responses are keyed by the identity of the user, not by the token */
+  authorizer = g_object_new (offline_authorizer_get_type (), NULL);
+  album = gfbgraph_node_new_from_id (authorizer, "200001", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_clear_object (&album);
+
+  g_assert (gfbgraph_authorizer_refresh_authorization (authorizer, NULL, &error));
+  g_assert_no_error (error);
+  n_not_modified = mock_server_get_n_not_modified (server);
+  album = gfbgraph_node_new_from_id (authorizer, "200001", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (mock_server_get_n_not_modified (server), ==, n_not_modified + 1);
+  g_object_unref (authorizer);
+
+  gfbgraph_client_set_cache (client, NULL);
+}
+
+static void
+test_offline_node_store (OfflineFixture *fixture,
+                         gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphNodeStore) store = NULL;
+  g_autoptr (GFBGraphNode) album = NULL;
+  g_autoptr (GFBGraphNode) photo = NULL;
+  GList *photos;
+  GList *l;
+  TestStore test_store;
+  GError *error = NULL;
+
+  test_store_init (&test_store);
+
+  store = gfbgraph_node_store_new (test_store.path, &error);
+  g_assert_no_error (error);
+
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200001", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_assert (gfbgraph_node_store_add_node (store, album, &error));
+
+  photos = gfbgraph_node_get_connection_nodes (album, GFBGRAPH_TYPE_PHOTO, GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  for (l = photos; l != NULL; l = l->next) {
+    g_assert (gfbgraph_node_store_add_node (store, l->data, &error));
+    g_assert (gfbgraph_node_store_add_connection (store, album, l->data, &error));
+  }
+  g_assert (gfbgraph_node_store_flush (store, &error));
+  g_assert_no_error (error);
+
+  /* Appended after the index, recovered from the log when opened again */
+  gfbgraph_album_set_name (GFBGRAPH_ALBUM (album), "Renamed album");
+  g_assert (gfbgraph_node_store_add_node (store, album, &error));
+  g_assert_cmpuint (gfbgraph_node_store_get_n_nodes (store), ==, g_list_length (photos) + 1);
+  g_clear_object (&album);
+  g_clear_object (&store);
+
+  store = gfbgraph_node_store_new (test_store.path, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gfbgraph_node_store_get_n_nodes (store), ==, g_list_length (photos) + 1);
+
+  album = gfbgraph_node_store_get_node (store, "200001", &error);
+  g_assert_no_error (error);
+  g_assert (GFBGRAPH_IS_ALBUM (album));
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Renamed album");
+
+  photo = gfbgraph_node_store_get_node (store, gfbgraph_node_get_id (photos->data), &error);
+  g_assert_no_error (error);
+  g_assert (GFBGRAPH_IS_PHOTO (photo));
+  g_assert_cmpuint (g_list_length (gfbgraph_photo_get_images (GFBGRAPH_PHOTO (photo))), ==, 4);
+  g_list_free_full (photos, g_object_unref);
+
+  /* From the index and from the records appended after it */
+  g_assert (gfbgraph_node_store_is_up_to_date (store, gfbgraph_node_get_id (photo),
+                                               gfbgraph_node_get_updated_time (photo)));
+  g_assert (gfbgraph_node_store_is_up_to_date (store, "200001", gfbgraph_node_get_updated_time (album)));
+  g_assert (!gfbgraph_node_store_is_up_to_date (store, "200001", "2000-01-01T00:00:00+0000"));
+  g_assert (!gfbgraph_node_store_is_up_to_date (store, "1", NULL));
+
+  photos = gfbgraph_node_store_get_connection_nodes (store, album, GFBGRAPH_TYPE_PHOTO, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_list_length (photos), ==, 25);
+  g_list_free_full (photos, g_object_unref);
+
+  g_assert_null (gfbgraph_node_store_get_node (store, "1", &error));
+  g_assert_error (error, GFBGRAPH_NODE_STORE_ERROR, GFBGRAPH_NODE_STORE_ERROR_NOT_FOUND);
+  g_clear_error (&error);
+
+  g_clear_object (&store);
+  test_store_clear (&test_store);
+}
+
+static void
+test_offline_node_store_corrupt_tail (OfflineFixture *fixture,
+                                      gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphNodeStore) store = NULL;
+  g_autoptr (GFBGraphNode) album = NULL;
+  g_autoptr (GFBGraphNode) node = NULL;
+  gchar garbage[4096];
+  TestStore test_store;
+  FILE *log;
+  GError *error = NULL;
+
+  test_store_init (&test_store);
+
+  store = gfbgraph_node_store_new (test_store.path, &error);
+  g_assert_no_error (error);
+
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200001", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_assert (gfbgraph_node_store_add_node (store, album, &error));
+  g_clear_object (&store);
+
+  /* A write interrupted by a crash, larger than the record appended later */
+  memset (garbage, 0xff, sizeof (garbage));
+  log = g_fopen (test_store.path, "ab");
+  g_assert_nonnull (log);
+  g_assert_cmpuint (fwrite (garbage, 1, sizeof (garbage), log), ==, sizeof (garbage));
+  fclose (log);
+
+  g_test_expect_message ("GFBGraph", G_LOG_LEVEL_WARNING, "Dropping 4096 invalid bytes*");
+  store = gfbgraph_node_store_new (test_store.path, &error);
+  g_test_assert_expected_messages ();
+  g_assert_no_error (error);
+  g_assert_cmpuint (gfbgraph_node_store_get_n_nodes (store), ==, 1);
+
+  gfbgraph_album_set_name (GFBGRAPH_ALBUM (album), "Renamed album");
+  g_assert (gfbgraph_node_store_add_node (store, album, &error));
+  g_assert_no_error (error);
+
+  node = gfbgraph_node_store_get_node (store, "200001", &error);
+  g_assert_no_error (error);
+  g_assert (GFBGRAPH_IS_ALBUM (node));
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (node)), ==, "Renamed album");
+  g_clear_object (&node);
+  g_clear_object (&store);
+
+  /* The appended record is read back from the log when opened again */
+  store = gfbgraph_node_store_new (test_store.path, &error);
+  g_assert_no_error (error);
+  node = gfbgraph_node_store_get_node (store, "200001", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (node)), ==, "Renamed album");
+
+  g_clear_object (&store);
+  test_store_clear (&test_store);
+}
+
+static void
+count_signal_cb (GFBGraphSync *sync,
+                 GFBGraphNode *node,
+                 gpointer      connected,
+                 guint        *count)
+{
+  (*count)++;
+}
+
+static void
+test_offline_sync (OfflineFixture *fixture,
+                   gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphNodeStore) store = NULL;
+  g_autoptr (GFBGraphSync) sync = NULL;
+  g_autoptr (GFBGraphUser) me = NULL;
+  g_autoptr (GFBGraphNode) album = NULL;
+  gchar **ids;
+  TestStore test_store;
+  gchar *watermarks_path;
+  guint n_added = 0;
+  guint n_changed = 0;
+  guint n_removed = 0;
+  GError *error = NULL;
+
+  test_store_init (&test_store);
+  watermarks_path = g_strconcat (test_store.path, ".sync", NULL);
+
+  store = gfbgraph_node_store_new (test_store.path, &error);
+  g_assert_no_error (error);
+  sync = gfbgraph_sync_new (store, GFBGRAPH_AUTHORIZER (fixture->authorizer));
+  g_signal_connect (sync, "node-added", G_CALLBACK (count_signal_cb), &n_added);
+  g_signal_connect (sync, "node-changed", G_CALLBACK (count_signal_cb), &n_changed);
+  g_signal_connect (sync, "node-removed", G_CALLBACK (count_signal_cb), &n_removed);
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+
+  /* The first run retrieves the whole connection */
+  g_assert (gfbgraph_sync_run (sync, GFBGRAPH_NODE (me), GFBGRAPH_TYPE_ALBUM, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_added, ==, 60);
+  g_assert_cmpuint (n_changed, ==, 0);
+  g_assert_cmpint (gfbgraph_sync_get_watermark (sync, GFBGRAPH_NODE (me), GFBGRAPH_TYPE_ALBUM), >, 0);
+  g_assert (g_file_test (watermarks_path, G_FILE_TEST_EXISTS));
+
+  /* Then only the changes. "since" filters by creation time, the edited
+   * album is found by the listing of the update times. */
+  mock_server_touch_node (server, MOCK_ALBUM_ID_BASE + 5);
+  g_assert (gfbgraph_sync_run (sync, GFBGRAPH_NODE (me), GFBGRAPH_TYPE_ALBUM, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_added, ==, 60);
+  g_assert_cmpuint (n_changed, ==, 1);
+  g_assert_cmpuint (n_removed, ==, 0);
+
+  mock_server_set_n_albums (server, 59);
+  gfbgraph_sync_set_detect_removals (sync, TRUE);
+  g_assert (gfbgraph_sync_run (sync, GFBGRAPH_NODE (me), GFBGRAPH_TYPE_ALBUM, NULL, &error));
+  g_assert_no_error (error);
+  mock_server_set_n_albums (server, 60);
+  g_assert_cmpuint (n_added, ==, 60);
+  g_assert_cmpuint (n_changed, ==, 1);
+  g_assert_cmpuint (n_removed, ==, 1);
+
+  ids = gfbgraph_node_store_get_connected_ids (store, gfbgraph_node_get_id (GFBGRAPH_NODE (me)), GFBGRAPH_TYPE_ALBUM);
+  g_assert_cmpuint (g_strv_length (ids), ==, 59);
+  g_assert (!g_strv_contains ((const gchar * const *) ids, "200059"));
+  g_strfreev (ids);
+
+  album = gfbgraph_node_store_get_node (store, "200005", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_node_get_updated_time (album), !=, "2013-01-01T10:00:00+0000");
+
+  g_clear_object (&sync);
+  g_clear_object (&store);
+  test_store_clear (&test_store);
+  g_free (watermarks_path);
+}
+
+static void
+download_finished_cb (GFBGraphPhotoDownloader *downloader,
+                      const gchar             *uri,
+                      GFile                   *destination,
+                      const GError            *error,
+                      gint                    *n_failed)
+{
+  if (error != NULL)
+    g_atomic_int_inc (n_failed);
+}
+
+static GFile*
+add_download (GFBGraphPhotoDownloader *downloader,
+              const gchar             *directory,
+              const gchar             *uri_path,
+              const gchar             *name)
+{
+  GFile *file;
+  gchar *uri;
+  gchar *path;
+  GError *error = NULL;
+
+  uri = g_strconcat (mock_server_get_endpoint (server), uri_path, NULL);
+  path = g_build_filename (directory, name, NULL);
+  file = g_file_new_for_path (path);
+  g_assert (gfbgraph_photo_downloader_add (downloader, uri, file, NULL, &error));
+  g_assert_no_error (error);
+  g_free (path);
+  g_free (uri);
+
+  return file;
+}
+
+/* The part file of an interrupted download, with @validator for If-Range */
+static void
+write_part_file (const gchar *directory,
+                 const gchar *name,
+                 const gchar *validator)
+{
+  gchar *path;
+  gchar *contents;
+  GError *error = NULL;
+
+  path = g_strconcat (directory, G_DIR_SEPARATOR_S, name, ".part", NULL);
+  contents = g_malloc0 (MOCK_MEDIA_SIZE / 2);
+  g_assert (g_file_set_contents (path, contents, MOCK_MEDIA_SIZE / 2, &error));
+  g_assert_no_error (error);
+  g_free (contents);
+  g_free (path);
+
+  path = g_strconcat (directory, G_DIR_SEPARATOR_S, name, ".part.if-range", NULL);
+  g_assert (g_file_set_contents (path, validator, -1, &error));
+  g_assert_no_error (error);
+  g_free (path);
+}
+
+static void
+test_offline_photo_downloader (OfflineFixture *fixture,
+                               gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphPhotoDownloader) downloader = NULL;
+  GPtrArray *files;
+  gchar *directory;
+  gchar *path;
+  gchar *contents;
+  gchar *resumed;
+  gsize length;
+  gint n_failed = 0;
+  guint i;
+  GError *error = NULL;
+
+  directory = g_dir_make_tmp ("gfbgraph-downloads-XXXXXX", &error);
+  g_assert_no_error (error);
+  files = g_ptr_array_new_with_free_func (g_object_unref);
+
+  /* A queue smaller than the downloads, so adding them blocks */
+  downloader = gfbgraph_photo_downloader_new (4, 2);
+  g_signal_connect (downloader, "download-finished", G_CALLBACK (download_finished_cb), &n_failed);
+
+  for (i = 0; i < 20; i++) {
+    gchar *uri_path;
+    gchar *name;
+
+    uri_path = g_strdup_printf ("/media/%u-960.jpg", MOCK_PHOTO_ID_BASE + i);
+    name = g_strdup_printf ("%u.jpg", i);
+    g_ptr_array_add (files, add_download (downloader, directory, uri_path, name));
+    g_free (name);
+    g_free (uri_path);
+  }
+  /* Not an image, it fails without stopping the other downloads */
+  g_ptr_array_add (files, add_download (downloader, directory, "/missing.jpg", "missing.jpg"));
+
+  gfbgraph_photo_downloader_wait (downloader);
+  g_assert_cmpint (n_failed, ==, 1);
+
+  path = g_build_filename (directory, "0.jpg", NULL);
+  g_assert (g_file_get_contents (path, &contents, &length, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (length, ==, MOCK_MEDIA_SIZE);
+  g_free (path);
+
+  /* An interrupted download, only the missing bytes are requested */
+  write_part_file (directory, "resumed.jpg", "\"300000-960.jpg\"");
+  g_ptr_array_add (files, add_download (downloader, directory, "/media/300000-960.jpg", "resumed.jpg"));
+  gfbgraph_photo_downloader_wait (downloader);
+  g_assert_cmpint (n_failed, ==, 1);
+
+  path = g_build_filename (directory, "resumed.jpg", NULL);
+  g_assert (g_file_get_contents (path, &resumed, &length, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (length, ==, MOCK_MEDIA_SIZE);
+  for (i = 0; i < MOCK_MEDIA_SIZE / 2; i++)
+    g_assert_cmpint (resumed[i], ==, 0);
+  g_assert (memcmp (resumed + MOCK_MEDIA_SIZE / 2, contents + MOCK_MEDIA_SIZE / 2, MOCK_MEDIA_SIZE / 2) == 0);
+  g_free (resumed);
+  g_free (path);
+
+  /* The part file of another version of the image is downloaded again */
+  write_part_file (directory, "changed.jpg", "\"changed\"");
+  g_ptr_array_add (files, add_download (downloader, directory, "/media/300000-960.jpg", "changed.jpg"));
+  gfbgraph_photo_downloader_wait (downloader);
+  g_assert_cmpint (n_failed, ==, 1);
+
+  path = g_build_filename (directory, "changed.jpg", NULL);
+  g_assert (g_file_get_contents (path, &resumed, &length, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (length, ==, MOCK_MEDIA_SIZE);
+  g_assert (memcmp (resumed, contents, MOCK_MEDIA_SIZE) == 0);
+  g_free (resumed);
+  g_free (contents);
+  g_free (path);
+
+  for (i = 0; i < files->len; i++)
+    g_file_delete (g_ptr_array_index (files, i), NULL, NULL);
+  g_ptr_array_unref (files);
+  g_rmdir (directory);
+  g_free (directory);
+}
+
+static gpointer
+process_calls_thread (GFBGraphAuthorizer *authorizer)
+{
+  guint i;
+
+  for (i = 0; i < 2000; i++) {
+    RestProxyCall *call;
+    RestParam *param;
+    const gchar *token;
+
+    call = gfbgraph_new_rest_call (authorizer);
+    param = rest_proxy_call_lookup_param (call, "access_token");
+    g_assert_nonnull (param);
+    token = rest_param_get_content (param);
+    g_assert (g_str_has_prefix (token, "mock-token-"));
+    g_object_unref (call);
+  }
+
+  return NULL;
+}
+
+static void
+test_offline_token_snapshot (OfflineFixture *fixture,
+                             gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphSimpleAuthorizer) authorizer = NULL;
+  GThread *threads[4];
+  gchar *token;
+  guint i;
+
+  /* The requests read the token while it's replaced */
+  authorizer = gfbgraph_simple_authorizer_new ("mock-token-0");
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("process-calls", (GThreadFunc) process_calls_thread, authorizer);
+
+  for (i = 1; i <= 2000; i++) {
+    token = g_strdup_printf ("mock-token-%u", i);
+    g_object_set (authorizer, "access-token", token, NULL);
+    g_free (token);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  g_object_get (authorizer, "access-token", &token, NULL);
+  g_assert_cmpstr (token, ==, "mock-token-2000");
+  g_free (token);
+}
+
+static void
+test_offline_photo_cache (OfflineFixture *fixture,
+                          gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphPhotoCache) photo_cache = NULL;
+  g_autoptr (GFBGraphNode) photo = NULL;
+  GInputStream *stream;
+  GBytes *bytes[3];
+  gchar *directory;
+  gchar buffer[64];
+  gsize n_read;
+  guint n_requests;
+  guint i;
+  GError *error = NULL;
+
+  directory = g_dir_make_tmp ("gfbgraph-photo-cache-XXXXXX", &error);
+  g_assert_no_error (error);
+  for (i = 0; i < G_N_ELEMENTS (bytes); i++)
+    bytes[i] = g_bytes_new_take (g_strnfill (sizeof (buffer), 'a' + i), sizeof (buffer));
+
+  /* Room for two blobs */
+  photo_cache = gfbgraph_photo_cache_new (directory, 2 * sizeof (buffer));
+
+  /* The same bytes in two URIs are stored once */
+  g_assert (gfbgraph_photo_cache_store (photo_cache, "http://example.org/a.jpg", bytes[0], &error));
+  g_assert_no_error (error);
+  g_assert (gfbgraph_photo_cache_store (photo_cache, "http://example.org/album/a.jpg", bytes[0], &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (gfbgraph_photo_cache_get_n_blobs (photo_cache), ==, 1);
+  g_assert_cmpuint (gfbgraph_photo_cache_get_size (photo_cache), ==, sizeof (buffer));
+
+  stream = gfbgraph_photo_cache_lookup (photo_cache, "http://example.org/album/a.jpg");
+  g_assert (G_IS_INPUT_STREAM (stream));
+  g_assert (g_input_stream_read_all (stream, buffer, sizeof (buffer), &n_read, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_read, ==, sizeof (buffer));
+  g_assert (memcmp (buffer, g_bytes_get_data (bytes[0], NULL), sizeof (buffer)) == 0);
+  g_object_unref (stream);
+
+  g_assert_null (gfbgraph_photo_cache_lookup (photo_cache, "http://example.org/b.jpg"));
+  g_assert_cmpuint (gfbgraph_photo_cache_get_n_hits (photo_cache), ==, 1);
+  g_assert_cmpuint (gfbgraph_photo_cache_get_n_misses (photo_cache), ==, 1);
+
+  /* "a" is used after "b", so "b" is the one evicted by "c" */
+  g_assert (gfbgraph_photo_cache_store (photo_cache, "http://example.org/b.jpg", bytes[1], &error));
+  g_assert_no_error (error);
+  stream = gfbgraph_photo_cache_lookup (photo_cache, "http://example.org/a.jpg");
+  g_assert (G_IS_INPUT_STREAM (stream));
+  g_object_unref (stream);
+  g_assert (gfbgraph_photo_cache_store (photo_cache, "http://example.org/c.jpg", bytes[2], &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (gfbgraph_photo_cache_get_n_blobs (photo_cache), ==, 2);
+  g_assert_null (gfbgraph_photo_cache_lookup (photo_cache, "http://example.org/b.jpg"));
+  stream = gfbgraph_photo_cache_lookup (photo_cache, "http://example.org/a.jpg");
+  g_assert (G_IS_INPUT_STREAM (stream));
+  g_object_unref (stream);
+
+  /* The blobs are found again by a new cache in the same directory */
+  g_clear_object (&photo_cache);
+  photo_cache = gfbgraph_photo_cache_new (directory, 2 * MOCK_MEDIA_SIZE);
+  g_assert_cmpuint (gfbgraph_photo_cache_get_n_blobs (photo_cache), ==, 2);
+
+  /* A photo downloaded twice is requested once */
+  gfbgraph_client_set_photo_cache (gfbgraph_client_get_default (), photo_cache);
+  photo = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "300000", GFBGRAPH_TYPE_PHOTO, &error);
+  g_assert_no_error (error);
+
+  for (i = 0; i < 2; i++) {
+    gchar *contents;
+
+    n_requests = mock_server_get_n_requests (server);
+    stream = gfbgraph_photo_download_default_size (GFBGRAPH_PHOTO (photo), GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+    g_assert_no_error (error);
+    contents = g_malloc (MOCK_MEDIA_SIZE);
+    g_assert (g_input_stream_read_all (stream, contents, MOCK_MEDIA_SIZE, &n_read, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (n_read, ==, MOCK_MEDIA_SIZE);
+    g_assert_cmpuint (mock_server_get_n_requests (server), ==, n_requests + (i == 0 ? 1 : 0));
+    g_object_unref (stream);
+    g_free (contents);
+  }
+  gfbgraph_client_set_photo_cache (gfbgraph_client_get_default (), NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (bytes); i++)
+    g_bytes_unref (bytes[i]);
+  test_remove_directory (directory);
+  g_free (directory);
+}
+
+static void
+test_offline_photo_cache_not_found (OfflineFixture *fixture,
+                                    gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphPhotoCache) photo_cache = NULL;
+  g_autoptr (GFBGraphNode) photo = NULL;
+  GInputStream *stream;
+  gchar *directory;
+  gchar *source;
+  GError *error = NULL;
+
+  directory = g_dir_make_tmp ("gfbgraph-photo-cache-XXXXXX", &error);
+  g_assert_no_error (error);
+  photo_cache = gfbgraph_photo_cache_new (directory, 2 * MOCK_MEDIA_SIZE);
+  gfbgraph_client_set_photo_cache (gfbgraph_client_get_default (), photo_cache);
+
+  photo = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "300000", GFBGRAPH_TYPE_PHOTO, &error);
+  g_assert_no_error (error);
+  source = g_strdup_printf ("%s/media/missing.jpg", mock_server_get_endpoint (server));
+  g_object_set (photo, "source", source, NULL);
+
+  /* The body of the error response isn't the photo */
+  stream = gfbgraph_photo_download_default_size (GFBGRAPH_PHOTO (photo), GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_error (error, SOUP_HTTP_ERROR, SOUP_STATUS_NOT_FOUND);
+  g_assert_null (stream);
+  g_clear_error (&error);
+
+  g_assert_cmpuint (gfbgraph_photo_cache_get_n_blobs (photo_cache), ==, 0);
+  g_assert_cmpuint (gfbgraph_photo_cache_get_size (photo_cache), ==, 0);
+  g_assert_null (gfbgraph_photo_cache_lookup (photo_cache, source));
+  gfbgraph_client_set_photo_cache (gfbgraph_client_get_default (), NULL);
+
+  g_free (source);
+  test_remove_directory (directory);
+  g_free (directory);
+}
+
+static void
+test_offline_disk_cache (OfflineFixture *fixture,
+                         gconstpointer   user_data)
+{
+  GFBGraphClient *client;
+  g_autoptr (GFBGraphDiskCache) cache = NULL;
+  g_autoptr (GFBGraphNode) album = NULL;
+  g_autoptr (GBytes) first = NULL;
+  g_autoptr (GBytes) second = NULL;
+  GBytes *payload = NULL;
+  gchar *etag = NULL;
+  gint64 expiration;
+  guint n_not_modified;
+  gchar *directory;
+  GError *error = NULL;
+
+  directory = g_dir_make_tmp ("gfbgraph-disk-cache-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  client = gfbgraph_client_get_default ();
+  cache = gfbgraph_disk_cache_new (directory, 0);
+  gfbgraph_client_set_cache (client, GFBGRAPH_CACHE (cache));
+
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200002", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_clear_object (&album);
+  g_assert_cmpuint (gfbgraph_disk_cache_get_size (cache), >, 0);
+
+  /* The responses are found by a new cache in the same directory, and
+   * revalidated with their ETag */
+  gfbgraph_client_set_cache (client, NULL);
+  g_clear_object (&cache);
+  cache = gfbgraph_disk_cache_new (directory, 0);
+  g_assert_cmpuint (gfbgraph_disk_cache_get_size (cache), >, 0);
+  gfbgraph_client_set_cache (client, GFBGRAPH_CACHE (cache));
+
+  n_not_modified = mock_server_get_n_not_modified (server);
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200002", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Album 2");
+  g_assert_cmpuint (mock_server_get_n_not_modified (server), ==, n_not_modified + 1);
+  g_clear_object (&album);
+
+  gfbgraph_client_set_cache (client, NULL);
+  g_clear_object (&cache);
+
+  /* The stored responses don't fit in a smaller cache */
+  cache = gfbgraph_disk_cache_new (directory, 64);
+  g_assert_cmpuint (gfbgraph_disk_cache_get_size (cache), ==, 0);
+
+  /* Each entry takes 44 bytes, so the least recently used is evicted */
+  first = g_bytes_new_static ("01234567890123456789", 20);
+  second = g_bytes_new_static ("98765432109876543210", 20);
+  gfbgraph_cache_store (GFBGRAPH_CACHE (cache), "first", first, "etag-1", 0);
+  gfbgraph_cache_store (GFBGRAPH_CACHE (cache), "second", second, "etag-2", 0);
+  g_assert_cmpuint (gfbgraph_disk_cache_get_size (cache), ==, 44);
+
+  g_assert (!gfbgraph_cache_lookup (GFBGRAPH_CACHE (cache), "first", &payload, &etag, &expiration));
+  g_assert (gfbgraph_cache_lookup (GFBGRAPH_CACHE (cache), "second", &payload, &etag, &expiration));
+  g_assert (g_bytes_equal (payload, second));
+  g_assert_cmpstr (etag, ==, "etag-2");
+  g_bytes_unref (payload);
+  g_free (etag);
+
+  g_clear_object (&cache);
+  test_remove_directory (directory);
+  g_free (directory);
+}
+
+static gpointer
+test_offline_token_refresh_thread (gpointer authorizer)
+{
+  GFBGraphUser *me;
+  GError *error = NULL;
+
+  me = gfbgraph_user_get_me (authorizer, &error);
+  g_assert_no_error (error);
+
+  return me;
+}
+
+static void
+test_offline_token_refresh (OfflineFixture *fixture,
+                            gconstpointer   user_data)
+{
+  OfflineAuthorizer *authorizer;
+  GThread *threads[8];
+  GFBGraphToken *token;
+  guint i;
+
+  /* Every request is rejected with the token expired, they refresh it once
+   * and are sent again with the new one */
+  authorizer = g_object_new (offline_authorizer_get_type (), NULL);
+  mock_server_fail_requests (server, G_N_ELEMENTS (threads), SOUP_STATUS_BAD_REQUEST, GFBGRAPH_API_ERROR_OAUTH);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("token-refresh", test_offline_token_refresh_thread, authorizer);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++) {
+    GFBGraphUser *me;
+
+    me = g_thread_join (threads[i]);
+    g_assert (GFBGRAPH_IS_USER (me));
+    g_object_unref (me);
+  }
+
+  g_assert_cmpint (g_atomic_int_get (&authorizer->n_refreshes), ==, 1);
+  token = gfbgraph_token_slot_get (&authorizer->slot);
+  g_assert_cmpstr (token->access_token, ==, "mock-refreshed-token-1");
+  gfbgraph_token_unref (token);
+
+  g_object_unref (authorizer);
+}
+
+typedef struct
+{
+  GFBGraphTokenSlot  slot;
+  GCancellable      *cancellable;
+  gint               n_calls;
+} TokenSlotData;
+
+static GFBGraphToken*
+test_offline_token_slot_get_token (TokenSlotData  *data,
+                                   GCancellable   *cancellable,
+                                   GError        **error)
+{
+  guint i;
+
+  g_atomic_int_inc (&data->n_calls);
+
+  /* Long enough for the other caller to wait for it */
+  for (i = 0; i < 20; i++) {
+    if (g_cancellable_set_error_if_cancelled (cancellable, error))
+      return NULL;
+    g_usleep (G_USEC_PER_SEC / 100);
+  }
+
+  return gfbgraph_token_new ("mock-slot-token");
+}
+
+static gpointer
+test_offline_token_slot_leader_thread (gpointer user_data)
+{
+  TokenSlotData *data = user_data;
+  GError *error = NULL;
+  gboolean success;
+
+  success = gfbgraph_token_slot_refresh (&data->slot,
+                                         (GFBGraphTokenRefreshFunc) test_offline_token_slot_get_token, data,
+                                         data->cancellable, &error);
+  g_clear_error (&error);
+
+  return GINT_TO_POINTER (success);
+}
+
+static gpointer
+test_offline_token_slot_cancel_thread (gpointer cancellable)
+{
+  g_usleep (G_USEC_PER_SEC / 20);
+  g_cancellable_cancel (cancellable);
+
+  return NULL;
+}
+
+static void
+test_offline_token_refresh_cancel (OfflineFixture *fixture,
+                                   gconstpointer   user_data)
+{
+  TokenSlotData data = { 0, };
+  GCancellable *cancellable;
+  GFBGraphToken *token;
+  GThread *leader;
+  GThread *canceller;
+  GError *error = NULL;
+
+  gfbgraph_token_slot_init (&data.slot);
+
+  /* A waiter gives up on its own cancellation, the refresh goes on */
+  cancellable = g_cancellable_new ();
+  leader = g_thread_new ("token-leader", test_offline_token_slot_leader_thread, &data);
+  g_usleep (G_USEC_PER_SEC / 50);
+  canceller = g_thread_new ("token-cancel", test_offline_token_slot_cancel_thread, cancellable);
+
+  g_assert (!gfbgraph_token_slot_refresh (&data.slot,
+                                          (GFBGraphTokenRefreshFunc) test_offline_token_slot_get_token, &data,
+                                          cancellable, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&error);
+  g_assert (gfbgraph_token_slot_get (&data.slot) == NULL);
+
+  g_thread_join (canceller);
+  g_assert (GPOINTER_TO_INT (g_thread_join (leader)));
+  g_assert_cmpint (g_atomic_int_get (&data.n_calls), ==, 1);
+  g_object_unref (cancellable);
+
+  /* A waiter takes over the refresh of a cancelled leader */
+  gfbgraph_token_slot_publish (&data.slot, NULL);
+  data.n_calls = 0;
+  data.cancellable = g_cancellable_new ();
+  leader = g_thread_new ("token-leader", test_offline_token_slot_leader_thread, &data);
+  g_usleep (G_USEC_PER_SEC / 50);
+  canceller = g_thread_new ("token-cancel", test_offline_token_slot_cancel_thread, data.cancellable);
+
+  g_assert (gfbgraph_token_slot_refresh (&data.slot,
+                                         (GFBGraphTokenRefreshFunc) test_offline_token_slot_get_token, &data,
+                                         NULL, &error));
+  g_assert_no_error (error);
+
+  g_thread_join (canceller);
+  g_assert (!GPOINTER_TO_INT (g_thread_join (leader)));
+  g_assert_cmpint (g_atomic_int_get (&data.n_calls), ==, 2);
+  token = gfbgraph_token_slot_get (&data.slot);
+  g_assert_cmpstr (token->access_token, ==, "mock-slot-token");
+  gfbgraph_token_unref (token);
+  g_object_unref (data.cancellable);
+
+  gfbgraph_token_slot_clear (&data.slot);
+}
+
+static void
+test_offline_authorizer_pool (OfflineFixture *fixture,
+                              gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphAuthorizerPool) pool = NULL;
+  g_autoptr (GFBGraphUser) me = NULL;
+  GFBGraphAuthorizer *first;
+  GFBGraphAuthorizer *second;
+  GError *error = NULL;
+  guint i;
+
+  pool = gfbgraph_authorizer_pool_new (GFBGRAPH_AUTHORIZER_POOL_ROUND_ROBIN);
+  first = gfbgraph_authorizer_pool_add_token (pool, "mock-pool-token-1");
+  second = gfbgraph_authorizer_pool_add_token (pool, "mock-pool-token-2");
+
+  /* The requests are spread over the tokens */
+  for (i = 0; i < 4; i++) {
+    me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (pool), &error);
+    g_assert_no_error (error);
+    g_clear_object (&me);
+  }
+  g_assert_cmpuint (gfbgraph_authorizer_pool_get_n_requests (pool, first), ==, 2);
+  g_assert_cmpuint (gfbgraph_authorizer_pool_get_n_requests (pool, second), ==, 2);
+  g_assert_cmpfloat (gfbgraph_authorizer_pool_get_usage (pool, first), ==, 0);
+
+  /* A throttled token is quarantined, the request is retried with the other */
+  mock_server_fail_requests (server, 1, SOUP_STATUS_BAD_REQUEST, GFBGRAPH_API_ERROR_RATE_LIMIT);
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (pool), &error);
+  g_assert_no_error (error);
+  g_assert (gfbgraph_authorizer_pool_is_quarantined (pool, first));
+  g_assert (!gfbgraph_authorizer_pool_is_quarantined (pool, second));
+  g_assert_cmpuint (gfbgraph_authorizer_pool_get_n_available (pool), ==, 1);
+  g_assert_cmpuint (gfbgraph_authorizer_pool_get_n_requests (pool, first), ==, 3);
+  g_assert_cmpuint (gfbgraph_authorizer_pool_get_n_requests (pool, second), ==, 3);
+}
+
+static void
+test_offline_metrics_request_finished_cb (GFBGraphClient *client,
+                                          RestProxyCall  *call,
+                                          gint64          latency,
+                                          const GError   *error,
+                                          gpointer        user_data)
+{
+  guint *n_finished = user_data;
+
+  g_assert_no_error (error);
+  g_assert_cmpint (latency, >=, 0);
+  (*n_finished)++;
+}
+
+static void
+test_offline_metrics (OfflineFixture *fixture,
+                      gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphMetrics) metrics = NULL;
+  g_autoptr (GFBGraphUser) me = NULL;
+  GFBGraphClient *client;
+  GFBGraphMetricsCounters counters;
+  guint64 n_parses;
+  guint n_finished = 0;
+  gulong handler;
+  gchar *dump;
+  GError *error = NULL;
+
+  client = gfbgraph_client_get_default ();
+  metrics = gfbgraph_metrics_new ();
+  gfbgraph_client_set_metrics (client, metrics);
+  handler = g_signal_connect (client, "request-finished",
+                              G_CALLBACK (test_offline_metrics_request_finished_cb), &n_finished);
+
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_finished, ==, 1);
+
+  g_assert (gfbgraph_metrics_get_counters (metrics, "GET", "me", &counters));
+  g_assert_cmpuint (counters.n_requests, ==, 1);
+  g_assert_cmpuint (counters.n_errors, ==, 0);
+  g_assert_cmpuint (counters.bytes_received, >, 0);
+  g_assert_cmpuint (counters.n_parses, ==, 1);
+  g_assert (!gfbgraph_metrics_get_counters (metrics, "POST", NULL, &counters));
+
+  gfbgraph_metrics_get_parse_time (metrics, &n_parses);
+  g_assert_cmpuint (n_parses, ==, 1);
+
+  dump = gfbgraph_metrics_dump_prometheus (metrics);
+  g_assert (strstr (dump, "gfbgraph_requests_total{method=\"GET\",endpoint=\"me\"} 1\n") != NULL);
+  g_assert (strstr (dump, "gfbgraph_json_parses_total{method=\"GET\",endpoint=\"me\"} 1\n") != NULL);
+  g_free (dump);
+
+  /* The requests aren't instrumented anymore */
+  gfbgraph_client_set_metrics (client, NULL);
+  g_clear_object (&me);
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_finished, ==, 1);
+
+  g_signal_handler_disconnect (client, handler);
+}
+
+static void
+test_offline_tracer_collect_cb (const GFBGraphTraceSpan *span,
+                                gpointer                 user_data)
+{
+  GString *names = user_data;
+
+  g_assert_cmpint (span->end, >=, span->start);
+  g_assert_cmpstr (span->endpoint, ==, "GET me");
+  g_assert_null (span->error);
+
+  if (names->len > 0)
+    g_string_append_c (names, ',');
+  g_string_append (names, span->name);
+}
+
+static void
+test_offline_tracer_page_cb (const GFBGraphTraceSpan *span,
+                             gpointer                 user_data)
+{
+  guint *n_items = user_data;
+
+  /* A single span for the elements of the page */
+  if (g_strcmp0 (span->name, "deserialize") == 0) {
+    g_assert_cmpuint (*n_items, ==, 0);
+    *n_items = span->n_items;
+  }
+}
+
+static void
+test_offline_tracer (OfflineFixture *fixture,
+                     gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphTracer) tracer = NULL;
+  g_autoptr (GFBGraphTracer) small = NULL;
+  g_autoptr (GFBGraphUser) me = NULL;
+  g_autoptr (GFBGraphNode) album = NULL;
+  GFBGraphClient *client;
+  GString *names;
+  GList *photos;
+  gchar *dump;
+  guint n_items = 0;
+  GError *error = NULL;
+
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), "200001", GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+
+  client = gfbgraph_client_get_default ();
+  tracer = gfbgraph_tracer_new (1024);
+  gfbgraph_client_set_tracer (client, tracer);
+
+  /* The spans are recorded when they end, so the request comes after its
+   * HTTP exchange but before the parsing of its response */
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+
+  names = g_string_new (NULL);
+  gfbgraph_tracer_foreach (tracer, test_offline_tracer_collect_cb, names);
+  g_assert_cmpstr (names->str, ==, "queue,http,request,parse,deserialize");
+  g_string_free (names, TRUE);
+
+  dump = gfbgraph_tracer_dump_chrome_trace (tracer);
+  g_assert (g_str_has_prefix (dump, "{\"traceEvents\":["));
+  g_assert (strstr (dump, "\"name\":\"http\"") != NULL);
+  g_assert (strstr (dump, "\"ph\":\"X\"") != NULL);
+  g_free (dump);
+
+  gfbgraph_tracer_clear (tracer);
+  g_assert_cmpuint (gfbgraph_tracer_get_n_spans (tracer), ==, 0);
+
+  photos = gfbgraph_node_get_connection_nodes (album, GFBGRAPH_TYPE_PHOTO, GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  gfbgraph_tracer_foreach (tracer, test_offline_tracer_page_cb, &n_items);
+  g_assert_cmpuint (n_items, ==, g_list_length (photos));
+  g_list_free_full (photos, g_object_unref);
+  gfbgraph_tracer_clear (tracer);
+
+  /* Only the last spans are kept */
+  small = gfbgraph_tracer_new (2);
+  gfbgraph_client_set_tracer (client, small);
+  g_clear_object (&me);
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gfbgraph_tracer_get_n_spans (small), ==, 2);
+
+  names = g_string_new (NULL);
+  gfbgraph_tracer_foreach (small, test_offline_tracer_collect_cb, names);
+  g_assert_cmpstr (names->str, ==, "parse,deserialize");
+  g_string_free (names, TRUE);
+
+  /* The requests aren't traced anymore */
+  gfbgraph_client_set_tracer (client, NULL);
+  gfbgraph_tracer_clear (small);
+  g_clear_object (&me);
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (gfbgraph_tracer_get_n_spans (small), ==, 0);
+}
+
+static void
+test_offline_deserialize (OfflineFixture *fixture,
+                          gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphNode) album = NULL;
+  g_autoptr (GFBGraphNode) node = NULL;
+  g_autoptr (GFBGraphNode) photo = NULL;
+  GError *error = NULL;
+  gchar *id;
+
+  id = g_strdup_printf ("%u", MOCK_ALBUM_ID_BASE + 5);
+  album = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), id, GFBGRAPH_TYPE_ALBUM, &error);
+  g_assert_no_error (error);
+  node = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), id, offline_node_get_type (), &error);
+  g_assert_no_error (error);
+
+  /* Set by the members of the album and its parent */
+  g_assert_cmpstr (gfbgraph_node_get_id (album), ==, id);
+  g_assert_cmpstr (gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)), ==, "Album 5");
+  g_assert_cmpstr (gfbgraph_album_get_description (GFBGRAPH_ALBUM (album)), ==, "The album number 5");
+  g_assert_cmpstr (gfbgraph_node_get_created_time (album), ==, "2013-01-02T10:00:00+0000");
+  g_assert_nonnull (gfbgraph_node_get_updated_time (album));
+  g_assert_null (gfbgraph_node_get_link (album));
+
+  /* The same values through the properties */
+  g_assert_cmpstr (gfbgraph_node_get_id (node), ==, id);
+  g_assert_cmpstr (((OfflineNode *) node)->name, ==, gfbgraph_album_get_name (GFBGRAPH_ALBUM (album)));
+  g_assert_cmpuint (((OfflineNode *) node)->count, ==, gfbgraph_album_get_count (GFBGRAPH_ALBUM (album)));
+  g_assert_cmpuint (((OfflineNode *) node)->count, >, 0);
+  g_free (id);
+
+  id = g_strdup_printf ("%u", MOCK_PHOTO_ID_BASE + 1);
+  photo = gfbgraph_node_new_from_id (GFBGRAPH_AUTHORIZER (fixture->authorizer), id, GFBGRAPH_TYPE_PHOTO, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (gfbgraph_photo_get_name (GFBGRAPH_PHOTO (photo)), ==, "Photo 1");
+  g_assert (g_str_has_suffix (gfbgraph_photo_get_default_source_uri (GFBGRAPH_PHOTO (photo)), "-960.jpg"));
+  g_assert_cmpuint (gfbgraph_photo_get_default_width (GFBGRAPH_PHOTO (photo)), ==, 960);
+  g_assert_cmpuint (gfbgraph_photo_get_default_height (GFBGRAPH_PHOTO (photo)), ==, 720);
+  g_assert_cmpuint (gfbgraph_photo_get_image_hires (GFBGRAPH_PHOTO (photo))->height, ==, 1536);
+  g_free (id);
+}
+
+static void
+test_offline_throttled (OfflineFixture *fixture,
+                        gconstpointer   user_data)
+{
+  g_autoptr (GFBGraphUser) me = NULL;
+  GError *error = NULL;
+  gint64 start;
+
+  /* The token is paused after the throttling error, the test has its own
+   * token to not slow down the others */
+  mock_server_fail_requests (server, 1, SOUP_STATUS_BAD_REQUEST, GFBGRAPH_API_ERROR_RATE_LIMIT);
+
+  start = g_get_monotonic_time ();
+  me = gfbgraph_user_get_me (GFBGRAPH_AUTHORIZER (fixture->authorizer), &error);
+  g_assert_no_error (error);
+  g_assert (GFBGRAPH_IS_USER (me));
+  g_assert_cmpint (g_get_monotonic_time () - start, >=, G_USEC_PER_SEC);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  int test_result;
+
+  g_test_init (&argc, &argv, NULL);
+
+  server = mock_server_new ();
+  /* Before the default client is created */
+  g_setenv ("GFBGRAPH_ENDPOINT", mock_server_get_endpoint (server), TRUE);
+
+  g_test_add ("/GFBGraph/Offline/Me", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_me, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/MeAsync", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_me_async, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/NodeFromId", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_node_from_id, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/NodeFromIds", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_node_from_ids, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/PhotoImages", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_photo_images, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/ConnectionNodes", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_connection_nodes, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/ConnectionIterator", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_connection_iterator, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/ConnectionIteratorCancel", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_connection_iterator_cancel, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/Batch", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_batch, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/ApiError", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_api_error, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/Retry", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_retry, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/Cache", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_cache, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/DiskCache", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_disk_cache, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/NodeStore", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_node_store, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/NodeStoreCorruptTail", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_node_store_corrupt_tail, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/Sync", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_sync, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/PhotoDownloader", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_photo_downloader, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/TokenSnapshot", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_token_snapshot, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/PhotoCache", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_photo_cache, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/PhotoCacheNotFound", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_photo_cache_not_found, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/TokenRefresh", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_token_refresh, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/TokenRefreshCancel", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_token_refresh_cancel, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/AuthorizerPool", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_authorizer_pool, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/Metrics", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_metrics, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/Tracer", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_tracer, offline_fixture_teardown);
+  g_test_add ("/GFBGraph/Offline/Deserialize", OfflineFixture, NULL,
+              offline_fixture_setup, test_offline_deserialize, offline_fixture_teardown);
+  if (g_test_slow ())
+    g_test_add ("/GFBGraph/Offline/Throttled", OfflineFixture, "mock-throttled-token",
+                offline_fixture_setup, test_offline_throttled, offline_fixture_teardown);
+
+  test_result = g_test_run ();
+
+  mock_server_free (server);
+
+  return test_result;
+}
@@ -0,0 +1,65 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+
+#include "test-store.h"
+
+void
+test_store_init (TestStore *store)
+{
+  GError *error = NULL;
+
+  store->directory = g_dir_make_tmp ("gfbgraph-store-XXXXXX", &error);
+  g_assert_no_error (error);
+  store->path = g_build_filename (store->directory, "store", NULL);
+}
+
+void
+test_store_clear (TestStore *store)
+{
+  test_remove_directory (store->directory);
+  g_clear_pointer (&store->path, g_free);
+  g_clear_pointer (&store->directory, g_free);
+}
+
+void
+test_remove_directory (const gchar *directory)
+{
+  GDir *dir;
+  const gchar *name;
+
+  dir = g_dir_open (directory, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL) {
+    gchar *path;
+
+    path = g_build_filename (directory, name, NULL);
+    if (g_file_test (path, G_FILE_TEST_IS_DIR))
+      test_remove_directory (path);
+    else
+      g_unlink (path);
+    g_free (path);
+  }
+  g_dir_close (dir);
+
+  g_rmdir (directory);
+}
@@ -0,0 +1,42 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 2; tab-width: 2 -*-  */
+/*
+ * libgfbgraph - GObject library for Facebook Graph API
+ * Copyright (C) 2026 The GFBGraph authors
+ *
+ * GFBGraph is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GFBGraph is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GFBGraph.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TEST_STORE_H__
+#define __TEST_STORE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* The path of a node store in a temporary directory. Clearing it removes
+ * the directory, with the log, the index and the sync watermarks in it. */
+typedef struct
+{
+  gchar *directory;
+  gchar *path;
+} TestStore;
+
+void test_store_init       (TestStore   *store);
+void test_store_clear      (TestStore   *store);
+
+void test_remove_directory (const gchar *directory);
+
+G_END_DECLS
+
+#endif /* __TEST_STORE_H__ */